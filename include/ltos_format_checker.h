@@ -41,10 +41,13 @@
 #include <stdarg.h>
 #include <dirent.h>
 #include <math.h>
+#include <fnmatch.h>
+#include <sys/statvfs.h>
 #include "spti_lib.h"
 #include "endian_utils.h"
 #include "str_replace.h"
 #include "output_level.h"
+#include "metrics.h"
 #include "scsi_util.h"
 #include "object_reader.h"
 
@@ -84,7 +87,9 @@
 #define UUID_LAST_OBJECT                          ZERO_FILLED_UUID
 #define JSON_EXT                                  ".json"
 #define ARRAY_KEY                                 "ObjectList"
-#define DEVICE_CHECK_COMMAND                      "lsscsi -g | grep tape | grep %s > /dev/null"
+#define SYSFS_SCSI_DEVICE_PATH                    "/sys/bus/scsi/devices"
+#define SCSI_TYPE_TAPE                            (1)
+#define COPY_CHUNK_SIZE                           (1024 * 1024)
 #define COMMAND_SIZE                              (PATH_MAX)
 #define OBJECT_SERIES_FILE_MARK_NUM               (-2)
 #define UTC_LENGTH                                (27)
@@ -266,6 +271,7 @@
 #define HYPHEN_ASCII                              (45)
 #define DOT_ASCII                                 (46)
 #define MIN(A, B)                                 ((A) < (B) ? (A) : (B))
+#define MAX(A, B)                                 ((A) > (B) ? (A) : (B))
 
 #define MAM_VCI_ACSI_VERSION_SIZE                 (1)
 
@@ -284,7 +290,6 @@
 typedef enum { false, true } Bool;
 
 #define OBJ_READER_MAX_SAVE_NUM      (1000)
-#define LARGE_OBJ_SIZE               (1)
 /* Bucket info for Object Reader */
 typedef struct BucketInfo4ObjReader {
   char bucket_name[BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1];
@@ -358,8 +363,7 @@ typedef enum {
   META,
 } MARKER_TYPE;
 
-extern uint64_t pr_num;
-extern uint64_t dp_rcm_block_number;
+#include "reader_context.h"
 
 /* Function prototypes */
 //void          print_usage(char *appname);
@@ -379,16 +383,23 @@ int           add_key_value_pairs_to_array_in_json_file(int new_list_flag, FILE*
 int           make_key_str_value_pairs(char** json_obj, const char* key, const char* value);
 int           make_key_ulong_int_value_pairs(char** json_obj, const char* key, const uint64_t value);
 int           read_property(const char* file_path, const char* key, char** value);
-int           output_history(const char* tape_id, const uint64_t pr_cnt, const uint64_t ocm_cnt, const uint64_t po_cnt, const uint64_t obj_cnt);
-int           get_history(const char* tape_id, uint64_t* pr_cnt, uint64_t* ocm_cnt, uint64_t* po_cnt, uint64_t* obj_cnt);
+int           output_history(const history_record* const history);
+int           get_history(const char* tape_id, history_record* const history);
+int           close_history(void);
 int           initialize_bucket_info_4_obj_reader(BucketInfo4ObjReader** bucket_info_4_obj_reader, char* obj_reader_saveroot);
 int           add_bucket_info_4_obj_reader(BucketInfo4ObjReader** bucket_info_4_obj_reader,
                                            char* bucket_name, int obj_reader_saved_counter, int savepath_dir_number, int savepath_sub_dir_number);
 int           get_bucket_info_4_obj_reader(BucketInfo4ObjReader** bucket_info_4_obj_reader, char* bucket_name,
                                            int* savepath_dir_number, int*  savepath_sub_dir_number);
+int           get_bucket_save_state(const BucketInfo4ObjReader* const bucket_info_4_obj_reader, const char* const bucket_name,
+                                    int* const savepath_dir_number, int* const savepath_sub_dir_number, int* const obj_reader_saved_counter);
+int           set_bucket_save_state(BucketInfo4ObjReader* const bucket_info_4_obj_reader, const char* const bucket_name,
+                                    const int savepath_dir_number, const int savepath_sub_dir_number, const int obj_reader_saved_counter);
 int           mk_deep_dir(const char *dirpath);
 int           cp_dir(const char *dirpath_from, const char *dirpath_to);
+int           find_tape_device(const char* const device_name);
 int           extract_dir_path(const char* restrict filepath, char* dirpath);
+int           get_md5(const unsigned char* const src, char* hash);
 int           get_element_from_metadata(const char* const meta_data, uint64_t* object_size, char* object_key, char* object_version,
                                         char* last_modified, char* version_id, char* content_md5);
 unsigned char *read_file(const char* const name, off_t* const file_size);
@@ -420,6 +431,12 @@ int           clf_object_series(const char* unpackedobjpath, int os_top_block_nu
 int           clf_packed_objects(const char* unpackedobjpath, int po_top_block_num, uint64_t poid_length, uint64_t poid_block_offset);
 int           clf_packed_objects_info(const char* unpackedobjpath, unsigned char* const data_buf,
                                       uint64_t* const current_position, const uint64_t po_info_length);
+int           cpof_po_header(unsigned char* const data_buf, uint64_t* const current_position,
+                             uint64_t* const out_num_of_obj, uint64_t* const po_header_length);
+int           cpof_object_directory(unsigned char* const data_buf, uint64_t* const current_position, const uint64_t poid_length,
+                                    const uint64_t po_header_length, const uint64_t num_of_obj, LTOSObject* const objects);
+int           cpof_only_meta(unsigned char* const data_buf, uint64_t* const current_position, const int num_of_obj,
+                             const LTOSObject* const objects);
 int           clf_check_mam_coherency(SCSI_DEVICE_PARAM* const scparam, MamVci* const mamvci, MamHta* const mamhta);
 char*         clf_get_partition_name(const int part);
 void*         clf_allocate_memory(const size_t size, const char* const object);
@@ -439,6 +456,7 @@ int           get_marker_file_flg();
 int           delete_files_in_directory(const char* const directory_path, const char* const ext);
 int           get_tape_generation(void* scparam, char tape_gen[2]);
 double        compare_time_string(const char *first_time_string, const char *second_time_string);
+int           convert_utc_to_epoch_ns(const char* const time_string, uint64_t* const epoch_ns);
 int           get_bucket_name(const char *bucket_list, const char *bucket_id, char **bucket_name);
 void          free_safely(char ** str);
 int           extract_json_element(const char *json_data, const char *json_key, char **json_element);
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file metrics.h
+ * @brief Function declaration to count events and measure latencies, and to export them in Prometheus text format.
+ */
+
+#ifndef INCLUDE_METRICS_H_
+#define INCLUDE_METRICS_H_
+
+#include <stdint.h>
+
+#define METRICS_BUCKETS                           (28)     // Bucket i holds latencies up to 2^i microseconds. The last one is +Inf.
+#define METRICS_SCSI_OPCODES                      (256)
+#define METRICS_SENSE_KEYS                        (16)
+#define METRICS_SENSE_CODES                       (64)     // Pairs of sense key, ASC and ASCQ counted per thread. Power of 2.
+#define METRICS_SENSE_CODE_USED                   (0x1000000) // Marks a used slot, so that 0/00/00 can be counted.
+#define METRICS_PREFIX                            "otformat_"
+#define METRICS_UNIX_PREFIX                       "unix:"  // Target of the exporter which is a Unix socket.
+#define METRICS_INTERVAL                          (15)     // Seconds between writes of a textfile.
+#define METRICS_TEXT_SIZE                         (64 * 1024) // Initial size of the exposition text.
+#define METRICS_REQUEST_SIZE                      (4096)   // Bytes of an HTTP request read from a client.
+#define METRICS_REQUEST_TIMEOUT                   (1000)   // Milliseconds to wait for an HTTP request.
+#define METRICS_POLL_TIMEOUT                      (200)    // Milliseconds between checks of the stop request.
+#define METRICS_LISTEN_BACKLOG                    (8)
+
+typedef enum {
+  METRIC_TAPE_BLOCKS_READ  = 0,
+  METRIC_TAPE_BYTES_READ   = 1,
+  METRIC_OUTPUT_BYTES      = 2,                         // Bytes of objects, metadata and archives written.
+  METRIC_OBJECTS           = 3,                         // Objects dumped, restored or listed.
+  METRIC_ERRORS            = 4,                         // ERROR messages, which do not stop the run with the continue mode.
+  METRIC_COUNTERS          = 5,
+} METRIC_COUNTER;
+
+typedef enum {
+  METRIC_LOCATE            = 0,                         // LOCATE including its seek time.
+  METRIC_OUTPUT_WRITE      = 1,
+  METRIC_JSON_PARSE        = 2,                         // Parse of object metadata.
+  METRIC_RP_PARSE          = 3,                         // Read and parse of the reference partition.
+  METRIC_DATA_VERIFY       = 4,                         // MD5 of object data with --verify.
+  METRIC_TIMERS            = 5,
+} METRIC_TIMER;
+
+typedef enum {
+  METRIC_PHASE_SETUP       = 0,                         // Options, the drive and MAM.
+  METRIC_PHASE_REFERENCE   = 1,                         // Read and parse of the reference partition.
+  METRIC_PHASE_DATA        = 2,                         // Dump, list or restore from the data partition.
+  METRIC_PHASES            = 3,
+} METRIC_PHASE;
+
+uint64_t start_metric_timer(void);
+void     observe_metric_timer(const METRIC_TIMER timer, const uint64_t start);
+void     add_metric_counter(const METRIC_COUNTER counter, const uint64_t value);
+void     observe_scsi_command(const uint8_t opcode, const uint64_t start, const uint8_t status,
+                              const uint8_t sense_key, const uint8_t asc, const uint8_t ascq);
+int      start_metrics_exporter(const char* const target);
+void     stop_metrics_exporter(void);
+void     output_metrics_summary(void);
+uint64_t get_metric_counter(const METRIC_COUNTER counter);
+uint64_t get_metric_scsi_commands(void);
+void     enter_metric_phase(const METRIC_PHASE phase);
+void     get_metric_phase_cpu(const METRIC_PHASE phase, uint64_t* const user, uint64_t* const system);
+
+#endif /* INCLUDE_METRICS_H_ */
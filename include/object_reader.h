@@ -41,9 +41,10 @@
 #define OUTPUT_PACKED_OBJECT                      (1)
 #define MAX_NUMBER_OF_OBJECTS                     (10000)
 #define MAX_NUMBER_OF_LISTS                       (1000)
-#define TEMP_PATH                                 "/tmp/object_reader/"
-#define DF_CMD_LOG_PATH                           "/tmp/df_cmd_result.tmp"
-#define MD5SUM_CMD_LOG_PATH                       "/tmp/md5sum_cmd_result.tmp"
+#define TEMP_PATH                                 "tmp/"         // Relative to the workspace.
+#define WORKSPACE_DIR                             ".object_reader" // Default workspace root under the save path.
+#define WORKSPACE_LOCK_FILE                       "workspace.lock"
+#define WORKSPACE_LOCK_EXTENSION                  ".lock"
 #define DATA_EXTENSION                            ".data"
 #define DATA_EXTENSION_SIZE                       (5)
 #define META_EXTENSION                            ".meta"
@@ -59,10 +60,68 @@
 #define MIN_HISTORY_INTERVAL                      (60)           // 1 minute
 #define MAX_HISTORY_INTERVAL                      (24 * 60 * 60) // 1 day
 #define MAX_HISTORY_INTERVAL_SIZE                 (5)            // 1 day = 86400 = 5 digits
+#define HISTORY_JOURNAL_PATH                      "./history.jnl"
+#define LEGACY_HISTORY_PATH                       "./history.log"
+#define HISTORY_RECORD_MAGIC                      "OTFJ"
+#define HISTORY_RECORD_MAGIC_SIZE                 (4)
+#define HISTORY_RECORD_VERSION                    (1)
+#define HISTORY_RECORD_SIZE                       (128)          // Fixed size of a journal record including CRC32 at the end.
+#define HISTORY_TAPE_ID_SIZE                      (16)           // BARCODE_SIZE padded with NUL.
+#define HISTORY_DATA_CHECKPOINT_SIZE              (1024UL * 1024 * 1024) // Progress of a large object is recorded every 1 GiB.
 #define MIN_REQUIRED_DISK_SPACE_GiB               (100UL)     // 100 GiB = 100 * 1024^3
-#define MAX_DISK_SPACE_LENGTH                     (1 + 21)   // 1 * 10^21 * 1024 ~ 1 YB, where 1024(KiB) is a unit of df command.
-#define DISK_SPACE_COMMAND_SIZE                   (64)       // 38 bytes + margin. To be used in get_disk_space function.
-#define OBJ_READER_MODE_LENGTH                    (20)
+#define DISK_SPACE_SAMPLE_INTERVAL                (10)       // Disk space is sampled with statvfs at least every 10 seconds.
+#define OBJ_READER_MODE_LENGTH                    (32)
+#define TAPE_IMAGE_MAGIC                          "OTFIMAGE"
+#define TAPE_IMAGE_MAGIC_SIZE                     (8)
+#define TAPE_IMAGE_VERSION                        (1)
+#define TAPE_IMAGE_HEADER_SIZE                    (32)           // Magic, version, number of partitions and barcode.
+#define TAPE_IMAGE_RECORD_HEADER_SIZE             (24)           // Type, partition, block number and length of a record.
+#define TAPE_IMAGE_EXTENSION                      ".part"        // Suffix of an image while it is captured.
+#define TAPE_IMAGE_QUEUE_DEPTH                    (64)           // Blocks read ahead of the image writer.
+#define TAPE_IMAGE_PROGRESS_SIZE                  (10UL * 1024 * 1024 * 1024) // Progress is displayed every 10 GiB.
+#define IMAGE_EXTRACT_MAX_JOBS                    (64)           // Maximum number of threads extracting an image.
+#define GENERATOR_CREATOR                         (IMPLEMENTATION_IDENTIFIER " Reader tape generator")
+#define GENERATOR_DEFAULT_BARCODE                 "GEN001L8"
+#define GENERATOR_BASE_TIME                       (1609459200)   // 2021-01-01T00:00:00Z, FormatTime of a generated tape.
+#define GENERATOR_MIN_KEY_LENGTH                  (8)            // Enough for the index of 2^32 keys in hexadecimal.
+#define GENERATOR_MAX_BUCKETS                     (10000)        // The bucket list has to fit in an RCM.
+#define GENERATOR_MAX_OBJECT_SIZE                 (INT32_MAX)    // Size in metadata is checked as a 32-bit integer.
+#define GENERATOR_META_SIZE                       (MAX_KEY_SIZE + 512)
+#define GENERATOR_CHUNK_SIZE                      (64 * 1024)    // Object data is made and copied in this size.
+#define GENERATOR_BUFFER_SIZE                     (4 * 1024 * 1024) // Buffer of the image stream.
+#define GENERATOR_VCR                             (1)            // Volume change reference in MAM.
+#define GENERATOR_ATTRIBUTE_SIZE                  (512)          // Response of READ ATTRIBUTE written for each partition.
+#define REPORT_RECORD_SIZE                        (2048)         // A line of --report.
+#define BENCHMARK_DIR                             "benchmark_XXXXXX" // Made in the save path for each run of --benchmark.
+#define BENCHMARK_DRIVE                           "emulated"     // Name of the emulated drive, used for the workspace.
+#define BENCHMARK_RESULT                          "benchmark.json"
+#define BENCHMARK_BATCH_OBJECTS                   (10)           // Objects restored with --manifest.
+#define BENCHMARK_MAX_ARGS                        (32)
+#define MICROBENCH_SAMPLES                        (200)          // Samples of each case of --microbench.
+#define MICROBENCH_SAMPLE_USEC                    (2000)         // Minimum time of a sample, which is long against the timer.
+#define MICROBENCH_DECODE_SIZE                    (64 * 1024)    // Bytes decoded by r64 and r32 in a call.
+#define MICROBENCH_PAIRS                          (5)            // String pairs of a record of --list.
+#define SCHEDULER_MAX_READER_OPTIONS              (8)            // Options passed through to the child object_readers.
+#define PAX_STDOUT                                "-"            // Path of a pax archive written to stdout.
+#define PAX_BLOCK_SIZE                            (512)
+#define PAX_END_BLOCKS                            (2)            // Zero blocks at the end of an archive.
+#define PAX_USTAR_MAX_SIZE                        (1UL << 33)    // Numbers up to 11 octal digits fit in a ustar header.
+#define PAX_NUMBER_SIZE                           (32)
+#define PAX_HEADER_NAME                           "PaxHeader"    // Name of an extended header.
+#define PAX_TYPE_EXTENDED                         'x'
+#define PAX_TYPE_REGULAR                          '0'
+#define PAX_VENDOR                                "OTFORMAT"     // Prefix of the vendor records in an extended header.
+#define MAM_CAPTURE_SIZE                          (64 * 1024)    // Buffer to read all attributes of a partition.
+#define PROGRESS_DEFAULT_INTERVAL                 (10)           // 10 seconds
+#define PROGRESS_MAX_INTERVAL                     (60 * 60)      // 1 hour
+#define PROGRESS_SAMPLES                          (512)          // Samples kept for the sliding windows. Enough for 5 minutes at 1 second.
+#define PROGRESS_SHORT_WINDOW                     (60)           // Seconds of the short sliding window.
+#define PROGRESS_LONG_WINDOW                      (5 * 60)       // Seconds of the long sliding window, which is also used for ETA.
+#define PROGRESS_RECORD_SIZE                      (1024)
+#define PROGRESS_NUMBER_SIZE                      (32)
+#define PROGRESS_RUNNING                          "running"      // States of a progress record.
+#define PROGRESS_COMPLETE                         "complete"
+#define PROGRESS_ABORTED                          "aborted"
 
 /* Nested 5 structures for storing all meta data formatted in OTFormat. */
 typedef struct L4{
@@ -110,22 +169,55 @@ typedef struct L0{
   struct L0 *next_obj;                                  // Pointer to next L0 in the current L1 (logically but not physically).
 } L0;
 
-typedef struct object_list{
-  char key[MAX_KEY_SIZE + 1];                           // Object key of this L0
-  char id[UUID_SIZE + 1];                               // UUID of this L0 Object
-  char verson_id[UUID_SIZE + 1];                        // Version ID of this L0 complying with UUID Format.
+typedef struct object_record{
   uint64_t size;                                        // Data size of this L0
   uint64_t metadata_size;                               // Metadata size of this L0
   uint64_t meta_offset;                                 // Offset from the beginning of PO Header to the object metadata (NOTE: 32 bytes Identifier is prepared just before PO header.
   uint64_t data_offset;                                 // Offset from the beginning of PO Header to the object data (NOTE: 32 bytes Identifier is prepared just before PO header.
-  char last_mod_date[UTC_LENGTH + 1];                   // Last modified date (ISO8601 extended)
-  char md5[MD5_SIZE + 1];                               // Hash Value on 32 bytes, which is the same as "Etag" in Object's Header.
-  BOOL is_delete_marker;                                // Whether this object is Delete Marker or not.
-  char po_id[UUID_SIZE + 1];                            // UUID of L1 Packed Object (PO) which has this object.
   uint64_t block_address;                               // Block address at which PO is stored in tape.
-  struct L0 *next_obj;                                  // Pointer to next L0.
-  struct object_list* next;                             // Pointer to next object.
-} object_list;
+  uint64_t last_mod_epoch_ns;                           // Last modified date in nanoseconds since the Unix epoch.
+  uint32_t key;                                         // Offset of the Object key in the string arena.
+  uint32_t id;                                          // Offset of the UUID of this L0 Object in the string arena.
+  uint32_t verson_id;                                   // Offset of the Version ID in the string arena.
+  uint32_t last_mod_date;                               // Offset of the Last modified date (ISO8601 extended) in the string arena.
+  uint32_t md5;                                         // Offset of the Hash Value in the string arena.
+} object_record;
+
+typedef struct object_vector{
+  object_record* records;                               // Contiguous array of objects found in list files.
+  uint64_t count;                                       // Number of records in use.
+  uint64_t capacity;                                    // Number of records allocated.
+  char* arena;                                          // Storage of the strings referred from records.
+  uint64_t arena_used;                                  // Bytes used in arena.
+  uint64_t arena_size;                                  // Bytes allocated for arena.
+} object_vector;
+
+#define OBJECT_VECTOR_INITIAL_CAPACITY            (16)
+#define OBJECT_VECTOR_INITIAL_ARENA_SIZE          (16 * 1024)
+#define OBJECT_STR(vector, offset)                ((vector)->arena + (offset))
+
+typedef enum {
+  IMAGE_RECORD_BLOCK     = 1,                           // A block read from tape.
+  IMAGE_RECORD_FILEMARK  = 2,
+  IMAGE_RECORD_EOD       = 3,
+  IMAGE_RECORD_ATTRIBUTE = 4,                           // Response of READ ATTRIBUTE(ATTRIBUTE VALUES) of a partition.
+  IMAGE_RECORD_END       = 5,                           // End of the image.
+} IMAGE_RECORD_TYPE;
+
+typedef struct history_record{
+  char tape_id[BARCODE_SIZE + 1];                       // Barcode of the tape which is dumped.
+  uint64_t pr_cnt;                                      // Index of the partial reference to restart from.
+  uint64_t ocm_cnt;                                     // Index of the object commit marker to restart from.
+  uint64_t po_cnt;                                      // Index of the packed object to restart from.
+  uint64_t obj_cnt;                                     // Index of the first object metadata in the packed object.
+  uint64_t done_obj_cnt;                                // Index of the last object which is completely written.
+  uint64_t written_size;                                // Bytes of the next object which have been written.
+  uint8_t prefix_md5[MD5_BIN_SIZE];                     // MD5 of the written bytes of the next object.
+  char bucket_id[UUID_SIZE + 1];                        // Bucket of the packed object. Empty if it is not known.
+  uint16_t dir_number;                                  // Save directory of the bucket in which the next object is written.
+  uint16_t sub_dir_number;
+  uint16_t saved_counter;                               // Objects already saved in the sub directory.
+} history_record;
 
 //int           add_L0_obj(L0* const current, L0* const next);
 //int           add_L1_po(L1* const current, L1* const next);
@@ -136,8 +228,56 @@ typedef struct object_list{
 //int           search_object_by_uuid(const L0* const obj, const char* const uuid, uint64_t* const seq_id);
 //uint64_t      identify_object_by_uuid(const L1* const po, const char* uuid);
 int           check_file(const char* const filename);
-int           get_object_info_in_list(const char* const object_key, const char* const object_id, const char* const list_path, object_list** objects);
+int           get_object_info_in_list(const char* const object_key, const char* const object_id, const char* const list_path, object_vector* const objects);
+void          initialize_object_vector(object_vector* const objects);
+void          free_object_vector(object_vector* const objects);
+void          append_object_vector(object_vector* const objects, const object_vector* const others);
+void          sort_object_vector_by_address(object_vector* const objects);
 void          set_force_flag(int is_force_enabled);
+int           get_force_flag(void);
+void          set_dump_filter_prefix(const char* const prefix);
+void          set_dump_filter_pattern(const char* const pattern);
+int           set_dump_filter_time_range(const char* const time_range);
+int           is_dump_filter_enabled(void);
+int           match_dump_filter(const char* const object_key, const char* const last_modified);
+int           set_object_range(const char* const range);
+int           get_object_range(uint64_t* const offset, uint64_t* const length);
 int           check_disk_space(const char* const path, const uint64_t data_size);
+void          commit_disk_space(const uint64_t size);
+int           lock_drive(const char* const workspace_root, const char* const drive_name);
+int           enter_workspace(const char* const workspace_root, const char* const barcode_id);
+int           make_absolute_path(const char* const base_path, char* const path, const size_t path_size);
 int           comlete_list_files(const char* const list_dir);
+int           capture_tape_image(const char* const image_path, const char* const barcode_id);
+int           extract_tape_image(const char* const image_path, const char* const save_root, const int jobs);
+int           generate_tape_image(const char* const image_path, const char* const spec);
+int           open_pax_stream(const char* const pax_path);
+int           is_pax_stream_enabled(void);
+int           begin_pax_entry(const char* const bucket_name, const char* const object_key, const char* const object_id,
+                              const char* const version_id, const char* const last_modified, const char* const meta_data,
+                              const uint64_t object_size);
+int           write_pax_data(const char* const data, const uint64_t size);
+int           close_pax_stream(void);
+int           open_content_verifier(const char* const report_path);
+int           is_content_verifier_enabled(void);
+void          begin_content_verification(const char* const bucket_name, const char* const object_key, const char* const object_id,
+                                         const char* const content_md5, const uint64_t object_size);
+void          update_content_verification(const char* const data, const uint64_t size);
+int           end_content_verification(const unsigned char* const digest);
+int           close_content_verifier(void);
+int           start_progress_stream(const int fd, const uint32_t interval, const char* const tape_id);
+void          stop_progress_stream(const char* const state);
+void          set_progress_totals(const uint64_t pr_total, const uint64_t ocm_total, const uint64_t po_total,
+                                  const uint64_t obj_total, const uint64_t block_total);
+void          update_progress_position(const uint64_t pr, const uint64_t ocm, const uint64_t po, const uint64_t object,
+                                       const uint64_t block);
+void          add_progress_read_size(const uint64_t size);
+void          add_progress_written_size(const uint64_t size);
+int           run_restore_scheduler(const char* const manifest_path, const char* const drive_names, const char* const events_path,
+                                    const char* const save_path, const char* const workspace_root, const char* const verbose_level);
+void          add_restore_reader_option(const char* const option, const char* const value);
+int           start_run_report(const char* const report_path);
+int           run_benchmark(const char* const image_path, const char* const cost_spec, const char* const save_root,
+                            const char* const verbose_level);
+int           run_microbenchmarks(const char* const image_path);
 #endif /* INCLUDE_OBJECT_READER_H_ */
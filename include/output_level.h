@@ -20,34 +20,95 @@
 #ifndef OUTPUT_LEVEL_H_
 #define OUTPUT_LEVEL_H_
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
 
-#define DISPLAY_COMMON_INFO                       ""       //FRAMEWORK for complete message.
-#define DISPLAY_HEADER_INFO                       "v"      //LABEL for VOL1 label and OTFormat label
-#define DISPLAY_HEADER_AND_L4_INFO                "vv"     //RCM for Reference Commit Marker
-#define DISPLAY_HEADER_AND_L43_INFO               "vvv"    //PR for Partial Reference
-#define DISPLAY_HEADER_AND_L432_INFO              "vvvv"   //OCM for Object Commit Marker
-#define DISPLAY_HEADER_AND_L4321_INFO             "vvvvv"  //POINFO for Packed Object
-#define DISPLAY_ALL_INFO                          "vvvvvv" //MISC for Cartridge Memory and others
-#define DEFAULT                                   "default"
-
-#define OUTPUT_SYSTEM_ERROR                       "[SYS_ERR] "
-#define OUTPUT_ERROR                              "[ERROR  ] "
-#define OUTPUT_WARNING                            "[WARNING] "
-#define OUTPUT_INFO                               "[INFO   ] "
-#define OUTPUT_DEBUG                              "[DEBUG  ] "
-#define OUTPUT_TRACE                              "[TRACE  ] "
+/* Verbose level of a message, which is also the number of "v" in the verbose option to display it. */
+#define DISPLAY_COMMON_INFO                       (0)      //FRAMEWORK for complete message.
+#define DISPLAY_HEADER_INFO                       (1)      //LABEL for VOL1 label and OTFormat label
+#define DISPLAY_HEADER_AND_L4_INFO                (2)      //RCM for Reference Commit Marker
+#define DISPLAY_HEADER_AND_L43_INFO               (3)      //PR for Partial Reference
+#define DISPLAY_HEADER_AND_L432_INFO              (4)      //OCM for Object Commit Marker
+#define DISPLAY_HEADER_AND_L4321_INFO             (5)      //POINFO for Packed Object
+#define DISPLAY_ALL_INFO                          (6)      //MISC for Cartridge Memory and others
+#define DISPLAY_UNKNOWN                           (7)      //DEFAULT outside of any marker. Always displayed.
+#define DEFAULT                                   (-1)     //Verbose level set by set_top_verbose().
+#define VERBOSE_OPTION_MAX_LENGTH                 (6)      //"vvvvvv"
+
+/* Log level of a message. */
+#define OUTPUT_SYSTEM_ERROR                       (0)
+#define OUTPUT_ERROR                              (1)
+#define OUTPUT_WARNING                            (2)
+#define OUTPUT_INFO                               (3)
+#define OUTPUT_DEBUG                              (4)
+#define OUTPUT_TRACE                              (5)
 
 #define LOCATION_MAM                              "Medium Auxiliary Memory"
 #define LOCATION_MAM_HTA                          "Medium Auxiliary Memory Host-type Attribute"
 #define LOCATION_MAM_VCI                          "Medium Auxiliary Memory Volume Coherency Information"
 
 #define INDENT                                    "                   " // message header length is 19 like "[ERROR  ] [LABEL ] "
+#define LOG_HEADER_SIZE                           (128)    //Date, time, log level and verbose level of a message.
+
+/* Ring buffer of INFO, DEBUG and TRACE messages, which are written by a background thread. */
+#define LOG_RING_SLOTS                            (4096)   //Number of messages. Power of 2.
+#define LOG_RING_MESSAGE_SIZE                     (256)    //A longer message is allocated separately.
+#define LOG_RING_MAX_STREAMS                      (4)      //Streams flushed after each batch of messages.
+#define LOG_RING_IDLE_WAIT_NS                     (1000000) //Wait of the writer thread when the ring is empty.
+#define LOG_RING_FLUSH_WAIT_NS                    (100000) //Wait for the writer thread to write messages.
+#define LOG_RING_STOPPED                          (0)
+#define LOG_RING_RUNNING                          (1)
+#define LOG_RING_STOPPING                         (2)
+
+/* Trace messages are removed at compile time with -DDISABLE_TRACE_OUTPUT, e.g. in release builds. */
+#ifdef DISABLE_TRACE_OUTPUT
+#define IS_OUTPUT_ELIDED(log_level)               ((log_level) == OUTPUT_TRACE)
+#else
+#define IS_OUTPUT_ELIDED(log_level)               (0)
+#endif
+
+extern unsigned int output_verbose_mask;  // Bit of each verbose level to be displayed.
+extern int output_top_verbose;            // Verbose level used for DEFAULT.
+
+/**
+ * Check if a message is displayed. Errors and warnings are always displayed.
+ * @param [in] (log_level) Log level.
+ * @param [in] (verbose)   Verbose level of the message.
+ * @return                 Non-zero if the message is displayed.
+ */
+static inline int is_output_enabled(const int log_level, const int verbose) {
+  return log_level <= OUTPUT_WARNING || (output_verbose_mask & (1U << ((verbose == DEFAULT) ? output_top_verbose : verbose)));
+}
+
+/**
+ * Result of a message which is not displayed. A call rather than a constant, so that an elided message
+ * used as a statement is not reported as a statement with no effect.
+ * @return                 OK
+ */
+static inline int skip_output(void) {
+  return 0;
+}
+
+/* Arguments of a message which is not displayed are not even evaluated. Returns OK(0) for such a message. */
+#define output_accdg_to_vl(log_level, verbose, ...) \
+  ((!IS_OUTPUT_ELIDED(log_level) && __builtin_expect(is_output_enabled((log_level), (verbose)), 0)) \
+   ? write_accdg_to_vl((log_level), (verbose), __VA_ARGS__) : skip_output())
 
 void  set_vl(const char* const vl);
-void  set_top_verbose(const char* const t_verbose);
-const char* get_top_verbose();
+void  set_top_verbose(const int t_verbose);
+int   get_top_verbose();
 void  set_c_mode(const char* const c_mode);
-int   output_accdg_to_vl(const char* const log_level, const char* verbose, const char * restrict format, ...);
+void  set_info_stream(FILE* const stream);
+int   write_accdg_to_vl(const int log_level, const int verbose, const char * restrict format, ...);
+int   format_log_header(char* const header, const size_t size, const int log_level, const int verbose);
+
+int   start_log_ring(void);
+void  stop_log_ring(void);
+int   is_log_ring_running(void);
+int   enqueue_log_record(FILE* const stream, const char* const header, const char* restrict format, va_list args);
+void  flush_log_ring(void);
+uint64_t get_dropped_log_records(void);
 
 #endif /* OUTPUT_LEVEL_H_ */
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file reader_context.h
+ * @brief State of reading one tape, which used to be kept in file-static variables.
+ *
+ * Every thread reads the tape bound by bind_reader_context(). A thread which has not bound any
+ * context uses the process default one, so a single-threaded program does not need to care.
+ */
+
+#ifndef INCLUDE_READER_CONTEXT_H_
+#define INCLUDE_READER_CONTEXT_H_
+
+#include "ltos_format_checker.h"
+
+#define OPEN_FILE_CACHE_SIZE                      (2)     // 1 for read_marker_file. 0 for others.
+#define OPEN_FILE_NAME_SIZE                       (4096)
+#define UNSYNCED_FILES_INITIAL_CAPACITY           (64)
+
+typedef struct reader_context {
+  /* Progress of the integrity check. */
+  uint64_t pr_num;                                      // Number of partial references.
+  uint64_t ocm_num;
+  uint64_t po_num;
+  uint64_t meta_num;
+  uint64_t dp_rcm_block_number;                         // Block number of the RCM just before EOD in data partition.
+  uint32_t block_size;
+  uint64_t last_data_offset;
+  uint64_t last_meta_data_offset;                       // Meta data offset of the last meta data.
+  uint64_t num_of_meta;                                 // Number of metas(Number of objects).
+  uint64_t num_of_meta_cnt;
+  uint64_t po_block_address;
+  int read_marker_file_flag;
+  int sequential_read_flag;
+  int marker_file_flg;
+  int skip_0_padding_check_flag;
+
+  /* Output of object_reader. */
+  FILE* fp_list;
+  int savepath_dir_number;
+  int pre_savepath_dir_number;
+  int savepath_sub_dir_number;
+  char obj_r_mode[OBJ_READER_MODE_LENGTH];
+  char obj_reader_saveroot[MAX_PATH + 1];
+  char bucket_id_for_obj_r[UUID_SIZE + 1];
+  char* bucket_name_for_obj_r;
+  char* pre_bucket_name_for_obj_r;
+  char* bucket_list_for_obj_r;
+  BucketInfo4ObjReader* bucket_info_4_obj_reader;
+  char barcode_id[BARCODE_SIZE + 1];
+  SCSI_DEVICE_PARAM scparam;
+  char* object_meta_for_json;
+  object_vector* objects;                               // Objects to be read. Owned by the caller.
+  uint8_t* meta_filter_result;                          // Whether each meta in the current PO matches the dump filter.
+  uint64_t meta_filter_first_cnt;                       // Index of the first meta in the current PO.
+  uint64_t meta_filter_num;                             // Number of metas in the current PO.
+  uint64_t meta_block_number;                           // Block number at which the current meta starts.
+  history_record dump_history;                          // Progress of the current dump.
+  history_record resume_history;                        // Progress replayed from the journal at resume.
+
+  /* Dump options of object_reader. */
+  char dump_filter_prefix[MAX_KEY_SIZE + 1];            // Key prefix which objects must start with.
+  char dump_filter_pattern[MAX_KEY_SIZE + 1];           // Glob pattern which object keys must match.
+  uint64_t dump_filter_from_ns;                         // Objects modified in [from, to) are dumped.
+  uint64_t dump_filter_to_ns;
+  int is_range_specified;
+  uint64_t object_range_offset;                         // Byte range of object data to be output.
+  uint64_t object_range_length;
+
+  /* History journal of object_reader. */
+  int history_fd;                                       // -1 until the first record is written.
+  uint32_t history_interval;                            // Interval of the commits of the journal.(Second)
+  time_t lap_start;                                     // Time of the last commit.
+  time_t lap_end;
+  char obj_save_path[OUTPUT_PATH_SIZE + 1];
+  char** unsynced_files;                                // Files written since the last commit of the journal.
+  uint64_t unsynced_file_num;
+  uint64_t unsynced_file_capacity;
+
+  /* Disk space left in the save path. */
+  char disk_space_path[PATH_MAX + 1];                   // Path at which the disk space was sampled.
+  uint64_t disk_space_available;                        // Disk space at the last sample.(Byte)
+  uint64_t disk_space_committed;                        // Size written since the last sample.(Byte)
+  time_t disk_space_sampled_at;                         // Time of the last sample.
+
+  /* Tape drive used by scsi_util.c. */
+  SCSI_DEVICE_PARAM* scsi_param;
+  ST_SPTI_REQUEST_SENSE_RESPONSE* sense_data;
+  ST_SYSTEM_ERRORINFO* err_info;
+
+  /* Files kept open by open_file(). */
+  FILE* open_file_fp[OPEN_FILE_CACHE_SIZE];
+  char open_file_name[OPEN_FILE_CACHE_SIZE][OPEN_FILE_NAME_SIZE];
+} reader_context;
+
+void            initialize_reader_context(reader_context* const ctx);
+reader_context* create_reader_context(void);
+void            free_reader_context(reader_context* const ctx);
+void            bind_reader_context(reader_context* const ctx);
+reader_context* get_reader_context(void);
+
+#endif /* INCLUDE_READER_CONTEXT_H_ */
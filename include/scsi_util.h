@@ -22,6 +22,14 @@
 
 #include "ltos_format_checker.h"
 
+#define SENSE_KEY_BLANK_CHECK (0x08)
+#define ASCQ_END_OF_DATA      (0x05)
+
+typedef enum {
+  TAPE_BLOCK,
+  TAPE_FILEMARK,
+  TAPE_EOD,
+} TAPE_BLOCK_KIND;
 
 void  set_device_pram(SCSI_DEVICE_PARAM* scsi_param, ST_SPTI_REQUEST_SENSE_RESPONSE* sense_data, ST_SYSTEM_ERRORINFO* err_info);
 
@@ -30,6 +38,8 @@ int move_on_tape(uint8_t code, uint32_t block_address) ;
 int read_position_on_tape(ST_SPTI_CMD_POSITIONDATA* pos);
 int set_tape_head(const int which_partition);
 int locate_to_tape(const uint32_t block_addres);
+int read_raw_block(uint32_t data_trans_len, void* data_pointer, uint32_t* transfer_size, TAPE_BLOCK_KIND* kind);
+int read_attributes_on_tape(const int which_partition, uint32_t data_trans_len, void* data_pointer, uint32_t* transfer_size);
 //int set_hexspeak(unsigned char* const data_buf, const int data_length);
 //int read_data_from_multi_blocks(unsigned char* const buf, uint64_t* const offset, unsigned char* const out, const uint64_t length);
 
@@ -59,6 +59,82 @@ typedef int BOOL;
 #endif // TRUE
 
 
+/* SCSI trace: a file header followed by a scsi_trace_record and its payload for each command, in the byte order of the host. */
+#define SCSI_TRACE_MAGIC                          "OTFSCTR1"
+#define SCSI_TRACE_MAGIC_SIZE                     (8)
+#define SCSI_TRACE_VERSION                        (1)
+#define SCSI_TRACE_CDB_SIZE                       (16)
+#define SCSI_TRACE_SENSE_SIZE                     (32)     // Fixed format sense data up to the CLN bit.
+#define SCSI_TRACE_DIGEST_SIZE                    (16)     // MD5
+#define SCSI_TRACE_BUFFER_SIZE                    (1024 * 1024)
+#define SCSI_TRACE_OFF                            (0)
+#define SCSI_TRACE_RECORD                         (1)
+#define SCSI_TRACE_REPLAY                         (2)
+#define SCSI_TRACE_PAYLOAD_NONE                   (0)      // No data is read.
+#define SCSI_TRACE_PAYLOAD_DATA                   (1)      // Data read from the drive as it is.
+#define SCSI_TRACE_PAYLOAD_DIGEST                 (2)      // MD5 of the data read from the drive.
+
+/* SCSI emulator: a drive which answers commands from a tape image and charges the time a real drive would take. */
+#define SCSI_EMULATOR_PARTITIONS                  (2)
+#define SCSI_EMULATOR_SENSE_SIZE                  (18)     // Fixed format sense data without the additional bytes.
+#define SCSI_EMULATOR_INITIAL_BLOCKS              (1024)   // Blocks of a partition allocated at first.
+#define SCSI_EMULATOR_COMMAND                     (500)    // Default overhead of every command in microseconds.
+#define SCSI_EMULATOR_LOCATE                      (3000000) // Default time of LOCATE and SPACE which move the tape, in microseconds.
+#define SCSI_EMULATOR_LOCATE_BLOCK                (2)      // Default time added for each block of the distance, in microseconds.
+#define SCSI_EMULATOR_PARTITION                   (15000000) // Default time added when the partition is changed, in microseconds.
+#define SCSI_EMULATOR_BANDWIDTH                   (400)    // Default streaming bandwidth in MB/s.
+#define SCSI_EMULATOR_BACKHITCH                   (3000000) // Default time to reposition after the drive stopped streaming, in microseconds.
+#define SCSI_EMULATOR_BUFFER                      (1024)   // Default size of the read-ahead buffer of the drive in MB.
+
+/** Header of a SCSI trace file */
+typedef struct {
+  char magic[SCSI_TRACE_MAGIC_SIZE];
+  uint32_t version;
+  uint32_t is_digest;                   // Payloads are digests, so the trace cannot be replayed.
+} scsi_trace_header;
+
+/** A SCSI command in a SCSI trace file */
+typedef struct {
+  uint64_t latency;                     // Microseconds.
+  uint32_t dxfer_len;
+  uint32_t resid;                       // Residual count reported by the driver.
+  uint32_t payload_size;                // Bytes following the record.
+  int32_t  result;                      // Return value of ioctl.
+  uint8_t  cdb_len;
+  uint8_t  status;
+  uint8_t  payload_kind;
+  uint8_t  reserved1;
+  uint8_t  cdb[SCSI_TRACE_CDB_SIZE];
+  uint8_t  sense[SCSI_TRACE_SENSE_SIZE];
+  uint8_t  reserved2[4];
+} scsi_trace_record;
+
+/** Costs charged by the SCSI emulator. Times are in microseconds. */
+typedef struct {
+  uint64_t command;                     // Overhead of every command.
+  uint64_t locate;                      // LOCATE, SPACE and REWIND which move the tape.
+  uint64_t locate_block;                // Added for each block of the distance.
+  uint64_t partition;                   // Added when the partition is changed.
+  uint64_t bandwidth;                   // MB/s while streaming.
+  uint64_t backhitch;                   // Reposition when a READ finds the buffer empty after the drive stopped.
+  uint64_t buffer;                      // MB read ahead while the host is busy.
+  int      is_slept;                    // Sleep for the charged time, or only account it.
+} scsi_emulator_cost;
+
+/** Statistics of the SCSI emulator. Times are in microseconds. */
+typedef struct {
+  uint64_t commands;
+  uint64_t command_time;
+  uint64_t locates;                     // LOCATE, SPACE and REWIND.
+  uint64_t locate_blocks;               // Sum of the distances.
+  uint64_t locate_time;
+  uint64_t read_bytes;
+  uint64_t transfer_time;
+  uint64_t backhitches;
+  uint64_t backhitch_time;
+  int      is_slept;
+} scsi_emulator_stats;
+
 /** Structure for SCSI device */
 typedef struct scsi_device_param
 {
@@ -78,6 +154,19 @@ void destroy_sg_io_hdr(sg_io_hdr_t* hdr);
 BOOL run_scsi_command(void* const scparam, sg_io_hdr_t* const hdr, uint32_t* const resid);
 uint64_t btoui(const unsigned char* const buf, const int size);
 
+BOOL start_scsi_trace_record(const char* const path, const int is_digest);
+BOOL start_scsi_trace_replay(const char* const path, const int is_latency_replayed);
+void stop_scsi_trace(void);
+int  get_scsi_trace_mode(void);
+void record_scsi_command(const sg_io_hdr_t* const hdr, const int result, const uint64_t latency);
+int  replay_scsi_command(sg_io_hdr_t* const hdr);
+
+BOOL start_scsi_emulator(const char* const image_path, const char* const cost_spec);
+void stop_scsi_emulator(void);
+BOOL is_scsi_emulator_enabled(void);
+int  emulate_scsi_command(sg_io_hdr_t* const hdr);
+void get_scsi_emulator_stats(scsi_emulator_stats* const stats);
+
 BOOL spti_locate(void* scparam, uint32_t blockAddress, ST_SPTI_REQUEST_SENSE_RESPONSE* sense_data,
                  ST_SYSTEM_ERRORINFO* syserr);
 BOOL spti_locate_partition(void* scparam, uint32_t partition, uint32_t blockAddress,
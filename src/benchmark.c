@@ -0,0 +1,543 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file benchmark.c
+ *
+ * Benchmark of the reader against a tape image with an emulated drive, and the report of a run.
+ *
+ * A run with --report appends a JSON object per line at exit: objects, bytes, SCSI commands,
+ * the time charged by the emulated drive and the CPU time of each phase.
+ * --benchmark runs child object_readers on the emulated drive in these scenarios, each in a fresh directory:
+ *   output_list : --list of all buckets.
+ *   single      : --object-key of an object in the middle of the lists.
+ *   batch       : --manifest of BENCHMARK_BATCH_OBJECTS objects spread over the lists, read by the restore scheduler.
+ *   full_dump   : --full-dump of the whole tape.
+ * The reports of the children are summed for each scenario. The elapsed time is the wall time of the children
+ * plus the time of the drive which was only accounted, so objects/s and MB/s are as with a real drive.
+ */
+
+#ifdef OBJ_READER
+#include <sys/wait.h>
+#include "ltos_format_checker.h"
+
+typedef struct {
+  char bucket_name[BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1];
+  char object_key[MAX_KEY_SIZE + 1];
+} benchmark_object;
+
+typedef struct {
+  const char* name;
+  int status;                                           // Exit status of the object_reader run for the scenario.
+  uint64_t processes;                                   // Reports, which are written by object_readers which read a tape.
+  double host_seconds;                                  // Wall time of the scenario measured by the benchmark.
+  double wall_seconds;                                  // Sum of the wall time in the reports.
+  double drive_seconds;                                 // Sum of the time charged by the emulated drive.
+  int is_slept;                                         // The charged time is included in the wall time.
+  uint64_t objects;
+  uint64_t tape_bytes;
+  uint64_t output_bytes;
+  uint64_t scsi_commands;
+  uint64_t locates;
+  uint64_t backhitches;
+  uint64_t errors;                                      // ERROR messages, which fail the scenario.
+  double cpu_seconds[METRIC_PHASES];                    // User and system CPU time.
+} benchmark_result;
+
+typedef struct {
+  char self_path[OUTPUT_PATH_SIZE + 1];
+  char dir[OUTPUT_PATH_SIZE + 1];                       // Directory of this run.
+  char barcode_id[BARCODE_SIZE + 1];
+  const char* image_path;
+  const char* cost_spec;
+  const char* verbose_level;
+} benchmark_run;
+
+static char report_path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+static uint64_t report_start                  = 0;
+
+static const char* const phase_names[METRIC_PHASES] = { "setup", "reference", "data" };
+
+/**
+ * Append the report of this run to the report file. It is called at exit.
+ */
+static void write_run_report(void) {
+  char record[REPORT_RECORD_SIZE] = { '\0' };
+  scsi_emulator_stats drive       = { 0 };
+  uint64_t user[METRIC_PHASES]    = { 0 };
+  uint64_t system[METRIC_PHASES]  = { 0 };
+
+  get_scsi_emulator_stats(&drive);
+  for (int i = 0; i < METRIC_PHASES; i++) {
+    get_metric_phase_cpu(i, &user[i], &system[i]);
+  }
+  const uint64_t drive_time = drive.command_time + drive.locate_time + drive.transfer_time + drive.backhitch_time;
+  const int size = snprintf(record, sizeof(record),
+      "{\"pid\":%d,\"wall_sec\":%.6f,\"objects\":%lu,\"tape_bytes\":%lu,\"output_bytes\":%lu,\"scsi_commands\":%lu,"
+      "\"drive_sec\":%.6f,\"drive_slept\":%d,\"drive_command_sec\":%.6f,\"locates\":%lu,\"locate_blocks\":%lu,"
+      "\"locate_sec\":%.6f,\"transfer_sec\":%.6f,\"backhitches\":%lu,\"backhitch_sec\":%.6f,\"errors\":%lu,"
+      "\"cpu_%s_user_sec\":%.6f,\"cpu_%s_system_sec\":%.6f,\"cpu_%s_user_sec\":%.6f,\"cpu_%s_system_sec\":%.6f,"
+      "\"cpu_%s_user_sec\":%.6f,\"cpu_%s_system_sec\":%.6f}\n",
+      (int)getpid(), (double)(start_metric_timer() - report_start) / 1000000,
+      get_metric_counter(METRIC_OBJECTS), get_metric_counter(METRIC_TAPE_BYTES_READ), get_metric_counter(METRIC_OUTPUT_BYTES),
+      get_metric_scsi_commands(), (double)drive_time / 1000000, drive.is_slept, (double)drive.command_time / 1000000,
+      drive.locates, drive.locate_blocks, (double)drive.locate_time / 1000000, (double)drive.transfer_time / 1000000,
+      drive.backhitches, (double)drive.backhitch_time / 1000000, get_metric_counter(METRIC_ERRORS),
+      phase_names[METRIC_PHASE_SETUP], (double)user[METRIC_PHASE_SETUP] / 1000000,
+      phase_names[METRIC_PHASE_SETUP], (double)system[METRIC_PHASE_SETUP] / 1000000,
+      phase_names[METRIC_PHASE_REFERENCE], (double)user[METRIC_PHASE_REFERENCE] / 1000000,
+      phase_names[METRIC_PHASE_REFERENCE], (double)system[METRIC_PHASE_REFERENCE] / 1000000,
+      phase_names[METRIC_PHASE_DATA], (double)user[METRIC_PHASE_DATA] / 1000000,
+      phase_names[METRIC_PHASE_DATA], (double)system[METRIC_PHASE_DATA] / 1000000);
+
+  // A line is appended with a single write, so object_readers running at the same time can share the file.
+  const int fd = open(report_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd < 0 || write(fd, record, size) != size) {
+    fprintf(stderr, "Failed to write the report to %s. error=%s\n", report_path, strerror(errno));
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+/**
+ * Write the report of this run to a file at exit.
+ * @param [in]  (path)  File to which the report is appended as a line of JSON.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+int start_run_report(const char* const path) {
+  if (OUTPUT_PATH_SIZE < strlen(path)) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The path of the report is too long: %s\n", path);
+  }
+  strcpy(report_path, path);
+  report_start = start_metric_timer();
+  atexit(write_run_report);
+  return OK;
+}
+
+/**
+ * Get a number in a report.
+ * @param [in]  (report) Report.
+ * @param [in]  (key)    Key.
+ * @return               Value, or 0 if the key is not found.
+ */
+static double get_report_number(json_object* const report, const char* const key) {
+  json_object* value = NULL;
+  if (!json_object_object_get_ex(report, key, &value)) {
+    return 0;
+  }
+  return json_object_get_double(value);
+}
+
+/**
+ * Sum the reports of the object_readers of a scenario.
+ * @param [in]     (path)   Report file of the scenario.
+ * @param [in/out] (result) Result of the scenario.
+ * @return         (OK/NG)  If the reports are read, return OK. Otherwise, return NG.
+ */
+static int sum_run_reports(const char* const path, benchmark_result* const result) {
+  char line[REPORT_RECORD_SIZE] = { '\0' };
+  char key[MAX_PATH + 1]        = { '\0' };
+  FILE* const fp                = fopen(path, "r");
+
+  if (fp == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "No report is written to %s.\n", path);
+  }
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    json_object* const report = json_tokener_parse(line);
+    if (report == NULL) {
+      continue;
+    }
+    result->processes++;
+    result->wall_seconds  += get_report_number(report, "wall_sec");
+    result->drive_seconds += get_report_number(report, "drive_sec");
+    result->is_slept       = (get_report_number(report, "drive_slept") != 0);
+    result->objects       += (uint64_t)get_report_number(report, "objects");
+    result->tape_bytes    += (uint64_t)get_report_number(report, "tape_bytes");
+    result->output_bytes  += (uint64_t)get_report_number(report, "output_bytes");
+    result->scsi_commands += (uint64_t)get_report_number(report, "scsi_commands");
+    result->locates       += (uint64_t)get_report_number(report, "locates");
+    result->backhitches   += (uint64_t)get_report_number(report, "backhitches");
+    result->errors        += (uint64_t)get_report_number(report, "errors");
+    for (int i = 0; i < METRIC_PHASES; i++) {
+      snprintf(key, sizeof(key), "cpu_%s_user_sec", phase_names[i]);
+      result->cpu_seconds[i] += get_report_number(report, key);
+      snprintf(key, sizeof(key), "cpu_%s_system_sec", phase_names[i]);
+      result->cpu_seconds[i] += get_report_number(report, key);
+    }
+    json_object_put(report);
+  }
+  fclose(fp);
+  return OK;
+}
+
+/**
+ * Run an object_reader on the emulated drive for a scenario, and sum its reports.
+ * @param [in]  (run)        Benchmark.
+ * @param [in]  (save_dir)   Directory in the directory of the run, which is the save path of the object_reader.
+ * @param [in]  (extra_args) Options of the scenario terminated with NULL.
+ * @param [out] (result)     Result of the scenario, whose name is set by the caller.
+ * @return      (OK/NG)      If the object_reader succeeded, return OK. Otherwise, return NG.
+ */
+static int run_benchmark_scenario(const benchmark_run* const run, const char* const save_dir, const char* const* extra_args,
+                                  benchmark_result* const result) {
+  char save_path[OUTPUT_PATH_SIZE + 1]   = { '\0' };
+  char scenario_report[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  char* args[BENCHMARK_MAX_ARGS]         = { NULL };
+  int n                                  = 0;
+  int status                             = 0;
+
+  if (snprintf(save_path, sizeof(save_path), "%s/%s", run->dir, save_dir) >= (int)sizeof(save_path)
+      || snprintf(scenario_report, sizeof(scenario_report), "%s/%s.jsonl", run->dir, result->name) >= (int)sizeof(scenario_report)) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The path of the %s scenario in %s is too long.\n", result->name, run->dir);
+  }
+  args[n++] = (char*)run->self_path;
+  args[n++] = "-d";
+  args[n++] = BENCHMARK_DRIVE;
+  args[n++] = "-E";
+  args[n++] = (char*)run->image_path;
+  if (strlen(run->cost_spec) > 0) {
+    args[n++] = "-C";
+    args[n++] = (char*)run->cost_spec;
+  }
+  args[n++] = "-K";
+  args[n++] = scenario_report;
+  args[n++] = "-s";
+  args[n++] = save_path;
+  args[n++] = "-F";
+  if (strlen(run->verbose_level) > 0) {
+    args[n++] = "-v";
+    args[n++] = (char*)run->verbose_level;
+  }
+  for (int i = 0; extra_args[i] != NULL && n < BENCHMARK_MAX_ARGS - 1; i++) {
+    args[n++] = (char*)extra_args[i];
+  }
+  args[n] = NULL;
+
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Benchmark of %s is started.\n", result->name);
+  flush_log_ring();
+  fflush(stdout);
+  fflush(stderr);
+  const uint64_t start = start_metric_timer();
+  const pid_t pid      = fork();
+  if (pid < 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to start object_reader. error=%s\n", strerror(errno));
+  } else if (pid == 0) {
+    // Requests to the tape loader of --manifest are not needed, since the emulated tape is always loaded.
+    const int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+      dup2(null_fd, STDOUT_FILENO);
+      close(null_fd);
+    }
+    execv(run->self_path, args);
+    fprintf(stderr, "Failed to execute %s. error=%s\n", run->self_path, strerror(errno));
+    _exit(EXIT_FAILURE);
+  }
+  if (waitpid(pid, &status, 0) < 0) {
+    status = -1;
+  }
+  result->host_seconds = (double)(start_metric_timer() - start) / 1000000;
+  result->status       = (WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+  if (result->status != EXIT_SUCCESS) {
+    output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "object_reader failed in the benchmark of %s.\n", result->name);
+  }
+  if (sum_run_reports(scenario_report, result) != OK || result->status != EXIT_SUCCESS) {
+    return NG;
+  }
+  if (result->errors != 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "%lu error(s) are logged in the benchmark of %s.\n",
+                              result->errors, result->name);
+  }
+  return OK;
+}
+
+/**
+ * Compare names of list files.
+ * @param [in]  (a) Name.
+ * @param [in]  (b) Name.
+ * @return          Result of strcmp.
+ */
+static int compare_list_names(const void* a, const void* b) {
+  return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+/**
+ * Pick objects at even intervals from the list files made by the output_list scenario.
+ * @param [in]  (list_dir)  Directory of the list files of the tape.
+ * @param [out] (objects)   Picked objects. objects[0] is in the middle of the lists, and the rest are for the batch.
+ * @param [out] (count)     Number of objects picked for the batch.
+ * @return      (OK/NG)     If at least an object is picked, return OK. Otherwise, return NG.
+ */
+static int pick_benchmark_objects(const char* const list_dir, benchmark_object* const objects, uint64_t* const count) {
+  char** names                    = NULL;
+  char path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  char* line                      = (char*)clf_allocate_memory(STR_MAX, "list line");
+  uint64_t name_count             = 0;
+  uint64_t total                  = 0;
+  DIR* const dp                   = opendir(list_dir);
+  struct dirent* ent              = NULL;
+
+  if (dp == NULL) {
+    free(line);
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "No list is made at %s.\n", list_dir);
+  }
+  while ((ent = readdir(dp)) != NULL) {
+    const size_t length = strlen(ent->d_name);
+    if (length > strlen(".lst") && strcmp(ent->d_name + length - strlen(".lst"), ".lst") == 0 && strchr(ent->d_name, '_') != NULL) {
+      names = (char**)realloc(names, (name_count + 1) * sizeof(char*));
+      if (names == NULL) {
+        output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to allocate memory for list names.\n");
+      }
+      names[name_count] = (char*)clf_allocate_memory(length + 1, "list name");
+      strcpy(names[name_count++], ent->d_name);
+    }
+  }
+  closedir(dp);
+  qsort(names, name_count, sizeof(char*), compare_list_names);
+
+  // The first pass counts the objects, and the second pass picks them.
+  *count = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    const uint64_t batch = MIN(total, BENCHMARK_BATCH_OBJECTS);
+    uint64_t index       = 0;
+    uint64_t next        = 0;
+    for (uint64_t i = 0; i < name_count; i++) {
+      FILE* const fp = (snprintf(path, sizeof(path), "%s/%s", list_dir, names[i]) < (int)sizeof(path)) ? fopen(path, "r") : NULL;
+      if (fp == NULL) {
+        continue;
+      }
+      while (fgets(line, STR_MAX, fp) != NULL) {
+        if (strncmp(line, "\"object_key\":", strlen("\"object_key\":")) != 0) {
+          continue;
+        }
+        if (pass == 1 && (index == total / 2 || (next < batch && index == (2 * next + 1) * total / (2 * batch)))) {
+          // A line is "object_key":"<key>", in the list, so the comma is removed to parse the value.
+          char* const end = line + strcspn(line, "\r\n");
+          if (end > line && end[-1] == ',') {
+            end[-1] = '\0';
+          }
+          json_object* const value = json_tokener_parse(line + strlen("\"object_key\":"));
+          benchmark_object object  = { { '\0' }, { '\0' } };
+          // The name of a list file is <bucket name>_<number>.lst.
+          snprintf(object.bucket_name, sizeof(object.bucket_name), "%.*s", (int)(strrchr(names[i], '_') - names[i]), names[i]);
+          snprintf(object.object_key, sizeof(object.object_key), "%s", (value != NULL) ? json_object_get_string(value) : "");
+          json_object_put(value);
+          if (index == total / 2) {
+            objects[0] = object;
+          }
+          if (next < batch && index == (2 * next + 1) * total / (2 * batch)) {
+            objects[1 + next++] = object;
+          }
+        }
+        index++;
+      }
+      fclose(fp);
+    }
+    total  = index;
+    *count = next;
+  }
+  for (uint64_t i = 0; i < name_count; i++) {
+    free(names[i]);
+  }
+  free(names);
+  free(line);
+  if (total == 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "No object is found in the lists at %s.\n", list_dir);
+  }
+  return OK;
+}
+
+/**
+ * Get the barcode of a tape image, which is the name of the directory of its list files.
+ * @param [in/out] (run) Benchmark, whose barcode is set.
+ * @return         (OK/NG) If the image is read, return OK. Otherwise, return NG.
+ */
+static int get_benchmark_barcode(benchmark_run* const run) {
+  uint8_t header[TAPE_IMAGE_HEADER_SIZE] = { 0 };
+  FILE* const fp                         = fopen(run->image_path, "rb");
+
+  if (fp == NULL || fread(header, TAPE_IMAGE_HEADER_SIZE, 1, fp) != 1 || memcmp(header, TAPE_IMAGE_MAGIC, TAPE_IMAGE_MAGIC_SIZE) != 0) {
+    if (fp != NULL) {
+      fclose(fp);
+    }
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "%s is not a tape image.\n", run->image_path);
+  }
+  fclose(fp);
+  // The barcode follows the magic, the version and the number of partitions.
+  snprintf(run->barcode_id, sizeof(run->barcode_id), "%.*s", BARCODE_SIZE, (const char*)header + 16);
+  for (int i = strlen(run->barcode_id) - 1; i >= 0 && run->barcode_id[i] == ' '; i--) {
+    run->barcode_id[i] = '\0';
+  }
+  return OK;
+}
+
+/**
+ * Write the request files of the batch scenario: a manifest and the event that the tape is loaded in the emulated drive.
+ * @param [in]  (run)     Benchmark.
+ * @param [in]  (objects) Objects to be restored.
+ * @param [in]  (count)   Number of the objects.
+ * @return      (OK/NG)   If success, return OK. Otherwise, return NG.
+ */
+static int write_batch_requests(const benchmark_run* const run, const benchmark_object* const objects, const uint64_t count) {
+  char path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+
+  if (snprintf(path, sizeof(path), "%s/batch.manifest", run->dir) >= (int)sizeof(path)) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The path of the manifest in %s is too long.\n", run->dir);
+  }
+  FILE* fp = fopen(path, "w");
+  if (fp == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write %s. error=%s\n", path, strerror(errno));
+  }
+  for (uint64_t i = 0; i < count; i++) {
+    fprintf(fp, "%s\t%s\t%s\n", run->barcode_id, objects[i].bucket_name, objects[i].object_key);
+  }
+  fclose(fp);
+  if (snprintf(path, sizeof(path), "%s/batch.events", run->dir) >= (int)sizeof(path)) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The path of the events in %s is too long.\n", run->dir);
+  }
+  fp = fopen(path, "w");
+  if (fp == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write %s. error=%s\n", path, strerror(errno));
+  }
+  fprintf(fp, "loaded %s %s\n", run->barcode_id, BENCHMARK_DRIVE);
+  fclose(fp);
+  return OK;
+}
+
+/**
+ * Output the results to stdout, and write them to BENCHMARK_RESULT in the directory of the run.
+ * @param [in]  (run)     Benchmark.
+ * @param [in]  (results) Results of the scenarios.
+ * @param [in]  (count)   Number of the scenarios.
+ * @return      (OK/NG)   If success, return OK. Otherwise, return NG.
+ */
+static int output_benchmark_results(const benchmark_run* const run, const benchmark_result* const results, const int count) {
+  char path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+
+  if (snprintf(path, sizeof(path), "%s/%s", run->dir, BENCHMARK_RESULT) >= (int)sizeof(path)) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The path of the results in %s is too long.\n", run->dir);
+  }
+  FILE* const fp = fopen(path, "w");
+  if (fp == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write %s. error=%s\n", path, strerror(errno));
+  }
+  fprintf(fp, "{\"image\":\"%s\",\"drive_cost\":\"%s\",\"scenarios\":[", run->image_path, run->cost_spec);
+  printf("%-13s %10s %11s %12s %10s %10s %10s %9s %10s %9s %9s %9s\n", "SCENARIO", "OBJECTS", "ELAPSED(s)", "OBJECTS/s", "MB/s",
+         "CMDS/OBJ", "DRIVE(s)", "LOCATES", "BACKHITCH", "CPU_SETUP", "CPU_REF", "CPU_DATA");
+  for (int i = 0; i < count; i++) {
+    const benchmark_result* const result = &results[i];
+    // The time of the drive is a part of the wall time if it was slept.
+    const double elapsed         = result->wall_seconds + (result->is_slept ? 0 : result->drive_seconds);
+    const double objects_per_sec = (elapsed > 0) ? result->objects / elapsed : 0;
+    const double mb_per_sec      = (elapsed > 0) ? result->output_bytes / elapsed / 1000000 : 0;
+    const double commands_per_object = (result->objects > 0) ? (double)result->scsi_commands / result->objects : 0;
+
+    printf("%-13s %10lu %11.3f %12.2f %10.2f %10.2f %10.3f %9lu %10lu %9.3f %9.3f %9.3f%s\n", result->name, result->objects, elapsed,
+           objects_per_sec, mb_per_sec, commands_per_object, result->drive_seconds, result->locates, result->backhitches,
+           result->cpu_seconds[METRIC_PHASE_SETUP], result->cpu_seconds[METRIC_PHASE_REFERENCE], result->cpu_seconds[METRIC_PHASE_DATA],
+           (result->status == EXIT_SUCCESS && result->errors == 0) ? "" : " (failed)");
+    fprintf(fp, "%s{\"name\":\"%s\",\"status\":%d,\"processes\":%lu,\"objects\":%lu,\"elapsed_sec\":%.6f,\"host_sec\":%.6f,"
+            "\"objects_per_sec\":%.3f,\"mb_per_sec\":%.3f,\"commands_per_object\":%.3f,\"scsi_commands\":%lu,"
+            "\"tape_bytes\":%lu,\"output_bytes\":%lu,\"drive_sec\":%.6f,\"locates\":%lu,\"backhitches\":%lu,\"errors\":%lu,"
+            "\"cpu_setup_sec\":%.6f,\"cpu_reference_sec\":%.6f,\"cpu_data_sec\":%.6f}",
+            (i == 0) ? "" : ",", result->name, result->status, result->processes, result->objects, elapsed, result->host_seconds,
+            objects_per_sec, mb_per_sec, commands_per_object, result->scsi_commands, result->tape_bytes, result->output_bytes,
+            result->drive_seconds, result->locates, result->backhitches, result->errors, result->cpu_seconds[METRIC_PHASE_SETUP],
+            result->cpu_seconds[METRIC_PHASE_REFERENCE], result->cpu_seconds[METRIC_PHASE_DATA]);
+  }
+  fprintf(fp, "]}\n");
+  fclose(fp);
+  printf("Results and outputs are in %s.\n", run->dir);
+  return OK;
+}
+
+/**
+ * Benchmark full dump, filtered dump, resume dump, list, single object and batch restore against a tape image
+ * with the emulated drive.
+ * @param [in]  (image_path)    Image made with --capture or --generate.
+ * @param [in]  (cost_spec)     Costs of the emulated drive. "" for the default.
+ * @param [in]  (save_root)     Directory in which the directory of this run is made.
+ * @param [in]  (verbose_level) Verbose level passed to the object_readers.
+ * @return      (OK/NG)         If all scenarios succeeded, return OK. Otherwise, return NG.
+ */
+int run_benchmark(const char* const image_path, const char* const cost_spec, const char* const save_root,
+                  const char* const verbose_level) {
+  int ret                                               = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:run_benchmark\n");
+  benchmark_run run                                     = { { '\0' }, { '\0' }, { '\0' }, image_path, cost_spec, verbose_level };
+  benchmark_result results[6]                           = { 0 };
+  benchmark_object objects[1 + BENCHMARK_BATCH_OBJECTS] = { { { '\0' }, { '\0' } } };
+  char list_dir[OUTPUT_PATH_SIZE + 1]                   = { '\0' };
+  char manifest_path[OUTPUT_PATH_SIZE + 1]              = { '\0' };
+  char events_path[OUTPUT_PATH_SIZE + 1]                = { '\0' };
+  uint64_t batch_count                                  = 0;
+  int count                                             = 0;
+
+  if (readlink("/proc/self/exe", run.self_path, OUTPUT_PATH_SIZE) < 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to get the path of object_reader. error=%s\n", strerror(errno));
+  }
+  if (get_benchmark_barcode(&run) != OK) {
+    return NG;
+  }
+  if (snprintf(run.dir, sizeof(run.dir), "%s/%s", save_root, BENCHMARK_DIR) >= (int)sizeof(run.dir)) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The save path %s is too long.\n", save_root);
+  }
+  if (mk_deep_dir(run.dir) != OK || mkdtemp(run.dir) == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to make a directory in %s. error=%s\n", save_root, strerror(errno));
+  }
+
+  // The single and the batch restore use the lists made by output_list, and the full dump starts from nothing.
+  results[count].name = "output_list";
+  const char* const list_args[] = { "-l", NULL };
+  ret |= run_benchmark_scenario(&run, "restore", list_args, &results[count++]);
+
+  if (snprintf(list_dir, sizeof(list_dir), "%s/restore/%s", run.dir, run.barcode_id) >= (int)sizeof(list_dir)
+      || snprintf(manifest_path, sizeof(manifest_path), "%s/batch.manifest", run.dir) >= (int)sizeof(manifest_path)
+      || snprintf(events_path, sizeof(events_path), "%s/batch.events", run.dir) >= (int)sizeof(events_path)) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The path of the lists in %s is too long.\n", run.dir);
+  }
+  if (ret == OK && pick_benchmark_objects(list_dir, objects, &batch_count) == OK) {
+    results[count].name = "single";
+    const char* const single_args[] = { "-b", objects[0].bucket_name, "-o", objects[0].object_key, NULL };
+    ret |= run_benchmark_scenario(&run, "restore", single_args, &results[count++]);
+
+    // Whole POs and single objects are skipped by the filter, and the following markers are located.
+    results[count].name = "filtered_dump";
+    const char* const filtered_args[] = { "-f", "-k", objects[0].object_key, NULL };
+    ret |= run_benchmark_scenario(&run, "filtered", filtered_args, &results[count++]);
+
+    results[count].name = "batch";
+    const char* const batch_args[] = { "-m", manifest_path, "-e", events_path, NULL };
+    if (write_batch_requests(&run, objects + 1, batch_count) == OK) {
+      ret |= run_benchmark_scenario(&run, "restore", batch_args, &results[count++]);
+    } else {
+      ret = NG;
+    }
+  } else {
+    ret = NG;
+  }
+
+  results[count].name = "full_dump";
+  const char* const dump_args[] = { "-f", NULL };
+  ret |= run_benchmark_scenario(&run, "dump", dump_args, &results[count++]);
+
+  // The journal of the full dump ends on the last object of the last OCM, so all objects are skipped up to the OCM.
+  results[count].name = "resume_dump";
+  const char* const resume_args[] = { "-r", NULL };
+  ret |= run_benchmark_scenario(&run, "dump", resume_args, &results[count++]);
+
+  ret |= output_benchmark_results(&run, results, count);
+  output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "end  :run_benchmark\n");
+  return ret;
+}
+#endif // OBJ_READER
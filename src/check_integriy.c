@@ -19,55 +19,22 @@
  */
 
 #include <dirent.h>
+#include <openssl/md5.h>
 #include "ltos_format_checker.h"
 
 #define BEGINNING        (-1)
 #define END              (1)
 #define UNKNOWN          (-1)
 
-uint64_t pr_num                     = 0;
-static uint64_t ocm_num             = 0;
-static uint64_t po_num              = 0;
-static uint64_t meta_num            = 0;
-uint64_t dp_rcm_block_number        = 0;
-static uint32_t block_size                 = LTOS_BLOCK_SIZE;
-static uint64_t last_data_offset           = 0;
-static uint64_t last_meta_data_offset      = 0; //meta data offset of the last meta data.
-static uint64_t num_of_meta                = 0; //Number of metas(Number of objects).
-static uint64_t num_of_meta_cnt            = 0;
-static uint64_t po_block_address           = 0;
-static int read_marker_file_flag           = 1;
-static int sequential_read_flag            = 1;
-static int marker_file_flg                 = 0;
-static int skip_0_padding_check_flag       = 0;
-
-#ifdef OBJ_READER
-static FILE* fp_list;
-static int  savepath_dir_number                       = 1;
-static int  pre_savepath_dir_number                   = 0;
-static int  savepath_sub_dir_number                   = 1;
-//static int  obj_reader_saved_counter                  = 0;
-static char obj_r_mode[OBJ_READER_MODE_LENGTH]        = {0};
-static char obj_reader_saveroot[MAX_PATH + 1]         = { 0 };
-static char bucket_id_for_obj_r[UUID_SIZE + 1]        = { 0 };
-static char* bucket_name_for_obj_r                    = NULL;
-static char* pre_bucket_name_for_obj_r                = NULL;
-static char* bucket_list_for_obj_r                    = NULL;
-static BucketInfo4ObjReader* bucket_info_4_obj_reader = NULL;
-static char barcode_id[BARCODE_SIZE + 1]              = DEFAULT_BARCODE;
-static SCSI_DEVICE_PARAM scparam                      = { 0 };
-static char* object_meta_for_json                     = NULL;
-static object_list *objects                           = NULL;
-#endif
-
 
 /**
  * Set marker_file_flg
  * @param [in] (mf_flg)  1:marker file exists. 0:marker file does not exists.
  */
 int set_marker_file_flg(const int mf_flg) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:set_marker_file_flg\n");
-  marker_file_flg = mf_flg;
+  ctx->marker_file_flg = mf_flg;
   return ret;
 }
 
@@ -75,8 +42,9 @@ int set_marker_file_flg(const int mf_flg) {
  * Get marker_file_flg
  */
 int get_marker_file_flg() {
+  reader_context* const ctx = get_reader_context();
   output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_marker_file_flg\n");
-  return marker_file_flg;
+  return ctx->marker_file_flg;
 }
 
 /**
@@ -180,6 +148,7 @@ static char* get_marker_name(const MARKER_TYPE m_type) {
  * @param [out] (fileNumber)      Pointer of a total file number.
  */
 static int move_to_last_rcm(MamVci* const mamvci, const int which_partition, uint64_t* fileNumber) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:move_to_last_rcm\n");
 
   ST_SPTI_CMD_POSITIONDATA pos_rcm_located_at_just_before_EOD = { 0 };
@@ -222,7 +191,7 @@ static int move_to_last_rcm(MamVci* const mamvci, const int which_partition, uin
         ,INDENT, mamvci[which_partition].Data.rcm_block);
   }
   if (which_partition == DATA_PARTITION) {
-      dp_rcm_block_number = pos_rcm_located_at_just_before_EOD.blockNumber;
+      ctx->dp_rcm_block_number = pos_rcm_located_at_just_before_EOD.blockNumber;
   }
   ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "end  :move_to_last_rcm\n");
   return ret;
@@ -268,9 +237,10 @@ static int check_fm_next_to_marker(const int pos, const int own_flag) {
  * @param [in] (write_flg)       Whether skip writing marker file or not.
  */
 int write_markers_to_file(const char* restrict filepath, int write_flg) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:write_markers_to_file(%s)\n", filepath);
 
-  if (marker_file_flg == ON) {
+  if (ctx->marker_file_flg == ON) {
     write_flg = OFF;
     //return ret;
   }
@@ -298,8 +268,8 @@ int write_markers_to_file(const char* restrict filepath, int write_flg) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to open file.\n");
   }
   while(1) {
-    unsigned char* read_buf = (unsigned char*)clf_allocate_memory(block_size, "read_buf");
-    if (read_data(block_size, read_buf, &residual_cnt) == NG) {
+    unsigned char* read_buf = (unsigned char*)clf_allocate_memory(ctx->block_size, "read_buf");
+    if (read_data(ctx->block_size, read_buf, &residual_cnt) == NG) {
       if (check_fm_next_to_marker(END, ON) == NG) {
         ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to read the reference partition.\n");
       }
@@ -346,6 +316,254 @@ int read_marker_file(const uint64_t str_size, const uint64_t str_offset, const c
   return ret;
 }
 
+#ifdef OBJ_READER
+/**
+ * Append the progress of the dump to the journal.
+ * @param [in]  (pr_cnt)       Index of the partial reference to restart from.
+ * @param [in]  (ocm_cnt)      Index of the object commit marker to restart from.
+ * @param [in]  (po_cnt)       Index of the packed object to restart from.
+ * @param [in]  (obj_cnt)      Index of the first object metadata in the packed object.
+ * @param [in]  (done_obj_cnt) Index of the last object which is completely written.
+ * @return      (OK/NG)        If succeeded or not.
+ */
+static int record_dump_history(const uint64_t pr_cnt, const uint64_t ocm_cnt, const uint64_t po_cnt, const uint64_t obj_cnt,
+                               const uint64_t done_obj_cnt) {
+  reader_context* const ctx = get_reader_context();
+  ctx->dump_history.pr_cnt       = pr_cnt;
+  ctx->dump_history.ocm_cnt      = ocm_cnt;
+  ctx->dump_history.po_cnt       = po_cnt;
+  ctx->dump_history.obj_cnt      = obj_cnt;
+  ctx->dump_history.done_obj_cnt = done_obj_cnt;
+  ctx->dump_history.written_size = 0;
+  memset(ctx->dump_history.prefix_md5, 0, MD5_BIN_SIZE);
+  if (done_obj_cnt == ctx->resume_history.done_obj_cnt && ctx->resume_history.written_size != 0) {
+    // Keep the progress of the object which is not resumed yet.
+    ctx->dump_history.written_size = ctx->resume_history.written_size;
+    memcpy(ctx->dump_history.prefix_md5, ctx->resume_history.prefix_md5, MD5_BIN_SIZE);
+  }
+  // The save directory of the next object is recorded, so that resume dump finds the files of the object in progress.
+  int dir_number     = 0;
+  int sub_dir_number = 0;
+  int saved_counter  = 0;
+  memset(ctx->dump_history.bucket_id, 0, sizeof(ctx->dump_history.bucket_id));
+  if (ctx->bucket_name_for_obj_r != NULL
+      && get_bucket_save_state(ctx->bucket_info_4_obj_reader, ctx->bucket_name_for_obj_r, &dir_number, &sub_dir_number, &saved_counter) == OK) {
+    strncpy(ctx->dump_history.bucket_id, ctx->bucket_id_for_obj_r, UUID_SIZE);
+  }
+  ctx->dump_history.dir_number     = (uint16_t)dir_number;
+  ctx->dump_history.sub_dir_number = (uint16_t)sub_dir_number;
+  ctx->dump_history.saved_counter  = (uint16_t)saved_counter;
+  return output_history(&ctx->dump_history);
+}
+
+/**
+ * Hash the object data which is written, and append the progress to the journal every HISTORY_DATA_CHECKPOINT_SIZE.
+ * @param [in/out] (md5_ctx)      MD5 context of the written bytes.
+ * @param [in]     (data)         Data which is written.
+ * @param [in]     (size)         Size of the data.
+ * @param [in/out] (written_size) Bytes of the object which have been written.
+ * @return         (OK/NG)        If succeeded or not.
+ */
+static int update_data_history(MD5_CTX* const md5_ctx, const char* const data, const uint64_t size, uint64_t* const written_size) {
+  reader_context* const ctx = get_reader_context();
+  int ret = OK;
+  const uint64_t before_size = *written_size;
+  if (MD5_Update(md5_ctx, data, size) != 1) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "Failed to calculate MD5.\n");
+  }
+  *written_size += size;
+  if (before_size / HISTORY_DATA_CHECKPOINT_SIZE != *written_size / HISTORY_DATA_CHECKPOINT_SIZE) {
+    MD5_CTX prefix_ctx = *md5_ctx; // Keep md5_ctx to continue hashing.
+    MD5_Final(ctx->dump_history.prefix_md5, &prefix_ctx);
+    ctx->dump_history.written_size = *written_size;
+    ret |= output_history(&ctx->dump_history);
+    ctx->dump_history.written_size = 0;
+    memset(ctx->dump_history.prefix_md5, 0, MD5_BIN_SIZE);
+  }
+  return ret;
+}
+
+/**
+ * Hash the beginning of a file.
+ * @param [in]  (filepath)  File path.
+ * @param [in]  (size)      Bytes to hash from the beginning.
+ * @param [out] (md5_ctx)   MD5 context of the bytes, which can be continued.
+ * @return      (OK/NG)     If the file has the bytes and they are hashed, return OK. Otherwise, return NG.
+ */
+static int get_md5_of_file_prefix(const char* const filepath, const uint64_t size, MD5_CTX* const md5_ctx) {
+  reader_context* const ctx = get_reader_context();
+  FILE* fp = fopen(filepath, "rb");
+  if (fp == NULL) {
+    return NG;
+  }
+  int ret               = OK;
+  uint64_t remained_size = size;
+  char* file_data       = (char*)clf_allocate_memory(ctx->block_size, "file_data");
+  while (0 < remained_size) {
+    const size_t read_size = fread(file_data, 1, MIN(ctx->block_size, remained_size), fp);
+    if (read_size == 0) {
+      ret = NG;
+      break;
+    }
+    MD5_Update(md5_ctx, file_data, read_size);
+    remained_size -= read_size;
+  }
+  free(file_data);
+  file_data = NULL;
+  fclose(fp);
+  fp = NULL;
+  return ret;
+}
+
+/**
+ * Resume writing an object data which was interrupted in the middle.
+ * The beginning of the file is verified with the hash recorded in the journal, and only the rest is read from tape.
+ * If the verification fails, the object data is written from the beginning.
+ * @param [in]  (object_data_path) File path of the object data.
+ * @param [in]  (data_block)       Block number from which the offset of the object data is counted.
+ * @param [in]  (data_offset)      Offset from data_block to the beginning of the object data.
+ * @param [in]  (object_size)      Size of the object data.
+ * @return      (OK/NG)            If succeeded or not.
+ */
+static int resume_object_data(const char* const object_data_path, const uint64_t data_block, const uint64_t data_offset,
+                              const uint64_t object_size) {
+  reader_context* const ctx = get_reader_context();
+  int ret                         = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:resume_object_data\n");
+  uint8_t md[MD5_DIGEST_LENGTH]   = { 0 };
+  uint32_t residual_cnt           = 0;
+  uint64_t written_size           = 0;
+  MD5_CTX md5_ctx;
+
+  MD5_Init(&md5_ctx);
+  if (ctx->resume_history.written_size < object_size
+      && get_md5_of_file_prefix(object_data_path, ctx->resume_history.written_size, &md5_ctx) == OK) {
+    MD5_CTX prefix_ctx = md5_ctx;
+    MD5_Final(md, &prefix_ctx);
+    if (memcmp(md, ctx->resume_history.prefix_md5, MD5_DIGEST_LENGTH) == 0) {
+      written_size = ctx->resume_history.written_size;
+    }
+  }
+  if (written_size == 0) {
+    ret |= output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "The beginning of %s is not verified. It is written from the beginning.\n",
+                              object_data_path);
+    MD5_Init(&md5_ctx);
+    remove(object_data_path);
+  } else {
+    if (truncate(object_data_path, written_size) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to truncate file(%s).\n", object_data_path);
+    }
+    ret |= output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Resume %s from %lu bytes.\n", object_data_path, written_size);
+  }
+
+  const uint64_t position  = data_offset + written_size;
+  uint64_t offset_in_block = position % ctx->block_size;
+  if (locate_to_tape(data_block + position / ctx->block_size) == NG) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to locate.\n");
+  }
+  char* tape_data = (char*)clf_allocate_memory(ctx->block_size, "tape_data");
+  while (written_size < object_size) {
+    if (read_data(ctx->block_size, tape_data, &residual_cnt) == NG) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to read data from tape.\n");
+    }
+    const uint64_t write_size = MIN(ctx->block_size - offset_in_block, object_size - written_size);
+    ret |= write_object_and_meta_to_file(tape_data, write_size, offset_in_block, object_data_path);
+    ret |= update_data_history(&md5_ctx, tape_data + offset_in_block, write_size, &written_size);
+    offset_in_block = 0;
+  }
+  free(tape_data);
+  tape_data = NULL;
+  if (is_content_verifier_enabled() == true) {
+    // md5_ctx has hashed the verified beginning of the file and the rest from tape, which is the whole object.
+    MD5_Final(md, &md5_ctx);
+    ret |= end_content_verification(md);
+  }
+
+  ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "end  :resume_object_data\n");
+  return ret;
+}
+
+/**
+ * Remove the files of an object which was not recorded as done in the journal, so that it is written again.
+ * It is the object which was being written when the dump stopped, or one written after the last commit of the journal.
+ * @param [in]  (object_meta_path) File path of the object metadata.
+ * @param [in]  (object_data_path) File path of the object data.
+ * @return      (OK/NG)            If succeeded or not.
+ */
+static int discard_unfinished_object(const char* const object_meta_path, const char* const object_data_path) {
+  int ret              = OK;
+  struct stat stat_buf = { 0 };
+  if (stat(object_meta_path, &stat_buf) != OK && stat(object_data_path, &stat_buf) != OK) {
+    return ret;
+  }
+  ret |= output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%s is not recorded as done in %s. It is written again.\n",
+                            object_meta_path, HISTORY_JOURNAL_PATH);
+  if (remove(object_meta_path) != OK && errno != ENOENT) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "Failed to remove file(%s).\n", object_meta_path);
+  }
+  if (remove(object_data_path) != OK && errno != ENOENT) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "Failed to remove file(%s).\n", object_data_path);
+  }
+  return ret;
+}
+
+/**
+ * Write only the requested range of an object data to file.
+ * Tape head is located directly to the block which has the first byte of the range.
+ * @param [in]  (object_path)      File path of the object without extension. "_<offset>_<length>.data" is added.
+ * @param [in]  (data_block)       Block number from which the offset of the object data is counted.
+ * @param [in]  (data_offset)      Offset from data_block to the beginning of the object data.
+ * @param [in]  (object_size)      Size of the object data.
+ * @param [in]  (range_offset)     Offset of the range from the beginning of the object data.
+ * @param [in]  (range_length)     Length of the range. 0 means up to the end of the object data.
+ * @return      (OK/NG)            If succeeded or not.
+ */
+static int write_object_range(const char* const object_path, const uint64_t data_block, const uint64_t data_offset,
+                              const uint64_t object_size, const uint64_t range_offset, uint64_t range_length) {
+  reader_context* const ctx = get_reader_context();
+  int ret                             = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:write_object_range\n");
+  char range_path[MAX_PATH + 1]       = { 0 };
+  uint32_t residual_cnt               = 0;
+  struct stat stat_buf                = { 0 };
+
+  if (object_size <= range_offset) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO,
+                              "The range offset(%lu) is out of the object(%s) whose size is %lu.\n", range_offset, object_path, object_size);
+    return ret;
+  }
+  if (range_length == 0 || object_size - range_offset < range_length) {
+    range_length = object_size - range_offset;
+  }
+  snprintf(range_path, sizeof(range_path), "%s_%lu_%lu.data", object_path, range_offset, range_length);
+  if (stat(range_path, &stat_buf) == OK) {
+    return ret;
+  }
+
+  const uint64_t position = data_offset + range_offset;
+  uint64_t offset_in_block = position % ctx->block_size;
+  uint64_t remained_size   = range_length;
+  if (locate_to_tape(data_block + position / ctx->block_size) == NG) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to locate.\n");
+  }
+  char* tape_data = (char*)clf_allocate_memory(ctx->block_size, "tape_data");
+  while (0 < remained_size) {
+    if (read_data(ctx->block_size, tape_data, &residual_cnt) == NG) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to read data from tape.\n");
+    }
+    const uint64_t write_size = MIN(ctx->block_size - offset_in_block, remained_size);
+    ret |= write_object_and_meta_to_file(tape_data, write_size, offset_in_block, range_path);
+    remained_size   -= write_size;
+    offset_in_block  = 0;
+  }
+  free(tape_data);
+  tape_data = NULL;
+
+  ret |= output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu bytes from offset %lu are written to %s.\n",
+                            range_length, range_offset, range_path);
+  ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "end  :write_object_range\n");
+  return ret;
+}
+#endif
+
 /**
  * Check if there is no difference between the marker file and the data on the data partition.
  * @param [in] (m_type)         Marker type.(OCM/PO/META)
@@ -356,6 +574,7 @@ int read_marker_file(const uint64_t str_size, const uint64_t str_offset, const c
  */
 static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* filepath, const uint64_t read_size,
                                          uint64_t offset, const uint64_t pr_file_offset) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:check_diff_btwn_file_and_tape(%s)\n",
                                filepath);
 
@@ -369,19 +588,20 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
   uint64_t meta_data_offset = 0;
   int meta_first_block_flag = 1;
   int data_first_block_flag = 1;
+  const uint64_t first_offset = offset;
 
   if (filepath == NULL) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
                               "Invalid arguments at write_markers_to_file: filepath = %p\n",filepath);
   }
-  if ((stat(filepath, &stat_buf) != OK) && read_marker_file_flag == 1) {
+  if ((stat(filepath, &stat_buf) != OK) && ctx->read_marker_file_flag == 1) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to get the file(%s) size.\n", filepath);
   }
 
   while(read_fin_flg == OFF) {
-    char* tape_data = (char*)clf_allocate_memory(block_size, "tape_data");
-    char* file_data = (char*)clf_allocate_memory(block_size, "file_data");
-    if (read_data(block_size, tape_data, &residual_cnt) == NG) {
+    char* tape_data = (char*)clf_allocate_memory(ctx->block_size, "tape_data");
+    char* file_data = (char*)clf_allocate_memory(ctx->block_size, "file_data");
+    if (read_data(ctx->block_size, tape_data, &residual_cnt) == NG) {
       if (check_fm_next_to_marker(END, ON) == NG) {
         ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to read data from tape.\n");
       }
@@ -404,8 +624,8 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
       file_data = NULL;
       break;
     }
-    if (read_marker_file_flag == 1) {
-      if (read_marker_file(MIN(block_size, stat_buf.st_size - pr_file_offset - readed_size),
+    if (ctx->read_marker_file_flag == 1) {
+      if (read_marker_file(MIN(ctx->block_size, stat_buf.st_size - pr_file_offset - readed_size),
                            pr_file_offset + readed_size, filepath, file_data) == NG) {
           ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to read file(%s).\n", filepath);
       }
@@ -426,10 +646,10 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
         memmove(rcm_header, tape_data + IDENTIFIER_SIZE, RCM_HEADER_SIZE);
         r64(BIG, rcm_header + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE, &system_info_size__for_obj_r, 1);
         r64(BIG, rcm_header + DIRECTORY_OFFSET_SIZE, &data_offset_for_obj_r, 1);
-        free(bucket_list_for_obj_r);
-        bucket_list_for_obj_r = NULL;
-        bucket_list_for_obj_r = (char*)clf_allocate_memory(system_info_size__for_obj_r, "bucket list");
-        memmove(bucket_list_for_obj_r, tape_data + IDENTIFIER_SIZE + data_offset_for_obj_r, system_info_size__for_obj_r);
+        free(ctx->bucket_list_for_obj_r);
+        ctx->bucket_list_for_obj_r = NULL;
+        ctx->bucket_list_for_obj_r = (char*)clf_allocate_memory(system_info_size__for_obj_r, "bucket list");
+        memmove(ctx->bucket_list_for_obj_r, tape_data + IDENTIFIER_SIZE + data_offset_for_obj_r, system_info_size__for_obj_r);
         free(rcm_header);
         rcm_header = NULL;
         }
@@ -450,16 +670,16 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
 #ifdef OBJ_READER
         uint8_t* po_header = (uint8_t*)clf_allocate_memory(PO_HEADER_SIZE, "PO Header");
         memmove(po_header, tape_data + PO_IDENTIFIER_SIZE, PO_HEADER_SIZE);
-        uuid_unparse(po_header + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE + NUMBER_OF_OBJECTS_SIZE + PACK_ID_SIZE, bucket_id_for_obj_r);
+        uuid_unparse(po_header + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE + NUMBER_OF_OBJECTS_SIZE + PACK_ID_SIZE, ctx->bucket_id_for_obj_r);
         free(po_header);
         po_header = NULL;
-        free(bucket_name_for_obj_r);
-        bucket_name_for_obj_r = NULL;
-        bucket_name_for_obj_r = (char*)clf_allocate_memory(BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1, "bucket_name_for_obj_r");
-        char *bucket_list = (char*)clf_allocate_memory(strlen(bucket_list_for_obj_r), "bucket_list");
-        extract_json_element(bucket_list_for_obj_r, "BucketList", &bucket_list);
-        get_bucket_name(bucket_list, bucket_id_for_obj_r, &bucket_name_for_obj_r);
-        add_bucket_info_4_obj_reader(&bucket_info_4_obj_reader, bucket_name_for_obj_r, 0, 1, 1);
+        free(ctx->bucket_name_for_obj_r);
+        ctx->bucket_name_for_obj_r = NULL;
+        ctx->bucket_name_for_obj_r = (char*)clf_allocate_memory(BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1, "bucket_name_for_obj_r");
+        char *bucket_list = (char*)clf_allocate_memory(strlen(ctx->bucket_list_for_obj_r), "bucket_list");
+        extract_json_element(ctx->bucket_list_for_obj_r, "BucketList", &bucket_list);
+        get_bucket_name(bucket_list, ctx->bucket_id_for_obj_r, &ctx->bucket_name_for_obj_r);
+        add_bucket_info_4_obj_reader(&ctx->bucket_info_4_obj_reader, ctx->bucket_name_for_obj_r, 0, 1, 1);
         free(bucket_list);
         bucket_list = NULL;
 #endif
@@ -467,8 +687,8 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
         residual_cnt -= strlen(PO_IDENTIFIER_ASCII_CODE);
         identifier_flg = OFF;
       }
-      if (memcmp(tape_data + offset, file_data, MIN(block_size - offset, read_size - (readed_size - residual_cnt))) != 0
-          && read_marker_file_flag == 1) {
+      if (memcmp(tape_data + offset, file_data, MIN(ctx->block_size - offset, read_size - (readed_size - residual_cnt))) != 0
+          && ctx->read_marker_file_flag == 1) {
         ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT,
                                   "The data partition is inconsistent with marker file(%d:%s).\n",
                                   m_type, filepath);
@@ -482,15 +702,15 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
           }
 #ifdef OBJ_READER
         if (m_type == META) {
-          memmove(meta_data + meta_data_offset, tape_data + offset, MIN(block_size - offset, read_size - (readed_size - residual_cnt)));
-          meta_data_offset += MIN(block_size - offset, read_size - (readed_size - residual_cnt));
-          if (offset + read_size > block_size) {
-            memset(tape_data, 0, block_size);
-              if (read_data(block_size, tape_data, &residual_cnt) == NG) {
+          memmove(meta_data + meta_data_offset, tape_data + offset, MIN(ctx->block_size - offset, read_size - (readed_size - residual_cnt)));
+          meta_data_offset += MIN(ctx->block_size - offset, read_size - (readed_size - residual_cnt));
+          if (offset + read_size > ctx->block_size) {
+            memset(tape_data, 0, ctx->block_size);
+              if (read_data(ctx->block_size, tape_data, &residual_cnt) == NG) {
               ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to read data from tape.\n");
               }
-              memmove(meta_data + meta_data_offset, tape_data, read_size + offset - block_size);
-              offset = offset - block_size;
+              memmove(meta_data + meta_data_offset, tape_data, read_size + offset - ctx->block_size);
+              offset = offset - ctx->block_size;
           }
           uint64_t object_size                = 0;
           char object_key[MAX_PATH + 1]       = { 0 };
@@ -501,37 +721,65 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
           char object_data_path[MAX_PATH + 1] = { 0 };
           char object_meta_path[MAX_PATH + 1] = { 0 };
           get_element_from_metadata(meta_data, &object_size, &object_key[0], &object_id[0], &last_modified[0], &version_id[0], &content_md5[0]);
-          if (strncmp(obj_r_mode, "output_list", sizeof("output_list")) == 0) {
-            make_key_str_value_pairs(&object_meta_for_json, "object_key", object_key);
-            make_key_ulong_int_value_pairs(&object_meta_for_json, "size", object_size);
-            make_key_str_value_pairs(&object_meta_for_json, "last_modified", last_modified);
-            make_key_str_value_pairs(&object_meta_for_json, "version_id", version_id);
-            make_key_str_value_pairs(&object_meta_for_json, "content_md5", content_md5);
-            make_key_str_value_pairs(&object_meta_for_json, "object_id", object_id);
+          if (strncmp(ctx->obj_r_mode, "output_list", sizeof("output_list")) == 0) {
+            make_key_str_value_pairs(&ctx->object_meta_for_json, "object_key", object_key);
+            make_key_ulong_int_value_pairs(&ctx->object_meta_for_json, "size", object_size);
+            make_key_str_value_pairs(&ctx->object_meta_for_json, "last_modified", last_modified);
+            uint64_t last_modified_ns = 0;
+            if (convert_utc_to_epoch_ns(last_modified, &last_modified_ns) == NG) {
+              ret |= output_accdg_to_vl(OUTPUT_WARNING, DEFAULT, "Failed to convert LastModifiedTime(%s) of %s.\n", last_modified, object_key);
+            }
+            make_key_ulong_int_value_pairs(&ctx->object_meta_for_json, "last_modified_ns", last_modified_ns);
+            make_key_str_value_pairs(&ctx->object_meta_for_json, "version_id", version_id);
+            make_key_str_value_pairs(&ctx->object_meta_for_json, "content_md5", content_md5);
+            make_key_str_value_pairs(&ctx->object_meta_for_json, "object_id", object_id);
+            add_metric_counter(METRIC_OBJECTS, 1);
           }
 
-          if (LARGE_OBJ_SIZE*pow(1024, 3) <= object_size) {
-            if (check_disk_space(obj_reader_saveroot, object_size) == NG) {
+          if (strncmp(ctx->obj_r_mode, "output_list", sizeof("output_list")) != 0 && is_pax_stream_enabled() == false) {
+            // Fail before starting an object which cannot fit. It is cheap since the disk space is sampled only occasionally.
+            if (check_disk_space(ctx->obj_reader_saveroot, object_size) == NG) {
               ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to check the disk space.\n");
             }
           }
 
-          if (strcmp(obj_r_mode , "output_objects_in_object_list") != 0) {
-            get_bucket_info_4_obj_reader(&bucket_info_4_obj_reader, bucket_name_for_obj_r, &savepath_dir_number, &savepath_sub_dir_number);
+          if (strcmp(ctx->obj_r_mode , "output_objects_in_object_list") != 0) {
+            get_bucket_info_4_obj_reader(&ctx->bucket_info_4_obj_reader, ctx->bucket_name_for_obj_r, &ctx->savepath_dir_number, &ctx->savepath_sub_dir_number);
           }
 
           Bool dir_max_limit_flag = false;
-          if (savepath_dir_number > OBJ_READER_MAX_SAVE_NUM) {
+          if (ctx->savepath_dir_number > OBJ_READER_MAX_SAVE_NUM) {
         	  dir_max_limit_flag = true;
           }
 
-          if ((strncmp(obj_r_mode, "full_dump", sizeof("full_dump")) == 0)
-        		  || (strncmp(obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0)
-              || (strncmp(obj_r_mode, "output_objects_in_object_list", sizeof("output_objects_in_object_list")) == 0)){
-            sprintf(object_meta_path, "%s/%s/%04d/%04d/%s/%s.meta", obj_reader_saveroot, bucket_name_for_obj_r, savepath_dir_number, savepath_sub_dir_number, object_key, object_id);
-            if (meta_first_block_flag == 1) {
+          if ((strncmp(ctx->obj_r_mode, "full_dump", sizeof("full_dump")) == 0)
+        		  || (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0)
+              || (strncmp(ctx->obj_r_mode, "output_objects_in_object_list", sizeof("output_objects_in_object_list")) == 0)){
+            sprintf(object_meta_path, "%s/%s/%04d/%04d/%s/%s.meta", ctx->obj_reader_saveroot, ctx->bucket_name_for_obj_r, ctx->savepath_dir_number, ctx->savepath_sub_dir_number, object_key, object_id);
+            struct stat meta_stat_buf;
+            if (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0 && ctx->resume_history.written_size != 0
+                && ctx->dump_history.done_obj_cnt == ctx->resume_history.done_obj_cnt && dir_max_limit_flag != true
+                && stat(object_meta_path, &meta_stat_buf) == OK) {
+              // The object was interrupted in the middle, so only the rest of the object data is read.
+              sprintf(object_data_path, "%s/%s/%04d/%04d/%s/%s.data", ctx->obj_reader_saveroot, ctx->bucket_name_for_obj_r, ctx->savepath_dir_number, ctx->savepath_sub_dir_number, object_key, object_id);
+              begin_content_verification(ctx->bucket_name_for_obj_r, object_key, object_id, content_md5, object_size);
+              ret |= resume_object_data(object_data_path, ctx->meta_block_number, first_offset + read_size, object_size);
+              read_fin_flg = ON;
+              free(meta_data);
+              meta_data = NULL;
+              free(tape_data);
+              tape_data = NULL;
+              free(file_data);
+              file_data = NULL;
+              break;
+            }
+            if (meta_first_block_flag == 1 && is_pax_stream_enabled() == false) {
               struct stat stat_buf;
-              if (stat(object_meta_path, &stat_buf) == OK) {
+              if (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0) {
+                // Objects recorded as done in the journal have been skipped, so files of this object may be incomplete.
+                sprintf(object_data_path, "%s/%s/%04d/%04d/%s/%s.data", ctx->obj_reader_saveroot, ctx->bucket_name_for_obj_r, ctx->savepath_dir_number, ctx->savepath_sub_dir_number, object_key, object_id);
+                ret |= discard_unfinished_object(object_meta_path, object_data_path);
+              } else if (stat(object_meta_path, &stat_buf) == OK) {
                 free(tape_data);
                 tape_data = NULL;
                 free(file_data);
@@ -540,22 +788,51 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
               }
               meta_first_block_flag = 0;
             }
-            if (dir_max_limit_flag != true) {
+            if (is_pax_stream_enabled() == true) {
+              // The metadata is a record of the extended header, and the data follows it in the archive.
+              ret |= begin_pax_entry(ctx->bucket_name_for_obj_r, object_key, object_id, version_id, last_modified, meta_data, object_size);
+            } else if (dir_max_limit_flag != true) {
               mk_deep_dir(object_meta_path);
-            }
-            if (dir_max_limit_flag != true) {
               write_object_and_meta_to_file(meta_data, strlen(meta_data), 0, object_meta_path);
             }
+            add_metric_counter(METRIC_OBJECTS, 1);
           }
           free(meta_data);
           meta_data = NULL;
 
-          sprintf(object_data_path, "%s/%s/%04d/%04d/%s/%s.data", obj_reader_saveroot, bucket_name_for_obj_r, savepath_dir_number, savepath_sub_dir_number, object_key, object_id);
-          uint64_t remained_tape_data_size = block_size - offset - MIN(block_size - offset, read_size - (readed_size - residual_cnt));
-          if ((strncmp(obj_r_mode, "full_dump", sizeof("full_dump")) == 0)
-        	  || (strncmp(obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0)
-			  || (strncmp(obj_r_mode, "output_objects_in_object_list", sizeof("output_objects_in_object_list")) == 0)){
-            if (data_first_block_flag == 1) {
+          uint64_t range_offset = 0;
+          uint64_t range_length = 0;
+          if ((strncmp(ctx->obj_r_mode, "output_objects_in_object_list", sizeof("output_objects_in_object_list")) == 0)
+              && get_object_range(&range_offset, &range_length) == true) {
+            // Object data follows its metadata, so the range can be located without reading the data before it.
+            sprintf(object_data_path, "%s/%s/%04d/%04d/%s/%s", ctx->obj_reader_saveroot, ctx->bucket_name_for_obj_r, ctx->savepath_dir_number, ctx->savepath_sub_dir_number, object_key, object_id);
+            if (dir_max_limit_flag != true) {
+              ret |= write_object_range(object_data_path, ctx->meta_block_number, first_offset + read_size, object_size, range_offset, range_length);
+            }
+            read_fin_flg = ON;
+            free(tape_data);
+            tape_data = NULL;
+            free(file_data);
+            file_data = NULL;
+            break;
+          }
+
+          sprintf(object_data_path, "%s/%s/%04d/%04d/%s/%s.data", ctx->obj_reader_saveroot, ctx->bucket_name_for_obj_r, ctx->savepath_dir_number, ctx->savepath_sub_dir_number, object_key, object_id);
+          uint64_t remained_tape_data_size = ctx->block_size - offset - MIN(ctx->block_size - offset, read_size - (readed_size - residual_cnt));
+          // Progress of a large object is recorded, so that resume dump can continue it from the middle.
+          Bool data_history_flag    = false;
+          Bool data_verify_flag     = false;
+          uint64_t data_written_size = 0;
+          MD5_CTX data_md5_ctx;
+          if (((strncmp(ctx->obj_r_mode, "full_dump", sizeof("full_dump")) == 0) || (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0))
+              && dir_max_limit_flag != true && HISTORY_DATA_CHECKPOINT_SIZE < object_size) {
+            data_history_flag = true;
+            MD5_Init(&data_md5_ctx);
+          }
+          if ((strncmp(ctx->obj_r_mode, "full_dump", sizeof("full_dump")) == 0)
+        	  || (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0)
+			  || (strncmp(ctx->obj_r_mode, "output_objects_in_object_list", sizeof("output_objects_in_object_list")) == 0)){
+            if (data_first_block_flag == 1 && is_pax_stream_enabled() == false) {
               struct stat stat_buf;
               if (stat(object_data_path, &stat_buf) == OK) {
                 free(tape_data);
@@ -566,38 +843,65 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
               }
               data_first_block_flag = 0;
             }
-            if (dir_max_limit_flag != true) {
-              write_object_and_meta_to_file(tape_data, (uint64_t)(MIN(object_size, remained_tape_data_size)), block_size - remained_tape_data_size, object_data_path);
+            // The data is hashed as it is written. The MD5 for the history is shared if the object has it.
+            if (is_content_verifier_enabled() == true && (dir_max_limit_flag != true || is_pax_stream_enabled() == true)) {
+              data_verify_flag = true;
+              begin_content_verification(ctx->bucket_name_for_obj_r, object_key, object_id, content_md5, object_size);
+            }
+            if (is_pax_stream_enabled() == true) {
+              ret |= write_pax_data(tape_data + ctx->block_size - remained_tape_data_size, MIN(object_size, remained_tape_data_size));
+            } else if (dir_max_limit_flag != true) {
+              write_object_and_meta_to_file(tape_data, (uint64_t)(MIN(object_size, remained_tape_data_size)), ctx->block_size - remained_tape_data_size, object_data_path);
+            }
+            if (data_history_flag == true) {
+              ret |= update_data_history(&data_md5_ctx, tape_data + ctx->block_size - remained_tape_data_size,
+                                         MIN(object_size, remained_tape_data_size), &data_written_size);
+            } else if (data_verify_flag == true) {
+              update_content_verification(tape_data + ctx->block_size - remained_tape_data_size, MIN(object_size, remained_tape_data_size));
             }
           }
 
           object_size -= MIN(object_size, remained_tape_data_size);
           while (0 < object_size) { //In case the object data is on multiple blocks.
-              memset(tape_data, 0, block_size);
-              if (read_data(block_size, tape_data, &residual_cnt) == NG) {
+              memset(tape_data, 0, ctx->block_size);
+              if (read_data(ctx->block_size, tape_data, &residual_cnt) == NG) {
               if (check_fm_next_to_marker(END, ON) == NG) {
                 ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to read data from tape.\n");
               }
             }
-           if ((strncmp(obj_r_mode, "full_dump", sizeof("full_dump")) == 0)
-       		 || (strncmp(obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0)
-               || (strncmp(obj_r_mode, "output_objects_in_object_list", sizeof("output_objects_in_object_list")) == 0)){
-        	   if (dir_max_limit_flag != true) {
-               write_object_and_meta_to_file(tape_data, (uint64_t)(MIN(object_size, block_size)), 0, object_data_path);
+           if ((strncmp(ctx->obj_r_mode, "full_dump", sizeof("full_dump")) == 0)
+       		 || (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0)
+               || (strncmp(ctx->obj_r_mode, "output_objects_in_object_list", sizeof("output_objects_in_object_list")) == 0)){
+        	   if (is_pax_stream_enabled() == true) {
+               ret |= write_pax_data(tape_data, MIN(object_size, ctx->block_size));
+        	   } else if (dir_max_limit_flag != true) {
+               write_object_and_meta_to_file(tape_data, (uint64_t)(MIN(object_size, ctx->block_size)), 0, object_data_path);
         	   }
+             if (data_history_flag == true) {
+               ret |= update_data_history(&data_md5_ctx, tape_data, MIN(object_size, ctx->block_size), &data_written_size);
+             } else if (data_verify_flag == true) {
+               update_content_verification(tape_data, MIN(object_size, ctx->block_size));
+             }
            }
-           object_size -= MIN(block_size, object_size);
+           object_size -= MIN(ctx->block_size, object_size);
          }
+          if (data_verify_flag == true) {
+            uint8_t data_md5[MD5_DIGEST_LENGTH] = { 0 };
+            if (data_history_flag == true) {
+              MD5_Final(data_md5, &data_md5_ctx);
+            }
+            ret |= end_content_verification((data_history_flag == true) ? data_md5 : NULL);
+          }
 
         }
 #endif
-          if ((m_type == META) && (num_of_meta == num_of_meta_cnt) && (skip_0_padding_check_flag == 0)) {
+          if ((m_type == META) && (ctx->num_of_meta == ctx->num_of_meta_cnt) && (ctx->skip_0_padding_check_flag == 0)) {
             // Read large object data to the end block.
-            const uint64_t last_obj_size = last_data_offset - last_meta_data_offset;
+            const uint64_t last_obj_size = ctx->last_data_offset - ctx->last_meta_data_offset;
 #ifndef OBJ_READER
-            for (int n = 0; n < (offset + last_obj_size) / block_size; n++) {
-              memset(tape_data, 0, block_size);
-              if (read_data(block_size, tape_data, &residual_cnt) == NG) {
+            for (int n = 0; n < (offset + last_obj_size) / ctx->block_size; n++) {
+              memset(tape_data, 0, ctx->block_size);
+              if (read_data(ctx->block_size, tape_data, &residual_cnt) == NG) {
                 ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "Failed to read Packed Object\n");
                 free(tape_data);
                 free(file_data);
@@ -606,9 +910,9 @@ static int check_diff_btwn_file_and_tape(const MARKER_TYPE m_type, const char* f
             }
 #endif
             // Checked the end of the last block of packed object.
-            const uint64_t padding_size = block_size - (offset + last_obj_size) % block_size;
+            const uint64_t padding_size = ctx->block_size - (offset + last_obj_size) % ctx->block_size;
             char* const zero_padding = (char*)clf_allocate_memory(padding_size, "zero_padding");
-            if (memcmp(tape_data + (offset + last_obj_size) % block_size, zero_padding, padding_size) != 0) {
+            if (memcmp(tape_data + (offset + last_obj_size) % ctx->block_size, zero_padding, padding_size) != 0) {
               ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "The end of the packed objects must be zero-padded.\n");
             }
             free(zero_padding);
@@ -679,6 +983,7 @@ int get_pr_num(uint64_t* pr_num) {
  * @param [out] (fileNumber) Pointer of a total file number.
  */
 static int check_last_rcm_integrity(const int which_partition, MamVci* const mamvci, MamHta* const mamhta, uint64_t* fileNumber) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_HEADER_AND_L4_INFO, "start:check_last_rcm_integrity\n");
 
   if (mamvci == NULL || mamhta == NULL) {
@@ -694,11 +999,11 @@ static int check_last_rcm_integrity(const int which_partition, MamVci* const mam
       ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_HEADER_AND_L4_INFO,
                                 "Failed to write the last reference commit marker to file.\n");
     }
-    if (get_pr_num(&pr_num) == NG) {
+    if (get_pr_num(&ctx->pr_num) == NG) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L4_INFO,
                                 "Failed to get the number of partial references.\n");
     }
-    if (clf_reference_commit_marker(LAST, mamvci, mamhta, pr_num) == NG) {
+    if (clf_reference_commit_marker(LAST, mamvci, mamhta, ctx->pr_num) == NG) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L4_INFO,
                                 "Format violation is detected at the last reference commit marker on Reference Partition.\n");
     }
@@ -759,6 +1064,7 @@ static int check_vol1_label_integrity(const int which_partition) {
  * @param [in] (write_flg)       Whether skip writing marker file or not.
  */
 static int check_otf_label_integrity(const int which_partition, MamVci* const mamvci, MamHta* const mamhta, int write_flg) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_HEADER_INFO, "start:check_otf_label_integrity\n");
 
   if (mamvci == NULL || mamhta == NULL) {
@@ -769,7 +1075,7 @@ static int check_otf_label_integrity(const int which_partition, MamVci* const ma
     if (write_markers_to_file(OTF_LABEL_PATH, write_flg) == NG){
       ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_HEADER_INFO, "Failed to write otf label to file.\n");
     }
-    if (clf_ltos_label(mamvci, mamhta, &block_size) == NG) {
+    if (clf_ltos_label(mamvci, mamhta, &ctx->block_size) == NG) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_INFO,
                                 "Format violation is detected at OTF label on Reference Partition.\n");
     }
@@ -794,6 +1100,7 @@ static int check_otf_label_integrity(const int which_partition, MamVci* const ma
  * @param [in] (mamhta) Pointer of a host-type attributes.
  */
 static int check_first_rcm_integrity(const int which_partition, MamVci* const mamvci, MamHta* const mamhta) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_HEADER_AND_L4_INFO, "start:check_first_rcm_integrity\n");
 
   if (mamvci == NULL || mamhta == NULL) {
@@ -805,7 +1112,7 @@ static int check_first_rcm_integrity(const int which_partition, MamVci* const ma
       ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_HEADER_AND_L4_INFO,
                                 "Failed to write the first reference commit marker to file.\n");
     }
-    if (clf_reference_commit_marker(FIRST, mamvci, mamhta, pr_num) == NG) {
+    if (clf_reference_commit_marker(FIRST, mamvci, mamhta, ctx->pr_num) == NG) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L4_INFO,
                                 "Format violation is detected at the first reference commit marker on Reference Partition.\n");
     }
@@ -893,6 +1200,7 @@ static int check_pr_integrity(const int which_partition, MamVci* const mamvci, i
  * @param [in]  (marker_len)            Length of the target marker.
  */
 static int get_last_data_offset(const char* filepath, const uint64_t pr_file_offset, const uint64_t marker_len) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_last_data_offset\n");
 
   char* bin_for_last_data_offset = (char*)clf_allocate_memory(sizeof(uint64_t), "bin_for_last_data_offset");
@@ -901,7 +1209,7 @@ static int get_last_data_offset(const char* filepath, const uint64_t pr_file_off
                        filepath, bin_for_last_data_offset) == NG) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to read file(%s).\n", filepath);
   }
-  r64(BIG, (unsigned char *)(bin_for_last_data_offset), &last_data_offset, 1);
+  r64(BIG, (unsigned char *)(bin_for_last_data_offset), &ctx->last_data_offset, 1);
   free(bin_for_last_data_offset);
   bin_for_last_data_offset = NULL;
   char* bin_for_last_meta_offset = (char*)clf_allocate_memory(sizeof(uint64_t), "bin_for_last_meta_offset");
@@ -910,7 +1218,7 @@ static int get_last_data_offset(const char* filepath, const uint64_t pr_file_off
                        filepath, bin_for_last_meta_offset) == NG) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to read file(%s).\n", filepath);
   }
-  r64(BIG, (unsigned char *)(bin_for_last_meta_offset), &last_meta_data_offset, 1);
+  r64(BIG, (unsigned char *)(bin_for_last_meta_offset), &ctx->last_meta_data_offset, 1);
   free(bin_for_last_meta_offset);
   bin_for_last_meta_offset = NULL;
   char* bin_for_num_of_meta = (char*)clf_allocate_memory(sizeof(uint64_t), "bin_for_num_of_meta");
@@ -919,7 +1227,7 @@ static int get_last_data_offset(const char* filepath, const uint64_t pr_file_off
                        filepath, bin_for_num_of_meta) == NG) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to read file(%s).\n", filepath);
   }
-  r64(BIG, (unsigned char *)(bin_for_num_of_meta), &num_of_meta, 1);
+  r64(BIG, (unsigned char *)(bin_for_num_of_meta), &ctx->num_of_meta, 1);
   free(bin_for_num_of_meta);
   bin_for_num_of_meta = NULL;
   ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "end  :get_last_data_offset\n");
@@ -937,6 +1245,7 @@ static int get_last_data_offset(const char* filepath, const uint64_t pr_file_off
  */
 static int check_part_of_pr_integrity(const MARKER_TYPE m_type, const uint64_t block_number, const uint64_t offset,
                                       const uint64_t pr_file_num, const uint64_t pr_file_offset, const uint64_t marker_len) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_HEADER_AND_L43_INFO, "start:check_part_of_pr_integrity\n");
 
   ST_SPTI_CMD_POSITIONDATA pos = { 0 };
@@ -947,9 +1256,12 @@ static int check_part_of_pr_integrity(const MARKER_TYPE m_type, const uint64_t b
   if (m_type == META) {
     ST_SPTI_CMD_POSITIONDATA pos_before_locate = { 0 };
     read_position_on_tape(&pos_before_locate);
-    locate_to_tape(block_number);
+    // Locate only when the tape head is not on the meta, so that sequential reads keep streaming.
+    if (pos_before_locate.blockNumber != block_number) {
+      locate_to_tape(block_number);
+    }
     read_position_on_tape(&pos);
-    if ((pos.blockNumber < pos_before_locate.blockNumber - 1) && sequential_read_flag == 1) {
+    if ((pos.blockNumber < pos_before_locate.blockNumber - 1) && ctx->sequential_read_flag == 1) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L43_INFO,
                                 "The position of the meta on the data partition is not correct.\n");
     }
@@ -958,7 +1270,7 @@ static int check_part_of_pr_integrity(const MARKER_TYPE m_type, const uint64_t b
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L43_INFO,
                                 "There is no file mark just before the object commit marker.\n");
     }
-    num_of_meta_cnt = 0;
+    ctx->num_of_meta_cnt = 0;
   }
   read_position_on_tape(&pos);
   if (pos.blockNumber != block_number) {
@@ -971,13 +1283,14 @@ static int check_part_of_pr_integrity(const MARKER_TYPE m_type, const uint64_t b
     if (get_last_data_offset(filepath, pr_file_offset, marker_len) != OK) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L4321_INFO, "Can't get the last data offset from file(%s).\n", filepath);
     }
-    num_of_meta_cnt = 0;
+    ctx->num_of_meta_cnt = 0;
   }
   if (m_type == META) {
-    num_of_meta_cnt += 1;
+    ctx->num_of_meta_cnt += 1;
 #ifdef OBJ_READER
-    if (strncmp(obj_r_mode, "output_list", sizeof("output_list")) == 0) {
-      object_meta_for_json  = (char*)clf_allocate_memory(MAX_PATH, "object_meta_for_json");
+    ctx->meta_block_number = block_number;
+    if (strncmp(ctx->obj_r_mode, "output_list", sizeof("output_list")) == 0) {
+      ctx->object_meta_for_json  = (char*)clf_allocate_memory(MAX_PATH, "object_meta_for_json");
     }
 #endif
   }
@@ -986,18 +1299,18 @@ static int check_part_of_pr_integrity(const MARKER_TYPE m_type, const uint64_t b
                               "The data partition is inconsistent with marker file(%s).\n", FIRST_RCM_PATH);
   }
 #ifdef OBJ_READER
-  if (strncmp(obj_r_mode, "output_list", sizeof("output_list")) == 0) {
+  if (strncmp(ctx->obj_r_mode, "output_list", sizeof("output_list")) == 0) {
     if (m_type == META) {
-      make_key_ulong_int_value_pairs(&object_meta_for_json, "block_address", po_block_address);
-      make_key_ulong_int_value_pairs(&object_meta_for_json, "offset", (block_number - po_block_address) * block_size + offset);
-      make_key_ulong_int_value_pairs(&object_meta_for_json, "meta_size", marker_len);
+      make_key_ulong_int_value_pairs(&ctx->object_meta_for_json, "block_address", ctx->po_block_address);
+      make_key_ulong_int_value_pairs(&ctx->object_meta_for_json, "offset", (block_number - ctx->po_block_address) * ctx->block_size + offset);
+      make_key_ulong_int_value_pairs(&ctx->object_meta_for_json, "meta_size", marker_len);
       char* list_file_path  = (char*)clf_allocate_memory(MAX_PATH, "list_file_path");
-      sprintf(list_file_path, "%s/%s/%s_%04d.lst", obj_reader_saveroot, barcode_id, bucket_name_for_obj_r, savepath_dir_number);
+      sprintf(list_file_path, "%s/%s/%s_%04d.lst", ctx->obj_reader_saveroot, ctx->barcode_id, ctx->bucket_name_for_obj_r, ctx->savepath_dir_number);
       int mk_fp_flag = 0;
       int new_list_flag = 0;
-      if (pre_bucket_name_for_obj_r == NULL) {
+      if (ctx->pre_bucket_name_for_obj_r == NULL) {
         mk_fp_flag = 1;
-      } else if (!((strcmp(pre_bucket_name_for_obj_r, bucket_name_for_obj_r) == 0) && (pre_savepath_dir_number == savepath_dir_number))) {
+      } else if (!((strcmp(ctx->pre_bucket_name_for_obj_r, ctx->bucket_name_for_obj_r) == 0) && (ctx->pre_savepath_dir_number == ctx->savepath_dir_number))) {
     	 mk_fp_flag = 1;
       }
       if (mk_fp_flag == 1) {
@@ -1011,30 +1324,30 @@ static int check_part_of_pr_integrity(const MARKER_TYPE m_type, const uint64_t b
         }
         free(dirpath);
         dirpath = NULL;
-        if (fp_list != NULL) {
-          fclose(fp_list);
-          fp_list = NULL;
+        if (ctx->fp_list != NULL) {
+          fclose(ctx->fp_list);
+          ctx->fp_list = NULL;
         }
-        if ((fp_list = fopen(list_file_path,"r")) == NULL) {
+        if ((ctx->fp_list = fopen(list_file_path,"r")) == NULL) {
         	new_list_flag = 1;
         } else {
-          fclose(fp_list);
-          fp_list = NULL;
+          fclose(ctx->fp_list);
+          ctx->fp_list = NULL;
         }
-        if (savepath_dir_number <= OBJ_READER_MAX_SAVE_NUM) {
-          fp_list = fopen(list_file_path,"ab");
+        if (ctx->savepath_dir_number <= OBJ_READER_MAX_SAVE_NUM) {
+          ctx->fp_list = fopen(list_file_path,"ab");
         }
       }
-      if (savepath_dir_number <= OBJ_READER_MAX_SAVE_NUM) {
-        add_key_value_pairs_to_array_in_json_file(new_list_flag, fp_list, list_file_path, object_meta_for_json);
+      if (ctx->savepath_dir_number <= OBJ_READER_MAX_SAVE_NUM) {
+        add_key_value_pairs_to_array_in_json_file(new_list_flag, ctx->fp_list, list_file_path, ctx->object_meta_for_json);
       }
-      free(pre_bucket_name_for_obj_r);
-      pre_bucket_name_for_obj_r = NULL;
-      pre_bucket_name_for_obj_r = (char*)clf_allocate_memory(BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1, "pre_bucket_name_for_obj_r");
-      strcpy(pre_bucket_name_for_obj_r, bucket_name_for_obj_r);
-      pre_savepath_dir_number = savepath_dir_number;
-      free(object_meta_for_json);
-      object_meta_for_json = NULL;
+      free(ctx->pre_bucket_name_for_obj_r);
+      ctx->pre_bucket_name_for_obj_r = NULL;
+      ctx->pre_bucket_name_for_obj_r = (char*)clf_allocate_memory(BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1, "pre_bucket_name_for_obj_r");
+      strcpy(ctx->pre_bucket_name_for_obj_r, ctx->bucket_name_for_obj_r);
+      ctx->pre_savepath_dir_number = ctx->savepath_dir_number;
+      free(ctx->object_meta_for_json);
+      ctx->object_meta_for_json = NULL;
       free(list_file_path);
       list_file_path = NULL;
     }
@@ -1159,10 +1472,11 @@ int get_ocm_po_meta_num(const int pr_num, uint64_t* ocm_num, uint64_t* po_num, u
  * @param [out] (offset)      Offset from current block to the current logical position.
  */
 static int get_address_of_pr(const int pr_num, uint64_t* block_number, uint64_t* offset) {
+  reader_context* const ctx = get_reader_context();
   int ret           = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_HEADER_AND_L43_INFO, "start:get_address_of_pr\n");
   uint64_t pr_block = 0;
 
-  if (dp_rcm_block_number == 0) {
+  if (ctx->dp_rcm_block_number == 0) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to get block number of the last reference commit marker of data partition.\n");
   }
   char* str = (char*)clf_allocate_memory(sizeof(uint64_t), "str");
@@ -1174,7 +1488,7 @@ static int get_address_of_pr(const int pr_num, uint64_t* block_number, uint64_t*
   #ifdef FORMAT_031
   *block_number = pr_block;
   #else
-  *block_number = dp_rcm_block_number - pr_block;
+  *block_number = ctx->dp_rcm_block_number - pr_block;
   #endif
   free(str);
   str = NULL;
@@ -1206,6 +1520,7 @@ static int get_block_num_and_offset_of_marker(const char* filepath, const MARKER
                                               const int po_ctr, const int ocm_ctr, const int pr_ctr,
                                               const uint64_t pkg_meta_num, const uint64_t pkg_po_num, const uint64_t pkg_ocm_num,
                                               uint64_t* block_number, uint64_t* offset, uint64_t* marker_len) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_block_num_and_offset_of_marker\n");
 
   char* str_for_marker_len   = NULL;
@@ -1329,8 +1644,8 @@ static int get_block_num_and_offset_of_marker(const char* filepath, const MARKER
     *offset = strlen(PO_IDENTIFIER_ASCII_CODE);
   } else if (m_type == META) {
     *block_number = 6 + po_block_offset +
-        ((strlen(PO_IDENTIFIER_ASCII_CODE) + po_h_data_offset + meta_block_offset) / block_size); // Impossible to know the ocm block address without reading data partition.
-    *offset = (strlen(PO_IDENTIFIER_ASCII_CODE) + po_h_data_offset + meta_block_offset) % block_size;
+        ((strlen(PO_IDENTIFIER_ASCII_CODE) + po_h_data_offset + meta_block_offset) / ctx->block_size); // Impossible to know the ocm block address without reading data partition.
+    *offset = (strlen(PO_IDENTIFIER_ASCII_CODE) + po_h_data_offset + meta_block_offset) % ctx->block_size;
   } else {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
                               "Invalid arguments at get_address_of_marker: m_type = %d\n", m_type);
@@ -1344,8 +1659,8 @@ static int get_block_num_and_offset_of_marker(const char* filepath, const MARKER
     *offset = strlen(PO_IDENTIFIER_ASCII_CODE);
   } else if (m_type == META) {
     *block_number = pt_block_number - ocm_block_offset - po_block_offset
-                  + ((strlen(PO_IDENTIFIER_ASCII_CODE) + meta_block_offset) / block_size);
-    *offset = (strlen(PO_IDENTIFIER_ASCII_CODE) + meta_block_offset) % block_size;
+                  + ((strlen(PO_IDENTIFIER_ASCII_CODE) + meta_block_offset) / ctx->block_size);
+    *offset = (strlen(PO_IDENTIFIER_ASCII_CODE) + meta_block_offset) % ctx->block_size;
   } else {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
                               "Invalid arguments at get_address_of_marker: m_type = %d\n", m_type);
@@ -1424,6 +1739,7 @@ static int get_target_marker_offset(const MARKER_TYPE m_type, const char* filepa
 int get_address_of_marker(MARKER_TYPE m_type, const uint64_t marker_num,
                                  uint64_t* block_number, uint64_t* offset, uint64_t* pr_file_num,
                                  uint64_t* pr_file_offset, uint64_t* marker_len) {
+  reader_context* const ctx = get_reader_context();
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO,
                                "start:get_address_of_marker: m_type=%d, marker_num=%d\n", m_type, marker_num);
 
@@ -1454,7 +1770,7 @@ int get_address_of_marker(MARKER_TYPE m_type, const uint64_t marker_num,
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
                               "Invalid arguments at get_address_of_marker: block_number = %p, offset = %p\n",block_number, offset);
   }
-  for (uint64_t pt_counter = 0; pt_counter < pr_num; pt_counter++) {
+  for (uint64_t pt_counter = 0; pt_counter < ctx->pr_num; pt_counter++) {
     *pr_file_num = pt_counter;
     sprintf(filepath, "%s%lu", PR_PATH_PREFIX, pt_counter);
     str_from_ocm_info_dir = (char*)clf_allocate_memory(sizeof(uint64_t) * 2, "str_from_ocm_info_dir");
@@ -1656,19 +1972,91 @@ static int set_block_size(MamVci* const mamvci, MamHta* const mamhta) {
   return ret;
 }
 
+#ifdef OBJ_READER
+/**
+ * Evaluate the dump filter for all objects in a packed object by using metadata stored in the reference partition,
+ * so that objects which do not match can be skipped without reading the data partition.
+ * @param [in]  (first_meta_cnt) Index of the first meta in the packed object.
+ * @param [in]  (pr_file_num)    Number of marker file(PR_X) which has the packed object.
+ * @param [in]  (pr_file_offset) Offset of the marker file from the beginning to the packed object.
+ * @param [out] (matched_num)    Number of objects which match the dump filter.
+ * @return      (OK/NG)          If succeeded or not.
+ */
+static int apply_dump_filter_to_po(const uint64_t first_meta_cnt, const uint64_t pr_file_num, const uint64_t pr_file_offset,
+                                   uint64_t* const matched_num) {
+  reader_context* const ctx = get_reader_context();
+  int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:apply_dump_filter_to_po\n");
+  char filepath[100]     = { 0 };
+  char bin_for_num[sizeof(uint64_t)] = { 0 };
+
+  *matched_num = 0;
+  sprintf(filepath, "%s%lu", PR_PATH_PREFIX, pr_file_num);
+  if (read_marker_file(sizeof(uint64_t), pr_file_offset + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE, filepath, bin_for_num) == NG) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to read file(%s).\n", filepath);
+  }
+  r64(BIG, (unsigned char *)bin_for_num, &ctx->meta_filter_num, 1);
+  ctx->meta_filter_first_cnt = first_meta_cnt;
+  free(ctx->meta_filter_result);
+  ctx->meta_filter_result = (uint8_t*)clf_allocate_memory(ctx->meta_filter_num + 1, "meta_filter_result");
+
+  for (uint64_t i = 0; i < ctx->meta_filter_num; i++) {
+    uint64_t block_number   = 0;
+    uint64_t offset         = 0;
+    uint64_t meta_file_num  = 0;
+    uint64_t meta_file_offset = 0;
+    uint64_t marker_len     = 0;
+    char object_key[MAX_PATH + 1]    = { 0 };
+    char last_modified[MAX_PATH + 1] = { 0 };
+    char object_id[UUID_SIZE + 1]    = { 0 };
+
+    get_address_of_marker(META, first_meta_cnt + i, &block_number, &offset, &meta_file_num, &meta_file_offset, &marker_len);
+    sprintf(filepath, "%s%lu", PR_PATH_PREFIX, meta_file_num);
+    char* meta_data = (char*)clf_allocate_memory(marker_len + 1, "meta_data");
+    if (read_marker_file(marker_len, meta_file_offset, filepath, meta_data) == NG) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to read file(%s).\n", filepath);
+    }
+    get_element_from_metadata(meta_data, NULL, object_key, object_id, last_modified, NULL, NULL);
+    ctx->meta_filter_result[i] = (match_dump_filter(object_key, last_modified) == true) ? ON : OFF;
+    if (ctx->meta_filter_result[i] == ON) {
+      (*matched_num)++;
+    }
+    free(meta_data);
+    meta_data = NULL;
+  }
+  ret |= output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_HEADER_AND_L4321_INFO, "apply_dump_filter_to_po: %lu of %lu objects match.\n",
+                            *matched_num, ctx->meta_filter_num);
+  ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "end  :apply_dump_filter_to_po\n");
+  return ret;
+}
+
+/**
+ * Check if the meta has been excluded by the dump filter.
+ * @param [in]  (meta_cnt) Index of the meta.
+ * @return      (true/false) true if the meta should be skipped.
+ */
+static int is_meta_filtered_out(const uint64_t meta_cnt) {
+  reader_context* const ctx = get_reader_context();
+  if (ctx->meta_filter_result == NULL || meta_cnt < ctx->meta_filter_first_cnt || ctx->meta_filter_first_cnt + ctx->meta_filter_num <= meta_cnt) {
+    return false;
+  }
+  return (ctx->meta_filter_result[meta_cnt - ctx->meta_filter_first_cnt] == OFF) ? true : false;
+}
+#endif
+
 /**
  * Check integrity of reference partition and data partition.
  * @param [in] (mamvci) Pointer of a volume coherency information.
  * @param [in] (mamhta) Pointer of a host-type attributes.
  */
 int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
-  int ret                     = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:check_integrity\n");
-  int last_flag               = OFF;
-  uint64_t total_fm_num_of_rp = 0;
-  uint64_t total_fm_num_of_dp = 0;
-  int first_locate_flag       = OFF;
-  int skip_dp_check_flag      = 0;
-  skip_0_padding_check_flag   = 0;
+  reader_context* const ctx      = get_reader_context();
+  int ret                        = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:check_integrity\n");
+  int last_flag                  = OFF;
+  uint64_t total_fm_num_of_rp    = 0;
+  uint64_t total_fm_num_of_dp    = 0;
+  int first_locate_flag          = OFF;
+  int skip_dp_check_flag         = 0;
+  ctx->skip_0_padding_check_flag = 0;
 
 #ifdef MONGODB_RESTORE_TOOL
   skip_dp_check_flag = 1;
@@ -1680,54 +2068,58 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
   }
   va_list ap;
   va_start(ap, mamhta);
-  sprintf(obj_r_mode, "%s", va_arg(ap, char*));
-  scparam = va_arg(ap, SCSI_DEVICE_PARAM);
-  sprintf(obj_reader_saveroot, "%s", va_arg(ap, char*));
-  sprintf(barcode_id, "%s", va_arg(ap, char*));
-  if (strcmp(obj_r_mode , "output_objects_in_object_list") == 0) {
-    objects = va_arg(ap, object_list*);
-    bucket_name_for_obj_r = va_arg(ap, char*);
-    skip_0_padding_check_flag = 1;
+  snprintf(ctx->obj_r_mode, sizeof(ctx->obj_r_mode), "%s", va_arg(ap, char*));
+  ctx->scparam = va_arg(ap, SCSI_DEVICE_PARAM);
+  sprintf(ctx->obj_reader_saveroot, "%s", va_arg(ap, char*));
+  sprintf(ctx->barcode_id, "%s", va_arg(ap, char*));
+  if (strcmp(ctx->obj_r_mode , "output_objects_in_object_list") == 0) {
+    ctx->objects = va_arg(ap, object_vector*);
+    ctx->bucket_name_for_obj_r = va_arg(ap, char*);
+    ctx->skip_0_padding_check_flag = 1;
   }
   va_end(ap);
 
-  if (strcmp(obj_r_mode , "resume_dump") == 0) {
-	  skip_0_padding_check_flag = 1;
+  if (strcmp(ctx->obj_r_mode , "resume_dump") == 0) {
+	  ctx->skip_0_padding_check_flag = 1;
   }
-  if (strcmp(obj_r_mode , "output_objects_in_object_list") != 0) {
-    initialize_bucket_info_4_obj_reader(&bucket_info_4_obj_reader, obj_reader_saveroot);
+  if (strcmp(ctx->obj_r_mode , "output_objects_in_object_list") != 0) {
+    initialize_bucket_info_4_obj_reader(&ctx->bucket_info_4_obj_reader, ctx->obj_reader_saveroot);
   } else {
-    savepath_dir_number     = 0;
-    savepath_sub_dir_number = 0;
-  }
-  if (strcmp(obj_r_mode , "output_objects_in_object_list") == 0) {
-    read_marker_file_flag = 0;
-    sequential_read_flag  = 0;
-    struct object_list* current      = NULL;
-    current = objects;
+    ctx->savepath_dir_number     = 0;
+    ctx->savepath_sub_dir_number = 0;
+  }
+  if (strcmp(ctx->obj_r_mode , "output_objects_in_object_list") == 0) {
+    ctx->read_marker_file_flag = 0;
+    ctx->sequential_read_flag  = 0;
     if (set_tape_head(DATA_PARTITION) == NG) {
       ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Can't locate to beginning of partition %d.\n", DATA_PARTITION);
       return NG;
     }
-    while(current != NULL) {
-      if (check_part_of_pr_integrity(META, current->block_address + (current->meta_offset / block_size), (current->meta_offset) % block_size, 0, 0, current->metadata_size) != OK) {
+    // Objects are sorted by their position on tape, so the tape moves in one direction.
+    for (uint64_t i = 0; i < ctx->objects->count; i++) {
+      const object_record* const current = &ctx->objects->records[i];
+      if (0 < i && current->block_address == ctx->objects->records[i - 1].block_address
+                && current->meta_offset == ctx->objects->records[i - 1].meta_offset) {
+        continue; // The same object is listed more than once.
+      }
+      if (check_part_of_pr_integrity(META, current->block_address + (current->meta_offset / ctx->block_size), (current->meta_offset) % ctx->block_size, 0, 0, current->metadata_size) != OK) {
         ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L43_INFO, "The partial reference format is not correct.\n");
       }
-      current = current->next;
     }
     return ret;
   }
   //if (strncmp(obj_r_mode, "full_dump", sizeof("full_dump")) == 0) {
 #endif
 
-  if (marker_file_flg == OFF) {
+  const uint64_t rp_parse_start = start_metric_timer();
+  if (ctx->marker_file_flg == OFF) {
     if (check_reference_partition_lable(mamvci, mamhta, &total_fm_num_of_rp) != OK) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_INFO, "Data stored in Reference Partition is not complying with OTFormat.\n");
     }
 
-    ret |= output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_HEADER_AND_L43_INFO, "check_integrity: pr_num=%lu\n", pr_num);
-    for (uint64_t target_pr_num = 0; target_pr_num < pr_num; target_pr_num++) {
-      if (target_pr_num + 1 == pr_num) {
+    ret |= output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_HEADER_AND_L43_INFO, "check_integrity: pr_num=%lu\n", ctx->pr_num);
+    for (uint64_t target_pr_num = 0; target_pr_num < ctx->pr_num; target_pr_num++) {
+      if (target_pr_num + 1 == ctx->pr_num) {
         last_flag = ON;
       }
       if (check_pr_integrity(REFERENCE_PARTITION, mamvci, target_pr_num, last_flag) != OK) {
@@ -1737,20 +2129,21 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
     if (skip_dp_check_flag == 1) {
       return ret;
     }
-    if (check_fm_num(total_fm_num_of_rp, pr_num, 0) != OK) {
+    if (check_fm_num(total_fm_num_of_rp, ctx->pr_num, 0) != OK) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "Total number of filemarks is not correct.\n");
     }
   }
-  get_pr_num(&pr_num);
-  get_ocm_po_meta_num(pr_num, &ocm_num, &po_num, &meta_num);
+  get_pr_num(&ctx->pr_num);
+  get_ocm_po_meta_num(ctx->pr_num, &ctx->ocm_num, &ctx->po_num, &ctx->meta_num);
+  observe_metric_timer(METRIC_RP_PARSE, rp_parse_start);
   ret |= output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_HEADER_AND_L43_INFO,
                             "check_integrity: pr_num=%lu ocm_num=%lu po_num=%lu meta_num=%lu\n",
-                            pr_num, ocm_num, po_num, meta_num);
+                            ctx->pr_num, ctx->ocm_num, ctx->po_num, ctx->meta_num);
 
   if (check_last_rcm_integrity(DATA_PARTITION, mamvci, mamhta, &total_fm_num_of_dp) != OK) {// Set "dp_rcm_block_number".
     ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L4_INFO, "The last reference commit marker format is not correct.\n");
   }
-  if (marker_file_flg == OFF) {
+  if (ctx->marker_file_flg == OFF) {
     if (check_vol1_label_integrity(DATA_PARTITION) != OK) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_INFO, "Vol1 Label format is not correct.\n");
     }
@@ -1760,18 +2153,18 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
     if (check_first_rcm_integrity(DATA_PARTITION, mamvci, mamhta) != OK) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L4_INFO, "The first reference commit marker format is not correct.\n");
     }
-    if (check_fm_num(total_fm_num_of_dp, pr_num, ocm_num) != OK) {
+    if (check_fm_num(total_fm_num_of_dp, ctx->pr_num, ctx->ocm_num) != OK) {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "Total number of filemarks is not correct.\n");
     }
   }
 
 #ifdef OBJ_READER
   char tape_gen[2] = {0};
-  get_tape_generation(&scparam, tape_gen);
-  if (read_marker_file(VOLUME_IDENTIFIER_SIZE, LABEL_IDENTIFIER_SIZE + LABEL_NUMBER_SIZE, VOL1_LABEL_PATH, &barcode_id[0]) == NG) {
+  get_tape_generation(&ctx->scparam, tape_gen);
+  if (read_marker_file(VOLUME_IDENTIFIER_SIZE, LABEL_IDENTIFIER_SIZE + LABEL_NUMBER_SIZE, VOL1_LABEL_PATH, &ctx->barcode_id[0]) == NG) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to read file(%s).\n", VOL1_LABEL_PATH);
   }
-  strncpy(&barcode_id[6], tape_gen, 2);
+  strncpy(&ctx->barcode_id[6], tape_gen, 2);
 #endif
   uint64_t pr_cnt              = 1; // Index of Partial Reference in reference partition.
   uint64_t ocm_cnt             = 1; // Index of Object Commit Marker in reference partition.
@@ -1786,20 +2179,40 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
   ST_SPTI_CMD_POSITIONDATA pos = { 0 };
 
 #ifdef OBJ_READER
-  if (strcmp(obj_r_mode , "resume_dump") == 0) {
-    if(get_history(barcode_id, &pr_cnt, &ocm_cnt, &po_cnt, &meta_cnt) == NG) {
+  memset(&ctx->dump_history, 0, sizeof(ctx->dump_history));
+  memset(&ctx->resume_history, 0, sizeof(ctx->resume_history));
+  strncpy(ctx->dump_history.tape_id, ctx->barcode_id, BARCODE_SIZE);
+  if (strcmp(ctx->obj_r_mode , "resume_dump") == 0) {
+    if(get_history(ctx->barcode_id, &ctx->resume_history) == NG) {
       ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "There is no history file.\n%sTry full dump.\n", INDENT);
     }
+    pr_cnt   = ctx->resume_history.pr_cnt;
+    ocm_cnt  = ctx->resume_history.ocm_cnt;
+    po_cnt   = ctx->resume_history.po_cnt;
+    meta_cnt = ctx->resume_history.obj_cnt;
   }
 #endif
   if (!(pr_cnt == 1 && ocm_cnt == 1 && po_cnt == 1 && meta_cnt == 1)) {
     first_locate_flag = ON;
   }
-  while (pr_cnt < pr_num + 1 || ocm_cnt < ocm_num + 1 || po_cnt < po_num + 1 || meta_cnt < meta_num + 1) {
+#ifdef OBJ_READER
+  int dump_filter_flag = OFF;
+  if (((strncmp(ctx->obj_r_mode, "full_dump", sizeof("full_dump")) == 0) || (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0))
+      && is_dump_filter_enabled() == true) {
+    dump_filter_flag = ON;
+  }
+#endif
+#ifdef OBJ_READER
+  set_progress_totals(ctx->pr_num, ctx->ocm_num, ctx->po_num, ctx->meta_num, ctx->dp_rcm_block_number);
+#endif
+  while (pr_cnt < ctx->pr_num + 1 || ocm_cnt < ctx->ocm_num + 1 || po_cnt < ctx->po_num + 1 || meta_cnt < ctx->meta_num + 1) {
     ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "pr:%lu,%lu ocm:%lu,%lu po:%lu,%lu meta:%lu,%lu\n",
-                              pr_cnt, pr_num, ocm_cnt, ocm_num, po_cnt, po_num, meta_cnt, meta_num);
+                              pr_cnt, ctx->pr_num, ocm_cnt, ctx->ocm_num, po_cnt, ctx->po_num, meta_cnt, ctx->meta_num);
+#ifdef OBJ_READER
+    update_progress_position(pr_cnt - 1, ocm_cnt - 1, po_cnt - 1, meta_cnt - 1, block_number);
+#endif
 
-    get_next_marker(pr_cnt, ocm_cnt, po_cnt, meta_cnt, pr_num, ocm_num, po_num, meta_num, &m_type);
+    get_next_marker(pr_cnt, ocm_cnt, po_cnt, meta_cnt, ctx->pr_num, ctx->ocm_num, ctx->po_num, ctx->meta_num, &m_type);
     if (m_type == PR) {
       get_address_of_pr(pr_cnt, &block_number, &offset);
       if (first_locate_flag == ON) {
@@ -1810,7 +2223,7 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
       if (pos.blockNumber != block_number) {
         ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L43_INFO, "The position of the partial reference on the data partition is not correct.\n");
       }
-      if (check_pr_integrity(DATA_PARTITION, mamvci, pr_cnt - 1, pr_cnt == pr_num) != OK) {
+      if (check_pr_integrity(DATA_PARTITION, mamvci, pr_cnt - 1, pr_cnt == ctx->pr_num) != OK) {
         ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L43_INFO, "The partial reference format is not correct.\n");
       }
       output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "pr   : %lu,%lu\n", block_number, offset);
@@ -1818,7 +2231,8 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
     } else if (m_type == OCM) {
       get_address_of_marker(OCM, ocm_cnt, &block_number, &offset, &pr_file_num, &pr_file_offset, &marker_len);
       if (first_locate_flag == ON) {
-        locate_to_tape(block_number);
+        // The OCM is checked from the filemark just before it.
+        locate_to_tape(block_number - 1);
         first_locate_flag = OFF;
       }
       if (check_part_of_pr_integrity(OCM, block_number, offset, pr_file_num, pr_file_offset, marker_len) != OK) {
@@ -1828,8 +2242,21 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
     } else if (m_type == PO) {
       get_address_of_marker(PO, po_cnt, &block_number, &offset, &pr_file_num, &pr_file_offset, &marker_len);
 #ifdef OBJ_READER
-      if (strncmp(obj_r_mode, "output_list", sizeof("output_list")) == 0) {
-        po_block_address = block_number;
+      if (strncmp(ctx->obj_r_mode, "output_list", sizeof("output_list")) == 0) {
+        ctx->po_block_address = block_number;
+      }
+      if (dump_filter_flag == ON) {
+        uint64_t matched_num = 0;
+        ret |= apply_dump_filter_to_po(meta_cnt, pr_file_num, pr_file_offset, &matched_num);
+        if (matched_num == 0) {
+          // Skip the whole packed object, and locate to the next marker.
+          ret |= output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_HEADER_AND_L4321_INFO, "Skip packed object %lu.\n", po_cnt);
+          ret |= record_dump_history(pr_cnt, ocm_cnt, po_cnt, meta_cnt, meta_cnt - 1);
+          meta_cnt += ctx->meta_filter_num;
+          po_cnt++;
+          first_locate_flag = ON;
+          continue;
+        }
       }
 #endif
       if (first_locate_flag == ON) {
@@ -1840,10 +2267,37 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
         ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L43_INFO, "The partial reference format is not correct.\n");
       }
 #ifdef OBJ_READER
-      output_history(barcode_id, pr_cnt, ocm_cnt, po_cnt, meta_cnt);
+      if (ctx->resume_history.bucket_id[0] != '\0') {
+        // Objects of the first packed object are saved to the same directory as the former run, which has the object in progress.
+        if (strcmp(ctx->resume_history.bucket_id, ctx->bucket_id_for_obj_r) == 0) {
+          set_bucket_save_state(ctx->bucket_info_4_obj_reader, ctx->bucket_name_for_obj_r, ctx->resume_history.dir_number,
+                                ctx->resume_history.sub_dir_number, ctx->resume_history.saved_counter);
+        }
+        memset(ctx->resume_history.bucket_id, 0, sizeof(ctx->resume_history.bucket_id));
+      }
+      if ((strncmp(ctx->obj_r_mode, "full_dump", sizeof("full_dump")) == 0) || (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0)) {
+        ret |= record_dump_history(pr_cnt, ocm_cnt, po_cnt, meta_cnt, MAX(meta_cnt - 1, ctx->resume_history.done_obj_cnt));
+      }
 #endif
       po_cnt++;
     } else if (m_type == META) {
+#ifdef OBJ_READER
+      if (dump_filter_flag == ON && is_meta_filtered_out(meta_cnt) == true) {
+        // The object is located directly, so only the following marker needs to locate.
+        ctx->num_of_meta_cnt++;
+        meta_cnt++;
+        first_locate_flag = ON;
+        continue;
+      }
+      if (meta_cnt <= ctx->resume_history.done_obj_cnt) {
+        // The object had been written completely before resume.
+        ret |= output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_HEADER_AND_L4321_INFO, "Skip object %lu which is already dumped.\n", meta_cnt);
+        ctx->num_of_meta_cnt++;
+        meta_cnt++;
+        first_locate_flag = ON;
+        continue;
+      }
+#endif
       get_address_of_marker(META, meta_cnt, &block_number, &offset, &pr_file_num, &pr_file_offset, &marker_len);
       if (first_locate_flag == ON) {
         locate_to_tape(block_number);
@@ -1852,14 +2306,27 @@ int check_integrity(MamVci* const mamvci, MamHta* const mamhta, ...) {
       if (check_part_of_pr_integrity(META, block_number, offset, pr_file_num, pr_file_offset, marker_len) != OK) {
         ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_HEADER_AND_L43_INFO, "The partial reference format is not correct.\n");
       }
+#ifdef OBJ_READER
+      if ((strncmp(ctx->obj_r_mode, "full_dump", sizeof("full_dump")) == 0) || (strncmp(ctx->obj_r_mode, "resume_dump", sizeof("resume_dump")) == 0)) {
+        if (meta_cnt == ctx->resume_history.done_obj_cnt + 1 && ctx->resume_history.written_size != 0) {
+          // The object was resumed from the middle, so the following marker needs to locate.
+          ctx->resume_history.written_size = 0;
+          first_locate_flag = ON;
+        }
+        ret |= record_dump_history(ctx->dump_history.pr_cnt, ctx->dump_history.ocm_cnt, ctx->dump_history.po_cnt, ctx->dump_history.obj_cnt, meta_cnt);
+      }
+#endif
       meta_cnt++;
     }
   }
 #ifdef OBJ_READER
-  if (fp_list != NULL) {
-    fclose(fp_list);
-    fp_list = NULL;
+  update_progress_position(pr_cnt - 1, ocm_cnt - 1, po_cnt - 1, meta_cnt - 1, block_number);
+  if (ctx->fp_list != NULL) {
+    fclose(ctx->fp_list);
+    ctx->fp_list = NULL;
   }
+  free(ctx->meta_filter_result);
+  ctx->meta_filter_result = NULL;
 #endif
   ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "end  :check_integrity\n");
 
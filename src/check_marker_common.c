@@ -169,7 +169,7 @@ int clf_header(const char* const identifier, const char* const buffer,
   if (info_flag == ON) {
     *current_position -= IDENTIFIER_SIZE;
   } else if (!strncmp(buffer, RCM_IDENTIFIER, IDENTIFIER_SIZE)) {
-    if (!strcmp(get_top_verbose(), DISPLAY_HEADER_AND_L4_INFO)) {
+    if (get_top_verbose() == DISPLAY_HEADER_AND_L4_INFO) {
       get_data_length_flag = ON;
       get_id_flag          = ON;
     } else {
@@ -73,8 +73,8 @@ static int cpof_po_identifier(unsigned char* const data_buf, int* const current_
  * @param [out] (out_num_of_obj)   Number of objects on the tape.
  * @return      (OK/NG)            If a PO Header format is correct or not.
  */
-static int cpof_po_header(unsigned char* const data_buf, uint64_t* const current_position,
-                          uint64_t* const out_num_of_obj, uint64_t* const po_header_length) {
+int cpof_po_header(unsigned char* const data_buf, uint64_t* const current_position,
+                   uint64_t* const out_num_of_obj, uint64_t* const po_header_length) {
   uint64_t directoryoffset                    = 0;
   uint64_t dataoffset                         = 0;
   uint64_t num_of_obj                         = 0;
@@ -192,8 +192,8 @@ static int cpof_po_header(unsigned char* const data_buf, uint64_t* const current
  * @param [out] (objects)          Pointer of a LTOS object.
  * @return      (OK/NG)            If an object directory format is correct or not.
  */
-static int cpof_object_directory(unsigned char* const data_buf, uint64_t* const current_position, const uint64_t poid_length,
-                                 const uint64_t po_header_length, const uint64_t num_of_obj, LTOSObject* const objects) {
+int cpof_object_directory(unsigned char* const data_buf, uint64_t* const current_position, const uint64_t poid_length,
+                          const uint64_t po_header_length, const uint64_t num_of_obj, LTOSObject* const objects) {
   uuid_t object_id_uuid;
   LTOSObject* current_object;
   int ret                          = output_accdg_to_vl(OUTPUT_TRACE, DEFAULT, "start:cpof_object_directory\n");
@@ -332,7 +332,9 @@ static int cpof_obj_meta(unsigned char* const data_buf, int* const current_posit
     unsigned char *metadata        = (unsigned char *)clf_allocate_memory(metadata_size, "metadata");
     ret |= read_data_from_multi_blocks(data_buf, current_position, metadata, metadata_size);
     // Parse KEY and VALUE in the meta data
+    const uint64_t parse_start = start_metric_timer();
     root_json = json_tokener_parse_verbose((char*)metadata, &error);
+    observe_metric_timer(METRIC_JSON_PARSE, parse_start);
     if (json_tokener_success != error) {
     	ret_sub |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "Meta data in Number %d Object is not complying with JSON format.\n", objnum);
      }
@@ -484,7 +486,7 @@ int clf_packed_objects(const char* unpackedobjpath, const int po_top_block_num,
  * @param [in]     (objects)          Pointer of a LTOS object.
  * @return         (OK/NG)            If Object Meta data is correct or not.
  */
-static int cpof_only_meta(unsigned char* const data_buf, uint64_t* const current_position, const int num_of_obj, const LTOSObject* const objects) {
+int cpof_only_meta(unsigned char* const data_buf, uint64_t* const current_position, const int num_of_obj, const LTOSObject* const objects) {
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DEFAULT, "start:cpof_only_meta\n");
 
   ret |= output_accdg_to_vl(OUTPUT_INFO, DEFAULT, "LEVEL 0\n");
@@ -507,7 +509,9 @@ static int cpof_only_meta(unsigned char* const data_buf, uint64_t* const current
     memmove(metadata, data_buf + *current_position, metadata_size);
     *current_position += metadata_size;
     // Parse KEY and VALUE in the meta data
+    const uint64_t parse_start = start_metric_timer();
     root_json = json_tokener_parse_verbose((char*)metadata, &error);
+    observe_metric_timer(METRIC_JSON_PARSE, parse_start);
     if (json_tokener_success != error) {
     	ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT,
     	                          "Meta data in Number %d Object is not complying with JSON format.\n", objnum);
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file content_verifier.c
+ *
+ * Verification of object data with ContentMd5 in its metadata while the data is written, run with --verify.
+ *
+ * The data of an object is hashed from the tape buffers as it is written, so it is never read again from disk.
+ * When the object is complete, the MD5 is compared with ContentMd5, which is Base64 as Content-MD5 of HTTP,
+ * or 32 hexadecimal digits as an ETag. A mismatch is appended to the report as a JSON object per line.
+ * An ETag of a multipart upload is not the MD5 of the data, so such an object is counted as not verified.
+ */
+
+#ifdef OBJ_READER
+#include <openssl/md5.h>
+#include <openssl/evp.h>
+#include "ltos_format_checker.h"
+
+static FILE* verify_report                    = NULL;    // Report of mismatches, or NULL if objects are not verified.
+static MD5_CTX verify_md5_ctx;
+static int is_verifying                       = false;   // An object is being hashed.
+static uint64_t verify_size                   = 0;       // Bytes of the object hashed so far.
+static uint64_t verify_object_size            = 0;
+static char verify_bucket[MAX_PATH + 1]       = { '\0' };
+static char verify_key[MAX_PATH + 1]          = { '\0' };
+static char verify_id[UUID_SIZE + 1]          = { '\0' };
+static char verify_expected[MAX_PATH + 1]     = { '\0' };
+static uint64_t verified_count                = 0;
+static uint64_t mismatch_count                = 0;
+static uint64_t unverified_count              = 0;       // Objects without ContentMd5 which is an MD5.
+
+/**
+ * Start to verify objects with ContentMd5 in their metadata.
+ * The report is appended, so child object_readers of --manifest can share it.
+ * @param [in]  (report_path) Path of the report of mismatches.
+ * @return      (OK/NG)       If success, return OK. Otherwise, return NG.
+ */
+int open_content_verifier(const char* const report_path) {
+  verify_report = fopen(report_path, "a");
+  if (verify_report == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to open the verify report(%s). error=%s\n",
+                              report_path, strerror(errno));
+  }
+  return OK;
+}
+
+/**
+ * Check if objects are verified with ContentMd5.
+ * @return      (true/false) If the report is open, return true. Otherwise, return false.
+ */
+int is_content_verifier_enabled(void) {
+  return (verify_report != NULL) ? true : false;
+}
+
+/**
+ * Start to hash the data of an object. Its data follows with update_content_verification().
+ * @param [in]  (bucket_name) Bucket name.
+ * @param [in]  (object_key)  Object key.
+ * @param [in]  (object_id)   Object ID.
+ * @param [in]  (content_md5) ContentMd5 in the metadata. Empty if the metadata has none.
+ * @param [in]  (object_size) Size of the object data.
+ */
+void begin_content_verification(const char* const bucket_name, const char* const object_key, const char* const object_id,
+                                const char* const content_md5, const uint64_t object_size) {
+  if (verify_report == NULL) {
+    return;
+  }
+  snprintf(verify_bucket, sizeof(verify_bucket), "%s", bucket_name);
+  snprintf(verify_key, sizeof(verify_key), "%s", object_key);
+  snprintf(verify_id, sizeof(verify_id), "%s", object_id);
+  snprintf(verify_expected, sizeof(verify_expected), "%s", content_md5);
+  verify_size        = 0;
+  verify_object_size = object_size;
+  is_verifying       = true;
+  MD5_Init(&verify_md5_ctx);
+}
+
+/**
+ * Hash a part of the data of the current object.
+ * @param [in]  (data) Data read from tape.
+ * @param [in]  (size) Size of the data.
+ */
+void update_content_verification(const char* const data, const uint64_t size) {
+  if (is_verifying == false) {
+    return;
+  }
+  const uint64_t start = start_metric_timer();
+  MD5_Update(&verify_md5_ctx, data, size);
+  observe_metric_timer(METRIC_DATA_VERIFY, start);
+  verify_size += size;
+}
+
+/**
+ * Append a mismatch to the report.
+ * @param [in]  (actual) MD5 of the data in the same form as ContentMd5.
+ * @return      (OK/NG)  If success, return OK. Otherwise, return NG.
+ */
+static int report_content_mismatch(const char* const actual) {
+  json_object* const record = json_object_new_object();
+  json_object_object_add(record, "bucket", json_object_new_string(verify_bucket));
+  json_object_object_add(record, "object_key", json_object_new_string(verify_key));
+  json_object_object_add(record, "object_id", json_object_new_string(verify_id));
+  json_object_object_add(record, "size", json_object_new_int64((int64_t)verify_object_size));
+  json_object_object_add(record, "verified_size", json_object_new_int64((int64_t)verify_size));
+  json_object_object_add(record, "expected_md5", json_object_new_string(verify_expected));
+  json_object_object_add(record, "actual_md5", json_object_new_string(actual));
+  const int written = fprintf(verify_report, "%s\n", json_object_to_json_string_ext(record, JSON_C_TO_STRING_PLAIN));
+  json_object_put(record);
+  if (written < 0 || fflush(verify_report) != 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the verify report. error=%s\n", strerror(errno));
+  }
+  return OK;
+}
+
+/**
+ * Compare the MD5 of the current object with its ContentMd5.
+ * @param [in]  (digest) MD5 of the data if the caller hashed it, or NULL to use the data given to update_content_verification().
+ * @return      (OK/NG)  If the object matches, cannot be verified or its mismatch is reported, return OK. Otherwise, return NG.
+ */
+int end_content_verification(const unsigned char* const digest) {
+  unsigned char md[MD5_DIGEST_LENGTH] = { 0 };
+  char base64[MD5_SIZE + 1]           = { '\0' };
+  char hex[MD5_SIZE + 1]              = { '\0' };
+  char expected[MD5_SIZE + 1]         = { '\0' };
+
+  if (is_verifying == false) {
+    return OK;
+  }
+  is_verifying = false;
+  MD5_Final(md, &verify_md5_ctx);
+  if (digest != NULL) {
+    memcpy(md, digest, MD5_DIGEST_LENGTH);
+    verify_size = verify_object_size;
+  }
+  EVP_EncodeBlock((unsigned char*)base64, md, MD5_DIGEST_LENGTH);
+  for (int i = 0; i < MD5_DIGEST_LENGTH; i++) {
+    sprintf(&hex[i * 2], "%02x", (unsigned int)md[i]);
+  }
+
+  // ContentMd5 is Base64 of the MD5. An ETag is its hexadecimal digits, which may be quoted.
+  const size_t length = strlen(verify_expected);
+  if (length == MD5_SIZE + 2 && verify_expected[0] == '"' && verify_expected[length - 1] == '"') {
+    memcpy(expected, verify_expected + 1, MD5_SIZE);
+  } else if (length <= MD5_SIZE) {
+    memcpy(expected, verify_expected, length);
+  }
+  const int is_base64 = (strlen(expected) == strlen(base64)) ? true : false;
+  const int is_hex    = (strlen(expected) == MD5_SIZE && strspn(expected, "0123456789abcdefABCDEF") == MD5_SIZE) ? true : false;
+  if ((is_base64 == true && strcmp(expected, base64) == 0) || (is_hex == true && strcasecmp(expected, hex) == 0)) {
+    verified_count++;
+    return OK;
+  }
+  if (is_base64 == false && is_hex == false) {
+    unverified_count++;
+    return output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_ALL_INFO, "%s/%s has no ContentMd5 to be verified.\n", verify_bucket, verify_key);
+  }
+  const char* const actual = (is_hex == true) ? hex : base64;
+  mismatch_count++;
+  output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "The data of %s/%s(%s) does not match ContentMd5. Expected %s, but %s.\n",
+                     verify_bucket, verify_key, verify_id, verify_expected, actual);
+  return report_content_mismatch(actual);
+}
+
+/**
+ * Finish the verification and display how many objects are verified.
+ * @return      (OK/NG) If no mismatch is found, return OK. Otherwise, return NG.
+ */
+int close_content_verifier(void) {
+  if (verify_report == NULL) {
+    return OK;
+  }
+  fclose(verify_report);
+  verify_report = NULL;
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO,
+                     "%lu object(s) are verified with ContentMd5. %lu mismatch(es). %lu object(s) have no ContentMd5 to be verified.\n",
+                     verified_count, mismatch_count, unverified_count);
+  if (mismatch_count != 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "%lu object(s) do not match ContentMd5.\n", mismatch_count);
+  }
+  return OK;
+}
+#endif // OBJ_READER
@@ -0,0 +1,571 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file image_extract.c
+ *
+ * Extraction of all objects from a tape image captured by capture_tape_image(), with several threads.
+ *
+ * The data partition of the image is indexed first: every packed object(PO) is found by walking the blocks,
+ * and the bucket list is taken from the last RCM. The save paths are then reserved in the order of POs on tape,
+ * so that the output is the same as a full dump regardless of the number of threads.
+ * Finally, the POs are divided into contiguous ranges of about the same size, and each thread extracts one range.
+ */
+
+#ifdef OBJ_READER
+#include <pthread.h>
+#include "ltos_format_checker.h"
+
+typedef struct image_po {
+  uint64_t offset;                                      // Offset in the image of the data of the first block.
+  uint64_t block_number;                                // Block number of the first block.
+  uint64_t size;                                        // Size of the PO including its identifier.
+  uint64_t num_of_obj;
+  char bucket_name[BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1];
+  BucketInfo4ObjReader savepath;                        // Save path allocator just before the first object of this PO.
+} image_po;
+
+typedef struct image_extractor {
+  int fd;                                               // Image, read with pread by all threads.
+  const char* save_root;
+  image_po* pos;
+  uint64_t po_count;
+  uint64_t po_capacity;
+  uint64_t last_rcm_offset;                             // Offset in the image of the data of the last RCM. 0 if none.
+  reader_context* ctx;                                  // Context of the caller, in which the disk space shared by the workers is accounted.
+  pthread_mutex_t mutex;                                // Protects the disk space, the stop flag and the progress below.
+  Bool is_stopped;                                      // Set when a worker runs out of the disk space, so that the others stop.
+  uint64_t extracted_obj;
+  uint64_t extracted_size;
+  time_t start;
+} image_extractor;
+
+typedef struct image_worker {
+  image_extractor* extractor;
+  uint64_t po_from;                                     // Range of POs extracted by this worker.
+  uint64_t po_to;
+  pthread_t thread;
+  int ret;
+} image_worker;
+
+
+/**
+ * Read bytes at an offset of the image.
+ * @param [in]  (fd)     Image.
+ * @param [out] (buf)    Buffer.
+ * @param [in]  (size)   Size to be read.
+ * @param [in]  (offset) Offset in the image.
+ * @return      (OK/NG)  If all bytes are read, return OK. Otherwise, return NG.
+ */
+static int pread_image(const int fd, uint8_t* buf, uint64_t size, uint64_t offset) {
+  while (size > 0) {
+    const ssize_t read_size = pread(fd, buf, size, offset);
+    if (read_size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read_size <= 0) {
+      return NG;
+    }
+    buf    += read_size;
+    size   -= read_size;
+    offset += read_size;
+  }
+  return OK;
+}
+
+/**
+ * Get the offset in the image of a byte of a marker written in consecutive blocks.
+ * @param [in]  (first_offset) Offset in the image of the data of the first block.
+ * @param [in]  (offset)       Offset from the beginning of the marker.
+ * @return      Offset in the image.
+ */
+static uint64_t get_image_offset(const uint64_t first_offset, const uint64_t offset) {
+  return first_offset + (offset / LTOS_BLOCK_SIZE) * (TAPE_IMAGE_RECORD_HEADER_SIZE + LTOS_BLOCK_SIZE) + offset % LTOS_BLOCK_SIZE;
+}
+
+/**
+ * Read bytes of a marker written in consecutive blocks, skipping the record headers between the blocks.
+ * @param [in]  (fd)           Image.
+ * @param [in]  (first_offset) Offset in the image of the data of the first block.
+ * @param [in]  (offset)       Offset from the beginning of the marker.
+ * @param [in]  (size)         Size to be read.
+ * @param [out] (buf)          Buffer.
+ * @return      (OK/NG)        If all bytes are read, return OK. Otherwise, return NG.
+ */
+static int read_marker_in_image(const int fd, const uint64_t first_offset, uint64_t offset, uint64_t size, uint8_t* buf) {
+  while (size > 0) {
+    const uint64_t chunk = MIN(size, LTOS_BLOCK_SIZE - offset % LTOS_BLOCK_SIZE);
+    if (pread_image(fd, buf, chunk, get_image_offset(first_offset, offset)) != OK) {
+      return NG;
+    }
+    buf    += chunk;
+    offset += chunk;
+    size   -= chunk;
+  }
+  return OK;
+}
+
+/**
+ * Copy bytes of a marker written in consecutive blocks to a file.
+ * The data is copied in kernel with copy_file_range, and copied in user space if it is not supported.
+ * @param [in]  (fd)           Image.
+ * @param [in]  (first_offset) Offset in the image of the data of the first block.
+ * @param [in]  (offset)       Offset from the beginning of the marker.
+ * @param [in]  (size)         Size to be copied.
+ * @param [in]  (fd_to)        File to which the bytes are appended.
+ * @param [in]  (buf)          Buffer of LTOS_BLOCK_SIZE used if copy_file_range is not supported.
+ * @return      (OK/NG)        If all bytes are copied, return OK. Otherwise, return NG.
+ */
+static int copy_marker_in_image(const int fd, const uint64_t first_offset, uint64_t offset, uint64_t size,
+                                const int fd_to, uint8_t* const buf) {
+  while (size > 0) {
+    const uint64_t chunk = MIN(size, LTOS_BLOCK_SIZE - offset % LTOS_BLOCK_SIZE);
+    off_t offset_in      = get_image_offset(first_offset, offset);
+    uint64_t remained    = chunk;
+    while (remained > 0) {
+      const ssize_t copied_size = copy_file_range(fd, &offset_in, fd_to, NULL, remained, 0);
+      if (copied_size > 0) {
+        remained -= copied_size;
+        continue;
+      }
+      if (copied_size == 0 || (errno != ENOSYS && errno != EXDEV && errno != EINVAL)) {
+        return NG;
+      }
+      // copy_file_range is not supported between the file systems, so copy it in user space.
+      if (pread_image(fd, buf, remained, offset_in) != OK || write(fd_to, buf, remained) != (ssize_t)remained) {
+        return NG;
+      }
+      remained = 0;
+    }
+    offset += chunk;
+    size   -= chunk;
+  }
+  return OK;
+}
+
+/**
+ * Read a record header of the image.
+ * @param [in]  (fd)        Image.
+ * @param [in]  (offset)    Offset of the record.
+ * @param [out] (type)      Type of the record.
+ * @param [out] (partition) Partition of the record.
+ * @param [out] (number)    Block number of the record.
+ * @param [out] (length)    Length of the data of the record.
+ * @return      (OK/NG)     If the header is read, return OK. Otherwise, return NG.
+ */
+static int read_image_record(const int fd, const uint64_t offset, uint32_t* const type, uint32_t* const partition,
+                             uint64_t* const number, uint64_t* const length) {
+  uint8_t header[TAPE_IMAGE_RECORD_HEADER_SIZE] = { 0 };
+  if (pread_image(fd, header, TAPE_IMAGE_RECORD_HEADER_SIZE, offset) != OK) {
+    return NG;
+  }
+  r32(BIG, header,      type,      1);
+  r32(BIG, header + 4,  partition, 1);
+  r64(BIG, header + 8,  number,    1);
+  r64(BIG, header + 16, length,    1);
+  return OK;
+}
+
+/**
+ * Add a PO found in the image.
+ * @param [in/out] (extractor)    Extractor.
+ * @param [in]     (offset)       Offset in the image of the data of the first block.
+ * @param [in]     (block_number) Block number of the first block.
+ * @param [out]    (block_count)  Number of blocks of the PO.
+ * @return         (OK/NG)        If the PO is read, return OK. Otherwise, return NG.
+ */
+static int add_image_po(image_extractor* const extractor, const uint64_t offset, const uint64_t block_number,
+                        uint64_t* const block_count) {
+  uint8_t po_header[PO_HEADER_SIZE]    = { 0 };
+  uint8_t last_po_dir[PO_DIR_SIZE]     = { 0 };
+  uint64_t num_of_obj                  = 0;
+  uint64_t last_data_offset            = 0;
+
+  if (read_marker_in_image(extractor->fd, offset, PO_IDENTIFIER_SIZE, PO_HEADER_SIZE, po_header) != OK) {
+    return NG;
+  }
+  r64(BIG, po_header + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE, &num_of_obj, 1);
+  // The directory has one more entry after the last object, whose data offset is the end of the PO.
+  if (read_marker_in_image(extractor->fd, offset, PO_IDENTIFIER_SIZE + PO_HEADER_SIZE + num_of_obj * PO_DIR_SIZE,
+                           PO_DIR_SIZE, last_po_dir) != OK) {
+    return NG;
+  }
+  r64(BIG, last_po_dir + OBJECT_ID_SIZE + META_DATA_OFFSET_SIZE, &last_data_offset, 1);
+
+  if (extractor->po_count == extractor->po_capacity) {
+    extractor->po_capacity = (extractor->po_capacity == 0) ? OBJECT_VECTOR_INITIAL_CAPACITY : extractor->po_capacity * 2;
+    extractor->pos = (image_po*)realloc(extractor->pos, sizeof(image_po) * extractor->po_capacity);
+    if (extractor->pos == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to allocate memory for packed objects.\n");
+    }
+  }
+  image_po* const po = &extractor->pos[extractor->po_count++];
+  memset(po, 0, sizeof(image_po));
+  po->offset       = offset;
+  po->block_number = block_number;
+  po->size         = PO_IDENTIFIER_SIZE + last_data_offset;
+  po->num_of_obj   = num_of_obj;
+  uuid_unparse(po_header + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE + NUMBER_OF_OBJECTS_SIZE + PACK_ID_SIZE, po->bucket_name);
+  *block_count = (po->size + LTOS_BLOCK_SIZE - 1) / LTOS_BLOCK_SIZE;
+  return OK;
+}
+
+/**
+ * Find all POs and the last RCM in the data partition of the image.
+ * A PO is skipped as a whole, so object data which looks like an identifier is not mistaken for a marker.
+ * @param [in/out] (extractor) Extractor.
+ * @return         (OK/NG)     If the data partition is indexed up to EOD, return OK. Otherwise, return NG.
+ */
+static int index_image(image_extractor* const extractor) {
+  int ret                                 = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:index_image\n");
+  uint8_t header[TAPE_IMAGE_HEADER_SIZE]  = { 0 };
+  uint8_t identifier[IDENTIFIER_SIZE]     = { 0 };
+  uint64_t offset                         = TAPE_IMAGE_HEADER_SIZE;
+  uint32_t version                        = 0;
+
+  if (pread_image(extractor->fd, header, TAPE_IMAGE_HEADER_SIZE, 0) != OK
+      || memcmp(header, TAPE_IMAGE_MAGIC, TAPE_IMAGE_MAGIC_SIZE) != 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "This file is not a tape image.\n");
+  }
+  r32(BIG, header + 8, &version, 1);
+  if (version != TAPE_IMAGE_VERSION) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Version %u of the tape image is not supported.\n", version);
+  }
+
+  while (true) {
+    uint32_t type      = 0;
+    uint32_t partition = 0;
+    uint64_t number    = 0;
+    uint64_t length    = 0;
+    if (read_image_record(extractor->fd, offset, &type, &partition, &number, &length) != OK) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The tape image is truncated at %lu.\n", offset);
+    }
+    if (type == IMAGE_RECORD_END || (type == IMAGE_RECORD_EOD && partition == DATA_PARTITION)) {
+      break;
+    }
+    const uint64_t data_offset = offset + TAPE_IMAGE_RECORD_HEADER_SIZE;
+    offset = data_offset + length;
+    if (type != IMAGE_RECORD_BLOCK || partition != DATA_PARTITION || length < IDENTIFIER_SIZE) {
+      continue;
+    }
+    if (pread_image(extractor->fd, identifier, IDENTIFIER_SIZE, data_offset) != OK) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The tape image is truncated at %lu.\n", data_offset);
+    }
+    if (!memcmp(identifier, RCM_IDENTIFIER, IDENTIFIER_SIZE)) {
+      extractor->last_rcm_offset = data_offset;
+    } else if (!memcmp(identifier, PO_IDENTIFIER_ASCII_CODE, PO_IDENTIFIER_SIZE)) {
+      uint64_t block_count = 0;
+      if (add_image_po(extractor, data_offset, number, &block_count) != OK) {
+        return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to read the packed object at block %lu.\n", number);
+      }
+      // The offsets in a PO are mapped to the image with blocks of LTOS_BLOCK_SIZE.
+      if (block_count > 1 && length != LTOS_BLOCK_SIZE) {
+        return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The block size of the tape image is %lu. Only %d is supported.\n",
+                                  length, LTOS_BLOCK_SIZE);
+      }
+      // The blocks of a PO are written one after another, which is confirmed with the last block.
+      const uint64_t last_offset = get_image_offset(data_offset, (block_count - 1) * LTOS_BLOCK_SIZE) - TAPE_IMAGE_RECORD_HEADER_SIZE;
+      if (read_image_record(extractor->fd, last_offset, &type, &partition, &number, &length) != OK
+          || type != IMAGE_RECORD_BLOCK || number != extractor->pos[extractor->po_count - 1].block_number + block_count - 1) {
+        return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO,
+                                  "The packed object at block %lu is not in consecutive blocks.\n",
+                                  extractor->pos[extractor->po_count - 1].block_number);
+      }
+      offset = last_offset + TAPE_IMAGE_RECORD_HEADER_SIZE + length;
+    }
+  }
+  if (extractor->last_rcm_offset == 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "No RCM is found in the data partition of the tape image.\n");
+  }
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu packed object(s) are found in the tape image.\n", extractor->po_count);
+  return ret;
+}
+
+/**
+ * Replace the bucket ID of each PO with its name in the bucket list of the last RCM,
+ * and reserve the save paths of all objects in the order of POs on tape.
+ * @param [in/out] (extractor) Extractor.
+ * @return         (OK/NG)     If success, return OK. Otherwise, return NG.
+ */
+static int reserve_savepaths(image_extractor* const extractor) {
+  int ret                                = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:reserve_savepaths\n");
+  uint8_t rcm_header[RCM_HEADER_SIZE]    = { 0 };
+  uint64_t data_offset                   = 0;
+  uint64_t system_info_size              = 0;
+  BucketInfo4ObjReader* bucket_info      = NULL;
+
+  if (read_marker_in_image(extractor->fd, extractor->last_rcm_offset, IDENTIFIER_SIZE, RCM_HEADER_SIZE, rcm_header) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to read the last RCM.\n");
+  }
+  r64(BIG, rcm_header + DIRECTORY_OFFSET_SIZE, &data_offset, 1);
+  r64(BIG, rcm_header + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE, &system_info_size, 1);
+  char* const system_info = (char*)clf_allocate_memory(system_info_size + 1, "system info");
+  if (read_marker_in_image(extractor->fd, extractor->last_rcm_offset, IDENTIFIER_SIZE + data_offset,
+                           system_info_size, (uint8_t*)system_info) != OK) {
+    free(system_info);
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to read the system info in the last RCM.\n");
+  }
+  char* bucket_list = (char*)clf_allocate_memory(system_info_size + 1, "bucket_list");
+  extract_json_element(system_info, "BucketList", &bucket_list);
+
+  initialize_bucket_info_4_obj_reader(&bucket_info, (char*)extractor->save_root);
+  for (uint64_t i = 0; i < extractor->po_count; i++) {
+    image_po* const po = &extractor->pos[i];
+    char bucket_id[UUID_SIZE + 1] = { '\0' };
+    char* bucket_name             = po->bucket_name;
+    strcpy(bucket_id, po->bucket_name);
+    po->bucket_name[0] = '\0';
+    get_bucket_name(bucket_list, bucket_id, &bucket_name);
+    if (strlen(po->bucket_name) == 0) {
+      ret |= output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "Bucket %s is not in the bucket list. The ID is used as its name.\n", bucket_id);
+      strcpy(po->bucket_name, bucket_id);
+    }
+    add_bucket_info_4_obj_reader(&bucket_info, po->bucket_name, 0, 1, 1);
+    for (BucketInfo4ObjReader* current = bucket_info; current != NULL; current = current->next) {
+      if (!strcmp(current->bucket_name, po->bucket_name)) {
+        po->savepath      = *current;
+        po->savepath.next = NULL;
+        break;
+      }
+    }
+    int dir_number     = 0;
+    int sub_dir_number = 0;
+    for (uint64_t j = 0; j < po->num_of_obj; j++) {
+      get_bucket_info_4_obj_reader(&bucket_info, po->bucket_name, &dir_number, &sub_dir_number);
+    }
+  }
+
+  while (bucket_info != NULL) {
+    BucketInfo4ObjReader* const next = bucket_info->next;
+    free(bucket_info);
+    bucket_info = next;
+  }
+  free(bucket_list);
+  free(system_info);
+  return ret;
+}
+
+/**
+ * Open a file to be written by a worker.
+ * @param [in]  (filepath) File path.
+ * @return      File descriptor, or -1 on error.
+ */
+static int open_extracted_file(const char* const filepath) {
+  const int fd = open(filepath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Can't open file: %s. error=%s\n", filepath, strerror(errno));
+  }
+  return fd;
+}
+
+/**
+ * Extract the objects in a PO.
+ * The data is written before the metadata, so an object with its metadata is always complete.
+ * @param [in]  (extractor) Extractor.
+ * @param [in]  (po)        PO to be extracted.
+ * @param [in]  (buf)       Buffer of LTOS_BLOCK_SIZE.
+ * @return      (OK/NG)     If all objects are extracted, return OK. Otherwise, return NG.
+ */
+static int extract_image_po(image_extractor* const extractor, const image_po* const po, uint8_t* const buf) {
+  int ret                            = OK;
+  BucketInfo4ObjReader* savepath     = (BucketInfo4ObjReader*)clf_allocate_memory(sizeof(BucketInfo4ObjReader), "savepath");
+  const uint64_t dir_size            = (po->num_of_obj + 1) * PO_DIR_SIZE;
+  uint8_t* const po_dir              = (uint8_t*)clf_allocate_memory(dir_size, "po_dir");
+
+  *savepath = po->savepath;
+  if (read_marker_in_image(extractor->fd, po->offset, PO_IDENTIFIER_SIZE + PO_HEADER_SIZE, dir_size, po_dir) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to read the directory of the packed object at block %lu.\n",
+                              po->block_number);
+  }
+  for (uint64_t i = 0; i < po->num_of_obj && ret == OK; i++) {
+    uint64_t meta_offset               = 0;
+    uint64_t data_offset               = 0;
+    uint64_t object_size               = 0;
+    int dir_number                     = 0;
+    int sub_dir_number                 = 0;
+    char object_key[MAX_PATH + 1]      = { 0 };
+    char object_id[UUID_SIZE + 1]      = { 0 };
+    char object_path[MAX_PATH + 1]     = { 0 };
+    r64(BIG, po_dir + i * PO_DIR_SIZE + OBJECT_ID_SIZE, &meta_offset, 1);
+    r64(BIG, po_dir + i * PO_DIR_SIZE + OBJECT_ID_SIZE + META_DATA_OFFSET_SIZE, &data_offset, 1);
+    if (data_offset < meta_offset || META_MAX_SIZE < data_offset - meta_offset) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The metadata %lu of the packed object at block %lu is broken.\n",
+                                i, po->block_number);
+      break;
+    }
+    char* const meta_data = (char*)clf_allocate_memory(data_offset - meta_offset + 1, "meta_data");
+    if (read_marker_in_image(extractor->fd, po->offset, PO_IDENTIFIER_SIZE + meta_offset, data_offset - meta_offset,
+                             (uint8_t*)meta_data) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to read the metadata %lu of the packed object at block %lu.\n",
+                                i, po->block_number);
+      free(meta_data);
+      break;
+    }
+    get_element_from_metadata(meta_data, &object_size, object_key, object_id, NULL, NULL, NULL);
+    get_bucket_info_4_obj_reader(&savepath, savepath->bucket_name, &dir_number, &sub_dir_number);
+    if (dir_number > OBJ_READER_MAX_SAVE_NUM) {
+      free(meta_data);
+      continue;
+    }
+
+    const int path_len = snprintf(object_path, sizeof(object_path) - strlen(".data"), "%s/%s/%04d/%04d/%s/%s",
+                                  extractor->save_root, po->bucket_name, dir_number, sub_dir_number, object_key, object_id);
+    if (path_len < 0 || (size_t)path_len >= sizeof(object_path) - strlen(".data")) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The save path of %s is too long.\n", object_key);
+      free(meta_data);
+      break;
+    }
+
+    pthread_mutex_lock(&extractor->mutex);
+    Bool is_stopped = extractor->is_stopped;
+    if (is_stopped == false) {
+      reader_context* const worker_ctx = get_reader_context();
+      bind_reader_context(extractor->ctx);
+      if (check_disk_space(extractor->save_root, object_size) == NG) {
+        ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to check the disk space. The extraction is stopped.\n");
+        extractor->is_stopped = true;
+        is_stopped            = true;
+      } else {
+        commit_disk_space(object_size + strlen(meta_data));
+      }
+      bind_reader_context(worker_ctx);
+    }
+    pthread_mutex_unlock(&extractor->mutex);
+    if (is_stopped == true) {
+      free(meta_data);
+      break;
+    }
+
+    strcpy(object_path + path_len, ".data");
+    mk_deep_dir(object_path);
+    const uint64_t start = start_metric_timer();
+    int fd = open_extracted_file(object_path);
+    if (fd < 0 || copy_marker_in_image(extractor->fd, po->offset, PO_IDENTIFIER_SIZE + data_offset, object_size, fd, buf) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to extract %s.\n", object_path);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+    strcpy(object_path + path_len, ".meta");
+    fd = (ret == OK) ? open_extracted_file(object_path) : -1;
+    if (fd >= 0) {
+      if (write(fd, meta_data, strlen(meta_data)) != (ssize_t)strlen(meta_data)) {
+        ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to extract %s.\n", object_path);
+      }
+      close(fd);
+    }
+    if (ret == OK) {
+      add_metric_counter(METRIC_OUTPUT_BYTES, object_size + strlen(meta_data));
+      add_metric_counter(METRIC_OBJECTS, 1);
+    }
+    observe_metric_timer(METRIC_OUTPUT_WRITE, start);
+    free(meta_data);
+
+    pthread_mutex_lock(&extractor->mutex);
+    extractor->extracted_obj++;
+    if (extractor->extracted_size / TAPE_IMAGE_PROGRESS_SIZE != (extractor->extracted_size + object_size) / TAPE_IMAGE_PROGRESS_SIZE) {
+      const time_t elapsed = MAX(time(NULL) - extractor->start, 1);
+      output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu object(s), %lu GiB extracted. %lu MB/s.\n", extractor->extracted_obj,
+                         (extractor->extracted_size + object_size) >> 30, (extractor->extracted_size + object_size) / 1000000 / elapsed);
+    }
+    extractor->extracted_size += object_size;
+    pthread_mutex_unlock(&extractor->mutex);
+  }
+
+  free(po_dir);
+  free(savepath);
+  return ret;
+}
+
+/**
+ * Extract a range of POs. Each worker has its own reader context.
+ * @param [in]  (arg) Image worker.
+ * @return      NULL
+ */
+static void* extract_image_pos(void* arg) {
+  image_worker* const worker = (image_worker*)arg;
+  reader_context* const ctx  = create_reader_context();
+  uint8_t* const buf         = (uint8_t*)clf_allocate_memory(LTOS_BLOCK_SIZE, "extract buffer");
+
+  bind_reader_context(ctx);
+  for (uint64_t i = worker->po_from; i < worker->po_to; i++) {
+    worker->ret |= extract_image_po(worker->extractor, &worker->extractor->pos[i], buf);
+  }
+  free(buf);
+  free_reader_context(ctx);
+  return NULL;
+}
+
+/**
+ * Extract all objects in a tape image to the save path with several threads.
+ * The objects are saved at the same paths as a full dump of the tape.
+ * @param [in]  (image_path) Path of the image captured by capture_tape_image().
+ * @param [in]  (save_root)  Directory to which the objects are saved.
+ * @param [in]  (jobs)       Number of threads.
+ * @return      (OK/NG)      If all objects are extracted, return OK. Otherwise, return NG.
+ */
+int extract_tape_image(const char* const image_path, const char* const save_root, const int jobs) {
+  int ret                   = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:extract_tape_image\n");
+  image_extractor extractor = { .fd = -1, .save_root = save_root, .ctx = get_reader_context(), .is_stopped = false, .start = time(NULL) };
+
+  extractor.fd = open(image_path, O_RDONLY);
+  if (extractor.fd < 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to open the tape image(%s). error=%s\n", image_path, strerror(errno));
+  }
+  ret |= index_image(&extractor);
+  if (ret == OK) {
+    char save_dir[MAX_PATH + 1] = { '\0' };
+    snprintf(save_dir, sizeof(save_dir), "%s/", save_root);
+    ret |= mk_deep_dir(save_dir);
+    ret |= reserve_savepaths(&extractor);
+  }
+
+  if (ret == OK) {
+    uint64_t total_size = 0;
+    for (uint64_t i = 0; i < extractor.po_count; i++) {
+      total_size += extractor.pos[i].size;
+    }
+    // Each worker reads a contiguous range of the image, whose size is about the same as the others.
+    const int worker_count       = (int)MAX(MIN((uint64_t)jobs, extractor.po_count), 1);
+    image_worker* const workers  = (image_worker*)clf_allocate_memory(sizeof(image_worker) * worker_count, "image workers");
+    uint64_t po_index            = 0;
+    uint64_t assigned_size       = 0;
+    pthread_mutex_init(&extractor.mutex, NULL);
+    for (int i = 0; i < worker_count; i++) {
+      workers[i].extractor = &extractor;
+      workers[i].po_from   = po_index;
+      while (po_index < extractor.po_count
+             && (i == worker_count - 1 || assigned_size < total_size / worker_count * (i + 1))) {
+        assigned_size += extractor.pos[po_index++].size;
+      }
+      workers[i].po_to = po_index;
+      if (pthread_create(&workers[i].thread, NULL, extract_image_pos, &workers[i]) != 0) {
+        ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to start the image extractor.\n");
+      }
+    }
+    for (int i = 0; i < worker_count; i++) {
+      pthread_join(workers[i].thread, NULL);
+      ret |= workers[i].ret;
+    }
+    pthread_mutex_destroy(&extractor.mutex);
+    free(workers);
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu object(s) are extracted from %s with %d thread(s). %lu bytes.\n",
+                       extractor.extracted_obj, image_path, worker_count, extractor.extracted_size);
+  }
+
+  close(extractor.fd);
+  free(extractor.pos);
+  return ret;
+}
+#endif // OBJ_READER
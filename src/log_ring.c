@@ -0,0 +1,241 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file log_ring.c
+ *
+ * Asynchronous output of INFO, DEBUG and TRACE messages.
+ *
+ * A message is formatted into a slot of a bounded lock-free ring buffer by the thread which outputs it,
+ * and a background thread writes the slots to their streams. Any thread can queue messages.
+ * When the ring is full, the message is dropped and counted instead of waiting for the writer thread,
+ * so that verbose output does not slow down reading from tape. The number of dropped messages is written as a warning.
+ */
+
+#include <pthread.h>
+#include "ltos_format_checker.h"
+
+typedef struct {
+  uint64_t sequence;                      // Position to queue a message in the slot, or the position + 1 when it is queued.
+  FILE* stream;                           // Stream to write the message.
+  char* long_message;                     // Message which does not fit in message, or NULL.
+  uint32_t size;                          // Size of the message.
+  char message[LOG_RING_MESSAGE_SIZE];
+} log_record;
+
+static log_record log_ring[LOG_RING_SLOTS];
+static uint64_t enqueue_position = 0;     // Position of the next message to be queued.
+static uint64_t written_position = 0;     // Messages before it are written and flushed.
+static uint64_t dropped_records  = 0;     // Messages dropped because the ring was full.
+static int log_ring_state        = LOG_RING_STOPPED;
+static pthread_t log_writer;
+
+/**
+ * Wait for a while.
+ * @param [in]  (nanoseconds) Time to wait.
+ */
+static void wait_log_ring(const long nanoseconds) {
+  const struct timespec wait = { 0, nanoseconds };
+  nanosleep(&wait, NULL);
+}
+
+/**
+ * Write the number of messages dropped since the last report.
+ * @param [in/out] (reported_drops) Number of dropped messages already reported.
+ */
+static void report_dropped_records(uint64_t* const reported_drops) {
+  const uint64_t drops = __atomic_load_n(&dropped_records, __ATOMIC_RELAXED);
+  if (drops != *reported_drops) {
+    char header[LOG_HEADER_SIZE] = { '\0' };
+    format_log_header(header, sizeof(header), OUTPUT_WARNING, DISPLAY_COMMON_INFO);
+    fprintf(stderr, "%s%lu message(s) were dropped because the log ring was full.\n", header, drops - *reported_drops);
+    *reported_drops = drops;
+  }
+}
+
+/**
+ * Write queued messages until the ring is stopped.
+ * @param [in]  (arg) Not used.
+ * @return            NULL.
+ */
+static void* write_log_records(void* arg) {
+  uint64_t position       = 0;
+  uint64_t reported_drops = 0;
+  (void)arg;
+
+  while (true) {
+    FILE* streams[LOG_RING_MAX_STREAMS] = { NULL };
+    int stream_count                    = 0;
+    const uint64_t batch_start          = position;
+
+    while (true) {
+      log_record* const record = &log_ring[position & (LOG_RING_SLOTS - 1)];
+      if (__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+        break;
+      }
+      fwrite((record->long_message != NULL) ? record->long_message : record->message, 1, record->size, record->stream);
+      free(record->long_message);
+      record->long_message = NULL;
+      int i = 0;
+      while (i < stream_count && streams[i] != record->stream) {
+        i++;
+      }
+      if (i == stream_count) {
+        if (stream_count == LOG_RING_MAX_STREAMS) {
+          fflush(streams[--stream_count]);
+        }
+        streams[stream_count++] = record->stream;
+      }
+      __atomic_store_n(&record->sequence, position + LOG_RING_SLOTS, __ATOMIC_RELEASE);
+      position++;
+    }
+    report_dropped_records(&reported_drops);
+    for (int i = 0; i < stream_count; i++) {
+      fflush(streams[i]);
+    }
+    __atomic_store_n(&written_position, position, __ATOMIC_RELEASE);
+
+    if (position == batch_start) {
+      if (__atomic_load_n(&log_ring_state, __ATOMIC_ACQUIRE) == LOG_RING_STOPPING &&
+          position == __atomic_load_n(&enqueue_position, __ATOMIC_ACQUIRE)) {
+        break;
+      }
+      wait_log_ring(LOG_RING_IDLE_WAIT_NS);
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Stop queueing messages in a child process, which does not have the writer thread.
+ */
+static void stop_log_ring_in_child(void) {
+  log_ring_state = LOG_RING_STOPPED;
+}
+
+/**
+ * Start the writer thread of the log ring. The ring is stopped at exit.
+ * If the thread cannot be started, messages are written synchronously.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+int start_log_ring(void) {
+  if (log_ring_state != LOG_RING_STOPPED) {
+    return OK;
+  }
+  for (uint64_t i = 0; i < LOG_RING_SLOTS; i++) {
+    log_ring[i].sequence = i;
+  }
+  if (pthread_create(&log_writer, NULL, write_log_records, NULL) != 0) {
+    output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "Failed to start the log writer. Messages are written synchronously.\n");
+    return NG;
+  }
+  __atomic_store_n(&log_ring_state, LOG_RING_RUNNING, __ATOMIC_RELEASE);
+  pthread_atfork(NULL, NULL, stop_log_ring_in_child);
+  atexit(stop_log_ring);
+  return OK;
+}
+
+/**
+ * Write all queued messages and stop the writer thread. Messages after it are written synchronously.
+ */
+void stop_log_ring(void) {
+  int state = LOG_RING_RUNNING;
+  if (__atomic_compare_exchange_n(&log_ring_state, &state, LOG_RING_STOPPING, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    pthread_join(log_writer, NULL);
+    __atomic_store_n(&log_ring_state, LOG_RING_STOPPED, __ATOMIC_RELEASE);
+  }
+}
+
+/**
+ * Check if messages are queued to the log ring.
+ * @return      (true/false) If the writer thread is running, return true. Otherwise, return false.
+ */
+int is_log_ring_running(void) {
+  return (__atomic_load_n(&log_ring_state, __ATOMIC_ACQUIRE) == LOG_RING_RUNNING) ? true : false;
+}
+
+/**
+ * Queue a message. If the ring is full, the message is dropped.
+ * @param [in]  (stream) Stream to write the message.
+ * @param [in]  (header) Header of the message.
+ * @param [in]  (format) Format of the message.
+ * @param [in]  (args)   Arguments of the format.
+ * @return      (OK/NG)  If the message is queued, return OK. If it is dropped, return NG.
+ */
+int enqueue_log_record(FILE* const stream, const char* const header, const char* restrict format, va_list args) {
+  uint64_t position = __atomic_load_n(&enqueue_position, __ATOMIC_RELAXED);
+  log_record* record = NULL;
+
+  while (true) {
+    record = &log_ring[position & (LOG_RING_SLOTS - 1)];
+    const uint64_t sequence = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+    if (sequence == position) {
+      if (__atomic_compare_exchange_n(&enqueue_position, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (sequence < position) {
+      __atomic_fetch_add(&dropped_records, 1, __ATOMIC_RELAXED);
+      return NG;
+    } else {
+      position = __atomic_load_n(&enqueue_position, __ATOMIC_RELAXED);
+    }
+  }
+
+  // The slot is owned by this thread until the sequence is updated.
+  const size_t header_size = strlen(header);
+  va_list long_args;
+  va_copy(long_args, args);
+  memcpy(record->message, header, header_size);
+  int message_size = vsnprintf(record->message + header_size, LOG_RING_MESSAGE_SIZE - header_size, format, args);
+  if (message_size < 0) {
+    message_size = 0;
+  }
+  record->stream       = stream;
+  record->long_message = NULL;
+  record->size         = header_size + message_size;
+  if (record->size >= LOG_RING_MESSAGE_SIZE) {
+    record->long_message = (char*)malloc(record->size + 1);
+    if (record->long_message != NULL) {
+      memcpy(record->long_message, header, header_size);
+      vsnprintf(record->long_message + header_size, message_size + 1, format, long_args);
+    } else {
+      record->size = LOG_RING_MESSAGE_SIZE - 1; // Truncated.
+    }
+  }
+  va_end(long_args);
+  __atomic_store_n(&record->sequence, position + 1, __ATOMIC_RELEASE);
+  return OK;
+}
+
+/**
+ * Wait until all messages queued so far are written.
+ * Call it before writing to the streams of the messages without the log ring.
+ */
+void flush_log_ring(void) {
+  if (is_log_ring_running() == false) {
+    return;
+  }
+  const uint64_t position = __atomic_load_n(&enqueue_position, __ATOMIC_ACQUIRE);
+  while (__atomic_load_n(&written_position, __ATOMIC_ACQUIRE) < position) {
+    wait_log_ring(LOG_RING_FLUSH_WAIT_NS);
+  }
+}
+
+/**
+ * Get the number of messages dropped because the log ring was full.
+ * @return      Number of dropped messages.
+ */
+uint64_t get_dropped_log_records(void) {
+  return __atomic_load_n(&dropped_records, __ATOMIC_RELAXED);
+}
@@ -55,6 +55,8 @@ static void print_usage(char *appname)
   fprintf(stderr, "                                  exit:Stop checking if a error is found.\n");
   fprintf(stderr, "                                  default is exit.\n");
   fprintf(stderr, "  -d, --device          = <name>  Specify device name. default is /dev/sg0.\n");
+  fprintf(stderr, "  -M, --metrics         = <path>  Export metrics in Prometheus text format to the file every %d seconds.\n", METRICS_INTERVAL);
+  fprintf(stderr, "                                  \"unix:<path>\" serves them over HTTP on the Unix socket instead.\n");
   fprintf(stderr, "  -o, --outputpath      = <path>  Specify output path of packed object.\n");
   fprintf(stderr, "  -t, --target          = <name>  all:Check both Reference Partition(RP) and Data Partition(DP).\n");
   fprintf(stderr, "                                  rp:Check only RP.\n");
@@ -74,7 +76,7 @@ static void print_usage(char *appname)
 
 #if !defined(OBJ_READER) && !defined(MONGODB_RESTORE_TOOL)
 /* Command line options */
-static const char *short_options    = "p:o:d:t:c:v:Vh";
+static const char *short_options    = "p:o:d:t:c:v:M:Vh";
 static struct option long_options[] = {
   { "packedobjpath",   required_argument, 0, 'p' },
   { "outputpath",      required_argument, 0, 'o' },
@@ -82,6 +84,7 @@ static struct option long_options[] = {
   { "target",          required_argument, 0, 't' },
   { "continue",        required_argument, 0, 'c' },
   { "verbose",         required_argument, 0, 'v' },
+  { "metrics",         required_argument, 0, 'M' },
   { "version",         no_argument,       0, 'V' },
   { "help",            no_argument,       0, 'h' },
   { 0,                    0,                    0,   0  }
@@ -100,7 +103,8 @@ int main(int argc, char **argv) {
   char continue_mode[MAX_PATH + 1];
   snprintf(continue_mode, PATH_MAX + 1, "%s", EXIT);
   //continue_mode        = EXIT;
-  char verbose_level[MAX_PATH + 1] = DISPLAY_COMMON_INFO;
+  char verbose_level[MAX_PATH + 1] = "";
+  char metrics_path[MAX_PATH + 1]  = "";
   int ret              = OK;
 
   /* Parse command line options */
@@ -130,6 +134,9 @@ int main(int argc, char **argv) {
     case 'v':
       snprintf(verbose_level, PATH_MAX + 1, "%s", optarg);
       break;
+    case 'M':
+      snprintf(metrics_path, PATH_MAX + 1, "%s", optarg);
+      break;
     case 'V':
       fprintf(stderr, "%s\n", FORMAT_CHECKER_VERSION);
       exit(EXIT_SUCCESS);
@@ -141,6 +148,12 @@ int main(int argc, char **argv) {
   }
   set_vl(verbose_level);
   set_c_mode(continue_mode);
+  start_log_ring();
+  //   Summary of SCSI commands is output at exit with -v.
+  atexit(output_metrics_summary);
+  if (strlen(metrics_path) > 0 && start_metrics_exporter(metrics_path) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to export metrics to %s.\n", metrics_path);
+  }
 
 #ifdef SC_PACKED_OBJECT_CHECK_FLAG
   // Read the file, store it in memory.
@@ -187,12 +200,10 @@ static int check_ltos_format(char *verbose_level, char *continue_mode, char *tar
   MamHta mamhta                             = { 0 };
   MamVci mamvci[NUMBER_OF_PARTITIONS]       = { { 0 } };
   int ret                                   = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:check_ltos_format\n");
-  char command_buff[COMMAND_SIZE + 1]       = { '\0' };
   int fd                                    = ERROR;
 
   //Check if tape device exists.
-  sprintf(command_buff, DEVICE_CHECK_COMMAND, device_name);
-  if (WEXITSTATUS(system(command_buff)) != OK) {
+  if (find_tape_device(device_name) != OK) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Can't find tape device(%s).\n"
                               "%sCheck option '-d'.\n", device_name, INDENT);
     return ret;
@@ -226,10 +237,15 @@ static int check_ltos_format(char *verbose_level, char *continue_mode, char *tar
     ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "MAM Check Error\n");
   }
 
+  // Check the tape with its own reader context.
+  reader_context* const ctx = create_reader_context();
+  bind_reader_context(ctx);
+
   // Set all pointers relating to SCSI control to utility module.
   set_device_pram(&scparam, &sense_data, &syserr);
 
   check_integrity(mamvci, &mamhta);
+  free_reader_context(ctx);
 
   /*
   // These clf_volume will be replaced with check_interity.
@@ -26,18 +26,6 @@
 #include <locale.h>
 #include <openssl/md5.h>
 
-//for obj_reader
-static time_t   lap_start                           = 0;
-static time_t   lap_end                             = 0;
-static uint32_t history_interval                    = 0;
-static char     obj_save_path[OUTPUT_PATH_SIZE + 1] = { '\0' };
-
-int scandir (const char *__restrict __dir,
-        struct dirent ***__restrict __namelist,
-        int (*__selector) (const struct dirent *),
-        int (*__cmp) (const struct dirent **,
-          const struct dirent **));
-
 static int read_or_write_ini(const int rw, const char* ini_path, const char* section, const char* key, char** value);
 static int update_bucket_info_4_obj_reader(BucketInfo4ObjReader** bucket_info_4_obj_reader);
 static int mk_a_dir(const char *dirpath);
@@ -47,8 +35,8 @@ static int mk_a_dir(const char *dirpath);
  * @param [in] (save_path) Object save path.
  */
 void set_obj_save_path(char save_path[OUTPUT_PATH_SIZE + 1]) {
-  //obj_save_path = save_path;
-  strcpy(obj_save_path, save_path);
+  reader_context* const ctx = get_reader_context();
+  strcpy(ctx->obj_save_path, save_path);
 }
 
 /**
@@ -56,7 +44,8 @@ void set_obj_save_path(char save_path[OUTPUT_PATH_SIZE + 1]) {
  * @param [in] (lap_s) Measurement start time.
  */
 void set_lap_start(time_t lap_s) {
-  lap_start = lap_s;
+  reader_context* const ctx = get_reader_context();
+  ctx->lap_start = lap_s;
 }
 
 /**
@@ -64,7 +53,8 @@ void set_lap_start(time_t lap_s) {
  * @param [in] (history_i) Interval option specified on the command line.
  */
 void set_history_interval(uint32_t history_i) {
-  history_interval = history_i;
+  reader_context* const ctx = get_reader_context();
+  ctx->history_interval = history_i;
 }
 
 /**
@@ -73,13 +63,14 @@ void set_history_interval(uint32_t history_i) {
  * @return         (OK/NG)    If success, return OK. Otherwise, return NG.
  */
 int get_interval(long int* interval) {
+  reader_context* const ctx = get_reader_context();
   int ret = OK;
   ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_interval\n");
 
-  lap_end = time(NULL);
-  *interval = lap_end - lap_start;
-  if (history_interval < *interval) {
-    lap_start = time(NULL);
+  ctx->lap_end = time(NULL);
+  *interval = ctx->lap_end - ctx->lap_start;
+  if (ctx->history_interval < *interval) {
+    ctx->lap_start = time(NULL);
   }
 
   return ret;
@@ -354,84 +345,254 @@ static int read_or_write_ini(const int rw, const char* ini_path, const char* sec
 }
 
 /**
- * Output history file.
- * @param [in]     (tape_id)  barcode id
- * @param [in]     (pr_cnt)   What number is the pr, which include the last output object, from the beginning.
- * @param [in]     (ocm_cnt)  What number is the ocm, which include the last output object, from the beginning.
- * @param [in]     (po_cnt)   What number is the po, which include the last output object, from the beginning.
- * @param [in/out] (obj_cnt)  How many objects have been read.
- * @return         (OK/NG)    If success, return OK. Otherwise, return NG.
+ * Calculate CRC32 (IEEE 802.3) of a buffer.
+ * @param [in] (buf) Buffer to be calculated.
+ * @param [in] (len) Length of the buffer.
+ * @return     CRC32 value.
+ */
+static uint32_t calc_crc32(const uint8_t* const buf, const size_t len) {
+  static uint32_t table[256];
+  static Bool     table_ready = false;
+  if (table_ready == false) {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int j = 0; j < 8; j++) {
+        c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+      }
+      table[i] = c;
+    }
+    table_ready = true;
+  }
+  uint32_t crc = 0xFFFFFFFFU;
+  for (size_t i = 0; i < len; i++) {
+    crc = table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFU;
+}
+
+/**
+ * Serialize a history record to a fixed size journal record.
+ * Layout (big endian): magic(4) version(4) tape_id(16) pr(8) ocm(8) po(8) obj(8) done_obj(8) written(8) prefix_md5(16)
+ *                      bucket_id(16) dir(2) sub_dir(2) saved(2) reserved(14) crc32(4)
+ * bucket_id and the following were reserved in the first records, so a record without them has a null bucket_id.
+ * @param [in]  (history) History record.
+ * @param [out] (record)  Journal record.
+ */
+static void pack_history_record(const history_record* const history, uint8_t record[HISTORY_RECORD_SIZE]) {
+  const uint32_t version = HISTORY_RECORD_VERSION;
+  memset(record, 0, HISTORY_RECORD_SIZE);
+  memcpy(record, HISTORY_RECORD_MAGIC, HISTORY_RECORD_MAGIC_SIZE);
+  w32(BIG, &version, record + 4, 1);
+  strncpy((char*)record + 8, history->tape_id, BARCODE_SIZE);
+  w64(BIG, &history->pr_cnt,       record + 24, 1);
+  w64(BIG, &history->ocm_cnt,      record + 32, 1);
+  w64(BIG, &history->po_cnt,       record + 40, 1);
+  w64(BIG, &history->obj_cnt,      record + 48, 1);
+  w64(BIG, &history->done_obj_cnt, record + 56, 1);
+  w64(BIG, &history->written_size, record + 64, 1);
+  memcpy(record + 72, history->prefix_md5, MD5_BIN_SIZE);
+  if (history->bucket_id[0] != '\0') {
+    uuid_parse(history->bucket_id, record + 88);
+  }
+  w16(BIG, &history->dir_number,     record + 104, 1);
+  w16(BIG, &history->sub_dir_number, record + 106, 1);
+  w16(BIG, &history->saved_counter,  record + 108, 1);
+  const uint32_t crc = calc_crc32(record, HISTORY_RECORD_SIZE - 4);
+  w32(BIG, &crc, record + HISTORY_RECORD_SIZE - 4, 1);
+}
+
+/**
+ * Deserialize a journal record.
+ * @param [in]  (record)  Journal record.
+ * @param [out] (history) History record.
+ * @return      (OK/NG)   If the record is valid, return OK. Otherwise (torn or corrupted), return NG.
  */
-int output_history(const char* tape_id, const uint64_t pr_cnt, const uint64_t ocm_cnt, const uint64_t po_cnt, const uint64_t obj_cnt) {
+static int unpack_history_record(const uint8_t record[HISTORY_RECORD_SIZE], history_record* const history) {
+  uint32_t version = 0;
+  uint32_t crc     = 0;
+  if (memcmp(record, HISTORY_RECORD_MAGIC, HISTORY_RECORD_MAGIC_SIZE) != 0) {
+    return NG;
+  }
+  r32(BIG, record + HISTORY_RECORD_SIZE - 4, &crc, 1);
+  if (calc_crc32(record, HISTORY_RECORD_SIZE - 4) != crc) {
+    return NG;
+  }
+  r32(BIG, record + 4, &version, 1);
+  if (version != HISTORY_RECORD_VERSION) {
+    return NG;
+  }
+  memset(history->tape_id, 0, sizeof(history->tape_id));
+  strncpy(history->tape_id, (const char*)record + 8, BARCODE_SIZE);
+  r64(BIG, record + 24, &history->pr_cnt,       1);
+  r64(BIG, record + 32, &history->ocm_cnt,      1);
+  r64(BIG, record + 40, &history->po_cnt,       1);
+  r64(BIG, record + 48, &history->obj_cnt,      1);
+  r64(BIG, record + 56, &history->done_obj_cnt, 1);
+  r64(BIG, record + 64, &history->written_size, 1);
+  memcpy(history->prefix_md5, record + 72, MD5_BIN_SIZE);
+  memset(history->bucket_id, 0, sizeof(history->bucket_id));
+  if (uuid_is_null(record + 88) == 0) {
+    uuid_unparse(record + 88, history->bucket_id);
+  }
+  r16(BIG, record + 104, &history->dir_number,     1);
+  r16(BIG, record + 106, &history->sub_dir_number, 1);
+  r16(BIG, record + 108, &history->saved_counter,  1);
+  return OK;
+}
+
+/**
+ * Remember a file written during the dump, so that it is flushed at the next commit of the journal.
+ * @param [in]  (filepath) File path which is written.
+ */
+static void add_unsynced_file(const char* const filepath) {
+  reader_context* const ctx = get_reader_context();
+  if (ctx->history_fd < 0) {
+    return;
+  }
+  // A file is written block by block, so only a change of the file is remembered.
+  if (ctx->unsynced_file_num != 0 && strcmp(ctx->unsynced_files[ctx->unsynced_file_num - 1], filepath) == 0) {
+    return;
+  }
+  if (ctx->unsynced_file_num == ctx->unsynced_file_capacity) {
+    ctx->unsynced_file_capacity = (ctx->unsynced_file_capacity == 0) ? UNSYNCED_FILES_INITIAL_CAPACITY : ctx->unsynced_file_capacity * 2;
+    if ((ctx->unsynced_files = (char**)realloc(ctx->unsynced_files, sizeof(char*) * ctx->unsynced_file_capacity)) == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to allocate memory for unsynced_files.\n");
+    }
+  }
+  ctx->unsynced_files[ctx->unsynced_file_num] = (char*)clf_allocate_memory(strlen(filepath) + 1, "unsynced_file");
+  strcpy(ctx->unsynced_files[ctx->unsynced_file_num], filepath);
+  ctx->unsynced_file_num++;
+}
+
+/**
+ * Flush a file or a directory to the disk.
+ * @param [in]  (filepath) File or directory path.
+ * @return      (OK/NG)    If success or the file has been removed, return OK. Otherwise, return NG.
+ */
+static int fsync_path(const char* const filepath) {
+  const int fd = open(filepath, O_RDONLY);
+  if (fd < 0) {
+    return (errno == ENOENT) ? OK : output_accdg_to_vl(OUTPUT_WARNING, DEFAULT, "open error(%s).\n", filepath);
+  }
   int ret = OK;
-  long int interval = 0;
-  get_interval(&interval);
-  if ((interval < history_interval) && (check_disk_space(obj_save_path, 0) == OK)) {
+  if (fsync(fd) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_WARNING, DEFAULT, "fsync error(%s).\n", filepath);
+  }
+  close(fd);
+  return ret;
+}
+
+/**
+ * Flush the extracted objects and the journal to the disk (group commit).
+ * Only the files written since the last commit and their directories are flushed, not every file system.
+ * @return (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int commit_history(void) {
+  reader_context* const ctx = get_reader_context();
+  int ret = OK;
+  if (ctx->history_fd < 0) {
     return ret;
   }
+  // Objects are flushed first, so that a durable record never points to an object which is not durable.
+  // Files of an object share the directory, which is flushed once for the entries of the new files.
+  char dirpath[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  for (uint64_t i = 0; i < ctx->unsynced_file_num; i++) {
+    ret |= fsync_path(ctx->unsynced_files[i]);
+    const char* const separator = strrchr(ctx->unsynced_files[i], '/');
+    const int dir_length        = (separator == NULL) ? 0 : (int)(separator - ctx->unsynced_files[i]);
+    if (dir_length != 0 && ((int)strlen(dirpath) != dir_length || strncmp(dirpath, ctx->unsynced_files[i], dir_length) != 0)) {
+      snprintf(dirpath, sizeof(dirpath), "%.*s", dir_length, ctx->unsynced_files[i]);
+      ret |= fsync_path(dirpath);
+    }
+    free(ctx->unsynced_files[i]);
+    ctx->unsynced_files[i] = NULL;
+  }
+  ctx->unsynced_file_num = 0;
+  if (fsync(ctx->history_fd) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_WARNING, DEFAULT, "fsync error(%s).\n", HISTORY_JOURNAL_PATH);
+  }
+  return ret;
+}
 
+/**
+ * Output history to the journal.
+ * A fixed size record is appended per call, and it is flushed to the disk at the interval specified by "--interval".
+ * @param [in]     (history)  Progress of the dump.
+ * @return         (OK/NG)    If success, return OK. Otherwise, return NG.
+ */
+int output_history(const history_record* const history) {
+  reader_context* const ctx = get_reader_context();
+  int ret = OK;
   ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:output_history\n");
 
-  char* char_pr_cnt  = (char*)clf_allocate_memory(STR_MAX, "char_pr_cnt");
-  char* char_ocm_cnt = (char*)clf_allocate_memory(STR_MAX, "char_ocm_cnt");
-  char* char_po_cnt  = (char*)clf_allocate_memory(STR_MAX, "char_po_cnt");
-  char* char_obj_cnt = (char*)clf_allocate_memory(STR_MAX, "char_obj_cnt");
-
-  sprintf(char_pr_cnt, "%lu", pr_cnt);
-  sprintf(char_ocm_cnt, "%lu", ocm_cnt);
-  sprintf(char_po_cnt, "%lu", po_cnt);
-  sprintf(char_obj_cnt, "%lu", obj_cnt);
+  if (ctx->history_fd < 0) {
+    if ((ctx->history_fd = open(HISTORY_JOURNAL_PATH, O_WRONLY | O_APPEND | O_CREAT, 0644)) < 0) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "fopen error(%s).\n", HISTORY_JOURNAL_PATH);
+    }
+    // Drop a torn record at the end, so that the following records are aligned.
+    struct stat stat_buf = { 0 };
+    if (fstat(ctx->history_fd, &stat_buf) == OK && stat_buf.st_size % HISTORY_RECORD_SIZE != 0) {
+      if (ftruncate(ctx->history_fd, stat_buf.st_size - stat_buf.st_size % HISTORY_RECORD_SIZE) != OK) {
+        ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to truncate file(%s).\n", HISTORY_JOURNAL_PATH);
+      }
+    }
+  }
 
-  read_or_write_ini(1, "./history.log", tape_id, "PR", &char_pr_cnt);
-  read_or_write_ini(1, "./history.log", tape_id, "OCM", &char_ocm_cnt);
-  read_or_write_ini(1, "./history.log", tape_id, "PO", &char_po_cnt);
-  read_or_write_ini(1, "./history.log", tape_id, "Object number", &char_obj_cnt);
+  uint8_t record[HISTORY_RECORD_SIZE] = { 0 };
+  pack_history_record(history, record);
+  if (write(ctx->history_fd, record, HISTORY_RECORD_SIZE) != HISTORY_RECORD_SIZE) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to write file(%s).\n", HISTORY_JOURNAL_PATH);
+  }
 
-  free(char_pr_cnt);
-  char_pr_cnt   = NULL;
-  free(char_ocm_cnt);
-  char_ocm_cnt  = NULL;
-  free(char_po_cnt);
-  char_po_cnt   = NULL;
-  free(char_obj_cnt);
-  char_obj_cnt  = NULL;
+  long int interval = 0;
+  get_interval(&interval);
+  if (ctx->history_interval < interval) {
+    ret |= commit_history();
+  }
 
-  if (interval < history_interval) {
-    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "No disk space(%s).\n", obj_save_path);
+  // Disk space is checked only at the beginning of a packed object, as before.
+  if (history->obj_cnt <= history->done_obj_cnt || history->written_size != 0) {
+    return ret;
+  }
+  if (check_disk_space(ctx->obj_save_path, 0) != OK) {
+    ret |= commit_history();
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "No disk space(%s).\n", ctx->obj_save_path);
   }
 
   return ret;
 }
 
 /**
- * Get history information from history.log.
- * @param [out]    (tape_id)  barcode id
- * @param [out]    (pr_cnt)   What number is the pr, which include the last output object, from the beginning.
- * @param [out]    (ocm_cnt)  What number is the ocm, which include the last output object, from the beginning.
- * @param [out]    (po_cnt)   What number is the po, which include the last output object, from the beginning.
- * @param [in/out] (obj_cnt)  How many objects have been read.
+ * Get history information from history.log created by the former version.
+ * @param [in]     (tape_id)  barcode id
+ * @param [out]    (history)  History record.
  * @return         (OK/NG)    If success, return OK. Otherwise, return NG.
  */
-int get_history(const char* tape_id, uint64_t* pr_cnt, uint64_t* ocm_cnt, uint64_t* po_cnt, uint64_t* obj_cnt) {
+static int get_legacy_history(const char* tape_id, history_record* const history) {
   int ret = OK;
-  ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_history\n");
+  ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_legacy_history\n");
 
   struct stat stat_buf    = { 0 };
-  if(stat("./history.log", &stat_buf) != OK) {
+  if(stat(LEGACY_HISTORY_PATH, &stat_buf) != OK) {
     return NG;
   }
   char* char_pr_cnt  = (char*)clf_allocate_memory(STR_MAX, "char_pr_cnt");
   char* char_ocm_cnt = (char*)clf_allocate_memory(STR_MAX, "char_ocm_cnt");
   char* char_po_cnt  = (char*)clf_allocate_memory(STR_MAX, "char_po_cnt");
   char* char_obj_cnt = (char*)clf_allocate_memory(STR_MAX, "char_obj_cnt");
-  read_or_write_ini(0, "./history.log", tape_id, "PR", &char_pr_cnt);
-  read_or_write_ini(0, "./history.log", tape_id, "OCM", &char_ocm_cnt);
-  read_or_write_ini(0, "./history.log", tape_id, "PO", &char_po_cnt);
-  read_or_write_ini(0, "./history.log", tape_id, "Object number", &char_obj_cnt);
-  *pr_cnt  = atol(char_pr_cnt);
-  *ocm_cnt = atol(char_ocm_cnt);
-  *po_cnt  = atol(char_po_cnt);
-  *obj_cnt = atol(char_obj_cnt);
+  read_or_write_ini(0, LEGACY_HISTORY_PATH, tape_id, "PR", &char_pr_cnt);
+  read_or_write_ini(0, LEGACY_HISTORY_PATH, tape_id, "OCM", &char_ocm_cnt);
+  read_or_write_ini(0, LEGACY_HISTORY_PATH, tape_id, "PO", &char_po_cnt);
+  read_or_write_ini(0, LEGACY_HISTORY_PATH, tape_id, "Object number", &char_obj_cnt);
+  history->pr_cnt       = atol(char_pr_cnt);
+  history->ocm_cnt      = atol(char_ocm_cnt);
+  history->po_cnt       = atol(char_po_cnt);
+  history->obj_cnt      = atol(char_obj_cnt);
+  history->done_obj_cnt = (history->obj_cnt == 0) ? 0 : history->obj_cnt - 1;
+  history->written_size = 0;
+  if (history->pr_cnt == 0 || history->ocm_cnt == 0 || history->po_cnt == 0 || history->obj_cnt == 0) {
+    ret = NG;
+  }
   free(char_pr_cnt);
   char_pr_cnt  = NULL;
   free(char_ocm_cnt);
@@ -444,6 +605,130 @@ int get_history(const char* tape_id, uint64_t* pr_cnt, uint64_t* ocm_cnt, uint64
   return ret;
 }
 
+/**
+ * Get history information by replaying the journal.
+ * The last valid record of the tape wins, and torn or corrupted records are ignored.
+ * If there is no journal, history.log created by the former version is read.
+ * @param [in]     (tape_id)  barcode id
+ * @param [out]    (history)  Progress of the dump to resume.
+ * @return         (OK/NG)    If success, return OK. Otherwise, return NG.
+ */
+int get_history(const char* tape_id, history_record* const history) {
+  int ret = OK;
+  ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_history\n");
+
+  FILE* fp = NULL;
+  if ((fp = fopen(HISTORY_JOURNAL_PATH, "rb")) == NULL) {
+    if (get_legacy_history(tape_id, history) == NG) {
+      return NG;
+    }
+  } else {
+    uint8_t record[HISTORY_RECORD_SIZE] = { 0 };
+    history_record current              = { 0 };
+    uint64_t invalid_num                = 0;
+    Bool found_flag                     = false;
+    while (fread(record, 1, HISTORY_RECORD_SIZE, fp) == HISTORY_RECORD_SIZE) {
+      if (unpack_history_record(record, &current) != OK) {
+        invalid_num++;
+        continue;
+      }
+      if (strncmp(current.tape_id, tape_id, BARCODE_SIZE) == 0) {
+        *history   = current;
+        found_flag = true;
+      }
+    }
+    fclose(fp);
+    fp = NULL;
+    if (invalid_num != 0) {
+      ret |= output_accdg_to_vl(OUTPUT_WARNING, DEFAULT, "%lu broken record(s) in %s are ignored.\n", invalid_num, HISTORY_JOURNAL_PATH);
+    }
+    if (found_flag == false) {
+      return NG;
+    }
+  }
+  return ret;
+}
+
+/**
+ * Flush the journal and compact it to the last record of each tape.
+ * It is called when either Full dump or Resume dump completes.
+ * @return (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+int close_history(void) {
+  reader_context* const ctx = get_reader_context();
+  int ret = OK;
+  ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:close_history\n");
+
+  if (ctx->history_fd < 0) {
+    return ret;
+  }
+  ret |= commit_history();
+  close(ctx->history_fd);
+  ctx->history_fd = -1;
+
+  FILE* fp = NULL;
+  if ((fp = fopen(HISTORY_JOURNAL_PATH, "rb")) == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "fopen error(%s).\n", HISTORY_JOURNAL_PATH);
+  }
+  uint64_t history_num                = 0;
+  uint64_t history_capacity           = 1;
+  history_record* histories           = (history_record*)clf_allocate_memory(sizeof(history_record) * history_capacity, "histories");
+  uint8_t record[HISTORY_RECORD_SIZE] = { 0 };
+  history_record current              = { 0 };
+  while (fread(record, 1, HISTORY_RECORD_SIZE, fp) == HISTORY_RECORD_SIZE) {
+    if (unpack_history_record(record, &current) != OK) {
+      continue;
+    }
+    uint64_t i = 0;
+    for (i = 0; i < history_num; i++) { // A journal holds a few tapes, so the linear search is enough.
+      if (strncmp(histories[i].tape_id, current.tape_id, BARCODE_SIZE) == 0) {
+        break;
+      }
+    }
+    if (i == history_capacity) {
+      history_capacity *= 2;
+      if ((histories = (history_record*)realloc(histories, sizeof(history_record) * history_capacity)) == NULL) {
+        ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to allocate memory for histories.\n");
+      }
+    }
+    histories[i] = current;
+    if (i == history_num) {
+      history_num++;
+    }
+  }
+  fclose(fp);
+  fp = NULL;
+
+  char journal_temp[] = HISTORY_JOURNAL_PATH "_temp";
+  int fd = -1;
+  if ((fd = open(journal_temp, O_WRONLY | O_TRUNC | O_CREAT, 0644)) < 0) {
+    free(histories);
+    histories = NULL;
+    return output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "fopen error(%s).\n", journal_temp);
+  }
+  for (uint64_t i = 0; i < history_num; i++) {
+    pack_history_record(&histories[i], record);
+    if (write(fd, record, HISTORY_RECORD_SIZE) != HISTORY_RECORD_SIZE) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "Failed to write file(%s).\n", journal_temp);
+    }
+  }
+  free(histories);
+  histories = NULL;
+  if (fsync(fd) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "fsync error(%s).\n", journal_temp);
+  }
+  close(fd);
+  if (ret == OK) {
+    if (rename(journal_temp, HISTORY_JOURNAL_PATH) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DEFAULT, "Failed to rename %s to %s.\n", journal_temp, HISTORY_JOURNAL_PATH);
+    }
+  } else {
+    remove(journal_temp);
+  }
+
+  return ret;
+}
+
 /**
  * Initialize BucketInfo4ObjReader .
  * @param [in/out] (bucket_info_4_obj_reader) bucket info structure
@@ -554,6 +839,50 @@ int get_bucket_info_4_obj_reader(BucketInfo4ObjReader** bucket_info_4_obj_reader
   return ret;
 }
 
+/**
+ * Get the save directory of a bucket without counting an object.
+ * @param [in]  (bucket_info_4_obj_reader) bucket info
+ * @param [in]  (bucket_name)              bucket name
+ * @param [out] (savepath_dir_number)      xxxx ({save_path}\{bucket name}\xxxx\yyyy)
+ * @param [out] (savepath_sub_dir_number)  yyyy ({save_path}\{bucket name}\xxxx\yyyy)
+ * @param [out] (obj_reader_saved_counter) Objects already saved in yyyy.
+ * @return      (OK/NG)                    If the bucket is found, return OK. Otherwise, return NG.
+ */
+int get_bucket_save_state(const BucketInfo4ObjReader* const bucket_info_4_obj_reader, const char* const bucket_name,
+                          int* const savepath_dir_number, int* const savepath_sub_dir_number, int* const obj_reader_saved_counter) {
+  for (const BucketInfo4ObjReader* current = bucket_info_4_obj_reader; current != NULL; current = current->next) {
+    if (strcmp(current->bucket_name, bucket_name) == 0) {
+      *savepath_dir_number      = current->savepath_dir_number;
+      *savepath_sub_dir_number  = current->savepath_sub_dir_number;
+      *obj_reader_saved_counter = current->obj_reader_saved_counter;
+      return OK;
+    }
+  }
+  return NG;
+}
+
+/**
+ * Set the save directory of a bucket, so that the following objects are saved as the former run did.
+ * @param [in/out] (bucket_info_4_obj_reader) bucket info
+ * @param [in]     (bucket_name)              bucket name
+ * @param [in]     (savepath_dir_number)      xxxx ({save_path}\{bucket name}\xxxx\yyyy)
+ * @param [in]     (savepath_sub_dir_number)  yyyy ({save_path}\{bucket name}\xxxx\yyyy)
+ * @param [in]     (obj_reader_saved_counter) Objects already saved in yyyy.
+ * @return         (OK/NG)                    If the bucket is found, return OK. Otherwise, return NG.
+ */
+int set_bucket_save_state(BucketInfo4ObjReader* const bucket_info_4_obj_reader, const char* const bucket_name,
+                          const int savepath_dir_number, const int savepath_sub_dir_number, const int obj_reader_saved_counter) {
+  for (BucketInfo4ObjReader* current = bucket_info_4_obj_reader; current != NULL; current = current->next) {
+    if (strcmp(current->bucket_name, bucket_name) == 0) {
+      current->savepath_dir_number      = savepath_dir_number;
+      current->savepath_sub_dir_number  = savepath_sub_dir_number;
+      current->obj_reader_saved_counter = obj_reader_saved_counter;
+      return OK;
+    }
+  }
+  return NG;
+}
+
 /**
  * Update bucket info.
  * @param [in/out] (bucket_info_4_obj_reader) bucket info
@@ -599,7 +928,8 @@ static int mk_a_dir(const char *dirpath) {
 
   struct stat stat_buf    = { 0 };
   if(stat(dirpath, &stat_buf) != OK) {
-    if(mkdir(dirpath, stat_buf.st_mode) != OK) {
+    // Another thread may make the same directory at the same time.
+    if(mkdir(dirpath, stat_buf.st_mode) != OK && errno != EEXIST) {
       ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to make directory.\n");
     }
   }
@@ -635,7 +965,56 @@ int mk_deep_dir(const char *dirpath) {
 }
 
 /**
- * Copy directory.
+ * Copy a regular file.
+ * The data is copied in kernel with copy_file_range, which shares the extents on a file system supporting reflink.
+ * @param [in]  (filepath_from) file path
+ * @param [in]  (filepath_to)   file path
+ * @param [in]  (mode)          permission of the file
+ * @return      (OK/NG)         If success, return OK. Otherwise, return NG.
+ */
+static int cp_a_file(const char *filepath_from, const char *filepath_to, const mode_t mode) {
+  int fd_from = open(filepath_from, O_RDONLY);
+  if (fd_from < 0) {
+    return NG;
+  }
+  int fd_to = open(filepath_to, O_WRONLY | O_CREAT | O_TRUNC, mode);
+  if (fd_to < 0) { // Same as "cp -f", remove the destination and try again.
+    remove(filepath_to);
+    fd_to = open(filepath_to, O_WRONLY | O_CREAT | O_TRUNC, mode);
+  }
+  if (fd_to < 0) {
+    close(fd_from);
+    return NG;
+  }
+
+  int ret = OK;
+  ssize_t copied_size = 0;
+  while ((copied_size = copy_file_range(fd_from, NULL, fd_to, NULL, COPY_CHUNK_SIZE, 0)) > 0) {
+  }
+  if (copied_size < 0) { // copy_file_range is not supported between the file systems, so copy it in user space.
+    char* buf = (char*)clf_allocate_memory(COPY_CHUNK_SIZE, "buf");
+    ssize_t read_size = 0;
+    while ((read_size = read(fd_from, buf, COPY_CHUNK_SIZE)) > 0) {
+      if (write(fd_to, buf, read_size) != read_size) {
+        ret = NG;
+        break;
+      }
+    }
+    if (read_size < 0) {
+      ret = NG;
+    }
+    free(buf);
+    buf = NULL;
+  }
+  close(fd_from);
+  if (close(fd_to) != OK) {
+    ret = NG;
+  }
+  return ret;
+}
+
+/**
+ * Copy all files and directories in a directory recursively, in the same way as "cp -rf" of the entries in dirpath_from into dirpath_to.
  * @param [in]  (dirpath_from) directory path
  * @param [in]  (dirpath_to)   directory path
  * @return      (OK/NG)        If success, return OK. Otherwise, return NG.
@@ -643,14 +1022,110 @@ int mk_deep_dir(const char *dirpath) {
 int cp_dir(const char *dirpath_from, const char *dirpath_to) {
   int ret = OK;
   ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:cp_dir\n");
-  char command_buff[COMMAND_SIZE + 1]       = { '\0' };
 
-  sprintf(command_buff, "cp -rf %s %s", dirpath_from, dirpath_to);
-  if (WEXITSTATUS(system(command_buff)) != OK) {
+  DIR* dir = opendir(dirpath_from);
+  if (dir == NULL) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to copy (%s) to (%s).\n"
                               , dirpath_from, dirpath_to);
     return ret;
   }
+  struct stat dir_stat_buf = { 0 };
+  if (stat(dirpath_to, &dir_stat_buf) != OK) {
+    stat(dirpath_from, &dir_stat_buf);
+    if (mkdir(dirpath_to, dir_stat_buf.st_mode & 0777) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to make directory.\n");
+    }
+  }
+
+  struct dirent* entry = NULL;
+  while ((entry = readdir(dir)) != NULL) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+      continue;
+    }
+    char path_from[MAX_PATH + 1] = { '\0' };
+    char path_to[MAX_PATH + 1]   = { '\0' };
+    snprintf(path_from, sizeof(path_from), "%s/%s", dirpath_from, entry->d_name);
+    snprintf(path_to, sizeof(path_to), "%s/%s", dirpath_to, entry->d_name);
+    struct stat stat_buf = { 0 };
+    if (stat(path_from, &stat_buf) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "Failed to copy (%s) to (%s).\n", path_from, path_to);
+      continue;
+    }
+    if (S_ISDIR(stat_buf.st_mode)) {
+      ret |= cp_dir(path_from, path_to);
+    } else if (cp_a_file(path_from, path_to, stat_buf.st_mode & 0777) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to copy (%s) to (%s).\n", path_from, path_to);
+    }
+  }
+  closedir(dir);
+  dir = NULL;
+
+  return ret;
+}
+
+/**
+ * Check if a tape device exists, in the same way as "lsscsi -g | grep tape | grep <device_name>".
+ * SCSI devices are enumerated in sysfs, and the device name is searched in "/dev/stX /dev/sgX" of each tape device.
+ * @param [in]  (device_name) device name
+ * @return      (OK/NG)       If the tape device exists, return OK. Otherwise, return NG.
+ */
+int find_tape_device(const char* const device_name) {
+  int ret = NG;
+  output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:find_tape_device\n");
+
+  DIR* scsi_dir = opendir(SYSFS_SCSI_DEVICE_PATH);
+  if (scsi_dir == NULL) {
+    return ret;
+  }
+  struct dirent* scsi_entry = NULL;
+  while (ret == NG && (scsi_entry = readdir(scsi_dir)) != NULL) {
+    char path[MAX_PATH + 1] = { '\0' };
+    char type[8]            = { '\0' };
+    snprintf(path, sizeof(path), "%s/%s/type", SYSFS_SCSI_DEVICE_PATH, scsi_entry->d_name);
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) { // Not a SCSI device but a host or a target.
+      continue;
+    }
+    if (fgets(type, sizeof(type), fp) == NULL) {
+      type[0] = '\0';
+    }
+    fclose(fp);
+    fp = NULL;
+    if (atoi(type) != SCSI_TYPE_TAPE) {
+      continue;
+    }
+
+    // Same as the device columns of "lsscsi -g", e.g. "/dev/st0 /dev/sg1".
+    char device_names[MAX_PATH + 1] = { '\0' };
+    const char* const classes[]     = { "scsi_tape", "scsi_generic" };
+    for (int i = 0; i < 2; i++) {
+      snprintf(path, sizeof(path), "%s/%s/%s", SYSFS_SCSI_DEVICE_PATH, scsi_entry->d_name, classes[i]);
+      DIR* class_dir = opendir(path);
+      if (class_dir == NULL) {
+        continue;
+      }
+      struct dirent* class_entry = NULL;
+      while ((class_entry = readdir(class_dir)) != NULL) {
+        const char* const name = class_entry->d_name;
+        if (name[0] == '.') {
+          continue;
+        }
+        // Only the primary node "stX" is listed for a tape, not "nstX" or "stXl" etc.
+        if (i == 0 && (strncmp(name, "st", 2) != 0 || strspn(name + 2, "0123456789") != strlen(name + 2))) {
+          continue;
+        }
+        const size_t used_size = strlen(device_names);
+        snprintf(device_names + used_size, sizeof(device_names) - used_size, " /dev/%s", name);
+      }
+      closedir(class_dir);
+      class_dir = NULL;
+    }
+    if (strstr(device_names, device_name) != NULL) {
+      ret = OK;
+    }
+  }
+  closedir(scsi_dir);
+  scsi_dir = NULL;
 
   return ret;
 }
@@ -684,7 +1159,7 @@ int extract_dir_path(const char* restrict filepath, char* dirpath) {
  * @param [out] (hash)  result of md5sum
  * @return      (OK/NG) If success to get a md5sum, return OK. Otherwise, return NG.
  */
-static int get_md5(const unsigned char const *src, char *hash) {
+int get_md5(const unsigned char* const src, char* hash) {
   int ret                             = OK;
   MD5_CTX c                           = { 0 };
   unsigned char md[MD5_DIGEST_LENGTH] = { 0 };
@@ -706,43 +1181,13 @@ static int get_md5(const unsigned char const *src, char *hash) {
   return ret;
 }
 
-/**
- * OBSOLETE: Use get_md5sum function instead.
- * Get result of md5sum.
- * @param [in]  (meta_data) meta data
- * @param [out] (hash)      result of md5sum
- * @return      (OK/NG)     If success to get object size, return OK. Otherwise, return NG.
- */
-//static int get_hash(const char* const meta_data, char* hash) {
-//  int ret = OK;
-//  FILE* out = NULL;
-//  char* command_buff = (char*)clf_allocate_memory(META_MAX_SIZE + 1, "command_buff");
-//  char result_buff[32 + 1]  = { '\0' };
-//
-//  sprintf(command_buff, "echo -n \"%s\" | md5sum >%s", meta_data, MD5SUM_CMD_LOG_PATH);
-//  if (strlen(command_buff) > META_MAX_SIZE) {
-//	  ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Meta size(%d) is too big. It must not be bigger than %d.\n", strlen(meta_data), META_MAX_SIZE - strlen(MD5SUM_CMD_LOG_PATH) - strlen("echo -n \"\" | md5sum >"));
-//  }
-//  system(command_buff);
-//  free(command_buff);
-//  command_buff = NULL;
-//  out = fopen(MD5SUM_CMD_LOG_PATH,"r");
-//  if (out == NULL) {
-//    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to run \"md5sum\" commmand.\n");
-//  }
-//  fgets(result_buff, sizeof(result_buff), out);
-//  sprintf(hash, result_buff);
-//  (void) fclose(out);
-//  out = NULL;
-//  return ret;
-//}
-
 /**
  * Get object size from metadata.
  * @param [in]  (meta_data)   meta data
  * @param [out] (object_size) object size
  * @param [out] (object_key)  object key
  * @param [out] (object_id)   object id
+ * @param [out] (content_md5) ContentMd5 of MAX_PATH bytes at most. Empty if it is longer, so that it is not verified.
  * @return      (OK/NG)       If success to get object size, return OK. Otherwise, return NG.
  */
 int get_element_from_metadata(const char* const meta_data, uint64_t* object_size, char* object_key, char* object_id,
@@ -751,7 +1196,9 @@ int get_element_from_metadata(const char* const meta_data, uint64_t* object_size
   ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_element_from_metadata\n");
 
   json_object* jobj_from_meta_data = NULL;
+  const uint64_t start = start_metric_timer();
   jobj_from_meta_data = json_tokener_parse(meta_data);
+  observe_metric_timer(METRIC_JSON_PARSE, start);
   json_object_object_foreach(jobj_from_meta_data, key, val) {
     if (!strcmp(key, "Size") && object_size != NULL) {
       *object_size = json_object_get_int64(val);
@@ -770,6 +1217,13 @@ int get_element_from_metadata(const char* const meta_data, uint64_t* object_size
       strcpy(last_modified, json_object_get_string(val));
     } else if (!strcmp(key, "Version") && version_id != NULL) {
       strcpy(version_id, json_object_get_string(val));
+    } else if (!strcmp(key, "ContentMd5") && content_md5 != NULL) {
+      const char* const value = json_object_get_string(val);
+      if (value != NULL && strlen(value) <= MAX_PATH) {
+        strcpy(content_md5, value);
+      } else {
+        content_md5[0] = '\0';
+      }
     }
   }
 
@@ -1122,15 +1576,16 @@ int clf_close_file(FILE* const stream) {
  * @return      Return file pointer.
  */
 static FILE* open_file(const char* filename, const char* mode, const int index) {
-  static FILE* fp[2] = { NULL };
-  static char prev_filename[2][4096] = { { '\0' } };
+  reader_context* const ctx                        = get_reader_context();
+  FILE** const fp                                  = ctx->open_file_fp;
+  char (*const prev_filename)[OPEN_FILE_NAME_SIZE] = ctx->open_file_name;
 
   // Check arguments.
   if (filename == NULL || mode == NULL) {
     output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
                        "Invalid argument at open_file. filename %d and/or mode %d is NULL.\n", filename, mode);
   }
-  if (index < 0 || 2 <= index) {
+  if (index < 0 || OPEN_FILE_CACHE_SIZE <= index) {
     output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
                        "Invalid argument at open_file. index %d should be 0 or 1.\n", index);
   }
@@ -1211,6 +1666,7 @@ size_t clf_read_file(void* const ptr, const size_t size, const size_t nobj, FILE
 int write_object_and_meta_to_file(const char* data, const uint64_t object_size, const uint64_t str_offset, const char* filepath) {
   int ret = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:write_object_and_meta_to_file(%s)\n",filepath);
 
+  const uint64_t start = start_metric_timer();
   struct stat stat_buf = { 0 };
   char* dirpath  = (char*)clf_allocate_memory(strlen(filepath), "dirpath");
   extract_dir_path(filepath, dirpath);
@@ -1226,14 +1682,21 @@ int write_object_and_meta_to_file(const char* data, const uint64_t object_size,
   if (fp_object == NULL) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Can't open file: %s\n", filepath);
   }
+  add_unsynced_file(filepath);
   if (0 < object_size) {
     if (fwrite(data + str_offset, object_size, 1, fp_object) < 1) {
 	    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to output %s.Disk space is likely to insufficient.\n", filepath);
     }
+    commit_disk_space(object_size);
+    add_metric_counter(METRIC_OUTPUT_BYTES, object_size);
+#ifdef OBJ_READER
+    add_progress_written_size(object_size);
+#endif
   }
 
   fclose(fp_object);
   fp_object = NULL;
+  observe_metric_timer(METRIC_OUTPUT_WRITE, start);
   return ret;
 }
 
@@ -1287,6 +1750,78 @@ double compare_time_string(const char *first_time_string, const char *second_tim
   return diff_time;
 }
 
+/**
+ * Convert a UTC string to nanoseconds since the Unix epoch.
+ * Only integer arithmetic is used so that the result does not depend on TZ or locale.
+ * @param [in]  (time_string) UTC like "2021-01-23T04:56:07.890123Z" (fraction may have 0-9 digits).
+ * @param [out] (epoch_ns)    Nanoseconds since 1970-01-01T00:00:00Z.
+ * @return      (OK/NG)       NG if time_string is not in the expected format.
+ */
+int convert_utc_to_epoch_ns(const char* const time_string, uint64_t* const epoch_ns) {
+  const char* p   = time_string;
+  int64_t field[6] = { 0 };
+  const char delim[6] = { '-', '-', 'T', ':', ':', '\0' };
+  const int  width[6] = { 4, 2, 2, 2, 2, 2 };
+
+  if (time_string == NULL || epoch_ns == NULL) {
+    return NG;
+  }
+  *epoch_ns = 0;
+
+  // Read YYYY-MM-DDTHH:MM:SS.
+  for (int i = 0; i < 6; i++) {
+    for (int digit = 0; digit < width[i]; digit++, p++) {
+      if (*p < '0' || '9' < *p) {
+        return NG;
+      }
+      field[i] = field[i] * 10 + (*p - '0');
+    }
+    if (delim[i] != '\0' && *p++ != delim[i]) {
+      return NG;
+    }
+  }
+  if (field[1] < 1 || 12 < field[1] || field[2] < 1 || 31 < field[2]) {
+    return NG;
+  }
+  // A leap second is 60.
+  if (23 < field[3] || 59 < field[4] || 60 < field[5]) {
+    return NG;
+  }
+
+  // Read fractional seconds and scale them to nanoseconds.
+  uint64_t nsec = 0;
+  int      nsec_digits = 0;
+  if (*p == '.') {
+    for (p++; '0' <= *p && *p <= '9'; p++) {
+      if (nsec_digits < 9) {
+        nsec = nsec * 10 + (*p - '0');
+        nsec_digits++;
+      }
+    }
+  }
+  for (; nsec_digits < 9; nsec_digits++) {
+    nsec *= 10;
+  }
+  if (*p != 'Z' && *p != '\0') {
+    return NG;
+  }
+
+  // Days from civil date (proleptic Gregorian calendar).
+  const int64_t year  = field[0] - (field[1] <= 2);
+  const int64_t era   = year / 400;
+  const int64_t yoe   = year - era * 400;
+  const int64_t doy   = (153 * (field[1] + (field[1] > 2 ? -3 : 9)) + 2) / 5 + field[2] - 1;
+  const int64_t doe   = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  const int64_t days  = era * 146097 + doe - 719468;
+  const int64_t secs  = days * 86400 + field[3] * 3600 + field[4] * 60 + field[5];
+  if (secs < 0) {
+    return NG;
+  }
+
+  *epoch_ns = (uint64_t)secs * 1000000000ULL + nsec;
+  return OK;
+}
+
 /**
  * Get bucket name.
  * @param [in]  (bucket_list) bucket_list
@@ -0,0 +1,704 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file metrics.c
+ *
+ * Counters and latency histograms exported in Prometheus text exposition format.
+ *
+ * Each thread counts in its own block, so counting is a plain store without any lock or atomic read-modify-write.
+ * The exporter sums the blocks of all threads. Blocks are kept after their threads exit, so nothing is lost.
+ * The metrics are either written to a file for the textfile collector of node_exporter at an interval,
+ * or served over HTTP on a Unix socket. A summary of SCSI commands is also output at the end of a run.
+ */
+
+#include <pthread.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include "ltos_format_checker.h"
+
+typedef struct {
+  uint64_t count;
+  uint64_t sum;                                         // Microseconds.
+  uint64_t max;                                         // Microseconds.
+  uint64_t buckets[METRICS_BUCKETS];
+} metric_histogram;
+
+typedef struct {
+  uint32_t code;                                        // METRICS_SENSE_CODE_USED | sense key << 16 | ASC << 8 | ASCQ, or 0 if unused.
+  uint64_t count;
+} sense_code_count;
+
+typedef struct metrics_block {
+  uint64_t counters[METRIC_COUNTERS];
+  metric_histogram timers[METRIC_TIMERS];
+  metric_histogram scsi_commands[METRICS_SCSI_OPCODES];
+  sense_code_count check_conditions[METRICS_SENSE_CODES]; // Open addressing table.
+  uint64_t other_check_conditions[METRICS_SENSE_KEYS];  // CHECK CONDITION which did not fit in the table.
+  struct metrics_block* next;
+} metrics_block;
+
+typedef struct {
+  char* text;
+  size_t size;
+  size_t capacity;
+} metrics_text;
+
+static metrics_block* metrics_blocks          = NULL;   // Blocks of all threads.
+static __thread metrics_block* thread_metrics = NULL;
+static char metrics_target[MAX_PATH + 1]      = { '\0' };
+static int metrics_socket                     = -1;
+static int is_metrics_stopping                = false;
+static int is_metrics_running                 = false;
+static pthread_t metrics_exporter;
+static METRIC_PHASE metric_phase              = METRIC_PHASE_SETUP;
+static uint64_t metric_phase_cpu[METRIC_PHASES][2]; // User and system CPU time of each phase in microseconds.
+static uint64_t metric_phase_start[2];          // CPU time when the current phase was entered.
+
+static const char* const metric_timer_names[METRIC_TIMERS] = {
+  "tape_locate_duration_seconds", "output_write_duration_seconds", "json_parse_duration_seconds", "rp_parse_duration_seconds",
+  "data_verify_duration_seconds"
+};
+static const char* const metric_timer_helps[METRIC_TIMERS] = {
+  "Time of LOCATE including the seek. The count is the number of LOCATE.",
+  "Time of writing object data, metadata and archives.",
+  "Time of parsing object metadata as JSON.",
+  "Time of reading and parsing the reference partition.",
+  "Time of hashing object data to verify it with ContentMd5."
+};
+static const char* const metric_counter_names[METRIC_COUNTERS] = {
+  "tape_blocks_read_total", "tape_read_bytes_total", "output_written_bytes_total", "objects_total", "errors_total"
+};
+static const char* const metric_counter_helps[METRIC_COUNTERS] = {
+  "Blocks read from tape.", "Bytes read from tape.", "Bytes of object data, metadata and archives written.",
+  "Objects dumped, restored or listed.", "ERROR messages logged."
+};
+static const char* const metric_phase_names[METRIC_PHASES] = { "setup", "reference", "data" };
+static const char* const sense_key_names[METRICS_SENSE_KEYS] = {
+  "NO SENSE", "RECOVERED ERROR", "NOT READY", "MEDIUM ERROR", "HARDWARE ERROR", "ILLEGAL REQUEST", "UNIT ATTENTION", "DATA PROTECT",
+  "BLANK CHECK", "VENDOR SPECIFIC", "COPY ABORTED", "ABORTED COMMAND", "RESERVED", "VOLUME OVERFLOW", "MISCOMPARE", "COMPLETED"
+};
+
+/**
+ * Get the name of a SCSI command.
+ * @param [in]  (opcode) Operation code.
+ * @return               Name, or "UNKNOWN".
+ */
+static const char* get_scsi_command_name(const uint8_t opcode) {
+  switch (opcode) {
+  case 0x00: return "TEST UNIT READY";
+  case 0x01: return "REWIND";
+  case 0x03: return "REQUEST SENSE";
+  case 0x08: return "READ";
+  case 0x11: return "SPACE";
+  case 0x12: return "INQUIRY";
+  case 0x1A: return "MODE SENSE(6)";
+  case 0x2B: return "LOCATE(10)";
+  case 0x34: return "READ POSITION";
+  case 0x4D: return "LOG SENSE";
+  case 0x5A: return "MODE SENSE(10)";
+  case 0x8C: return "READ ATTRIBUTE";
+  case 0x91: return "SPACE(16)";
+  case 0x92: return "LOCATE(16)";
+  default:   return "UNKNOWN";
+  }
+}
+
+/**
+ * Get the counters of the current thread. They are allocated at the first call in the thread.
+ * @return      Counters of the current thread.
+ */
+static metrics_block* get_thread_metrics(void) {
+  if (__builtin_expect(thread_metrics == NULL, 0)) {
+    metrics_block* const block = (metrics_block*)calloc(1, sizeof(metrics_block));
+    if (block == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to allocate memory for metrics.\n");
+    }
+    block->next = __atomic_load_n(&metrics_blocks, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&metrics_blocks, &block->next, block, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    thread_metrics = block;
+  }
+  return thread_metrics;
+}
+
+/**
+ * Add a value to a counter owned by the current thread. The exporter may read it at the same time.
+ * @param [in/out] (counter) Counter.
+ * @param [in]     (value)   Value to be added.
+ */
+static inline void add_to_metric(uint64_t* const counter, const uint64_t value) {
+  __atomic_store_n(counter, *counter + value, __ATOMIC_RELAXED);
+}
+
+/**
+ * Add a latency to a histogram.
+ * @param [in/out] (histogram) Histogram owned by the current thread.
+ * @param [in]     (latency)   Latency in microseconds.
+ */
+static void observe_histogram(metric_histogram* const histogram, const uint64_t latency) {
+  int bucket = (latency <= 1) ? 0 : 64 - __builtin_clzll(latency - 1);
+  if (METRICS_BUCKETS - 1 < bucket) {
+    bucket = METRICS_BUCKETS - 1;
+  }
+  add_to_metric(&histogram->count, 1);
+  add_to_metric(&histogram->sum, latency);
+  add_to_metric(&histogram->buckets[bucket], 1);
+  if (histogram->max < latency) {
+    __atomic_store_n(&histogram->max, latency, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * Count CHECK CONDITION by sense key, ASC and ASCQ.
+ * Only the owner thread of the block adds a code, so a slot is filled without compare and swap.
+ * @param [in/out] (block) Counters owned by the current thread, or the total.
+ * @param [in]     (code)  METRICS_SENSE_CODE_USED | sense key << 16 | ASC << 8 | ASCQ.
+ * @param [in]     (count) Value to be added.
+ */
+static void count_sense_code(metrics_block* const block, const uint32_t code, const uint64_t count) {
+  uint32_t slot = ((code * 2654435761U) >> 16) & (METRICS_SENSE_CODES - 1);
+  for (int i = 0; i < METRICS_SENSE_CODES; i++, slot = (slot + 1) & (METRICS_SENSE_CODES - 1)) {
+    sense_code_count* const entry = &block->check_conditions[slot];
+    if (entry->code == code) {
+      add_to_metric(&entry->count, count);
+      return;
+    }
+    if (entry->code == 0) {
+      add_to_metric(&entry->count, count);
+      __atomic_store_n(&entry->code, code, __ATOMIC_RELEASE);
+      return;
+    }
+  }
+  add_to_metric(&block->other_check_conditions[(code >> 16) & 0x0F], count);
+}
+
+/**
+ * Start to measure a latency.
+ * @return      Current time in microseconds.
+ */
+uint64_t start_metric_timer(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (uint64_t)now.tv_sec * 1000000 + now.tv_usec;
+}
+
+/**
+ * Add the time since start_metric_timer() to a timer.
+ * @param [in]  (timer) Timer.
+ * @param [in]  (start) Value returned by start_metric_timer().
+ */
+void observe_metric_timer(const METRIC_TIMER timer, const uint64_t start) {
+  const uint64_t now = start_metric_timer();
+  observe_histogram(&get_thread_metrics()->timers[timer], (now > start) ? now - start : 0);
+}
+
+/**
+ * Add a value to a counter.
+ * @param [in]  (counter) Counter.
+ * @param [in]  (value)   Value to be added.
+ */
+void add_metric_counter(const METRIC_COUNTER counter, const uint64_t value) {
+  add_to_metric(&get_thread_metrics()->counters[counter], value);
+}
+
+/**
+ * Count a SCSI command and its latency.
+ * @param [in]  (opcode)    Operation code.
+ * @param [in]  (start)     Value returned by start_metric_timer() before the command.
+ * @param [in]  (status)    SCSI status.
+ * @param [in]  (sense_key) Sense key, which is counted for CHECK CONDITION with ASC and ASCQ.
+ * @param [in]  (asc)       Additional sense code.
+ * @param [in]  (ascq)      Additional sense code qualifier.
+ */
+void observe_scsi_command(const uint8_t opcode, const uint64_t start, const uint8_t status,
+                          const uint8_t sense_key, const uint8_t asc, const uint8_t ascq) {
+  metrics_block* const block = get_thread_metrics();
+  const uint64_t now         = start_metric_timer();
+  observe_histogram(&block->scsi_commands[opcode], (now > start) ? now - start : 0);
+  if (status == 0x02) { // CHECK CONDITION
+    count_sense_code(block, METRICS_SENSE_CODE_USED | (sense_key & 0x0F) << 16 | asc << 8 | ascq, 1);
+  }
+}
+
+/**
+ * Append a formatted string to the exposition text.
+ * @param [in/out] (text)   Text.
+ * @param [in]     (format) Format.
+ */
+static void append_metrics_text(metrics_text* const text, const char* const format, ...) {
+  va_list args;
+  va_start(args, format);
+  int size = vsnprintf(text->text + text->size, text->capacity - text->size, format, args);
+  va_end(args);
+  if (text->capacity - text->size <= (size_t)size) {
+    text->capacity = MAX(text->capacity * 2, text->size + size + 1);
+    text->text     = (char*)realloc(text->text, text->capacity);
+    if (text->text == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to allocate memory for metrics.\n");
+    }
+    va_start(args, format);
+    size = vsnprintf(text->text + text->size, text->capacity - text->size, format, args);
+    va_end(args);
+  }
+  text->size += size;
+}
+
+/**
+ * Add the histogram of another thread.
+ * @param [in/out] (total)     Total.
+ * @param [in]     (histogram) Histogram of a thread.
+ */
+static void sum_histogram(metric_histogram* const total, metric_histogram* const histogram) {
+  total->count += __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+  total->sum   += __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+  total->max    = MAX(total->max, __atomic_load_n(&histogram->max, __ATOMIC_RELAXED));
+  for (int i = 0; i < METRICS_BUCKETS; i++) {
+    total->buckets[i] += __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * Append the samples of a histogram.
+ * @param [in/out] (text)      Text.
+ * @param [in]     (name)      Name of the metric without the prefix.
+ * @param [in]     (labels)    Labels followed by a comma, or an empty string.
+ * @param [in]     (histogram) Histogram.
+ */
+static void append_histogram(metrics_text* const text, const char* const name, const char* const labels,
+                             const metric_histogram* const histogram) {
+  uint64_t cumulative = 0;
+  for (int i = 0; i < METRICS_BUCKETS - 1; i++) {
+    cumulative += histogram->buckets[i];
+    append_metrics_text(text, METRICS_PREFIX "%s_bucket{%sle=\"%.6f\"} %lu\n", name, labels, (double)(1UL << i) / 1000000, cumulative);
+  }
+  append_metrics_text(text, METRICS_PREFIX "%s_bucket{%sle=\"+Inf\"} %lu\n", name, labels, histogram->count);
+  if (labels[0] == '\0') {
+    append_metrics_text(text, METRICS_PREFIX "%s_sum %.6f\n", name, (double)histogram->sum / 1000000);
+    append_metrics_text(text, METRICS_PREFIX "%s_count %lu\n", name, histogram->count);
+  } else {
+    // Drop the comma after the labels.
+    append_metrics_text(text, METRICS_PREFIX "%s_sum{%.*s} %.6f\n", name, (int)strlen(labels) - 1, labels, (double)histogram->sum / 1000000);
+    append_metrics_text(text, METRICS_PREFIX "%s_count{%.*s} %lu\n", name, (int)strlen(labels) - 1, labels, histogram->count);
+  }
+}
+
+/**
+ * Sum the counters of all threads.
+ * @return      Total, which must be freed by the caller.
+ */
+static metrics_block* sum_metrics_blocks(void) {
+  metrics_block* const total = (metrics_block*)clf_allocate_memory(sizeof(metrics_block), "metrics");
+
+  memset(total, 0, sizeof(metrics_block));
+  for (metrics_block* block = __atomic_load_n(&metrics_blocks, __ATOMIC_ACQUIRE); block != NULL; block = block->next) {
+    for (int i = 0; i < METRIC_COUNTERS; i++) {
+      total->counters[i] += __atomic_load_n(&block->counters[i], __ATOMIC_RELAXED);
+    }
+    for (int i = 0; i < METRIC_TIMERS; i++) {
+      sum_histogram(&total->timers[i], &block->timers[i]);
+    }
+    for (int i = 0; i < METRICS_SCSI_OPCODES; i++) {
+      sum_histogram(&total->scsi_commands[i], &block->scsi_commands[i]);
+    }
+    for (int i = 0; i < METRICS_SENSE_CODES; i++) {
+      const uint32_t code = __atomic_load_n(&block->check_conditions[i].code, __ATOMIC_ACQUIRE);
+      if (code != 0) {
+        count_sense_code(total, code, __atomic_load_n(&block->check_conditions[i].count, __ATOMIC_RELAXED));
+      }
+    }
+    for (int i = 0; i < METRICS_SENSE_KEYS; i++) {
+      total->other_check_conditions[i] += __atomic_load_n(&block->other_check_conditions[i], __ATOMIC_RELAXED);
+    }
+  }
+  return total;
+}
+
+/**
+ * Make the exposition text of the sum of all threads.
+ * @param [out] (text) Text, which must be freed by the caller.
+ */
+static void make_metrics_text(metrics_text* const text) {
+  metrics_block* const total = sum_metrics_blocks();
+  char labels[MAX_PATH + 1]  = { '\0' };
+
+  text->capacity = METRICS_TEXT_SIZE;
+  text->size     = 0;
+  text->text     = (char*)clf_allocate_memory(text->capacity, "metrics text");
+
+  append_metrics_text(text, "# HELP " METRICS_PREFIX "scsi_command_duration_seconds Latency of SCSI commands by operation code.\n");
+  append_metrics_text(text, "# TYPE " METRICS_PREFIX "scsi_command_duration_seconds histogram\n");
+  for (int i = 0; i < METRICS_SCSI_OPCODES; i++) {
+    if (total->scsi_commands[i].count != 0) {
+      snprintf(labels, sizeof(labels), "opcode=\"0x%02X\",command=\"%s\",", i, get_scsi_command_name(i));
+      append_histogram(text, "scsi_command_duration_seconds", labels, &total->scsi_commands[i]);
+    }
+  }
+  append_metrics_text(text, "# HELP " METRICS_PREFIX "scsi_command_max_duration_seconds Maximum latency of SCSI commands by operation code.\n");
+  append_metrics_text(text, "# TYPE " METRICS_PREFIX "scsi_command_max_duration_seconds gauge\n");
+  for (int i = 0; i < METRICS_SCSI_OPCODES; i++) {
+    if (total->scsi_commands[i].count != 0) {
+      append_metrics_text(text, METRICS_PREFIX "scsi_command_max_duration_seconds{opcode=\"0x%02X\",command=\"%s\"} %.6f\n",
+                          i, get_scsi_command_name(i), (double)total->scsi_commands[i].max / 1000000);
+    }
+  }
+  append_metrics_text(text, "# HELP " METRICS_PREFIX "scsi_check_conditions_total CHECK CONDITION by sense key, ASC and ASCQ.\n");
+  append_metrics_text(text, "# TYPE " METRICS_PREFIX "scsi_check_conditions_total counter\n");
+  for (int i = 0; i < METRICS_SENSE_CODES; i++) {
+    const uint32_t code = total->check_conditions[i].code;
+    if (code != 0) {
+      append_metrics_text(text, METRICS_PREFIX "scsi_check_conditions_total{sense_key=\"0x%X\",name=\"%s\",asc=\"0x%02X\",ascq=\"0x%02X\"} %lu\n",
+                          (code >> 16) & 0x0F, sense_key_names[(code >> 16) & 0x0F], (code >> 8) & 0xFF, code & 0xFF,
+                          total->check_conditions[i].count);
+    }
+  }
+  for (int i = 0; i < METRICS_SENSE_KEYS; i++) {
+    if (total->other_check_conditions[i] != 0) {
+      append_metrics_text(text, METRICS_PREFIX "scsi_check_conditions_total{sense_key=\"0x%X\",name=\"%s\",asc=\"other\",ascq=\"other\"} %lu\n",
+                          i, sense_key_names[i], total->other_check_conditions[i]);
+    }
+  }
+  for (int i = 0; i < METRIC_COUNTERS; i++) {
+    append_metrics_text(text, "# HELP " METRICS_PREFIX "%s %s\n", metric_counter_names[i], metric_counter_helps[i]);
+    append_metrics_text(text, "# TYPE " METRICS_PREFIX "%s counter\n", metric_counter_names[i]);
+    append_metrics_text(text, METRICS_PREFIX "%s %lu\n", metric_counter_names[i], total->counters[i]);
+  }
+  for (int i = 0; i < METRIC_TIMERS; i++) {
+    append_metrics_text(text, "# HELP " METRICS_PREFIX "%s %s\n", metric_timer_names[i], metric_timer_helps[i]);
+    append_metrics_text(text, "# TYPE " METRICS_PREFIX "%s histogram\n", metric_timer_names[i]);
+    append_histogram(text, metric_timer_names[i], "", &total->timers[i]);
+  }
+  append_metrics_text(text, "# HELP " METRICS_PREFIX "log_dropped_messages_total Messages dropped because the log ring was full.\n");
+  append_metrics_text(text, "# TYPE " METRICS_PREFIX "log_dropped_messages_total counter\n");
+  append_metrics_text(text, METRICS_PREFIX "log_dropped_messages_total %lu\n", get_dropped_log_records());
+  free(total);
+}
+
+/**
+ * Write all bytes to a file descriptor.
+ * @param [in]  (fd)    File descriptor.
+ * @param [in]  (data)  Data.
+ * @param [in]  (size)  Size of the data.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int write_metrics_fd(const int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return NG;
+    }
+    data += written;
+    size -= written;
+  }
+  return OK;
+}
+
+/**
+ * Write the metrics to the textfile. It is written to a temporary file and renamed, so a collector never reads a partial file.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int write_metrics_textfile(void) {
+  char temp_path[MAX_PATH + 32] = { '\0' };
+  metrics_text text            = { 0 };
+  int ret                      = OK;
+
+  snprintf(temp_path, sizeof(temp_path), "%s.%d.tmp", metrics_target, (int)getpid());
+  const int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "Failed to open %s. error=%s\n", temp_path, strerror(errno));
+  }
+  make_metrics_text(&text);
+  ret |= write_metrics_fd(fd, text.text, text.size);
+  ret |= (close(fd) == 0) ? OK : NG;
+  free(text.text);
+  if (ret != OK || rename(temp_path, metrics_target) != 0) {
+    unlink(temp_path);
+    output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "Failed to write metrics to %s. error=%s\n", metrics_target, strerror(errno));
+    return NG;
+  }
+  return OK;
+}
+
+/**
+ * Reply the metrics to a client of the Unix socket as an HTTP response.
+ * The request is read but not parsed, so any path is answered with the metrics.
+ * @param [in]  (client) Socket of the client.
+ */
+static void reply_metrics(const int client) {
+  char request[METRICS_REQUEST_SIZE] = { '\0' };
+  char header[MAX_PATH + 1]          = { '\0' };
+  size_t request_size                = 0;
+  metrics_text text                  = { 0 };
+  struct pollfd pfd                  = { client, POLLIN, 0 };
+
+  // Wait for the end of the request header, but a client which sends nothing gets the metrics after the timeout.
+  while (request_size < sizeof(request) - 1 && strstr(request, "\r\n\r\n") == NULL && strstr(request, "\n\n") == NULL
+         && poll(&pfd, 1, METRICS_REQUEST_TIMEOUT) > 0) {
+    const ssize_t size = read(client, request + request_size, sizeof(request) - 1 - request_size);
+    if (size <= 0) {
+      break;
+    }
+    request_size += size;
+  }
+  make_metrics_text(&text);
+  const int header_size = snprintf(header, sizeof(header),
+                                   "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %lu\r\n\r\n",
+                                   (unsigned long)text.size);
+  if (write_metrics_fd(client, header, header_size) == OK) {
+    write_metrics_fd(client, text.text, text.size);
+  }
+  free(text.text);
+}
+
+/**
+ * Export the metrics until the exporter is stopped.
+ * @param [in]  (arg) Not used.
+ * @return            NULL.
+ */
+static void* export_metrics(void* arg) {
+  sigset_t sigpipe;
+  int elapsed = 0;  // Milliseconds since the last write of the textfile.
+  (void)arg;
+
+  // A client which closes the socket early must not kill the reader.
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe, NULL);
+
+  while (__atomic_load_n(&is_metrics_stopping, __ATOMIC_ACQUIRE) == false) {
+    if (metrics_socket >= 0) {
+      struct pollfd pfd = { metrics_socket, POLLIN, 0 };
+      if (poll(&pfd, 1, METRICS_POLL_TIMEOUT) > 0) {
+        const int client = accept(metrics_socket, NULL, NULL);
+        if (client >= 0) {
+          reply_metrics(client);
+          close(client);
+        }
+      }
+    } else {
+      poll(NULL, 0, METRICS_POLL_TIMEOUT);
+      elapsed += METRICS_POLL_TIMEOUT;
+      if (METRICS_INTERVAL * 1000 <= elapsed) {
+        write_metrics_textfile();
+        elapsed = 0;
+      }
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Start to export the metrics.
+ * @param [in]  (target) Path of the textfile, or "unix:" followed by the path of the Unix socket.
+ * @return      (OK/NG)  If success, return OK. Otherwise, return NG.
+ */
+int start_metrics_exporter(const char* const target) {
+  const size_t prefix_size = strlen(METRICS_UNIX_PREFIX);
+
+  if (strncmp(target, METRICS_UNIX_PREFIX, prefix_size) == 0) {
+    struct sockaddr_un address = { 0 };
+    struct stat stat_buf;
+    snprintf(metrics_target, sizeof(metrics_target), "%s", target + prefix_size);
+    if (sizeof(address.sun_path) <= strlen(metrics_target)) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The path of the metrics socket is too long.\n");
+    }
+    // A socket left by a previous run is removed, but a file or a directory is not.
+    if (stat(metrics_target, &stat_buf) == 0 && !S_ISREG(stat_buf.st_mode) && !S_ISDIR(stat_buf.st_mode)) {
+      unlink(metrics_target);
+    }
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, metrics_target);
+    metrics_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (metrics_socket < 0 || bind(metrics_socket, (struct sockaddr*)&address, sizeof(address)) != 0
+        || listen(metrics_socket, METRICS_LISTEN_BACKLOG) != 0
+        || pthread_create(&metrics_exporter, NULL, export_metrics, NULL) != 0) {
+      output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to open the metrics socket(%s). error=%s\n",
+                         metrics_target, strerror(errno));
+      if (metrics_socket >= 0) {
+        close(metrics_socket);
+        metrics_socket = -1;
+        unlink(metrics_target);
+      }
+      return NG;
+    }
+  } else {
+    snprintf(metrics_target, sizeof(metrics_target), "%s", target);
+    if (write_metrics_textfile() != OK || pthread_create(&metrics_exporter, NULL, export_metrics, NULL) != 0) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to start the metrics exporter(%s).\n", metrics_target);
+    }
+  }
+  is_metrics_running = true;
+  atexit(stop_metrics_exporter);
+  return OK;
+}
+
+/**
+ * Stop the exporter. The textfile is written with the final values, and the Unix socket is removed.
+ */
+void stop_metrics_exporter(void) {
+  if (is_metrics_running == false) {
+    return;
+  }
+  is_metrics_running = false;
+  __atomic_store_n(&is_metrics_stopping, true, __ATOMIC_RELEASE);
+  pthread_join(metrics_exporter, NULL);
+  if (metrics_socket >= 0) {
+    close(metrics_socket);
+    metrics_socket = -1;
+    unlink(metrics_target);
+  } else {
+    write_metrics_textfile();
+  }
+}
+
+/**
+ * Get the upper bound of the bucket which holds a percentile of a histogram.
+ * @param [in]  (histogram)  Histogram.
+ * @param [in]  (percentile) Percentile from 0 to 100.
+ * @return                   Upper bound in microseconds. For the last bucket, the maximum latency.
+ */
+static uint64_t get_histogram_percentile(const metric_histogram* const histogram, const int percentile) {
+  const uint64_t rank = (histogram->count * percentile + 99) / 100;
+  uint64_t cumulative = 0;
+  for (int i = 0; i < METRICS_BUCKETS - 1; i++) {
+    cumulative += histogram->buckets[i];
+    if (rank <= cumulative) {
+      return MIN(1UL << i, histogram->max);
+    }
+  }
+  return histogram->max;
+}
+
+/**
+ * Output the summary of SCSI commands: count, total, average, 99th percentile and maximum latency of each operation code,
+ * and CHECK CONDITION by sense key, ASC and ASCQ. Nothing is output if no SCSI command was issued.
+ * Register it with atexit() after start_log_ring() so that the summary is written before the log ring stops.
+ */
+void output_metrics_summary(void) {
+  if (!is_output_enabled(OUTPUT_INFO, DISPLAY_HEADER_INFO)) {
+    return;
+  }
+  metrics_block* const total = sum_metrics_blocks();
+  uint64_t commands          = 0;
+  for (int i = 0; i < METRICS_SCSI_OPCODES; i++) {
+    commands += total->scsi_commands[i].count;
+  }
+  if (commands == 0) {
+    free(total);
+    return;
+  }
+
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_HEADER_INFO, "SCSI command summary:\n");
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_HEADER_INFO, "  %-4s %-16s %10s %12s %10s %10s %10s\n",
+                     "OP", "COMMAND", "COUNT", "TOTAL(s)", "AVG(ms)", "P99(ms)", "MAX(ms)");
+  for (int i = 0; i < METRICS_SCSI_OPCODES; i++) {
+    const metric_histogram* const command = &total->scsi_commands[i];
+    if (command->count != 0) {
+      output_accdg_to_vl(OUTPUT_INFO, DISPLAY_HEADER_INFO, "  %02X   %-16s %10lu %12.3f %10.3f %10.3f %10.3f\n",
+                         i, get_scsi_command_name(i), command->count, (double)command->sum / 1000000,
+                         (double)command->sum / command->count / 1000, (double)get_histogram_percentile(command, 99) / 1000,
+                         (double)command->max / 1000);
+    }
+  }
+  for (int i = 0; i < METRICS_SENSE_CODES; i++) {
+    const uint32_t code = total->check_conditions[i].code;
+    if (code != 0) {
+      output_accdg_to_vl(OUTPUT_INFO, DISPLAY_HEADER_INFO, "  CHECK CONDITION %X/%02X/%02X (%s): %lu\n", (code >> 16) & 0x0F,
+                         (code >> 8) & 0xFF, code & 0xFF, sense_key_names[(code >> 16) & 0x0F], total->check_conditions[i].count);
+    }
+  }
+  for (int i = 0; i < METRICS_SENSE_KEYS; i++) {
+    if (total->other_check_conditions[i] != 0) {
+      output_accdg_to_vl(OUTPUT_INFO, DISPLAY_HEADER_INFO, "  CHECK CONDITION %X/other (%s): %lu\n",
+                         i, sense_key_names[i], total->other_check_conditions[i]);
+    }
+  }
+  for (int i = 0; i < METRIC_PHASES; i++) {
+    uint64_t user   = 0;
+    uint64_t system = 0;
+    get_metric_phase_cpu(i, &user, &system);
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_HEADER_INFO, "  CPU time of %s: %.3f seconds (user %.3f, system %.3f)\n",
+                       metric_phase_names[i], (double)(user + system) / 1000000, (double)user / 1000000, (double)system / 1000000);
+  }
+  free(total);
+}
+
+/**
+ * Get the sum of a counter of all threads.
+ * @param [in]  (counter) Counter.
+ * @return                Value of the counter.
+ */
+uint64_t get_metric_counter(const METRIC_COUNTER counter) {
+  uint64_t value = 0;
+  for (metrics_block* block = __atomic_load_n(&metrics_blocks, __ATOMIC_ACQUIRE); block != NULL; block = block->next) {
+    value += __atomic_load_n(&block->counters[counter], __ATOMIC_RELAXED);
+  }
+  return value;
+}
+
+/**
+ * Get the number of SCSI commands issued by all threads.
+ * @return      Number of SCSI commands.
+ */
+uint64_t get_metric_scsi_commands(void) {
+  uint64_t commands = 0;
+  for (metrics_block* block = __atomic_load_n(&metrics_blocks, __ATOMIC_ACQUIRE); block != NULL; block = block->next) {
+    for (int i = 0; i < METRICS_SCSI_OPCODES; i++) {
+      commands += __atomic_load_n(&block->scsi_commands[i].count, __ATOMIC_RELAXED);
+    }
+  }
+  return commands;
+}
+
+/**
+ * Add the CPU time of the process since the current phase was entered to the phase.
+ * The CPU time of all threads is counted, so the background threads are included in the phase of the main thread.
+ */
+static void close_metric_phase(void) {
+  struct rusage usage = { 0 };
+  getrusage(RUSAGE_SELF, &usage);
+  const uint64_t now[2] = { (uint64_t)usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec,
+                            (uint64_t)usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec };
+  for (int i = 0; i < 2; i++) {
+    metric_phase_cpu[metric_phase][i] += now[i] - metric_phase_start[i];
+    metric_phase_start[i]              = now[i];
+  }
+}
+
+/**
+ * Enter a phase of a run. The process is in METRIC_PHASE_SETUP when it starts.
+ * Only the main thread enters a phase.
+ * @param [in]  (phase) Phase to enter.
+ */
+void enter_metric_phase(const METRIC_PHASE phase) {
+  close_metric_phase();
+  metric_phase = phase;
+}
+
+/**
+ * Get the CPU time of a phase up to now.
+ * @param [in]  (phase)  Phase.
+ * @param [out] (user)   User CPU time in microseconds.
+ * @param [out] (system) System CPU time in microseconds.
+ */
+void get_metric_phase_cpu(const METRIC_PHASE phase, uint64_t* const user, uint64_t* const system) {
+  close_metric_phase();
+  *user   = metric_phase_cpu[phase][0];
+  *system = metric_phase_cpu[phase][1];
+}
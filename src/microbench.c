@@ -0,0 +1,465 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file microbench.c
+ *
+ * Microbenchmark of the marker parsers and the metadata handling, run with --microbench.
+ *
+ * The inputs are taken from a tape image made with --capture or --generate, so an image made with the same
+ * --generate spec gives the same inputs on every run: the first PR in the reference partition, the first OCM
+ * in the data partition, the first PO info in the OCM and the metadata of its first object.
+ * Each function is called in memory with these inputs. The calls in a sample are increased until a sample takes
+ * MICROBENCH_SAMPLE_USEC, and MICROBENCH_SAMPLES samples are taken. The time per unit (a call, an object,
+ * a pair or a decoded value) is written to stdout as a JSON object per line with its percentiles.
+ */
+
+#ifdef OBJ_READER
+#include "ltos_format_checker.h"
+
+typedef struct {
+  char* pr;                                             // First PR, terminated with NUL.
+  uint64_t pr_size;
+  uint64_t pr_count;                                    // OCMs in the PR directory.
+  uint64_t pr_dir_position;
+  char* ocm;                                            // First OCM, terminated with NUL.
+  uint64_t ocm_size;
+  uint64_t ocm_count;                                   // PO infos in the OCM directory.
+  uint64_t ocm_dir_position;
+  uint64_t* lengths;                                    // Directory entries of the PR or the OCM.
+  uint64_t* block_offsets;
+  uint64_t po_info_position;                            // First PO info in the OCM.
+  uint64_t po_info_length;
+  uint64_t po_dir_position;
+  uint64_t po_header_length;
+  uint64_t meta_position;
+  uint64_t num_of_obj;
+  LTOSObject* objects;
+  char* meta;                                           // Metadata of the first object, terminated with NUL.
+  uint64_t meta_size;
+  char object_key[MAX_PATH + 1];
+  char last_modified[MAX_PATH + 1];
+  char version_id[MAX_PATH + 1];
+  char content_md5[MAX_PATH + 1];
+  char object_id[UUID_SIZE + 1];
+  char* json;                                           // Key value pairs of a list record.
+  uint64_t decode_count;                                // Values decoded by r64 from the head of the OCM.
+  uint64_t values64[MICROBENCH_DECODE_SIZE / sizeof(uint64_t)];
+  uint32_t values32[MICROBENCH_DECODE_SIZE / sizeof(uint32_t)];
+  char* null_block;
+} microbench_fixture;
+
+typedef int (*microbench_function)(microbench_fixture* const fixture);
+
+typedef struct {
+  const char* name;
+  microbench_function function;
+  uint64_t units;                                       // Units processed by a call, which the time is divided by.
+  uint64_t bytes;                                       // Bytes processed by a call.
+  int verbose;                                          // Verbose level of the marker, as the reader sets it.
+} microbench_case;
+
+/**
+ * Append a block of the image to a marker.
+ * @param [in/out] (marker) Marker, which is reallocated.
+ * @param [in/out] (size)   Size of the marker.
+ * @param [in]     (fp)     Image at the data of the block.
+ * @param [in]     (length) Length of the block.
+ * @return         (OK/NG)  If the block is read, return OK. Otherwise, return NG.
+ */
+static int append_microbench_block(char** const marker, uint64_t* const size, FILE* const fp, const uint64_t length) {
+  // One more byte for NUL, so the marker can be printed as a string by clf_header.
+  char* const grown = (char*)realloc(*marker, *size + length + 1);
+  if (grown == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to allocate memory for a marker.\n");
+  }
+  *marker = grown;
+  if (fread(*marker + *size, 1, length, fp) != length) {
+    return NG;
+  }
+  *size += length;
+  (*marker)[*size] = '\0';
+  return OK;
+}
+
+/**
+ * Read the first PR and the first OCM of a tape image. A marker is the blocks up to the next filemark.
+ * @param [in/out] (fixture)    Fixture, whose markers are set.
+ * @param [in]     (image_path) Tape image.
+ * @return         (OK/NG)      If both markers are read, return OK. Otherwise, return NG.
+ */
+static int read_microbench_markers(microbench_fixture* const fixture, const char* const image_path) {
+  uint8_t header[TAPE_IMAGE_HEADER_SIZE]        = { 0 };
+  uint8_t record[TAPE_IMAGE_RECORD_HEADER_SIZE] = { 0 };
+  char identifier[IDENTIFIER_SIZE]              = { '\0' };
+  uint32_t version                              = 0;
+  char** marker                                 = NULL;    // Marker being read.
+  uint64_t* marker_size                         = NULL;
+  uint32_t marker_partition                     = 0;
+  int ret                                       = OK;
+  FILE* const fp                                = fopen(image_path, "rb");
+
+  if (fp == NULL || fread(header, TAPE_IMAGE_HEADER_SIZE, 1, fp) != 1 || memcmp(header, TAPE_IMAGE_MAGIC, TAPE_IMAGE_MAGIC_SIZE) != 0) {
+    if (fp != NULL) {
+      fclose(fp);
+    }
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "%s is not a tape image.\n", image_path);
+  }
+  r32(BIG, header + 8, &version, 1);
+  if (version != TAPE_IMAGE_VERSION) {
+    fclose(fp);
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Version %u of the tape image is not supported.\n", version);
+  }
+
+  while (ret == OK && (fixture->pr == NULL || fixture->ocm == NULL || marker != NULL)) {
+    uint32_t type      = 0;
+    uint32_t partition = 0;
+    uint64_t length    = 0;
+    if (fread(record, TAPE_IMAGE_RECORD_HEADER_SIZE, 1, fp) != 1) {
+      ret = NG;
+      break;
+    }
+    r32(BIG, record,      &type,      1);
+    r32(BIG, record + 4,  &partition, 1);
+    r64(BIG, record + 16, &length,    1);
+    if (marker != NULL) {
+      if (type == IMAGE_RECORD_BLOCK && partition == marker_partition) {
+        ret = append_microbench_block(marker, marker_size, fp, length);
+        continue;
+      }
+      marker = NULL;
+    }
+    if (type == IMAGE_RECORD_END) {
+      break;
+    }
+    if (type != IMAGE_RECORD_BLOCK || length < IDENTIFIER_SIZE) {
+      ret = (length == 0 || fseek(fp, length, SEEK_CUR) == 0) ? OK : NG;
+      continue;
+    }
+    if (fread(identifier, IDENTIFIER_SIZE, 1, fp) != 1 || fseek(fp, -IDENTIFIER_SIZE, SEEK_CUR) != 0) {
+      ret = NG;
+      break;
+    }
+    if (fixture->pr == NULL && partition == REFERENCE_PARTITION && !memcmp(identifier, PR_IDENTIFIER, IDENTIFIER_SIZE)) {
+      marker      = &fixture->pr;
+      marker_size = &fixture->pr_size;
+    } else if (fixture->ocm == NULL && partition == DATA_PARTITION && !memcmp(identifier, OCM_IDENTIFIER, IDENTIFIER_SIZE)) {
+      marker      = &fixture->ocm;
+      marker_size = &fixture->ocm_size;
+    }
+    if (marker != NULL) {
+      marker_partition = partition;
+      ret              = append_microbench_block(marker, marker_size, fp, length);
+    } else if (fseek(fp, length, SEEK_CUR) != 0) {
+      ret = NG;
+    }
+  }
+  fclose(fp);
+
+  if (ret != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to read the tape image %s.\n", image_path);
+  }
+  if (fixture->pr == NULL || fixture->ocm == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "No %s is found in the tape image %s.\n",
+                              (fixture->pr == NULL) ? "PR" : "OCM", image_path);
+  }
+  return OK;
+}
+
+/**
+ * Make the inputs of the microbenchmark from a tape image. The markers are parsed once here,
+ * which gives the positions of each part and confirms that the functions succeed with them.
+ * @param [out] (fixture)    Fixture.
+ * @param [in]  (image_path) Tape image.
+ * @return      (OK/NG)      If all inputs are made, return OK. Otherwise, return NG.
+ */
+static int load_microbench_fixture(microbench_fixture* const fixture, const char* const image_path) {
+  uint64_t position    = 0;
+  uint64_t data_length = 0;
+
+  if (read_microbench_markers(fixture, image_path) != OK) {
+    return NG;
+  }
+  set_top_verbose(DISPLAY_HEADER_AND_L43_INFO);
+  if (clf_header(PR_IDENTIFIER, fixture->pr, NULL, OFF, &position, &fixture->pr_count, &data_length) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "PR header format is not correct.\n");
+  }
+  fixture->pr_dir_position = position;
+  position                 = 0;
+  set_top_verbose(DISPLAY_HEADER_AND_L432_INFO);
+  if (clf_header(OCM_IDENTIFIER, fixture->ocm, NULL, OFF, &position, &fixture->ocm_count, &data_length) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "OCM header format is not correct.\n");
+  }
+  fixture->ocm_dir_position = position;
+  if (fixture->pr_count == 0 || fixture->ocm_count == 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The %s is empty.\n", (fixture->pr_count == 0) ? "PR" : "OCM");
+  }
+  fixture->lengths       = (uint64_t*)clf_allocate_memory(sizeof(uint64_t) * (MAX(fixture->pr_count, fixture->ocm_count) + 1), "lengths");
+  fixture->block_offsets = (uint64_t*)clf_allocate_memory(sizeof(uint64_t) * (MAX(fixture->pr_count, fixture->ocm_count) + 1), "block_offsets");
+  position               = fixture->pr_dir_position;
+  set_top_verbose(DISPLAY_HEADER_AND_L43_INFO);
+  if (clf_directory(PR_IDENTIFIER, fixture->pr, &position, fixture->pr_count, fixture->lengths, fixture->block_offsets) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "PR directory format is not correct.\n");
+  }
+  position = fixture->ocm_dir_position;
+  set_top_verbose(DISPLAY_HEADER_AND_L432_INFO);
+  if (clf_directory(OCM_IDENTIFIER, fixture->ocm, &position, fixture->ocm_count, fixture->lengths, fixture->block_offsets) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "OCM directory format is not correct.\n");
+  }
+  fixture->po_info_position = position;
+  fixture->po_info_length   = fixture->lengths[0];
+  if (fixture->po_info_position + fixture->po_info_length > fixture->ocm_size) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The first packed object info exceeds the OCM.\n");
+  }
+
+  set_top_verbose(DISPLAY_HEADER_AND_L4321_INFO);
+  if (cpof_po_header((unsigned char*)fixture->ocm, &position, &fixture->num_of_obj, &fixture->po_header_length) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "PO header format is not correct.\n");
+  }
+  fixture->po_dir_position = position;
+  fixture->objects         = (LTOSObject*)clf_allocate_memory(sizeof(LTOSObject) * (fixture->num_of_obj + 1), "objects");
+  if (cpof_object_directory((unsigned char*)fixture->ocm, &position, fixture->po_info_length, fixture->po_header_length,
+                            fixture->num_of_obj, fixture->objects) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Objects Directory format is not correct.\n");
+  }
+  fixture->meta_position = position;
+  if (cpof_only_meta((unsigned char*)fixture->ocm, &position, (int)fixture->num_of_obj, fixture->objects) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "At least one of Objects has an invalid Meta data.\n");
+  }
+
+  set_top_verbose(DEFAULT);
+
+  fixture->meta_size = fixture->objects[0].object_data_offset - fixture->objects[0].meta_data_offset;
+  fixture->meta      = (char*)clf_allocate_memory(fixture->meta_size + 1, "meta");
+  memcpy(fixture->meta, fixture->ocm + fixture->meta_position, fixture->meta_size);
+  uint64_t object_size = 0;
+  if (get_element_from_metadata(fixture->meta, &object_size, fixture->object_key, fixture->object_id,
+                                fixture->last_modified, fixture->version_id, fixture->content_md5) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to get elements from the metadata.\n");
+  }
+
+  fixture->json         = (char*)clf_allocate_memory(MAX_PATH, "json");
+  fixture->decode_count = MIN(MICROBENCH_DECODE_SIZE, fixture->ocm_size) / sizeof(uint64_t);
+  fixture->null_block   = (char*)clf_allocate_memory(LTOS_BLOCK_SIZE, "null_block");
+  return OK;
+}
+
+/**
+ * Release the inputs of the microbenchmark.
+ * @param [in/out] (fixture) Fixture.
+ */
+static void free_microbench_fixture(microbench_fixture* const fixture) {
+  free(fixture->pr);
+  free(fixture->ocm);
+  free(fixture->lengths);
+  free(fixture->block_offsets);
+  free(fixture->objects);
+  free(fixture->meta);
+  free(fixture->json);
+  free(fixture->null_block);
+}
+
+static int bench_clf_header_pr(microbench_fixture* const fixture) {
+  uint64_t position    = 0;
+  uint64_t count       = 0;
+  uint64_t data_length = 0;
+  return clf_header(PR_IDENTIFIER, fixture->pr, NULL, OFF, &position, &count, &data_length);
+}
+
+static int bench_clf_header_ocm(microbench_fixture* const fixture) {
+  uint64_t position    = 0;
+  uint64_t count       = 0;
+  uint64_t data_length = 0;
+  return clf_header(OCM_IDENTIFIER, fixture->ocm, NULL, OFF, &position, &count, &data_length);
+}
+
+static int bench_clf_directory_pr(microbench_fixture* const fixture) {
+  uint64_t position = fixture->pr_dir_position;
+  return clf_directory(PR_IDENTIFIER, fixture->pr, &position, fixture->pr_count, fixture->lengths, fixture->block_offsets);
+}
+
+static int bench_clf_directory_ocm(microbench_fixture* const fixture) {
+  uint64_t position = fixture->ocm_dir_position;
+  return clf_directory(OCM_IDENTIFIER, fixture->ocm, &position, fixture->ocm_count, fixture->lengths, fixture->block_offsets);
+}
+
+static int bench_cpof_po_header(microbench_fixture* const fixture) {
+  uint64_t position         = fixture->po_info_position;
+  uint64_t num_of_obj       = 0;
+  uint64_t po_header_length = 0;
+  return cpof_po_header((unsigned char*)fixture->ocm, &position, &num_of_obj, &po_header_length);
+}
+
+static int bench_cpof_object_directory(microbench_fixture* const fixture) {
+  uint64_t position = fixture->po_dir_position;
+  return cpof_object_directory((unsigned char*)fixture->ocm, &position, fixture->po_info_length, fixture->po_header_length,
+                               fixture->num_of_obj, fixture->objects);
+}
+
+static int bench_cpof_only_meta(microbench_fixture* const fixture) {
+  uint64_t position = fixture->meta_position;
+  return cpof_only_meta((unsigned char*)fixture->ocm, &position, (int)fixture->num_of_obj, fixture->objects);
+}
+
+static int bench_get_element_from_metadata(microbench_fixture* const fixture) {
+  uint64_t object_size                = 0;
+  char object_key[MAX_PATH + 1]       = { 0 };
+  char last_modified[MAX_PATH + 1]    = { 0 };
+  char version_id[MAX_PATH + 1]       = { 0 };
+  char content_md5[MAX_PATH + 1]      = { 0 };
+  char object_id[UUID_SIZE + 1]       = { 0 };
+  return get_element_from_metadata(fixture->meta, &object_size, object_key, object_id, last_modified, version_id, content_md5);
+}
+
+static int bench_get_md5(microbench_fixture* const fixture) {
+  char hash[UUID_SIZE + 1] = { '\0' };
+  return get_md5((unsigned char*)fixture->meta, hash);
+}
+
+// The pairs of a record of --list, in the same order as the reader.
+static int bench_make_key_str_value_pairs(microbench_fixture* const fixture) {
+  int ret = OK;
+  fixture->json[0] = '\0';
+  ret |= make_key_str_value_pairs(&fixture->json, "object_key", fixture->object_key);
+  ret |= make_key_str_value_pairs(&fixture->json, "last_modified", fixture->last_modified);
+  ret |= make_key_str_value_pairs(&fixture->json, "version_id", fixture->version_id);
+  ret |= make_key_str_value_pairs(&fixture->json, "content_md5", fixture->content_md5);
+  ret |= make_key_str_value_pairs(&fixture->json, "object_id", fixture->object_id);
+  return ret;
+}
+
+static int bench_r64(microbench_fixture* const fixture) {
+  return (r64(BIG, (uint8_t*)fixture->ocm, fixture->values64, fixture->decode_count) == fixture->decode_count) ? OK : NG;
+}
+
+static int bench_r32(microbench_fixture* const fixture) {
+  const uint64_t count = fixture->decode_count * 2;
+  return (r32(BIG, (uint8_t*)fixture->ocm, fixture->values32, count) == count) ? OK : NG;
+}
+
+static int bench_is_null_filled(microbench_fixture* const fixture) {
+  return (is_null_filled(fixture->null_block, LTOS_BLOCK_SIZE) == TRUE) ? OK : NG;
+}
+
+/**
+ * Compare the time of samples for qsort.
+ */
+static int compare_microbench_samples(const void* a, const void* b) {
+  const double x = *(const double*)a;
+  const double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Measure a case and write its result as a line of JSON to stdout.
+ * @param [in/out] (fixture)    Fixture.
+ * @param [in]     (bench_case) Case to be measured.
+ * @return         (OK/NG)      If the function succeeds in all calls, return OK. Otherwise, return NG.
+ */
+static int run_microbench_case(microbench_fixture* const fixture, const microbench_case* const bench_case) {
+  double samples[MICROBENCH_SAMPLES] = { 0 };
+  uint64_t calls                     = 1;
+  double total                       = 0;
+  int ret                            = OK;
+
+  set_top_verbose(bench_case->verbose);
+  ret |= bench_case->function(fixture); // Warm up the caches and the allocator.
+
+  // Double the calls in a sample until it is long enough for the resolution of the timer.
+  while (ret == OK) {
+    const uint64_t start = start_metric_timer();
+    for (uint64_t i = 0; i < calls; i++) {
+      ret |= bench_case->function(fixture);
+    }
+    if (start_metric_timer() - start >= MICROBENCH_SAMPLE_USEC) {
+      break;
+    }
+    calls *= 2;
+  }
+  for (int sample = 0; sample < MICROBENCH_SAMPLES && ret == OK; sample++) {
+    const uint64_t start = start_metric_timer();
+    for (uint64_t i = 0; i < calls; i++) {
+      ret |= bench_case->function(fixture);
+    }
+    samples[sample] = (double)(start_metric_timer() - start) * 1000 / calls / bench_case->units;
+    total          += samples[sample];
+  }
+  set_top_verbose(DEFAULT);
+  if (ret != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "%s failed in the microbenchmark.\n", bench_case->name);
+  }
+
+  qsort(samples, MICROBENCH_SAMPLES, sizeof(double), compare_microbench_samples);
+  const double p50 = samples[(MICROBENCH_SAMPLES - 1) * 50 / 100];
+  printf("{\"benchmark\":\"%s\",\"units_per_call\":%lu,\"bytes\":%lu,\"samples\":%d,\"calls_per_sample\":%lu,"
+         "\"ns_min\":%.3f,\"ns_p50\":%.3f,\"ns_p90\":%.3f,\"ns_p99\":%.3f,\"ns_max\":%.3f,\"ns_mean\":%.3f,\"mb_per_sec\":%.3f}\n",
+         bench_case->name, bench_case->units, bench_case->bytes, MICROBENCH_SAMPLES, calls,
+         samples[0], p50, samples[(MICROBENCH_SAMPLES - 1) * 90 / 100], samples[(MICROBENCH_SAMPLES - 1) * 99 / 100],
+         samples[MICROBENCH_SAMPLES - 1], total / MICROBENCH_SAMPLES,
+         (p50 > 0) ? bench_case->bytes * 1000.0 / (p50 * bench_case->units) : 0.0);
+  fflush(stdout);
+  return OK;
+}
+
+/**
+ * Run the microbenchmark of the marker parsers and the metadata handling with inputs from a tape image.
+ * @param [in]  (image_path) Tape image made with --capture or --generate.
+ * @return      (OK/NG)      If all cases are measured, return OK. Otherwise, return NG.
+ */
+int run_microbenchmarks(const char* const image_path) {
+  int ret                           = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:run_microbenchmarks\n");
+  microbench_fixture* const fixture = (microbench_fixture*)clf_allocate_memory(sizeof(microbench_fixture), "fixture");
+
+  set_info_stream(stderr); // stdout carries the results.
+
+  const int fixture_ret             = load_microbench_fixture(fixture, image_path);
+  set_top_verbose(DEFAULT);
+  if (fixture_ret != OK) {
+    free_microbench_fixture(fixture);
+    free(fixture);
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to make the inputs of the microbenchmark from %s.\n", image_path);
+  }
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO,
+                     "Microbenchmark with %lu OCM(s) in the PR, %lu PO info(s) in the OCM and %lu object(s) in the PO.\n",
+                     fixture->pr_count, fixture->ocm_count, fixture->num_of_obj);
+
+  const uint64_t pr_dir_size    = fixture->pr_count * PR_DIR_SIZE;
+  const uint64_t ocm_dir_size   = fixture->ocm_count * (LENGTH_DIRECTORY + BLOCK_OFFSET_DIRECTORY);
+  const uint64_t po_dir_size    = (fixture->num_of_obj + 1) * PO_DIR_SIZE;
+  const uint64_t meta_size      = fixture->po_info_length - fixture->po_header_length - po_dir_size;
+  const microbench_case cases[] = {
+    { "clf_header_pr",             bench_clf_header_pr,             1,                         IDENTIFIER_SIZE + PR_HEADER_SIZE,         DISPLAY_HEADER_AND_L43_INFO },
+    { "clf_header_ocm",            bench_clf_header_ocm,            1,                         IDENTIFIER_SIZE + OCM_HEADER_SIZE,        DISPLAY_HEADER_AND_L432_INFO },
+    { "clf_directory_pr",          bench_clf_directory_pr,          fixture->pr_count,         pr_dir_size,                              DISPLAY_HEADER_AND_L43_INFO },
+    { "clf_directory_ocm",         bench_clf_directory_ocm,         fixture->ocm_count,        ocm_dir_size,                             DISPLAY_HEADER_AND_L432_INFO },
+    { "cpof_po_header",            bench_cpof_po_header,            1,                         fixture->po_header_length,                DISPLAY_HEADER_AND_L4321_INFO },
+    { "cpof_object_directory",     bench_cpof_object_directory,     fixture->num_of_obj,       po_dir_size,                              DISPLAY_HEADER_AND_L4321_INFO },
+    { "cpof_only_meta",            bench_cpof_only_meta,            fixture->num_of_obj,       meta_size,                                DISPLAY_HEADER_AND_L4321_INFO },
+    { "get_element_from_metadata", bench_get_element_from_metadata, 1,                         fixture->meta_size,                       DEFAULT },
+    { "get_md5",                   bench_get_md5,                   1,                         fixture->meta_size,                       DEFAULT },
+    { "make_key_str_value_pairs",  bench_make_key_str_value_pairs,  MICROBENCH_PAIRS,          0,                                        DEFAULT },
+    { "r64",                       bench_r64,                       fixture->decode_count,     fixture->decode_count * sizeof(uint64_t), DEFAULT },
+    { "r32",                       bench_r32,                       fixture->decode_count * 2, fixture->decode_count * sizeof(uint64_t), DEFAULT },
+    { "is_null_filled",            bench_is_null_filled,            1,                         LTOS_BLOCK_SIZE,                          DEFAULT },
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    ret |= run_microbench_case(fixture, &cases[i]);
+  }
+
+  free_microbench_fixture(fixture);
+  free(fixture);
+  ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "end  :run_microbenchmarks\n");
+  return ret;
+}
+#endif /* OBJ_READER */
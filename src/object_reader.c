@@ -33,24 +33,64 @@ static void print_usage(char *appname)
 {
   fprintf(stderr, "usage: %s <options>\n", appname);
   fprintf(stderr, "Available options are:\n");
+  fprintf(stderr, "  -B, --benchmark       = <path>   Benchmark listing, restoring and dumping objects of an image made with --capture or --generate\n");
+  fprintf(stderr, "                                   on the emulated drive. Results are written in a new directory in the save path.\n");
   fprintf(stderr, "  -b, --bucket          = <name>   Specify a bucket name in which an object you specified is stored.\n");
+  fprintf(stderr, "  -C, --drive-cost      = <spec>   Costs of the emulated drive, which is key=value separated by comma.\n");
+  fprintf(stderr, "                                   e.g. locate=3000000,bandwidth=400,sleep=1 (See README.md for the keys.)\n");
+  fprintf(stderr, "  -c, --capture         = <path>   Capture both partitions and MAM of a tape into an image file without parsing.\n");
+  fprintf(stderr, "  -D, --trace-digest    : Record MD5 of the data read from the drive instead of the data with --trace-record.\n");
   fprintf(stderr, "  -d, --drive           = <name>   Specify a device name of a tape drive.\n");
+  fprintf(stderr, "                                   With --manifest, specify device names of tape drives separated by comma.\n");
+  fprintf(stderr, "  -E, --emulate         = <path>   Read a tape image made with --capture or --generate with an emulated drive instead of the drive.\n");
+  fprintf(stderr, "                                   --drive is still required, but only used as the name of the lock file of the drive.\n");
+  fprintf(stderr, "  -e, --events          = <path>   Read \"loaded <barcode> <drive>\" events from this file with --manifest. Default is stdin.\n");
   fprintf(stderr, "  -F, --Force           : Avoid to check a disk space during either Full dump or Resume dump.\n");
   fprintf(stderr, "  -f, --full-dump       : Read all objects from a tape formatted with the OTFoarmt.\n");
+  fprintf(stderr, "  -G, --generate        = <path>   Generate a synthetic tape image in the format of --capture without a tape drive.\n");
+  fprintf(stderr, "  -g, --glob            = <pattern> Dump only objects whose KEY matches the pattern during either Full dump or Resume dump.\n");
   fprintf(stderr, "  -h, --help\n");
-  fprintf(stderr, "  -i, --interval        : Output a progress to \"history.log\" during either Full dump or Resume dump.\n");
+  fprintf(stderr, "  -I, --progress-interval = <seconds> Interval of the progress with --progress-fd. Default is %d seconds.\n",
+          PROGRESS_DEFAULT_INTERVAL);
+  fprintf(stderr, "  -i, --interval        : Flush a progress in \"history.jnl\" to the disk at this interval during either Full dump or Resume dump.\n");
+  fprintf(stderr, "  -j, --jobs            = <number> Number of threads extracting objects with --extract. Default is the number of CPUs.\n");
+  fprintf(stderr, "  -K, --report          = <path>   Append objects, bytes, SCSI commands, drive time and CPU time of this run to the file\n");
+  fprintf(stderr, "                                   as a JSON object per line at exit.\n");
+  fprintf(stderr, "  -k, --key-prefix      = <prefix> Dump only objects whose KEY starts with the prefix during either Full dump or Resume dump.\n");
   fprintf(stderr, "  -L, --Level           = <value>  Specify output level. default is 0\n");
   fprintf(stderr, "                                   0: Object Data and Meta\n");
   fprintf(stderr, "                                   1: Packed Object\n");
   fprintf(stderr, "  -l, --list            : Output a list of all objects in each bucket stored in a tape.\n");
+  fprintf(stderr, "  -M, --metrics         = <path>   Export metrics in Prometheus text format to the file every %d seconds.\n", METRICS_INTERVAL);
+  fprintf(stderr, "                                   \"unix:<path>\" serves them over HTTP on the Unix socket instead.\n");
+  fprintf(stderr, "  -m, --manifest        = <path>   Restore objects listed in the manifest with the drives specified with --drive.\n");
+  fprintf(stderr, "                                   Each line is <barcode>, <bucket>, <object key> and optionally <object id> separated by TAB.\n");
+  fprintf(stderr, "                                   \"load <barcode> <drive>\" and \"unload <barcode> <drive>\" are written to stdout\n");
+  fprintf(stderr, "                                   for an external loader, which replies \"loaded <barcode> <drive>\" to --events.\n");
   fprintf(stderr, "  -o, --object-key      = <name>   Specify an object KEY.\n");
   fprintf(stderr, "  -O, --Object-id       = <ID or Option> Specify an Object version. default is \"latest\".\n");
   fprintf(stderr, "                          <ID>     Specify a versioned object ID, which will be shown in a list file.\n");
   fprintf(stderr, "                          <Option> Either \"latest\" or \"all\" is available.\n");
   fprintf(stderr, "                                   \"latest\" : Output ONLY the latest version object. \n");
   fprintf(stderr, "                                   \"all\"    : Output ALL versions with the Object-Key. \n");
-  fprintf(stderr, "  -r, --resume-dump     : Resume a Full dump process when \"history.log\" file was updated.\n");
+  fprintf(stderr, "  -P, --progress-fd     = <fd>     Write the progress as a JSON object per line to the open file descriptor.\n");
+  fprintf(stderr, "  -p, --pax             = <path>   Write objects to a pax archive instead of files with --full-dump or --object-key.\n");
+  fprintf(stderr, "                                   \"-\" writes it to stdout, and messages are written to stderr.\n");
+  fprintf(stderr, "  -Q, --requests        = <path>   Read all objects listed in the file from the bucket specified with --bucket in one pass.\n");
+  fprintf(stderr, "                                   Each line is <object key> and optionally <object id> separated by TAB.\n");
+  fprintf(stderr, "  -R, --range           = <offset>:<length> Output only the byte range of an object data specified with --object-key.\n");
+  fprintf(stderr, "                                   If <length> is omitted, the range lasts up to the end of the object.\n");
+  fprintf(stderr, "  -r, --resume-dump     : Resume a Full dump process from the last object recorded in \"history.jnl\".\n");
+  fprintf(stderr, "  -S, --generate-spec   = <spec>   Specification of the image with --generate, which is key=value separated by comma.\n");
+  fprintf(stderr, "                                   e.g. objects=100000000,size=1K,objects_per_po=1000,prs=100 (See README.md for the keys.)\n");
   fprintf(stderr, "  -s, --save-path       = <path>   Specify a full path where data will be stored. Default is the application path.\n");
+  fprintf(stderr, "  -T, --trace-record    = <path>   Record all SCSI commands and their responses to the trace file.\n");
+  fprintf(stderr, "  -t, --time-range      = <from>,<to> Dump only objects whose LastModifiedTime is <from> or later and before <to>.\n");
+  fprintf(stderr, "                                   e.g. 2021-01-01T00:00:00.000000Z,2021-02-01T00:00:00.000000Z (Either side can be omitted.)\n");
+  fprintf(stderr, "  -U, --microbench      = <path>   Measure the marker parsers and the metadata handling with inputs from an image made with\n");
+  fprintf(stderr, "                                   --capture or --generate. Results are written to stdout as a JSON object per line.\n");
+  fprintf(stderr, "  -V, --verify          = <path>   Verify object data with ContentMd5 in its metadata while it is written,\n");
+  fprintf(stderr, "                                   and append mismatches to the report with --full-dump, --resume-dump or --object-key.\n");
   fprintf(stderr, "  -v, --verbose         = <level>  Specify output_level.\n");
   fprintf(stderr, "                                   If this option is not set, nothing will be displayed.\n");
   fprintf(stderr, "                                   v:information about header.\n");
@@ -59,24 +99,57 @@ static void print_usage(char *appname)
   fprintf(stderr, "                                   vvvv:information about L2 in addition to above.\n");
   fprintf(stderr, "                                   vvvvv:information about L1 in addition to above.\n");
   fprintf(stderr, "                                   vvvvvv:information about MISC for MAM and others in addition to above.\n");
+  fprintf(stderr, "  -w, --workspace       = <path>   Specify a directory in which a workspace for each tape is created.\n");
+  fprintf(stderr, "                                   Default is \"%s\" in the save path.\n", WORKSPACE_DIR);
+  fprintf(stderr, "  -x, --extract         = <path>   Extract all objects from an image captured with --capture to the save path without a tape drive.\n");
+  fprintf(stderr, "  -Y, --trace-replay    = <path>   Answer SCSI commands from a trace recorded with --trace-record instead of the drive.\n");
+  fprintf(stderr, "                                   --drive is still required, but only used as the name of the lock file of the drive.\n");
+  fprintf(stderr, "  -y, --replay-latency  : Wait for the recorded latency of each command with --trace-replay.\n");
 }
 
 /* Command line options */
-static const char *short_options    = "b:d:Ffhi:L:lo:O:rs:v:";
+static const char *short_options    = "B:b:C:c:DE:d:e:FfG:g:hI:i:j:K:k:L:lM:m:o:O:P:p:Q:R:rS:s:T:t:U:V:v:w:x:Y:y";
 static struct option long_options[] = {
+  { "benchmark",       required_argument, 0, 'B' },
   { "bucket",          required_argument, 0, 'b' },
+  { "drive-cost",      required_argument, 0, 'C' },
+  { "capture",         required_argument, 0, 'c' },
+  { "trace-digest",    no_argument,       0, 'D' },
+  { "emulate",         required_argument, 0, 'E' },
   { "drive",           required_argument, 0, 'd' },
+  { "events",          required_argument, 0, 'e' },
   { "Force",           no_argument,       0, 'F' },
   { "full-dump",       no_argument,       0, 'f' },
+  { "generate",        required_argument, 0, 'G' },
+  { "glob",            required_argument, 0, 'g' },
   { "help",            no_argument,       0, 'h' },
+  { "progress-interval", required_argument, 0, 'I' },
   { "interval",        required_argument, 0, 'i' },
+  { "jobs",            required_argument, 0, 'j' },
+  { "report",          required_argument, 0, 'K' },
+  { "key-prefix",      required_argument, 0, 'k' },
   { "Level",           required_argument, 0, 'L' },
   { "list",            no_argument,       0, 'l' },
+  { "metrics",         required_argument, 0, 'M' },
+  { "manifest",        required_argument, 0, 'm' },
   { "object-key",      required_argument, 0, 'o' },
   { "Object-id",       required_argument, 0, 'O' }, // Oct 28, 2020 added instead of Version-id
+  { "pax",             required_argument, 0, 'p' },
+  { "progress-fd",     required_argument, 0, 'P' },
+  { "requests",        required_argument, 0, 'Q' },
+  { "range",           required_argument, 0, 'R' },
   { "resume-dump",     no_argument,       0, 'r' },
+  { "generate-spec",   required_argument, 0, 'S' },
   { "save-path",       required_argument, 0, 's' },
+  { "trace-record",    required_argument, 0, 'T' },
+  { "time-range",      required_argument, 0, 't' },
+  { "microbench",      required_argument, 0, 'U' },
+  { "verify",          required_argument, 0, 'V' },
   { "verbose",         required_argument, 0, 'v' },
+  { "workspace",       required_argument, 0, 'w' },
+  { "extract",         required_argument, 0, 'x' },
+  { "trace-replay",    required_argument, 0, 'Y' },
+  { "replay-latency",  no_argument,       0, 'y' },
   { 0,                    0,                    0,   0  }
 };
 
@@ -96,19 +169,21 @@ static int open_drive(const char* const device_name, int* fd,
                        SCSI_DEVICE_PARAM* const scparam, ST_SPTI_REQUEST_SENSE_RESPONSE* const sense_data,
                        ST_SYSTEM_ERRORINFO* const syserr, MamVci* const mamvci, MamHta* const mamhta) {
   int ret                                   = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:open_drive\n");
-  char command_buff[COMMAND_SIZE + 1]       = { '\0' };
 
-  //Check if tape device exists.
-  sprintf(command_buff, DEVICE_CHECK_COMMAND, device_name);
-  if (WEXITSTATUS(system(command_buff)) != OK) {
+  // Commands are answered from a SCSI trace or the emulated drive, so the drive is neither looked for nor opened.
+  if (get_scsi_trace_mode() == SCSI_TRACE_REPLAY || is_scsi_emulator_enabled() == TRUE) {
+    *fd = ERROR;
+  } else if (find_tape_device(device_name) != OK) {
+    //Check if tape device exists.
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Can't find tape device(%s).\n"
                               "%sCheck option '-d'.\n", device_name, INDENT);
     return ret;
+  } else {
+    // Open scsi device.
+    *fd = open(device_name, O_RDWR);
   }
-  // Open scsi device.
-  *fd = open(device_name, O_RDWR);
 
-  if (*fd == ERROR) {
+  if (*fd == ERROR && get_scsi_trace_mode() != SCSI_TRACE_REPLAY && is_scsi_emulator_enabled() == FALSE) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Can't open file: %s\n"
                               "%sfd = %d, errno = %d: %s\n", device_name, INDENT, *fd, errno, strerror(errno));
     return ret;
@@ -183,13 +258,21 @@ static int check_interval(const char* const str_interval, uint32_t* const interv
  * @param [in]  (is_output_object)         Boolean
  * @param [in]  (bucket_name)              Bucket name in string
  * @param [in]  (object_key)               Object key in string.
+ * @param [in]  (object_id)                Object id in string.
+ * @param [in]  (requests_path)            Path of the requests in string.
+ * @param [in]  (structure_level)          Output level.
+ * @param [in]  (is_dump_filtered)         Boolean
+ * @param [in]  (is_range_specified)       Boolean
+ * @param [in]  (is_capture_required)      Boolean
+ * @param [in]  (is_pax_required)          Boolean
  * @return      (OK/NG)                    Return OK if no errors.
  */
 static int check_arguments(const Bool is_drive_specified, const Bool is_output_list, const Bool is_resume_dump_required,
                            const Bool is_full_dump_required, const Bool is_output_object,
                            const char* const bucket_name, const char* const object_key,
-                           const char* const object_id,
-                           const uint32_t structure_level) {
+                           const char* const object_id, const char* const requests_path,
+                           const uint32_t structure_level, const Bool is_dump_filtered,
+                           const Bool is_range_specified, const Bool is_capture_required, const Bool is_pax_required) {
   int ret = OK;
 
   // Required argument check
@@ -197,15 +280,26 @@ static int check_arguments(const Bool is_drive_specified, const Bool is_output_l
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Please specify --drive option.\n");
   }
   if ( is_output_list        == false && is_resume_dump_required == false
-    && is_full_dump_required == false && is_output_object        == false ) {
+    && is_full_dump_required == false && is_output_object        == false && is_capture_required == false ) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+           "Please specify at least --full-dump, --resume-dump, --list, --capture, or both --bucket and --object option.\n");
+  }
+  if (is_capture_required == true && (is_output_list == true || is_resume_dump_required == true
+                                      || is_full_dump_required == true || is_output_object == true)) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
-           "Please specify at least --full-dump, --resume-dump, --list, or both --bucket and --object option.\n");
+           "--capture cannot be specified with --full-dump, --resume-dump, --list, or --bucket and --object option.\n");
   }
   //   Both bucket_name and object_key are required to output an object from a tape.
   if (is_output_object == true) {
-    if ( strlen(bucket_name) < 1 || strlen(object_key) < 1 ) {
+    if ( strlen(bucket_name) < 1 || (strlen(object_key) < 1 && strlen(requests_path) < 1) ) {
       ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Please specify both --bucket and --object.\n");
     }
+    if (strlen(object_key) > 0 && strlen(requests_path) > 0) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Please specify either --object or --requests.\n");
+    }
+  }
+  if (strlen(requests_path) > 0 && structure_level == OUTPUT_PACKED_OBJECT) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "You cannot specify both --requests and \"-L 1\".\n");
   }
   // Collision check
   if ((structure_level == OUTPUT_PACKED_OBJECT) && (strncmp(object_id, "all", 3) == OK)) {
@@ -244,6 +338,105 @@ static int check_arguments(const Bool is_drive_specified, const Bool is_output_l
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
            "Please specify either --full-dump or --resume-dump.\n");
   }
+  if (is_range_specified == true && (strlen(object_key) < 1 || structure_level == OUTPUT_PACKED_OBJECT)) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+           "--range is available only with both --bucket and --object option, and without \"-L 1\".\n");
+  }
+  if (is_pax_required == true && ((is_full_dump_required == false && is_output_object == false) || is_resume_dump_required == true
+                                  || is_range_specified == true || structure_level == OUTPUT_PACKED_OBJECT)) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+           "--pax is available only with --full-dump, or both --bucket and --object option without --range and \"-L 1\".\n");
+  }
+  if (is_dump_filtered == true && is_full_dump_required == false && is_resume_dump_required == false) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+           "--key-prefix, --glob and --time-range are available only with --full-dump or --resume-dump.\n");
+  }
+  return ret;
+}
+
+
+/**
+ * Find an object in the list files of a bucket, and add its records to the objects to be read.
+ * @param [in]  (save_path)   Directory in which the list files are saved.
+ * @param [in]  (barcode_id)  Barcode of the tape.
+ * @param [in]  (bucket_name) Bucket name.
+ * @param [in]  (object_key)  Object key.
+ * @param [in]  (object_id)   Object id, "latest" or "all".
+ * @param [out] (list_path)   Path of the last list file searched.
+ * @param [out] (objects)     Objects to be read.
+ * @return      (OK/NG)       If the object is found, return OK. Otherwise, return NG.
+ */
+static int find_object_in_lists(const char* const save_path, const char* const barcode_id, const char* const bucket_name,
+                                const char* const object_key, const char* const object_id,
+                                char list_path[OUTPUT_PATH_SIZE + 1], object_vector* const objects) {
+  object_vector found = { 0 };
+
+  // The latest version is chosen among the records found so far, so the records of each object are collected separately.
+  initialize_object_vector(&found);
+  for (int i = 1; i <= MAX_NUMBER_OF_LISTS; i++) {
+    char path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+    snprintf(path, sizeof(path), "%s/%s/%s_%04d.lst", save_path, barcode_id, bucket_name, i);
+    if (check_file(path) != OK) {
+      break;
+    }
+    strcpy(list_path, path);
+    get_object_info_in_list(object_key, object_id, list_path, &found);
+  }
+  const int ret = (found.count == 0) ? NG : OK;
+  append_object_vector(objects, &found);
+  free_object_vector(&found);
+  return ret;
+}
+
+
+/**
+ * Read the requests for a bucket, and add the records of the requested objects to the objects to be read.
+ * Each line is <object key> and optionally <object id> separated by TAB. The object id is "latest" if omitted.
+ * @param [in]  (requests_path) Path of the requests.
+ * @param [in]  (save_path)     Directory in which the list files are saved.
+ * @param [in]  (barcode_id)    Barcode of the tape.
+ * @param [in]  (bucket_name)   Bucket name.
+ * @param [out] (objects)       Objects to be read.
+ * @return      (OK/NG)         If all requested objects are found, return OK. Otherwise, return NG.
+ */
+static int read_requests(const char* const requests_path, const char* const save_path, const char* const barcode_id,
+                         const char* const bucket_name, object_vector* const objects) {
+  int ret                              = OK;
+  char readline[MAX_LINE_LENGTH + 1]   = { '\0' };
+  char list_path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  uint64_t request_count               = 0;
+
+  snprintf(list_path, sizeof(list_path), "%s/%s/%s_%04d.lst", save_path, barcode_id, bucket_name, 1);
+  if (check_file(list_path) != OK) {
+    return output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+        "Specify \"--list\" option if you did not make a list before.\n"
+        "%sIf already done it, the bucket you specified is not found.\n", INDENT);
+  }
+  FILE* const fp = fopen(requests_path, "r");
+  if (fp == NULL) {
+    return output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+                              "Failed to open the requests(%s). error=%s\n", requests_path, strerror(errno));
+  }
+  while (fgets(readline, sizeof(readline), fp) != NULL) {
+    readline[strcspn(readline, "\r\n")] = '\0';
+    if (readline[0] == '\0') {
+      continue;
+    }
+    char* const separator  = strchr(readline, '\t');
+    const char* object_id  = VERSION_OPT_LATEST;
+    if (separator != NULL) {
+      *separator = '\0';
+      object_id  = separator + 1;
+    }
+    if (MAX_KEY_SIZE < strlen(readline) || UUID_SIZE < strlen(object_id)) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Request %lu in %s is invalid.\n", request_count + 1, requests_path);
+    } else if (find_object_in_lists(save_path, barcode_id, bucket_name, readline, object_id, list_path, objects) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "%s/%s(%s) was not found in the list.\n", bucket_name, readline, object_id);
+    }
+    request_count++;
+  }
+  fclose(fp);
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu request(s) are read from %s.\n", request_count, requests_path);
   return ret;
 }
 
@@ -260,12 +453,36 @@ int main(int argc, char **argv) {
   Bool is_resume_dump_required                            = false;
   Bool is_force_enabled                                   = false;
   Bool is_drive_specified                                 = false;
+  Bool is_range_specified                                 = false;
   char object_key[MAX_KEY_SIZE + 1]                       = { '\0' };
   char object_id[UUID_SIZE + 1]                           = VERSION_OPT_LATEST;  // default = latest
   char save_path[OUTPUT_PATH_SIZE + 1]                    = { '\0' };
+  char workspace_root[OUTPUT_PATH_SIZE + 1]               = { '\0' };
   char pr_file_path[OUTPUT_PATH_SIZE + 1]                 = { '\0' };
   char list_path[OUTPUT_PATH_SIZE + 1]                    = { '\0' };
-  char verbose_level[OUTPUT_PATH_SIZE + 1]                = DISPLAY_COMMON_INFO;
+  char requests_path[OUTPUT_PATH_SIZE + 1]                = { '\0' };
+  char manifest_path[OUTPUT_PATH_SIZE + 1]                = { '\0' };
+  char events_path[OUTPUT_PATH_SIZE + 1]                  = "-";                 // default = stdin
+  char image_path[OUTPUT_PATH_SIZE + 1]                   = { '\0' };
+  char extract_image_path[OUTPUT_PATH_SIZE + 1]           = { '\0' };
+  char generate_image_path[OUTPUT_PATH_SIZE + 1]          = { '\0' };
+  char generate_spec[OUTPUT_PATH_SIZE + 1]                = { '\0' };   // default = all keys are default
+  char pax_path[OUTPUT_PATH_SIZE + 1]                     = { '\0' };
+  char metrics_path[OUTPUT_PATH_SIZE + 1]                 = { '\0' };   // default = no metrics
+  char trace_record_path[OUTPUT_PATH_SIZE + 1]            = { '\0' };   // default = no SCSI trace
+  char trace_replay_path[OUTPUT_PATH_SIZE + 1]            = { '\0' };   // default = use the drive
+  char emulate_image_path[OUTPUT_PATH_SIZE + 1]           = { '\0' };   // default = use the drive
+  char drive_cost[OUTPUT_PATH_SIZE + 1]                   = { '\0' };   // default = all costs are default
+  char report_path[OUTPUT_PATH_SIZE + 1]                  = { '\0' };   // default = no report
+  char benchmark_image_path[OUTPUT_PATH_SIZE + 1]         = { '\0' };
+  char microbench_image_path[OUTPUT_PATH_SIZE + 1]        = { '\0' };
+  char verify_report_path[OUTPUT_PATH_SIZE + 1]           = { '\0' };   // default = no verification
+  Bool is_trace_digest                                    = false;
+  Bool is_latency_replayed                                = false;
+  int extract_jobs                                        = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int progress_fd                                         = -1;                  // default = no progress
+  uint32_t progress_interval                              = PROGRESS_DEFAULT_INTERVAL;
+  char verbose_level[OUTPUT_PATH_SIZE + 1]                = "";                  // default = common messages only
   char barcode_id[BARCODE_SIZE + 1]                       = DEFAULT_BARCODE;
   int fd_tape                                             = ERROR;               // File descriptor for tape drive
   ST_SPTI_REQUEST_SENSE_RESPONSE sense_data               = { 0 };
@@ -273,11 +490,13 @@ int main(int argc, char **argv) {
   SCSI_DEVICE_PARAM scparam                               = { 0 };
   MamHta mamhta                                           = { 0 };
   MamVci mamvci[NUMBER_OF_PARTITIONS]                     = { { 0 } };
-  object_list *objects                                    = NULL;
+  object_vector objects                                   = { 0 };
   uint64_t total_fm_num_in_rp                             = 0;
   uint64_t total_pr_num_in_rp                             = 0;
   time_t lap_start                                        = time(NULL);
+  reader_context* ctx                                     = create_reader_context();
 
+  bind_reader_context(ctx);
   set_lap_start(lap_start);
   // Set default value in order to output an error during "Parse command line options"
   set_vl(verbose_level);
@@ -291,6 +510,9 @@ int main(int argc, char **argv) {
       break;
 
     switch (c) {
+    case 'B':
+      snprintf(benchmark_image_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
     case 'b':
       snprintf(bucket_name, BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1, "%s", optarg);
       if (strlen(bucket_name) < BUCKET_LIST_BUCKETNAME_MIN_SIZE) {
@@ -302,16 +524,37 @@ int main(int argc, char **argv) {
       }
       is_output_object = true;
       break;
+    case 'C':
+      snprintf(drive_cost, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'c':
+      snprintf(image_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'D':
+      is_trace_digest = true;
+      break;
+    case 'E':
+      snprintf(emulate_image_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
     case 'd':
       snprintf(drive_name, DEVICE_NAME_SIZE + 1, "%s", optarg);
       is_drive_specified = true;
       break;
+    case 'e':
+      snprintf(events_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
     case 'F': //Force
       is_force_enabled = true;
       break;
     case 'f': //full dump
       is_full_dump_required = true;
       break;
+    case 'G':
+      snprintf(generate_image_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'g':
+      set_dump_filter_pattern(optarg);
+      break;
     case 'h':
       print_usage(argv[0]);
       exit(EXIT_SUCCESS);
@@ -321,6 +564,24 @@ int main(int argc, char **argv) {
       }
       set_history_interval(history_interval);
       break;
+    case 'I':
+      if (sscanf(optarg, "%u", &progress_interval) != 1 || progress_interval < 1 || PROGRESS_MAX_INTERVAL < progress_interval) {
+        ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+                                  "Progress interval must be from 1 to %d seconds.\n", PROGRESS_MAX_INTERVAL);
+      }
+      break;
+    case 'j':
+      if (sscanf(optarg, "%d", &extract_jobs) != 1 || extract_jobs < 1 || IMAGE_EXTRACT_MAX_JOBS < extract_jobs) {
+        ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+                                  "Number of jobs must be from 1 to %d.\n", IMAGE_EXTRACT_MAX_JOBS);
+      }
+      break;
+    case 'K':
+      snprintf(report_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'k':
+      set_dump_filter_prefix(optarg);
+      break;
     case 'L':
       sscanf(optarg, "%u", &structure_level);
       if (structure_level > MAX_LEVEL_OPT_VALUE) {
@@ -331,10 +592,35 @@ int main(int argc, char **argv) {
     case 'l':
       is_output_list = true;
       break;
+    case 'M':
+      snprintf(metrics_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'm':
+      snprintf(manifest_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
     case 'o':
       snprintf(object_key, MAX_KEY_SIZE + 1, "%s", optarg);
       is_output_object = true;
       break;
+    case 'Q':
+      snprintf(requests_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      is_output_object = true;
+      break;
+    case 'p':
+      snprintf(pax_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'P':
+      if (sscanf(optarg, "%d", &progress_fd) != 1 || progress_fd < 0) {
+        ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Progress file descriptor is invalid.\n");
+      }
+      break;
+    case 'R':
+      if (set_object_range(optarg) != OK) {
+        ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+                                  "Range is invalid. Specify <offset>:<length> in bytes.\n");
+      }
+      is_range_specified = true;
+      break;
     case 'r':
       is_resume_dump_required = true;
       break;
@@ -350,19 +636,74 @@ int main(int argc, char **argv) {
        is_output_object = true;
       }
       break;
+    case 'S':
+      snprintf(generate_spec, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
     case 's':
       snprintf(save_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
       set_obj_save_path(save_path);
       break;
+    case 'T':
+      snprintf(trace_record_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'U':
+      snprintf(microbench_image_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'V':
+      snprintf(verify_report_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 't':
+      if (set_dump_filter_time_range(optarg) != OK) {
+        ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+                                  "Time range is invalid. Specify <from>,<to> like 2021-01-01T00:00:00.000000Z,2021-02-01T00:00:00.000000Z.\n");
+      }
+      break;
     case 'v':
       snprintf(verbose_level, OUTPUT_PATH_SIZE + 1, "%s", optarg);
       break;
+    case 'w':
+      snprintf(workspace_root, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'x':
+      snprintf(extract_image_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'Y':
+      snprintf(trace_replay_path, OUTPUT_PATH_SIZE + 1, "%s", optarg);
+      break;
+    case 'y':
+      is_latency_replayed = true;
+      break;
     default:
       break;
     }
   }
   //   Update verbose level.
   set_vl(verbose_level);
+  //   stdout is dedicated to the loader protocol with --manifest, and to the archive with "--pax -".
+  if (strlen(manifest_path) > 0 || strcmp(pax_path, PAX_STDOUT) == 0) {
+    set_info_stream(stderr);
+  }
+  //   INFO, DEBUG and TRACE messages are written by a background thread from here.
+  start_log_ring();
+  //   Summary of SCSI commands is output at exit with -v.
+  atexit(output_metrics_summary);
+  if (strlen(metrics_path) > 0 && start_metrics_exporter(metrics_path) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to export metrics to %s.\n", metrics_path);
+  }
+  //   SCSI commands are recorded to a trace, or answered from a trace instead of the drive.
+  if (strlen(trace_record_path) > 0 && strlen(trace_replay_path) > 0) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "--trace-record cannot be specified with --trace-replay.\n");
+  } else if (strlen(trace_record_path) > 0 && start_scsi_trace_record(trace_record_path, is_trace_digest) != TRUE) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to record SCSI commands.\n");
+  } else if (strlen(trace_replay_path) > 0 && start_scsi_trace_replay(trace_replay_path, is_latency_replayed) != TRUE) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to replay SCSI commands.\n");
+  }
+  //   SCSI commands are answered by the emulated drive from a tape image.
+  if (strlen(emulate_image_path) > 0 && strlen(trace_replay_path) > 0) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "--emulate cannot be specified with --trace-replay.\n");
+  } else if (strlen(emulate_image_path) > 0 && start_scsi_emulator(emulate_image_path, drive_cost) != TRUE) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to start the emulated drive.\n");
+  }
 
   // Step #1 Arguments check (Default setting, Required options and Collision check)
   // Default setting: If save_path is not specified, set the application path as default.
@@ -372,16 +713,117 @@ int main(int argc, char **argv) {
              "Failed to get the application path. Specify a valid path with --save-path option.\n");
     }
   }
+  // The current directory is changed to the workspace later, so relative paths are resolved here.
+  char current_path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  if (getcwd(current_path, sizeof(current_path)) == NULL) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to get the application path.\n");
+  }
+  ret |= make_absolute_path(current_path, save_path, sizeof(save_path));
+  if (strlen(image_path) > 0) {
+    ret |= make_absolute_path(current_path, image_path, sizeof(image_path));
+  }
+  if (strlen(emulate_image_path) > 0) {
+    ret |= make_absolute_path(current_path, emulate_image_path, sizeof(emulate_image_path));
+  }
+  if (strlen(report_path) > 0) {
+    ret |= make_absolute_path(current_path, report_path, sizeof(report_path));
+  }
+  if (strlen(verify_report_path) > 0) {
+    ret |= make_absolute_path(current_path, verify_report_path, sizeof(verify_report_path));
+  }
+  if (strlen(requests_path) > 0) {
+    ret |= make_absolute_path(current_path, requests_path, sizeof(requests_path));
+  }
+  if (strlen(pax_path) > 0 && strcmp(pax_path, PAX_STDOUT) != 0) {
+    ret |= make_absolute_path(current_path, pax_path, sizeof(pax_path));
+  }
+  if (strlen(workspace_root) < 1) {
+    if (snprintf(workspace_root, sizeof(workspace_root), "%s/%s", save_path, WORKSPACE_DIR) >= (int)sizeof(workspace_root)) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+             "Save path is too long to make the workspace in it. Specify a workspace with --workspace option.\n");
+    }
+  } else {
+    ret |= make_absolute_path(current_path, workspace_root, sizeof(workspace_root));
+  }
+  // Restore objects in a manifest with several drives. The objects in each bucket on a tape are read by a child object_reader.
+  if (strlen(manifest_path) > 0) {
+    if (is_drive_specified == false) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Please specify --drive option.\n");
+    }
+    set_force_flag(is_force_enabled);
+    // Each child reads the emulated drive and appends its own report.
+    if (strlen(emulate_image_path) > 0) {
+      add_restore_reader_option("-E", emulate_image_path);
+    }
+    if (strlen(drive_cost) > 0) {
+      add_restore_reader_option("-C", drive_cost);
+    }
+    if (strlen(report_path) > 0) {
+      add_restore_reader_option("-K", report_path);
+    }
+    if (strlen(verify_report_path) > 0) {
+      add_restore_reader_option("-V", verify_report_path);
+    }
+    ret |= run_restore_scheduler(manifest_path, drive_name, events_path, save_path, workspace_root, verbose_level);
+    free_reader_context(ctx);
+    exit((ret == OK) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  // Extract objects from a captured image. Neither a tape drive nor the workspace is used.
+  if (strlen(extract_image_path) > 0) {
+    if (strlen(pax_path) > 0) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "--pax cannot be specified with --extract.\n");
+    }
+    if (strlen(verify_report_path) > 0) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "--verify cannot be specified with --extract.\n");
+    }
+    set_force_flag(is_force_enabled);
+    if (check_disk_space(save_path, 0) == NG) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to check the disk space.\n");
+    }
+    ret |= extract_tape_image(extract_image_path, save_path, MIN(MAX(extract_jobs, 1), IMAGE_EXTRACT_MAX_JOBS));
+    free_reader_context(ctx);
+    exit((ret == OK) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  // Generate a synthetic image. Neither a tape drive nor the workspace is used.
+  if (strlen(generate_image_path) > 0) {
+    ret |= generate_tape_image(generate_image_path, generate_spec);
+    free_reader_context(ctx);
+    exit((ret == OK) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  // Benchmark an image with the emulated drive. Each scenario is run by a child object_reader.
+  if (strlen(benchmark_image_path) > 0) {
+    ret |= run_benchmark(benchmark_image_path, drive_cost, save_path, verbose_level);
+    free_reader_context(ctx);
+    exit((ret == OK) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  // Microbenchmark the parsers in memory with inputs from an image. Neither a tape drive nor the workspace is used.
+  if (strlen(microbench_image_path) > 0) {
+    ret |= run_microbenchmarks(microbench_image_path);
+    free_reader_context(ctx);
+    exit((ret == OK) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  if (strlen(report_path) > 0 && start_run_report(report_path) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to write the report to %s.\n", report_path);
+  }
   // Required options and Collision check
   if (check_arguments(is_drive_specified, is_output_list, is_resume_dump_required,
-                      is_full_dump_required, is_output_object, bucket_name, object_key, object_id, structure_level) != OK) {
+                      is_full_dump_required, is_output_object, bucket_name, object_key, object_id, requests_path, structure_level,
+                      is_dump_filter_enabled() == true ? true : false, is_range_specified,
+                      strlen(image_path) > 0 ? true : false, strlen(pax_path) > 0 ? true : false) != OK) {
     exit(EXIT_FAILURE); // Error reason will be output in the above function.
   }
-  // Step #1-2 Initialize (=delete temporary files which were stored at the previous execution.)
-  if (delete_files_in_directory(TEMP_PATH, NULL) == NG) {
-    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Temporary files could not be deleted at %s.\n", TEMP_PATH);
+  if (strlen(pax_path) > 0 && open_pax_stream(pax_path) != OK) {
+    exit(EXIT_FAILURE);
+  }
+  if (strlen(verify_report_path) > 0) {
+    if (is_full_dump_required == false && is_resume_dump_required == false && is_output_object == false) {
+      ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO,
+                                "--verify is available only with --full-dump, --resume-dump or --object-key.\n");
+    }
+    if (open_content_verifier(verify_report_path) != OK) {
+      exit(EXIT_FAILURE);
+    }
   }
-
   // Step #2: Check if the disk space is greater than 100GB if --force is not specified.
   set_force_flag(is_force_enabled);
   if (check_disk_space(save_path, 0) == NG) {
@@ -389,6 +831,9 @@ int main(int argc, char **argv) {
   }
 
   // Step #3: Check if the tape drive user specified is accessible.
+  if (lock_drive(workspace_root, drive_name) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Tape Drive is not accessible.\n");
+  }
   if (open_drive(drive_name, &fd_tape, &scparam, &sense_data, &syserr, mamvci, &mamhta) != 0) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Tape Drive is not accessible.\n");
   }
@@ -398,6 +843,23 @@ int main(int argc, char **argv) {
   }
   //printf(" barcode_id    =%s\n barcode in mam=%s\n", barcode_id, mamhta.Data.barcode); // for DEBUG
 
+  // Step #3-1: Enter the workspace of this tape, and initialize (=delete temporary files which were stored at the previous execution.)
+  if (enter_workspace(workspace_root, barcode_id) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to prepare the workspace at %s.\n", workspace_root);
+  }
+  if (delete_files_in_directory(TEMP_PATH, NULL) == NG) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Temporary files could not be deleted at %s.\n", TEMP_PATH);
+  }
+
+  // Step #4: Capture the whole tape into an image, and release the drive so that objects are extracted offline.
+  if (strlen(image_path) > 0) {
+    ret |= capture_tape_image(image_path, barcode_id);
+    close(fd_tape);
+    fd_tape = ERROR;
+    free_reader_context(ctx);
+    exit((ret == OK) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
   char marker_file_path[MAX_PATH + 1] = { 0 };
   sprintf(marker_file_path, "%s/%s/reference_partition/OTFLabel", save_path, barcode_id);
   struct stat stat_mf;
@@ -408,12 +870,14 @@ int main(int argc, char **argv) {
   if (get_marker_file_flg()) {
     char marker_file_back[MAX_PATH + 1] = { 0 };
     char marker_file_ref[MAX_PATH + 1]  = { 0 };
-    sprintf(marker_file_back, "%s/%s/reference_partition/*", save_path, barcode_id);
-    sprintf(marker_file_ref, "reference_partition/");
+    sprintf(marker_file_back, "%s/%s/reference_partition", save_path, barcode_id);
+    sprintf(marker_file_ref, "reference_partition");
     cp_dir(marker_file_back, marker_file_ref);
   }
 
   // Step #5 and #6: Check if this tape is formatted in OTFormat.
+  enter_metric_phase(METRIC_PHASE_REFERENCE);
+  const uint64_t rp_parse_start = start_metric_timer();
   if (check_reference_partition_lable(mamvci, &mamhta, &total_fm_num_in_rp) != 0) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "This tape is not formatted in OTFormat.\n");
   }
@@ -426,7 +890,7 @@ int main(int argc, char **argv) {
   } else {
     ret |= output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_HEADER_AND_L43_INFO, "main: pr_num=%lu\n", total_pr_num_in_rp);
   }
-  // Step #7-2: Read all of PR(s) in Reference Partition, and output them to /tmp/object_reader/PR_<number>.
+  // Step #7-2: Read all of PR(s) in Reference Partition, and output them to <workspace>/tmp/PR_<number>.
   for (uint64_t cur_pr_num = 0; cur_pr_num < total_pr_num_in_rp; cur_pr_num++) {
     snprintf(pr_file_path, OUTPUT_PATH_SIZE + 1, "%sPR_%lu", TEMP_PATH, cur_pr_num);
     if (write_markers_to_file(pr_file_path, ON) == NG) {
@@ -434,6 +898,13 @@ int main(int argc, char **argv) {
           "Failed to write partial reference to file.\n");
     }
   }
+  observe_metric_timer(METRIC_RP_PARSE, rp_parse_start);
+  enter_metric_phase(METRIC_PHASE_DATA);
+
+  // Progress of reading the data partition is written to --progress-fd from here.
+  if (progress_fd >= 0 && start_progress_stream(progress_fd, progress_interval, barcode_id) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to start the progress.\n");
+  }
 
   // Step #8-1: Check options
   //   '--resume-dump'              : move to Step #17, then #18
@@ -468,11 +939,16 @@ int main(int argc, char **argv) {
         }
     }
 
+    ret |= close_pax_stream();
+    ret |= close_content_verifier();
+    ret |= close_history();
+    stop_progress_stream(PROGRESS_COMPLETE);
+
     if (get_marker_file_flg() == OFF) {
       char marker_file_back[MAX_PATH + 1] = { 0 };
       char marker_file_ref[MAX_PATH + 1]  = { 0 };
       sprintf(marker_file_back, "%s/%s/reference_partition/", save_path, barcode_id);
-      sprintf(marker_file_ref, "reference_partition/*");
+      sprintf(marker_file_ref, "reference_partition");
       ret |= mk_deep_dir(marker_file_back);
       ret |= cp_dir(marker_file_ref, marker_file_back);
     }
@@ -518,9 +994,10 @@ int main(int argc, char **argv) {
     //   True  : continue
     //   False : exit(EXIT_SUCCESS);
     ret = output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Making and output the list file is complete.\n");
-    if (strlen(object_key) > 0 && strlen(bucket_name) >= BUCKET_LIST_BUCKETNAME_MIN_SIZE) {
+    if ((strlen(object_key) > 0 || strlen(requests_path) > 0) && strlen(bucket_name) >= BUCKET_LIST_BUCKETNAME_MIN_SIZE) {
       output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Continue to read the specified object from the tape.\n");
     } else {
+      stop_progress_stream(PROGRESS_COMPLETE);
       exit(EXIT_SUCCESS);
     }
   }
@@ -529,7 +1006,12 @@ int main(int argc, char **argv) {
   //   True  : continue
   //   False : exit(EXIT_FAILURE);
   int get_list_info_flag = 0;
-  for (int i = 1; i <= MAX_NUMBER_OF_LISTS; i++) {
+  initialize_object_vector(&objects);
+  // With --requests, all requested objects in the bucket are read in one pass.
+  if (strlen(requests_path) > 0) {
+    ret |= read_requests(requests_path, save_path, barcode_id, bucket_name, &objects);
+  }
+  for (int i = 1; i <= MAX_NUMBER_OF_LISTS && strlen(requests_path) < 1; i++) {
     snprintf(list_path, OUTPUT_PATH_SIZE + 1, "%s/%s/%s_%04d.lst", save_path, barcode_id, bucket_name, i);
     if (check_file(list_path) != OK) {
       if (get_list_info_flag == 0) {
@@ -544,18 +1026,24 @@ int main(int argc, char **argv) {
   //   True  : continue
   //   False : exit(EXIT_FAILURE);
   // Step #12-1: Get a physical block address of a Packed Object which includes the object.
-  //   Refer to objects->block_adress
+  //   Refer to objects.records[].block_address
     if (get_object_info_in_list(object_key, object_id, list_path, &objects) == OK) {
       get_list_info_flag = 1;
     }
   }
-  if (objects == NULL) {
+  if (objects.count == 0) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,"The object you specified was not found in the list(%s).\n", list_path);
   }
 
-  if (check_integrity(mamvci, &mamhta, "output_objects_in_object_list", scparam, save_path, barcode_id, objects, bucket_name) == NG) {
+  // Read the objects in the order of their position on tape.
+  sort_object_vector_by_address(&objects);
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu object(s) will be read in the order of the position on tape.\n", objects.count);
+  if (check_integrity(mamvci, &mamhta, "output_objects_in_object_list", scparam, save_path, barcode_id, &objects, bucket_name) == NG) {
     ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "Some error has occurred at check_integrity.\n");
   }
+  ret |= close_pax_stream();
+  ret |= close_content_verifier();
+  stop_progress_stream(PROGRESS_COMPLETE);
 
   if (structure_level == OUTPUT_PACKED_OBJECT) {
     uint32_t residual_cnt                    = 0;
@@ -569,7 +1057,7 @@ int main(int argc, char **argv) {
     char pack_id[UUID_SIZE + 1]              = { '\0' };
     char tape_data[LTOS_BLOCK_SIZE + 1]      = { '\0' };
 
-    ret |= locate_to_tape(objects->block_address);
+    ret |= locate_to_tape(objects.records[0].block_address);
     if (read_data(LTOS_BLOCK_SIZE, tape_data, &residual_cnt) == NG) {
       ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DEFAULT, "Failed to read data from tape.\n");
     }
@@ -578,8 +1066,8 @@ int main(int argc, char **argv) {
     r64(BIG, po_header + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE, &num_of_obj, 1);
     last_obj_dir_from = PO_IDENTIFIER_SIZE + PO_HEADER_SIZE + num_of_obj * PO_DIR_SIZE;
     last_obj_dir_to   = PO_IDENTIFIER_SIZE + PO_HEADER_SIZE + (num_of_obj + 1) * PO_DIR_SIZE;
-    last_obj_dir_from_block_address = objects->block_address + last_obj_dir_from / LTOS_BLOCK_SIZE;
-    last_obj_dir_to_block_address   = objects->block_address + last_obj_dir_to / LTOS_BLOCK_SIZE;
+    last_obj_dir_from_block_address = objects.records[0].block_address + last_obj_dir_from / LTOS_BLOCK_SIZE;
+    last_obj_dir_to_block_address   = objects.records[0].block_address + last_obj_dir_to / LTOS_BLOCK_SIZE;
     uuid_unparse(po_header + DIRECTORY_OFFSET_SIZE + DATA_OFFSET_SIZE + NUMBER_OF_OBJECTS_SIZE, pack_id);
     free(po_header);
     po_header = NULL;
@@ -626,7 +1114,7 @@ int main(int argc, char **argv) {
     //}
       // output po.
       long int remained_po_size = po_size;
-      ret |= locate_to_tape(objects->block_address);
+      ret |= locate_to_tape(objects.records[0].block_address);
       int po_first_block_flag = 1;
       char po_path[MAX_PATH + 1] = { 0 };
       sprintf(po_path, "%s/%s.pack", save_path, pack_id);
@@ -654,8 +1142,8 @@ int main(int argc, char **argv) {
   close(fd_tape);
   fd_tape = ERROR;
 
-  free(objects);
-  objects = NULL;
+  free_object_vector(&objects);
+  free_reader_context(ctx);
   return ret;
 }
 
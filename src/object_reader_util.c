@@ -217,19 +217,169 @@ int check_file(const char* const filename) {
 }
 
 
+/**
+ * Initialize an object vector.
+ * @param [out] (objects) Object vector to be initialized.
+ */
+void initialize_object_vector(object_vector* const objects) {
+  objects->records    = (object_record*)clf_allocate_memory(sizeof(object_record) * OBJECT_VECTOR_INITIAL_CAPACITY, "object records");
+  objects->count      = 0;
+  objects->capacity   = OBJECT_VECTOR_INITIAL_CAPACITY;
+  objects->arena      = (char*)clf_allocate_memory(OBJECT_VECTOR_INITIAL_ARENA_SIZE, "object string arena");
+  objects->arena_used = 0;
+  objects->arena_size = OBJECT_VECTOR_INITIAL_ARENA_SIZE;
+}
+
+/**
+ * Free an object vector.
+ * @param [in]  (objects) Object vector to be freed.
+ */
+void free_object_vector(object_vector* const objects) {
+  free(objects->records);
+  objects->records    = NULL;
+  free(objects->arena);
+  objects->arena      = NULL;
+  objects->count      = 0;
+  objects->capacity   = 0;
+  objects->arena_used = 0;
+  objects->arena_size = 0;
+}
+
+/**
+ * Copy a string into the arena of an object vector.
+ * @param [in/out] (objects) Object vector.
+ * @param [in]     (str)     String to be copied.
+ * @return         (offset)  Offset of the copied string in the arena.
+ */
+static uint32_t push_string_to_arena(object_vector* const objects, const char* const str) {
+  const uint64_t len = strlen(str) + 1;
+
+  if (objects->arena_size < objects->arena_used + len) {
+    uint64_t new_size = objects->arena_size * 2;
+    while (new_size < objects->arena_used + len) {
+      new_size *= 2;
+    }
+    if (UINT32_MAX < new_size) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Too many objects are found in list files.\n");
+    }
+    char* const arena = (char*)realloc(objects->arena, new_size);
+    if (arena == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
+                         "Failed to allocate %lu bytes for object string arena.\n", new_size);
+    }
+    objects->arena      = arena;
+    objects->arena_size = new_size;
+  }
+  const uint32_t offset = (uint32_t)objects->arena_used;
+  memcpy(objects->arena + offset, str, len);
+  objects->arena_used += len;
+  return offset;
+}
+
+/**
+ * Append a record to an object vector. The strings in the record are set by the caller.
+ * @param [in/out] (objects) Object vector.
+ * @return         (record)  Pointer to the appended record, which is valid until the next append.
+ */
+static object_record* push_object_record(object_vector* const objects) {
+  if (objects->count == objects->capacity) {
+    const uint64_t new_capacity = objects->capacity * 2;
+    object_record* const records = (object_record*)realloc(objects->records, sizeof(object_record) * new_capacity);
+    if (records == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
+                         "Failed to allocate %lu bytes for object records.\n", sizeof(object_record) * new_capacity);
+    }
+    objects->records  = records;
+    objects->capacity = new_capacity;
+  }
+  object_record* const record = &objects->records[objects->count++];
+  memset(record, 0, sizeof(object_record));
+  return record;
+}
+
+/**
+ * Append all records of another object vector, together with their strings.
+ * @param [in/out] (objects) Object vector to which the records are appended.
+ * @param [in]     (others)  Object vector whose records are appended.
+ */
+void append_object_vector(object_vector* const objects, const object_vector* const others) {
+  for (uint64_t i = 0; i < others->count; i++) {
+    const object_record* const source = &others->records[i];
+    object_record* const record       = push_object_record(objects);
+    *record               = *source;
+    record->key           = push_string_to_arena(objects, others->arena + source->key);
+    record->id            = push_string_to_arena(objects, others->arena + source->id);
+    record->verson_id     = push_string_to_arena(objects, others->arena + source->verson_id);
+    record->last_mod_date = push_string_to_arena(objects, others->arena + source->last_mod_date);
+    record->md5           = push_string_to_arena(objects, others->arena + source->md5);
+  }
+}
+
+/**
+ * Compare two records by their position on tape, for qsort.
+ * @param [in]  (a) Pointer to the first record.
+ * @param [in]  (b) Pointer to the second record.
+ * @return      Negative, zero or positive if a is before, same as or after b on tape.
+ */
+static int compare_object_record_address(const void* a, const void* b) {
+  const object_record* const rec_a = (const object_record*)a;
+  const object_record* const rec_b = (const object_record*)b;
+
+  if (rec_a->block_address != rec_b->block_address) {
+    return (rec_a->block_address < rec_b->block_address) ? -1 : 1;
+  }
+  if (rec_a->meta_offset != rec_b->meta_offset) {
+    return (rec_a->meta_offset < rec_b->meta_offset) ? -1 : 1;
+  }
+  return 0;
+}
+
+/**
+ * Sort an object vector by the position on tape, so that objects can be read in a single direction.
+ * @param [in/out] (objects) Object vector.
+ */
+void sort_object_vector_by_address(object_vector* const objects) {
+  if (1 < objects->count) {
+    qsort(objects->records, objects->count, sizeof(object_record), compare_object_record_address);
+  }
+}
+
+/**
+ * Check if the candidate is newer than the current one.
+ * Versions are ordered by LastModifiedTime, then by the position on tape (later written wins),
+ * then by version ID so that the result does not depend on the order in the list file.
+ * @param [in]  (objects)   Object vector which has both records.
+ * @param [in]  (candidate) Object to be checked.
+ * @param [in]  (current)   The newest object found so far.
+ * @return      (true/false) true if candidate is newer than current.
+ */
+static Bool is_newer_version(const object_vector* const objects, const object_record* const candidate, const object_record* const current) {
+  if (candidate->last_mod_epoch_ns != current->last_mod_epoch_ns) {
+    return (candidate->last_mod_epoch_ns > current->last_mod_epoch_ns) ? true : false;
+  }
+  if (candidate->block_address != current->block_address) {
+    return (candidate->block_address > current->block_address) ? true : false;
+  }
+  if (candidate->meta_offset != current->meta_offset) {
+    return (candidate->meta_offset > current->meta_offset) ? true : false;
+  }
+  return (strcmp(OBJECT_STR(objects, candidate->verson_id), OBJECT_STR(objects, current->verson_id)) > 0) ? true : false;
+}
+
+
 /**
  * get information, which has the object key, in the list file.
- * @param [in]  (object_key) Object key user wants to get.
- * @param [in]  (object_id)  Object id user wants to get.
- * @param [in]  (list_path)  File path.
- * @param [out] (objects)    Structure of each object which has the Object key.
- * @return      (OK)         return OK if at least an object is found.
+ * @param [in]     (object_key) Object key user wants to get.
+ * @param [in]     (object_id)  Object id user wants to get.
+ * @param [in]     (list_path)  File path.
+ * @param [in/out] (objects)    Objects which have the Object key are appended to this vector.
+ * @return         (OK)         return OK if at least an object is found.
  */
-int get_object_info_in_list(const char* const object_key, const char* const object_id, const char* const list_path, object_list** objects) {
+int get_object_info_in_list(const char* const object_key, const char* const object_id, const char* const list_path, object_vector* const objects) {
   int ret                      = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:get_object_info_in_list\n");
 
   // Check arguments.
-  if (object_key == NULL || object_id == NULL || list_path == NULL) {
+  if (object_key == NULL || object_id == NULL || list_path == NULL || objects == NULL) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
                        "Invalid argument at get_object_key_in_list. object_key %s or object_id %s or list_path %s is NULL.\n", object_key, object_id, list_path);
   }
@@ -243,6 +393,7 @@ int get_object_info_in_list(const char* const object_key, const char* const obje
   char readline[STR_MAX]           = {'\0'};
   char json_object_key[STR_MAX]    = {'\0'};
   char json_last_modified[STR_MAX] = {'\0'};
+  char json_last_modified_ns[STR_MAX] = {'\0'};
   char json_version_id[STR_MAX]    = {'\0'};
   char json_content_md5[STR_MAX]   = {'\0'};
   char json_object_id[STR_MAX]     = {'\0'};
@@ -254,28 +405,21 @@ int get_object_info_in_list(const char* const object_key, const char* const obje
   int end_comma_flag               = 0;
   int add_object_list_key_flag     = 0;
   int add_object_list_oid_flag     = 0;
-  struct object_list* current      = NULL;
-  struct object_list* latest       = (object_list *)clf_allocate_memory(sizeof(struct object_list), "latest");
   while ( fgets(readline, STR_MAX, fp) != NULL ) {
     if (obj_list_flag == 1) {
       if (strncmp("]", readline, strlen("]")) == 0) { // Read all objects' info in ObjectList.
-    	 if (*objects == NULL) { // In case the specified object key was not found in the list.
-    		 free(latest);
-    		 latest = NULL;
-    		 break;
-    	 }
+        if (objects->count == 0) { // In case the specified object key was not found in the list.
+          break;
+        }
         if (strcmp(object_id, "latest") == 0) {
-          current = *objects;
-          *latest  = *(*objects);
-          while(current->next != NULL) {
-            if (compare_time_string(latest->last_mod_date, current->next->last_mod_date) < 0){
-              *latest = *(current->next);
+          uint64_t latest = 0;
+          for (uint64_t i = 1; i < objects->count; i++) {
+            if (is_newer_version(objects, &objects->records[i], &objects->records[latest]) == true) {
+              latest = i;
             }
-            current = current->next;
           }
-          (*objects) = latest;
-          (*objects)->next = NULL;
-
+          objects->records[0] = objects->records[latest];
+          objects->count      = 1;
         }
         break;
       }
@@ -301,6 +445,11 @@ int get_object_info_in_list(const char* const object_key, const char* const obje
         sprintf(json_last_modified, "%s", last_modified);
         free(last_modified);
         last_modified = NULL;
+      } else if (strncmp("\"last_modified_ns\":", readline, strlen("\"last_modified_ns\":")) == 0) {
+        char *last_modified_ns = str_substring(readline, strlen("\"last_modified_ns\":") , strlen(readline) - strlen("\"last_modified_ns\":") - 1 - end_comma_flag);
+        sprintf(json_last_modified_ns, "%s", last_modified_ns);
+        free(last_modified_ns);
+        last_modified_ns = NULL;
       } else if (strncmp("\"version_id\":", readline, strlen("\"version_id\":")) == 0) {
     	 char *version_id = str_substring(readline, strlen("\"version_id\":") + 1 , strlen(readline) - strlen("\"version_id\":") - 3 - end_comma_flag);
         sprintf(json_version_id, "%s", version_id);
@@ -338,36 +487,28 @@ int get_object_info_in_list(const char* const object_key, const char* const obje
         if (add_object_list_key_flag == 1 && add_object_list_oid_flag == 1) {
           add_object_list_key_flag = 0;
           add_object_list_oid_flag = 0;
-          struct object_list* add_object = (object_list *)clf_allocate_memory(sizeof(struct object_list), "add_object");
-          add_object->block_address = atol(json_block_address);
-          add_object->data_offset = atol(json_offset);
-          strcpy((add_object->id), json_object_id);
-          //add_object->is_delete_marker
-          strcpy((add_object->key), json_object_key);
-          strcpy((add_object->last_mod_date), json_last_modified);
-          strcpy((add_object->md5), json_content_md5);
-          add_object->meta_offset = atol(json_offset);
-          add_object->metadata_size = atol(json_meta_size);
-          //strcpy((add_object->po_id),
-          add_object->size = atol(json_size);
-          strcpy((add_object->verson_id), json_version_id);
-          add_object->next                     = NULL;
-          if (*objects == NULL) {
-            *objects = add_object;
-          } else {
-            current = *objects;
-            while(1) {
-              if (current->next == NULL){
-                current->next = add_object;
-                break;
-              }
-              current = current->next;
-            }
+          object_record* const add_object = push_object_record(objects);
+          add_object->block_address = strtoull(json_block_address, NULL, 10);
+          add_object->data_offset   = strtoull(json_offset, NULL, 10);
+          add_object->meta_offset   = strtoull(json_offset, NULL, 10);
+          add_object->metadata_size = strtoull(json_meta_size, NULL, 10);
+          add_object->size          = strtoull(json_size, NULL, 10);
+          if (strlen(json_last_modified_ns) != 0) {
+            add_object->last_mod_epoch_ns = strtoull(json_last_modified_ns, NULL, 10);
+          } else if (convert_utc_to_epoch_ns(json_last_modified, &(add_object->last_mod_epoch_ns)) == NG) {
+            // List files written by older versions have no "last_modified_ns".
+            ret |= output_accdg_to_vl(OUTPUT_WARNING, DEFAULT, "Failed to convert LastModifiedTime(%s) of %s.\n", json_last_modified, json_object_key);
           }
+          add_object->id            = push_string_to_arena(objects, json_object_id);
+          add_object->key           = push_string_to_arena(objects, json_object_key);
+          add_object->last_mod_date = push_string_to_arena(objects, json_last_modified);
+          add_object->md5           = push_string_to_arena(objects, json_content_md5);
+          add_object->verson_id     = push_string_to_arena(objects, json_version_id);
           if (strcmp(object_id, "all") != 0 && strcmp(object_id, "latest") != 0) {
             break;
           }
         }
+        memset(json_last_modified_ns, 0, sizeof(json_last_modified_ns));
       }
     }
     if (strncmp("\"ObjectList\":[", readline, strlen("\"ObjectList\":[")) == 0) {
@@ -435,9 +576,181 @@ void set_force_flag(int is_force_enabled) {
 	is_force_flag = is_force_enabled;
 }
 
+/**
+ * Get force flag(-F).
+ * @return     (true/false) Whether force option is specified.
+ */
+int get_force_flag(void) {
+  return is_force_flag;
+}
+
+
+/**
+ * Set the key prefix which objects must start with to be dumped.
+ * @param [in] (prefix) Key prefix specified on the command line.
+ */
+void set_dump_filter_prefix(const char* const prefix) {
+  reader_context* const ctx = get_reader_context();
+  snprintf(ctx->dump_filter_prefix, sizeof(ctx->dump_filter_prefix), "%s", prefix);
+}
+
+/**
+ * Set the glob pattern which object keys must match to be dumped.
+ * @param [in] (pattern) Pattern specified on the command line. See fnmatch(3).
+ */
+void set_dump_filter_pattern(const char* const pattern) {
+  reader_context* const ctx = get_reader_context();
+  snprintf(ctx->dump_filter_pattern, sizeof(ctx->dump_filter_pattern), "%s", pattern);
+}
+
+/**
+ * Set the range of LastModifiedTime of objects to be dumped.
+ * @param [in]  (time_range) "<from>,<to>" in UTC like "2021-01-23T04:56:07.890123Z". Either side can be omitted.
+ *                           Objects modified at <from> or later, and before <to>, are dumped.
+ * @return      (OK/NG)      NG if time_range is not in the expected format.
+ */
+int set_dump_filter_time_range(const char* const time_range) {
+  reader_context* const ctx = get_reader_context();
+  const char* const comma = strchr(time_range, ',');
+  char from[STR_MAX]      = { '\0' };
+  char to[STR_MAX]        = { '\0' };
+
+  if (comma == NULL || (size_t)(comma - time_range) >= sizeof(from) || strlen(comma + 1) >= sizeof(to)) {
+    return NG;
+  }
+  memcpy(from, time_range, comma - time_range);
+  strcpy(to, comma + 1);
+
+  ctx->dump_filter_from_ns = 0;
+  ctx->dump_filter_to_ns   = UINT64_MAX;
+  if (strlen(from) != 0 && convert_utc_to_epoch_ns(from, &ctx->dump_filter_from_ns) == NG) {
+    return NG;
+  }
+  if (strlen(to) != 0 && convert_utc_to_epoch_ns(to, &ctx->dump_filter_to_ns) == NG) {
+    return NG;
+  }
+  if (ctx->dump_filter_to_ns <= ctx->dump_filter_from_ns) {
+    return NG;
+  }
+  return OK;
+}
+
+/**
+ * Check if any filter for full dump or resume dump is specified.
+ * @return      (true/false) true if at least one filter is specified.
+ */
+int is_dump_filter_enabled(void) {
+  reader_context* const ctx = get_reader_context();
+  if (strlen(ctx->dump_filter_prefix) != 0 || strlen(ctx->dump_filter_pattern) != 0
+      || ctx->dump_filter_from_ns != 0 || ctx->dump_filter_to_ns != UINT64_MAX) {
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Check if an object matches all filters specified for full dump or resume dump.
+ * @param [in]  (object_key)    Object key.
+ * @param [in]  (last_modified) LastModifiedTime of the object.
+ * @return      (true/false)    true if the object should be dumped.
+ */
+int match_dump_filter(const char* const object_key, const char* const last_modified) {
+  reader_context* const ctx = get_reader_context();
+  if (strlen(ctx->dump_filter_prefix) != 0 && strncmp(object_key, ctx->dump_filter_prefix, strlen(ctx->dump_filter_prefix)) != 0) {
+    return false;
+  }
+  if (strlen(ctx->dump_filter_pattern) != 0 && fnmatch(ctx->dump_filter_pattern, object_key, 0) != 0) {
+    return false;
+  }
+  if (ctx->dump_filter_from_ns != 0 || ctx->dump_filter_to_ns != UINT64_MAX) {
+    uint64_t last_modified_ns = 0;
+    if (convert_utc_to_epoch_ns(last_modified, &last_modified_ns) == NG) {
+      output_accdg_to_vl(OUTPUT_WARNING, DEFAULT, "Failed to convert LastModifiedTime(%s) of %s.\n", last_modified, object_key);
+      return false;
+    }
+    if (last_modified_ns < ctx->dump_filter_from_ns || ctx->dump_filter_to_ns <= last_modified_ns) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/**
+ * Set the byte range of object data to be output.
+ * @param [in]  (range) "<offset>:<length>" in bytes. If <length> is omitted, the range lasts up to the end of the object.
+ * @return      (OK/NG) NG if range is not in the expected format or <length> is 0.
+ */
+int set_object_range(const char* const range) {
+  reader_context* const ctx = get_reader_context();
+  char* end = NULL;
+
+  if (!isdigit(range[0])) {
+    return NG;
+  }
+  errno = 0;
+  ctx->object_range_offset = strtoull(range, &end, 10);
+  if (errno != 0 || *end != ':') {
+    return NG;
+  }
+  ctx->object_range_length = 0;
+  if (*(end + 1) != '\0') {
+    if (!isdigit(*(end + 1))) {
+      return NG;
+    }
+    ctx->object_range_length = strtoull(end + 1, &end, 10);
+    if (errno != 0 || *end != '\0' || ctx->object_range_length == 0) {
+      return NG;
+    }
+  }
+  ctx->is_range_specified = true;
+  return OK;
+}
+
+/**
+ * Get the byte range of object data to be output.
+ * @param [out] (offset) Offset of the range from the beginning of object data.
+ * @param [out] (length) Length of the range. 0 means up to the end of the object.
+ * @return      (true/false) true if the range is specified.
+ */
+int get_object_range(uint64_t* const offset, uint64_t* const length) {
+  reader_context* const ctx = get_reader_context();
+  *offset = ctx->object_range_offset;
+  *length = ctx->object_range_length;
+  return ctx->is_range_specified;
+}
+
+/**
+ * Get the disk space available for unprivileged user at specified path.
+ * @param [in]  (path)      Path you want to check.
+ * @param [out] (size)      Available disk space.(Byte)
+ * @return      (OK/NG)     If success, return OK. Otherwise, return NG.
+ */
+static int sample_disk_space(const char* const path, uint64_t* const size) {
+  reader_context* const ctx = get_reader_context();
+  struct statvfs statvfs_buf = { 0 };
+  if (statvfs(path, &statvfs_buf) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to get a disk space of %s.\n", path);
+  }
+  *size = (uint64_t)statvfs_buf.f_bavail * statvfs_buf.f_frsize;
+  ctx->disk_space_sampled_at = time(NULL);
+  ctx->disk_space_committed  = 0;
+  return OK;
+}
+
+/**
+ * Add the size written to the disk since the last sample of the disk space.
+ * @param [in]  (size)      Size written.(Byte)
+ */
+void commit_disk_space(const uint64_t size) {
+  reader_context* const ctx = get_reader_context();
+  ctx->disk_space_committed += size;
+}
 
 /**
  * Check if the disk space (GiB) at specified path is greater than the total size of MIN_REQUIRED_DISK_SPACE_GiB and specified size.
+ * The disk space is sampled with statvfs at DISK_SPACE_SAMPLE_INTERVAL, or when the estimation from the last sample
+ * and the size written since then does not satisfy the requirement.
  * @param [in]  (path)      Path you want to check.
  * @param [in]  (data_size) Size you want to write.(Byte)
  * @return      (OK/NG)     OK  :The disk space (GiB) at specified path is greater than MIN_REQUIRED_DISK_SPACE_GiB.
@@ -445,42 +758,148 @@ void set_force_flag(int is_force_enabled) {
  *                               or the disk space (GiB) at specified path is less than MIN_REQUIRED_DISK_SPACE_GiB.
  */
 int check_disk_space(const char* const path, const uint64_t data_size) {
+  reader_context* const ctx = get_reader_context();
 
   int ret  = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:check_disk_space\n");
-  FILE* out = NULL;
-  char df_command_buff[PATH_MAX + DISK_SPACE_COMMAND_SIZE + 1]  = { '\0' };
-  char result[MAX_DISK_SPACE_LENGTH + 1]   = { '\0' };
-  uint64_t size = 0;
+  const uint64_t required_size = MIN_REQUIRED_DISK_SPACE_GiB * 1024 * 1024 * 1024 + data_size;
 
   if (is_force_flag == true) {
 	  return ret;
   }
-  sprintf(df_command_buff, "df %s | tail -n 1 | awk '{print $4 }' >%s", path, DF_CMD_LOG_PATH);
-  system(df_command_buff);
-  out = fopen(DF_CMD_LOG_PATH,"r");
-  if (out == NULL) {
-    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to run \"df\" commmand to get a disk space.\n", path);
+  Bool sample_flag = false;
+  if (strncmp(ctx->disk_space_path, path, PATH_MAX) != 0) {
+    strncpy(ctx->disk_space_path, path, PATH_MAX);
+    sample_flag = true;
+  } else if (DISK_SPACE_SAMPLE_INTERVAL <= time(NULL) - ctx->disk_space_sampled_at) {
+    sample_flag = true;
+  } else if (ctx->disk_space_available < ctx->disk_space_committed + required_size) {
+    sample_flag = true; // Confirm with the actual disk space before failing.
   }
-  while (!feof(out)) {
-    fgets(result, sizeof(result), out);
+  if (sample_flag == true) {
+    if (sample_disk_space(path, &ctx->disk_space_available) != OK) {
+      ctx->disk_space_path[0] = '\0';
+      return NG;
+    }
+    ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "Disk space (GiB) = %ld\n", ctx->disk_space_available / (1024 * 1024 * 1024));
   }
-  (void) fclose(out);
-  out = NULL;
+  const uint64_t size = (ctx->disk_space_committed < ctx->disk_space_available) ? ctx->disk_space_available - ctx->disk_space_committed : 0;
 
-  size = (atol(result) * 1024); // KiB to Byte conversion
-
-  if (size == 0) { // It means that "result" is not digit or disk space = 0;
+  if (size == 0) {
     ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Disk space specified is zero.\n");
   }
 
-  if (size < MIN_REQUIRED_DISK_SPACE_GiB * pow(1024, 3) + data_size) {
+  if (size < required_size) {
     output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO,
            "Disk space is not large enough: %ld (GiB).\n"
-           "%sSpecify --Force option or keep >%d GiB disk space.\n", (uint64_t)(size / pow(1024, 3)), INDENT, MIN_REQUIRED_DISK_SPACE_GiB);
+           "%sSpecify --Force option or keep >%d GiB disk space.\n", size / (1024 * 1024 * 1024), INDENT, MIN_REQUIRED_DISK_SPACE_GiB);
     //Don't specify "OUTPUT_ERROR" as an argument of "output_accdg_to_vl" because, history.log should be output even if exit option(--continue) is specified.
     ret = NG;
   }
-  ret |= output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "Disk space (GiB) = %ld\n", (uint64_t)(size / pow(1024, 3)));
+  return ret;
+}
+
+/**
+ * Take an advisory lock on a file, which is released when the process exits.
+ * @param [in]  (lock_path) Path of the lock file.
+ * @return      (OK/NG)     If the lock is taken, return OK. If another process holds it, return NG.
+ */
+static int lock_file(const char* const lock_path) {
+  int fd = open(lock_path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    return output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Can't open file: %s\n", lock_path);
+  }
+  struct flock lock = { 0 };
+  lock.l_type   = F_WRLCK;
+  lock.l_whence = SEEK_SET;
+  if (fcntl(fd, F_SETLK, &lock) != OK) {
+    close(fd);
+    return NG;
+  }
+  // Keep fd opened so that the lock lasts until the process exits.
+  return OK;
+}
+
+/**
+ * Make a name of a workspace from a device name, e.g. "/dev/sg4" to "sg4".
+ * @param [in]  (drive_name) Device name of a tape drive.
+ * @param [out] (drive_key)  Name used in the workspace.
+ */
+static void get_drive_key(const char* const drive_name, char drive_key[DEVICE_NAME_SIZE + 1]) {
+  const char* const base_name = strrchr(drive_name, '/');
+  snprintf(drive_key, DEVICE_NAME_SIZE + 1, "%s", (base_name == NULL) ? drive_name : base_name + 1);
+}
+
+/**
+ * Make a relative path absolute.
+ * @param [in]     (base_path) Absolute path of the directory which the path is relative to.
+ * @param [in/out] (path)      Path, which is replaced with the absolute path if it is relative.
+ * @param [in]     (path_size) Size of the buffer of the path.
+ * @return         (OK/NG)     If the absolute path fits in the buffer, return OK. Otherwise, return NG.
+ */
+int make_absolute_path(const char* const base_path, char* const path, const size_t path_size) {
+  if (path[0] == '/') {
+    return OK;
+  }
+  char relative_path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  if (snprintf(relative_path, sizeof(relative_path), "%s", path) >= (int)sizeof(relative_path)
+      || snprintf(path, path_size, "%s/%s", base_path, relative_path) >= (int)path_size) {
+    return output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Path is too long: %s/%s\n", base_path, relative_path);
+  }
+  return OK;
+}
+
+/**
+ * Lock a tape drive, so that only one object reader uses the drive on this host.
+ * @param [in]  (workspace_root) Directory in which workspaces are created.
+ * @param [in]  (drive_name)     Device name of a tape drive.
+ * @return      (OK/NG)          If success, return OK. Otherwise, return NG.
+ */
+int lock_drive(const char* const workspace_root, const char* const drive_name) {
+  int ret                              = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:lock_drive\n");
+  char drive_key[DEVICE_NAME_SIZE + 1] = { '\0' };
+  char lock_path[MAX_PATH + 1]         = { '\0' };
+
+  get_drive_key(drive_name, drive_key);
+  if (snprintf(lock_path, sizeof(lock_path), "%s/%s%s", workspace_root, drive_key, WORKSPACE_LOCK_EXTENSION) >= (int)sizeof(lock_path)) {
+    return output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Path of the lock file is too long: %s/%s%s\n",
+                              workspace_root, drive_key, WORKSPACE_LOCK_EXTENSION);
+  }
+  // The lock path is longer than the root with a trailing slash, so the root fits in the buffer.
+  snprintf(lock_path, sizeof(lock_path), "%s/", workspace_root);
+  ret |= mk_deep_dir(lock_path);
+  snprintf(lock_path, sizeof(lock_path), "%s/%s%s", workspace_root, drive_key, WORKSPACE_LOCK_EXTENSION);
+  if (lock_file(lock_path) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Tape drive(%s) is used by another process.\n", drive_name);
+  }
+  return ret;
+}
+
+/**
+ * Enter a workspace which is dedicated to a tape.
+ * The workspace holds the marker files of the reference partition, the history journal and temporary files,
+ * which are referred with relative paths, so the current directory is changed to it.
+ * It does not depend on the drive, so that a dump can be resumed with the tape loaded in another drive.
+ * @param [in]  (workspace_root) Directory in which workspaces are created.
+ * @param [in]  (barcode_id)     Barcode of the tape.
+ * @return      (OK/NG)          If success, return OK. Otherwise, return NG.
+ */
+int enter_workspace(const char* const workspace_root, const char* const barcode_id) {
+  int ret                      = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:enter_workspace\n");
+  char workspace[MAX_PATH + 1] = { '\0' };
+
+  if (snprintf(workspace, sizeof(workspace), "%s/%s/%s", workspace_root, barcode_id, TEMP_PATH) >= (int)sizeof(workspace)) {
+    return output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Path of the workspace is too long: %s/%s\n", workspace_root, barcode_id);
+  }
+  ret |= mk_deep_dir(workspace);
+  snprintf(workspace, sizeof(workspace), "%s/%s", workspace_root, barcode_id);
+  if (chdir(workspace) != OK) {
+    return output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to change directory to the workspace(%s).\n", workspace);
+  }
+  // The same tape may be loaded in another drive, but the workspace is still dedicated to this process.
+  if (lock_file(WORKSPACE_LOCK_FILE) != OK) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Workspace(%s) is used by another process.\n", workspace);
+  }
+  ret |= output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Workspace: %s\n", workspace);
   return ret;
 }
 
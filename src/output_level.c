@@ -23,145 +23,143 @@
 #include <stdarg.h>
 #include "ltos_format_checker.h"
 
-static const char* verbose_level = NULL; // DISPLAY_HEADER_INFO, DISPLAY_HEADER_AND_L4_INFO, ... DISPLAY_ALL_INFO
+unsigned int output_verbose_mask = 1U << DISPLAY_COMMON_INFO | 1U << DISPLAY_UNKNOWN;
+int output_top_verbose           = DISPLAY_UNKNOWN;
 static const char* continue_mode = NULL; // CONT or not
-static const char* top_verbose   = NULL;
+static FILE* info_stream         = NULL; // Stream of INFO, DEBUG and TRACE. NULL means stdout.
+static const char* const log_level_labels[] = {
+  "[SYS_ERR] ", "[ERROR  ] ", "[WARNING] ", "[INFO   ] ", "[DEBUG  ] ", "[TRACE  ] "
+};
+static const char* const verbose_labels[] = {
+  "[COMMON] ", "[LABEL ] ", "[RCM   ] ", "[PR    ] ", "[OCM   ] ", "[POINFO] ", "[MISC  ] ", "[UNKNOWN] "
+};
+static __thread time_t timestamp_second    = -1;  // Second formatted in timestamp_prefix.
+static __thread char timestamp_prefix[80]  = { '\0' };
 
 /**
  * Set verbose level specified in command line.
+ * Messages whose verbose level is up to the number of "v" are displayed. Any other option displays only common ones.
  * @param [in] (vl) Verbose level option specified on the command line.
  */
 void set_vl(const char* const vl) {
-  verbose_level = vl;
+  int verbose_rank = 0;
+  if (vl != NULL && strlen(vl) <= VERBOSE_OPTION_MAX_LENGTH && strspn(vl, "v") == strlen(vl)) {
+    verbose_rank = strlen(vl);
+  }
+  output_verbose_mask = 1U << DISPLAY_UNKNOWN;
+  for (int i = DISPLAY_COMMON_INFO; i <= verbose_rank; i++) {
+    output_verbose_mask |= 1U << i;
+  }
 }
 
 /**
  * Set verbose level specified in each method.
- * @param [in] (t_verbose) Verbose level option specified in each method.
+ * @param [in] (t_verbose) Verbose level option specified in each method. DEFAULT to reset it.
  */
-void set_top_verbose(const char* const t_verbose) {
-  top_verbose = t_verbose;
+void set_top_verbose(const int t_verbose) {
+  output_top_verbose = (t_verbose == DEFAULT) ? DISPLAY_UNKNOWN : t_verbose;
 }
 
 /**
  * Get verbose level specified in each method.
- * @param [in] (t_verbose) Verbose level option specified in each method.
+ * @return Verbose level specified in each method.
  */
-const char* get_top_verbose() {
-  return top_verbose;
+int get_top_verbose() {
+  return output_top_verbose;
 }
 
 /**
- * Set continue mode.
- * @param [in] (c_mode) Continue mode option specified on the command line.
+ * Set the stream to which INFO, DEBUG and TRACE messages are written, e.g. stderr when stdout carries data.
+ * Messages already queued are written to the previous stream first.
+ * @param [in] (stream) Stream. NULL to write to stdout.
  */
-void set_c_mode(const char* const c_mode) {
-	continue_mode = c_mode;
+void set_info_stream(FILE* const stream) {
+  flush_log_ring();
+  info_stream = stream;
 }
 
 /**
- * Get verbose rank to check a rank includes other rank or not.
- * @param [in] (verbose) String to show verbose.
- * @return               Verbose rank is returned. Bigger value means more verbose.
+ * Set continue mode.
+ * @param [in] (c_mode) Continue mode option specified on the command line.
  */
-static int get_verbose_rank(const char* const verbose) {
-  int verbose_rank = 0;
-
-  if (strcmp(verbose, DISPLAY_HEADER_INFO) == 0) {
-    verbose_rank = 1;
-  } else if (strcmp(verbose, DISPLAY_HEADER_AND_L4_INFO) == 0) {
-    verbose_rank = 2;
-  } else if (strcmp(verbose, DISPLAY_HEADER_AND_L43_INFO) == 0) {
-    verbose_rank = 3;
-  } else if (strcmp(verbose, DISPLAY_HEADER_AND_L432_INFO) == 0) {
-    verbose_rank = 4;
-  } else if (strcmp(verbose, DISPLAY_HEADER_AND_L4321_INFO) == 0) {
-    verbose_rank = 5;
-  } else if (strcmp(verbose, DISPLAY_ALL_INFO) == 0) {
-    verbose_rank = 6;
-  }
-
-  return verbose_rank;
+void set_c_mode(const char* const c_mode) {
+	continue_mode = c_mode;
 }
 
 /**
- * Output header according to verbose level.
- * @param [out] (stream)    Stream to write header. stdout, stderr or log file.
+ * Format the header of a message according to verbose level.
+ * The date and time are formatted once a second, and only milliseconds are formatted for each message.
+ * @param [out] (header)    Buffer of the header.
+ * @param [in]  (size)      Size of the buffer.
  * @param [in]  (log_level) Log Level like Error, Warning, Info, Debug and Trace.
  * @param [in]  (verbose)   Verbose level like Label, RCM, PR, OCM, PO and MISC.
+ * @return                  Length of the header.
  */
-static void print_header(FILE* const stream, const char* const log_level, const char* const verbose) {
+int format_log_header(char* const header, const size_t size, const int log_level, const int verbose) {
   struct timeval tvToday; // for msec
-  struct tm *ptm; // for date and time
 
   gettimeofday(&tvToday, NULL); // Today
-  ptm = localtime(&tvToday.tv_sec);
-  char char_date_and_time_now[MAX_PATH + 1] = { 0 };
-  sprintf(char_date_and_time_now, "%04d/%02d/%02d %02d:%02d:%02d.%3d ",
-      ptm->tm_year + 1900, ptm->tm_mon + 1, ptm->tm_mday,
-      ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
-      (uint16_t)(tvToday.tv_usec / 1000));
-  fprintf(stream, char_date_and_time_now);
-
-  fprintf(stream, log_level);
-
-  if (!strcmp(verbose, DISPLAY_COMMON_INFO)) {
-    fprintf(stream, "[COMMON] ");
-  } else if (!strcmp(verbose, DISPLAY_HEADER_INFO)) {
-    fprintf(stream, "[LABEL ] ");
-  } else if (!strcmp(verbose ,DISPLAY_HEADER_AND_L4_INFO)) {
-    fprintf(stream, "[RCM   ] ");
-  } else if (!strcmp(verbose ,DISPLAY_HEADER_AND_L43_INFO)) {
-    fprintf(stream, "[PR    ] ");
-  } else if (!strcmp(verbose ,DISPLAY_HEADER_AND_L432_INFO)) {
-    fprintf(stream, "[OCM   ] ");
-  } else if (!strcmp(verbose ,DISPLAY_HEADER_AND_L4321_INFO)) {
-    fprintf(stream, "[POINFO] ");
-  } else if (!strcmp(verbose ,DISPLAY_ALL_INFO)) {
-    fprintf(stream, "[MISC  ] ");
-  } else {
-    fprintf(stream, "[UNKNOWN] ");
+  if (tvToday.tv_sec != timestamp_second) {
+    struct tm tm_now; // for date and time
+    localtime_r(&tvToday.tv_sec, &tm_now);
+    snprintf(timestamp_prefix, sizeof(timestamp_prefix), "%04d/%02d/%02d %02d:%02d:%02d.",
+        tm_now.tm_year + 1900, tm_now.tm_mon + 1, tm_now.tm_mday,
+        tm_now.tm_hour, tm_now.tm_min, tm_now.tm_sec);
+    timestamp_second = tvToday.tv_sec;
   }
+  return snprintf(header, size, "%s%3d %s%s", timestamp_prefix, (uint16_t)(tvToday.tv_usec / 1000),
+                  log_level_labels[log_level], verbose_labels[verbose]);
 }
 
 /**
  * Output information according to verbose level.
- * @param [in] (log_level) ERROR/WARNING/INFO/DEBUG/TRACE
+ * Use output_accdg_to_vl(), which calls this function only for messages to be displayed.
+ * INFO, DEBUG and TRACE messages are queued to the log ring if it is running, and dropped if it is full.
+ * Errors and warnings are written at once after the queued messages.
+ * @param [in] (log_level) OUTPUT_SYSTEM_ERROR/OUTPUT_ERROR/OUTPUT_WARNING/OUTPUT_INFO/OUTPUT_DEBUG/OUTPUT_TRACE
  * @param [in] (verbose)   Verbose level specified in each method.
  * @param [in] (format)    Information to display.
  * @return     (OK/NG)     For Error message, return NG. Otherwise, return OK.
  */
-int output_accdg_to_vl(const char* const log_level, const char* verbose, const char * restrict format, ...){
-  int ret = OK;
+int write_accdg_to_vl(const int log_level, int verbose, const char * restrict format, ...){
+  int ret                      = OK;
+  char header[LOG_HEADER_SIZE] = { '\0' };
   va_list args;
 
-  if (top_verbose == NULL && !strcmp(verbose, DEFAULT)) {
-    verbose = "UNKNOWN";
-  }
-  if (!strcmp(verbose, DEFAULT)) {
-    verbose = top_verbose;
+  if (verbose == DEFAULT) {
+    verbose = output_top_verbose;
   }
+  format_log_header(header, sizeof(header), log_level, verbose);
   va_start(args, format);
-  if (!strcmp(log_level, OUTPUT_ERROR) || !strcmp(log_level, OUTPUT_WARNING) || !strcmp(log_level, OUTPUT_SYSTEM_ERROR)) {
-    fflush(stdout);
-    print_header(stderr, log_level, verbose);
+  if (log_level <= OUTPUT_WARNING) {
+    flush_log_ring();
+    fflush((info_stream != NULL) ? info_stream : stdout);
+    flockfile(stderr);
+    fputs(header, stderr);
     vfprintf(stderr, format, args);
     fflush(stderr);
+    funlockfile(stderr);
 
-    if (!strcmp(log_level, OUTPUT_SYSTEM_ERROR)) {
+    if (log_level == OUTPUT_SYSTEM_ERROR) {
       va_end(args);
       exit(1);
-    } else if (!strcmp(log_level, OUTPUT_ERROR)) {
+    } else if (log_level == OUTPUT_ERROR) {
+      add_metric_counter(METRIC_ERRORS, 1);
       if (strcmp(continue_mode, CONT) != 0) {
         va_end(args);
         exit(1);
       }
       ret = NG;
     }
-  } else if (!strcmp(log_level, OUTPUT_INFO) || !strcmp(log_level, OUTPUT_DEBUG) || !strcmp(log_level, OUTPUT_TRACE)) {
-    if (get_verbose_rank(verbose_level) >= get_verbose_rank(verbose)) {
-      print_header(stdout, log_level, verbose);
-      vprintf(format, args);
+  } else {
+    FILE* const stream = (info_stream != NULL) ? info_stream : stdout;
+    if (is_log_ring_running() == true) {
+      enqueue_log_record(stream, header, format, args);
+    } else {
+      flockfile(stream);
+      fputs(header, stream);
+      vfprintf(stream, format, args);
+      funlockfile(stream);
     }
   }
   va_end(args);
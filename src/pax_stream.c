@@ -0,0 +1,275 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file pax_stream.c
+ *
+ * Output of objects as a POSIX pax archive(IEEE Std 1003.1 pax interchange format) instead of files.
+ *
+ * Each object is an entry "<bucket>/<object key>/<object id>.data" preceded by an extended header,
+ * which holds the path, the size, the LastModifiedTime and the OTFORMAT.* records for the object key,
+ * the version, the object ID and the metadata as it is on tape. The object data is written from the tape buffers.
+ */
+
+#ifdef OBJ_READER
+#include "ltos_format_checker.h"
+
+static int pax_fd                 = -1;    // Archive, or -1 if objects are written to files.
+static int is_pax_stdout          = false;
+static uint64_t pax_remained_size = 0;     // Bytes of the current entry which are not written yet.
+static uint64_t pax_entry_size    = 0;     // Size of the current entry.
+static uint64_t pax_entry_count   = 0;
+
+
+/**
+ * Write all bytes to the archive.
+ * @param [in]  (data)  Data to be written.
+ * @param [in]  (size)  Size of the data.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int write_pax(const void* data, uint64_t size) {
+  const uint8_t* p     = (const uint8_t*)data;
+  const uint64_t start = start_metric_timer();
+  while (size > 0) {
+    const ssize_t written = write(pax_fd, p, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the pax archive. error=%s\n", strerror(errno));
+    }
+    p    += written;
+    size -= written;
+    add_progress_written_size(written);
+    add_metric_counter(METRIC_OUTPUT_BYTES, written);
+  }
+  observe_metric_timer(METRIC_OUTPUT_WRITE, start);
+  return OK;
+}
+
+/**
+ * Write zeros up to the next boundary of PAX_BLOCK_SIZE.
+ * @param [in]  (size)  Size written since the last boundary.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int write_pax_padding(const uint64_t size) {
+  static const uint8_t zeros[PAX_BLOCK_SIZE] = { 0 };
+  if (size % PAX_BLOCK_SIZE == 0) {
+    return OK;
+  }
+  return write_pax(zeros, PAX_BLOCK_SIZE - size % PAX_BLOCK_SIZE);
+}
+
+/**
+ * Fill the rest of the current entry and its padding with zeros, so that the next header starts at a boundary.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int fill_pax_entry(void) {
+  static const uint8_t zeros[PAX_BLOCK_SIZE] = { 0 };
+  int ret                                    = OK;
+
+  while (pax_remained_size > 0 && ret == OK) {
+    const uint64_t size = MIN(pax_remained_size, PAX_BLOCK_SIZE);
+    ret |= write_pax(zeros, size);
+    pax_remained_size -= size;
+  }
+  pax_remained_size = 0;
+  return ret | write_pax_padding(pax_entry_size);
+}
+
+/**
+ * Append a "<length> <keyword>=<value>\n" record of an extended header.
+ * The length is the decimal length of the whole record including the length itself.
+ * @param [in/out] (records)      Records.
+ * @param [in/out] (records_size) Size of the records.
+ * @param [in]     (keyword)      Keyword.
+ * @param [in]     (value)        Value, which may contain any byte.
+ * @param [in]     (value_size)   Size of the value.
+ */
+static void add_pax_record(char** const records, uint64_t* const records_size,
+                           const char* const keyword, const char* const value, const uint64_t value_size) {
+  const uint64_t body_size = 1 + strlen(keyword) + 1 + value_size + 1;  // " keyword=value\n"
+  uint64_t record_size     = body_size + 1;
+  while (snprintf(NULL, 0, "%lu", record_size) + body_size != record_size) {
+    record_size++;
+  }
+  *records = (char*)realloc(*records, *records_size + record_size);
+  if (*records == NULL) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to allocate memory for pax records.\n");
+  }
+  char* p = *records + *records_size;
+  p += sprintf(p, "%lu %s=", record_size, keyword);
+  memcpy(p, value, value_size);
+  p[value_size] = '\n';
+  *records_size += record_size;
+}
+
+/**
+ * Write a ustar header block.
+ * Fields which do not fit are left to the records of the extended header before it.
+ * @param [in]  (name)     Name of the entry.
+ * @param [in]  (size)     Size of the entry.
+ * @param [in]  (mtime)    Modification time in seconds since the Epoch.
+ * @param [in]  (typeflag) Type of the entry.
+ * @return      (OK/NG)    If success, return OK. Otherwise, return NG.
+ */
+static int write_ustar_header(const char* const name, const uint64_t size, const uint64_t mtime, const char typeflag) {
+  uint8_t header[PAX_BLOCK_SIZE] = { 0 };
+  uint32_t checksum              = 0;
+
+  strncpy((char*)header, name, 99);                                         // name[100]
+  sprintf((char*)header + 100, "%07o", 0644);                               // mode[8]
+  sprintf((char*)header + 108, "%07o", 0);                                  // uid[8]
+  sprintf((char*)header + 116, "%07o", 0);                                  // gid[8]
+  sprintf((char*)header + 124, "%011lo", (size < PAX_USTAR_MAX_SIZE) ? size : 0);  // size[12]
+  sprintf((char*)header + 136, "%011lo", (mtime < PAX_USTAR_MAX_SIZE) ? mtime : 0); // mtime[12]
+  memset(header + 148, ' ', 8);                                             // chksum[8]
+  header[156] = typeflag;
+  memcpy(header + 257, "ustar", 6);                                         // magic[6]
+  memcpy(header + 263, "00", 2);                                            // version[2]
+  for (int i = 0; i < PAX_BLOCK_SIZE; i++) {
+    checksum += header[i];
+  }
+  sprintf((char*)header + 148, "%06o", checksum);
+  return write_pax(header, PAX_BLOCK_SIZE);
+}
+
+/**
+ * Start to write objects to a pax archive instead of files.
+ * If the archive is stdout, messages which would be written to stdout are written to stderr.
+ * @param [in]  (pax_path) Path of the archive, or "-" for stdout.
+ * @return      (OK/NG)    If success, return OK. Otherwise, return NG.
+ */
+int open_pax_stream(const char* const pax_path) {
+  if (!strcmp(pax_path, PAX_STDOUT)) {
+    fflush(stdout);
+    pax_fd        = STDOUT_FILENO;
+    is_pax_stdout = true;
+    set_info_stream(stderr);
+    return OK;
+  }
+  pax_fd = open(pax_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (pax_fd < 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to open the pax archive(%s). error=%s\n", pax_path, strerror(errno));
+  }
+  return OK;
+}
+
+/**
+ * Check if objects are written to a pax archive.
+ * @return      (true/false) If a pax archive is open, return true. Otherwise, return false.
+ */
+int is_pax_stream_enabled(void) {
+  return (pax_fd >= 0) ? true : false;
+}
+
+/**
+ * Start an entry of an object. Its data follows with write_pax_data().
+ * @param [in]  (bucket_name)   Bucket name.
+ * @param [in]  (object_key)    Object key.
+ * @param [in]  (object_id)     Object ID.
+ * @param [in]  (version_id)    Version ID.
+ * @param [in]  (last_modified) LastModifiedTime.
+ * @param [in]  (meta_data)     Metadata of the object.
+ * @param [in]  (object_size)   Size of the object data.
+ * @return      (OK/NG)         If success, return OK. Otherwise, return NG.
+ */
+int begin_pax_entry(const char* const bucket_name, const char* const object_key, const char* const object_id,
+                    const char* const version_id, const char* const last_modified, const char* const meta_data,
+                    const uint64_t object_size) {
+  int ret                          = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:begin_pax_entry\n");
+  char* records                    = NULL;
+  uint64_t records_size            = 0;
+  uint64_t last_modified_ns        = 0;
+  char path[MAX_PATH * 2 + 1]      = { '\0' };
+  char number[PAX_NUMBER_SIZE + 1] = { '\0' };
+
+  if (pax_remained_size != 0) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The previous entry of the pax archive is filled with zeros. %lu bytes.\n",
+                              pax_remained_size);
+    ret |= fill_pax_entry();
+  }
+  if (convert_utc_to_epoch_ns(last_modified, &last_modified_ns) == NG) {
+    ret |= output_accdg_to_vl(OUTPUT_WARNING, DEFAULT, "Failed to convert LastModifiedTime(%s) of %s.\n", last_modified, object_key);
+  }
+  snprintf(path, sizeof(path), "%s/%s/%s.data", bucket_name, object_key, object_id);
+  add_pax_record(&records, &records_size, "path", path, strlen(path));
+  snprintf(number, sizeof(number), "%lu", object_size);
+  add_pax_record(&records, &records_size, "size", number, strlen(number));
+  snprintf(number, sizeof(number), "%lu.%09lu", last_modified_ns / 1000000000, last_modified_ns % 1000000000);
+  add_pax_record(&records, &records_size, "mtime", number, strlen(number));
+  add_pax_record(&records, &records_size, PAX_VENDOR ".bucket", bucket_name, strlen(bucket_name));
+  add_pax_record(&records, &records_size, PAX_VENDOR ".key", object_key, strlen(object_key));
+  add_pax_record(&records, &records_size, PAX_VENDOR ".object_id", object_id, strlen(object_id));
+  add_pax_record(&records, &records_size, PAX_VENDOR ".version_id", version_id, strlen(version_id));
+  add_pax_record(&records, &records_size, PAX_VENDOR ".metadata", meta_data, strlen(meta_data));
+
+  ret |= write_ustar_header(PAX_HEADER_NAME, records_size, last_modified_ns / 1000000000, PAX_TYPE_EXTENDED);
+  ret |= write_pax(records, records_size);
+  ret |= write_pax_padding(records_size);
+  ret |= write_ustar_header(path, object_size, last_modified_ns / 1000000000, PAX_TYPE_REGULAR);
+  free(records);
+
+  pax_entry_size    = object_size;
+  pax_remained_size = object_size;
+  pax_entry_count++;
+  return ret;
+}
+
+/**
+ * Write a part of the data of the current entry. The entry is padded when all of its data is written.
+ * @param [in]  (data)  Data read from tape.
+ * @param [in]  (size)  Size of the data.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+int write_pax_data(const char* const data, const uint64_t size) {
+  if (pax_remained_size < size) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The data exceeds the size of the entry of the pax archive.\n");
+  }
+  int ret = write_pax(data, size);
+  pax_remained_size -= size;
+  if (pax_remained_size == 0) {
+    ret |= write_pax_padding(pax_entry_size);
+  }
+  return ret;
+}
+
+/**
+ * Finish the pax archive with two zero blocks.
+ * An incomplete entry is filled with zeros, so that the archive can still be read.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+int close_pax_stream(void) {
+  static const uint8_t zeros[PAX_BLOCK_SIZE] = { 0 };
+  int ret                                    = OK;
+
+  if (pax_fd < 0) {
+    return OK;
+  }
+  if (pax_remained_size != 0) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The last entry of the pax archive is filled with zeros. %lu bytes.\n",
+                              pax_remained_size);
+    ret |= fill_pax_entry();
+  }
+  for (int i = 0; i < PAX_END_BLOCKS; i++) {
+    ret |= write_pax(zeros, PAX_BLOCK_SIZE);
+  }
+  if (is_pax_stdout == false) {
+    close(pax_fd);
+  }
+  pax_fd = -1;
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu object(s) are written to the pax archive.\n", pax_entry_count);
+  return ret;
+}
+#endif // OBJ_READER
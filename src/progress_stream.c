@@ -0,0 +1,314 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file progress_stream.c
+ *
+ * Machine-readable progress of a dump, written as NDJSON(one JSON object per line) to a file descriptor.
+ *
+ * The reading thread only updates counters. A background thread writes a record at a fixed interval,
+ * so that a record is written even while a large object is being read, and a stalled drive can be detected.
+ * Throughput is calculated over sliding windows from the samples taken at each record.
+ */
+
+#ifdef OBJ_READER
+#include <pthread.h>
+#include <signal.h>
+#include "ltos_format_checker.h"
+
+typedef struct {
+  double time;                            // Seconds since the progress stream was started.
+  uint64_t read_size;
+  uint64_t written_size;
+  uint64_t objects;
+  uint64_t block;
+} progress_sample;
+
+static int progress_fd                        = -1;
+static uint32_t progress_interval             = PROGRESS_DEFAULT_INTERVAL;
+static char progress_tape_id[BARCODE_SIZE + 1] = { '\0' };
+static struct timeval progress_start;
+static pthread_t progress_writer;
+static pthread_mutex_t progress_mutex         = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t progress_cond           = PTHREAD_COND_INITIALIZER;
+static const char* progress_stop_state       = NULL;  // State of the last record, or NULL while running.
+static progress_sample progress_first;          // Sample at the start.
+static progress_sample progress_samples[PROGRESS_SAMPLES];
+static uint64_t progress_sample_count         = 0;
+
+/* Updated by the reading thread, and read by the writer thread. */
+static uint64_t progress_pr         = 0;
+static uint64_t progress_ocm        = 0;
+static uint64_t progress_po         = 0;
+static uint64_t progress_object     = 0;
+static uint64_t progress_block      = 0;
+static uint64_t progress_pr_total   = 0;
+static uint64_t progress_ocm_total  = 0;
+static uint64_t progress_po_total   = 0;
+static uint64_t progress_obj_total  = 0;
+static uint64_t progress_blk_total  = 0;
+static uint64_t progress_read_size  = 0;
+static uint64_t progress_write_size = 0;
+
+/**
+ * Get seconds since the progress stream was started.
+ * @return      Seconds.
+ */
+static double get_progress_time(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - progress_start.tv_sec) + (now.tv_usec - progress_start.tv_usec) / 1000000.0;
+}
+
+/**
+ * Take a sample of the counters.
+ * @param [out] (sample) Sample.
+ */
+static void take_progress_sample(progress_sample* const sample) {
+  sample->time         = get_progress_time();
+  sample->read_size    = __atomic_load_n(&progress_read_size, __ATOMIC_RELAXED);
+  sample->written_size = __atomic_load_n(&progress_write_size, __ATOMIC_RELAXED);
+  sample->objects      = __atomic_load_n(&progress_object, __ATOMIC_RELAXED);
+  sample->block        = __atomic_load_n(&progress_block, __ATOMIC_RELAXED);
+}
+
+/**
+ * Find the sample from which a sliding window starts.
+ * It is the latest sample taken at least the window before the current one, or the oldest sample kept.
+ * @param [in]  (current) Current sample.
+ * @param [in]  (window)  Length of the window in seconds.
+ * @return                Sample at the start of the window.
+ */
+static const progress_sample* get_window_start(const progress_sample* const current, const double window) {
+  const uint64_t oldest = (progress_sample_count < PROGRESS_SAMPLES) ? 0 : progress_sample_count - PROGRESS_SAMPLES;
+  for (uint64_t i = progress_sample_count; i-- > oldest;) {
+    const progress_sample* const sample = &progress_samples[i % PROGRESS_SAMPLES];
+    if (sample->time <= current->time - window) {
+      return sample;
+    }
+  }
+  return &progress_samples[oldest % PROGRESS_SAMPLES];
+}
+
+/**
+ * Calculate MB/s over a window.
+ * @param [in]  (from) Sample at the start of the window.
+ * @param [in]  (to)   Current sample.
+ * @param [in]  (size) Bytes at the end of the window minus bytes at the start.
+ * @return             MB/s, or 0 if no time has passed.
+ */
+static double get_mb_per_second(const progress_sample* const from, const progress_sample* const to, const uint64_t size) {
+  return (to->time > from->time) ? size / (to->time - from->time) / 1000000.0 : 0;
+}
+
+/**
+ * Write a record of the current progress.
+ * @param [in]  (state) PROGRESS_RUNNING, PROGRESS_COMPLETE or PROGRESS_ABORTED.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int write_progress_record(const char* const state) {
+  char record[PROGRESS_RECORD_SIZE] = { '\0' };
+  char eta[PROGRESS_NUMBER_SIZE]    = "null";
+  progress_sample current           = { 0 };
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  take_progress_sample(&current);
+  const progress_sample* const short_start = get_window_start(&current, PROGRESS_SHORT_WINDOW);
+  const progress_sample* const long_start  = get_window_start(&current, PROGRESS_LONG_WINDOW);
+  const double long_time       = current.time - long_start->time;
+  const double objects_per_sec = (current.time > short_start->time)
+                                   ? (current.objects - short_start->objects) / (current.time - short_start->time) : 0;
+  const uint64_t block_total   = __atomic_load_n(&progress_blk_total, __ATOMIC_RELAXED);
+  const uint64_t object_total  = __atomic_load_n(&progress_obj_total, __ATOMIC_RELAXED);
+
+  // ETA is derived from the blocks to the last RCM of the data partition, or from the objects if it is unknown.
+  if (strcmp(state, PROGRESS_COMPLETE) == 0) {
+    snprintf(eta, sizeof(eta), "0");
+  } else if (block_total != 0 && current.block < block_total && long_time > 0 && current.block > long_start->block) {
+    snprintf(eta, sizeof(eta), "%.0f", (block_total - current.block) * long_time / (current.block - long_start->block));
+  } else if (object_total != 0 && current.objects < object_total && long_time > 0 && current.objects > long_start->objects) {
+    snprintf(eta, sizeof(eta), "%.0f", (object_total - current.objects) * long_time / (current.objects - long_start->objects));
+  }
+
+  const int size = snprintf(record, sizeof(record),
+      "{\"time\":%ld.%03ld,\"elapsed_sec\":%.3f,\"tape_id\":\"%s\",\"state\":\"%s\","
+      "\"pr\":%lu,\"pr_total\":%lu,\"ocm\":%lu,\"ocm_total\":%lu,\"po\":%lu,\"po_total\":%lu,"
+      "\"object\":%lu,\"object_total\":%lu,\"block\":%lu,\"block_total\":%lu,"
+      "\"bytes_read\":%lu,\"bytes_written\":%lu,"
+      "\"read_mbps_1m\":%.3f,\"read_mbps_5m\":%.3f,\"read_mbps_avg\":%.3f,\"write_mbps_1m\":%.3f,"
+      "\"objects_per_sec\":%.3f,\"eta_sec\":%s}\n",
+      (long)now.tv_sec, (long)now.tv_usec / 1000, current.time, progress_tape_id, state,
+      __atomic_load_n(&progress_pr, __ATOMIC_RELAXED), __atomic_load_n(&progress_pr_total, __ATOMIC_RELAXED),
+      __atomic_load_n(&progress_ocm, __ATOMIC_RELAXED), __atomic_load_n(&progress_ocm_total, __ATOMIC_RELAXED),
+      __atomic_load_n(&progress_po, __ATOMIC_RELAXED), __atomic_load_n(&progress_po_total, __ATOMIC_RELAXED),
+      current.objects, object_total, current.block, block_total,
+      current.read_size, current.written_size,
+      get_mb_per_second(short_start, &current, current.read_size - short_start->read_size),
+      get_mb_per_second(long_start, &current, current.read_size - long_start->read_size),
+      get_mb_per_second(&progress_first, &current, current.read_size - progress_first.read_size),
+      get_mb_per_second(short_start, &current, current.written_size - short_start->written_size),
+      objects_per_sec, eta);
+
+  progress_samples[progress_sample_count % PROGRESS_SAMPLES] = current;
+  progress_sample_count++;
+
+  for (int written = 0; written < size;) {
+    const ssize_t result = write(progress_fd, record + written, size - written);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "Failed to write the progress. No more progress is written. error=%s\n",
+                         strerror(errno));
+      return NG;
+    }
+    written += result;
+  }
+  return OK;
+}
+
+/**
+ * Write a record at each interval until the progress stream is stopped.
+ * A closed pipe stops only the records, not the dump.
+ * @param [in]  (arg) Not used.
+ * @return            NULL.
+ */
+static void* write_progress_records(void* arg) {
+  sigset_t sigpipe;
+  int is_failed = false;
+  (void)arg;
+
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe, NULL);
+
+  pthread_mutex_lock(&progress_mutex);
+  while (true) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    const struct timespec deadline = { now.tv_sec + progress_interval, now.tv_usec * 1000 };
+    while (progress_stop_state == NULL && pthread_cond_timedwait(&progress_cond, &progress_mutex, &deadline) == 0) {
+    }
+    const char* const state = (progress_stop_state != NULL) ? progress_stop_state : PROGRESS_RUNNING;
+    if (is_failed == false && write_progress_record(state) == NG) {
+      is_failed = true;
+    }
+    if (progress_stop_state != NULL) {
+      break;
+    }
+  }
+  pthread_mutex_unlock(&progress_mutex);
+  return NULL;
+}
+
+/**
+ * Stop the progress stream with PROGRESS_ABORTED state if it is still running at exit.
+ */
+static void abort_progress_stream(void) {
+  stop_progress_stream(PROGRESS_ABORTED);
+}
+
+/**
+ * Start to write the progress to a file descriptor.
+ * @param [in]  (fd)       File descriptor, which is open for writing.
+ * @param [in]  (interval) Interval of the records in seconds.
+ * @param [in]  (tape_id)  Barcode of the tape.
+ * @return      (OK/NG)    If success, return OK. Otherwise, return NG.
+ */
+int start_progress_stream(const int fd, const uint32_t interval, const char* const tape_id) {
+  if (fcntl(fd, F_GETFL) < 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "File descriptor %d for the progress is not open.\n", fd);
+  }
+  progress_fd       = fd;
+  progress_interval = interval;
+  strncpy(progress_tape_id, tape_id, BARCODE_SIZE);
+  gettimeofday(&progress_start, NULL);
+  take_progress_sample(&progress_first);
+  progress_samples[0]   = progress_first;
+  progress_sample_count = 1;
+  progress_stop_state   = NULL;
+  if (pthread_create(&progress_writer, NULL, write_progress_records, NULL) != 0) {
+    progress_fd = -1;
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to start the progress writer.\n");
+  }
+  atexit(abort_progress_stream);
+  return OK;
+}
+
+/**
+ * Write the last record with the state, and stop the progress stream.
+ * @param [in]  (state) PROGRESS_COMPLETE or PROGRESS_ABORTED.
+ */
+void stop_progress_stream(const char* const state) {
+  if (progress_fd < 0) {
+    return;
+  }
+  pthread_mutex_lock(&progress_mutex);
+  progress_stop_state = state;
+  pthread_cond_signal(&progress_cond);
+  pthread_mutex_unlock(&progress_mutex);
+  pthread_join(progress_writer, NULL);
+  progress_fd = -1;
+}
+
+/**
+ * Set the totals in the reference partition.
+ * @param [in]  (pr_total)    Number of partial references.
+ * @param [in]  (ocm_total)   Number of object commit markers.
+ * @param [in]  (po_total)    Number of packed objects.
+ * @param [in]  (obj_total)   Number of objects.
+ * @param [in]  (block_total) Block number of the last RCM in the data partition, or 0 if unknown.
+ */
+void set_progress_totals(const uint64_t pr_total, const uint64_t ocm_total, const uint64_t po_total,
+                         const uint64_t obj_total, const uint64_t block_total) {
+  __atomic_store_n(&progress_pr_total, pr_total, __ATOMIC_RELAXED);
+  __atomic_store_n(&progress_ocm_total, ocm_total, __ATOMIC_RELAXED);
+  __atomic_store_n(&progress_po_total, po_total, __ATOMIC_RELAXED);
+  __atomic_store_n(&progress_obj_total, obj_total, __ATOMIC_RELAXED);
+  __atomic_store_n(&progress_blk_total, block_total, __ATOMIC_RELAXED);
+}
+
+/**
+ * Set the current position. Each index is the number of markers already processed.
+ * @param [in]  (pr)     Index of the partial reference.
+ * @param [in]  (ocm)    Index of the object commit marker.
+ * @param [in]  (po)     Index of the packed object.
+ * @param [in]  (object) Index of the object.
+ * @param [in]  (block)  Block number on the data partition.
+ */
+void update_progress_position(const uint64_t pr, const uint64_t ocm, const uint64_t po, const uint64_t object, const uint64_t block) {
+  __atomic_store_n(&progress_pr, pr, __ATOMIC_RELAXED);
+  __atomic_store_n(&progress_ocm, ocm, __ATOMIC_RELAXED);
+  __atomic_store_n(&progress_po, po, __ATOMIC_RELAXED);
+  __atomic_store_n(&progress_object, object, __ATOMIC_RELAXED);
+  __atomic_store_n(&progress_block, block, __ATOMIC_RELAXED);
+}
+
+/**
+ * Count bytes read from tape.
+ * @param [in]  (size) Size read.
+ */
+void add_progress_read_size(const uint64_t size) {
+  __atomic_fetch_add(&progress_read_size, size, __ATOMIC_RELAXED);
+}
+
+/**
+ * Count bytes of objects written.
+ * @param [in]  (size) Size written.
+ */
+void add_progress_written_size(const uint64_t size) {
+  __atomic_fetch_add(&progress_write_size, size, __ATOMIC_RELAXED);
+}
+#endif // OBJ_READER
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file reader_context.c
+ *
+ * Per-tape state of the reader and its binding to the calling thread.
+ */
+
+#include "ltos_format_checker.h"
+
+
+static reader_context default_context;                   // Used by threads which have not bound any context.
+static int is_default_context_initialized = false;
+static __thread reader_context* current_context = NULL; // Context bound to the calling thread.
+
+
+/**
+ * Set the initial state to a reader context.
+ * @param [out] (ctx) Reader context.
+ */
+void initialize_reader_context(reader_context* const ctx) {
+  if (ctx == NULL) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Null pointer is detected at initialize_reader_context.\n");
+  }
+  memset(ctx, 0, sizeof(reader_context));
+  ctx->block_size              = LTOS_BLOCK_SIZE;
+  ctx->read_marker_file_flag   = 1;
+  ctx->sequential_read_flag    = 1;
+  ctx->savepath_dir_number     = 1;
+  ctx->savepath_sub_dir_number = 1;
+  ctx->dump_filter_to_ns       = UINT64_MAX;
+  ctx->history_fd              = -1;
+  strcpy(ctx->barcode_id, DEFAULT_BARCODE);
+}
+
+/**
+ * Allocate a reader context in the initial state.
+ * @return Reader context. Release it with free_reader_context().
+ */
+reader_context* create_reader_context(void) {
+  reader_context* const ctx = (reader_context*)clf_allocate_memory(sizeof(reader_context), "reader_context");
+  initialize_reader_context(ctx);
+  return ctx;
+}
+
+/**
+ * Release a reader context and the resources it owns.
+ * The tape drive and the objects passed to check_integrity() are owned by the caller and not released.
+ * @param [in] (ctx) Reader context created by create_reader_context().
+ */
+void free_reader_context(reader_context* const ctx) {
+  if (ctx == NULL) {
+    return;
+  }
+  if (current_context == ctx) {
+    current_context = NULL;
+  }
+
+  if (ctx->fp_list != NULL) {
+    fclose(ctx->fp_list);
+  }
+  if (ctx->history_fd >= 0) {
+    close(ctx->history_fd);
+  }
+  for (int i = 0; i < OPEN_FILE_CACHE_SIZE; i++) {
+    if (ctx->open_file_fp[i] != NULL) {
+      fclose(ctx->open_file_fp[i]);
+    }
+  }
+  // The bucket name is given by the caller when objects in a list are read.
+  if (strcmp(ctx->obj_r_mode, "output_objects_in_object_list") != 0) {
+    free(ctx->bucket_name_for_obj_r);
+  }
+  free(ctx->pre_bucket_name_for_obj_r);
+  free(ctx->bucket_list_for_obj_r);
+  free(ctx->object_meta_for_json);
+  free(ctx->meta_filter_result);
+  for (uint64_t i = 0; i < ctx->unsynced_file_num; i++) {
+    free(ctx->unsynced_files[i]);
+  }
+  free(ctx->unsynced_files);
+  while (ctx->bucket_info_4_obj_reader != NULL) {
+    BucketInfo4ObjReader* const next = ctx->bucket_info_4_obj_reader->next;
+    free(ctx->bucket_info_4_obj_reader);
+    ctx->bucket_info_4_obj_reader = next;
+  }
+  free(ctx);
+}
+
+/**
+ * Bind a reader context to the calling thread.
+ * Every function called from the thread reads and updates the bound context.
+ * @param [in] (ctx) Reader context. NULL to use the process default context again.
+ */
+void bind_reader_context(reader_context* const ctx) {
+  current_context = ctx;
+}
+
+/**
+ * Get the reader context bound to the calling thread.
+ * @return Bound reader context, or the process default context if the thread has not bound any.
+ */
+reader_context* get_reader_context(void) {
+  if (current_context != NULL) {
+    return current_context;
+  }
+  if (!is_default_context_initialized) {
+    initialize_reader_context(&default_context);
+    is_default_context_initialized = true;
+  }
+  return &default_context;
+}
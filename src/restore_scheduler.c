@@ -0,0 +1,723 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file restore_scheduler.c
+ *
+ * Scheduler to restore objects from many tapes with several tape drives in a tape library.
+ *
+ * A manifest lists the objects to be restored, one per line:
+ *   <barcode> TAB <bucket> TAB <object key> [TAB <object id>]
+ * The scheduler asks an external loader to load the tapes by writing "load <barcode> <drive>" to stdout,
+ * and starts to read a tape when "loaded <barcode> <drive>" is given from the event stream.
+ * When all objects on a tape are read, "unload <barcode> <drive>" is written to stdout.
+ * The requests for each bucket on a tape are read by a child object_reader with --requests in one pass,
+ * so every drive has its own reader context and workspace, and the tape is not repositioned per object.
+ * Only the loader protocol is written to stdout. Messages of the scheduler and the children go to stderr.
+ */
+
+#ifdef OBJ_READER
+#include <poll.h>
+#include <sys/wait.h>
+#include "ltos_format_checker.h"
+
+#define SCHEDULER_TAB_ASCII                       '\t'
+#define SCHEDULER_SELF_PATH                       "/proc/self/exe"
+#define SCHEDULER_STDIN                           "-"
+#define SCHEDULER_REQUESTS_EXTENSION              ".requests"
+#define SCHEDULER_POLL_INTERVAL                   (1000)         // msec
+#define SCHEDULER_READ_RATE                       (300UL * 1000 * 1000) // Bytes per second to estimate a read time.
+#define SCHEDULER_LOCATE_SECONDS                  (60)           // Seconds to estimate a locate to a packed object.
+#define SCHEDULER_LIST_SECONDS                    (30 * 60)      // Seconds to estimate making lists of a tape.
+#define SCHEDULER_MAX_ARGS                        (20 + SCHEDULER_MAX_READER_OPTIONS * 2)
+
+typedef enum {
+  TAPE_PENDING,   // Not requested to load yet.
+  TAPE_REQUESTED, // Requested to load, waiting for the event.
+  TAPE_LOADED,    // Loaded in a drive, objects are being read.
+  TAPE_DONE,      // All objects are read.
+} TAPE_STATE;
+
+typedef struct restore_request {
+  char bucket_name[BUCKET_LIST_BUCKETNAME_MAX_SIZE + 1];
+  char object_key[MAX_KEY_SIZE + 1];
+  char object_id[UUID_SIZE + 1];
+  uint64_t size;                                        // Data size found in the list files. 0 if unknown.
+  uint64_t block_address;                               // Position of the packed object. UINT64_MAX if unknown.
+} restore_request;
+
+typedef struct restore_tape {
+  char barcode_id[BARCODE_SIZE + 1];
+  restore_request* requests;
+  uint64_t count;                                       // Number of requests.
+  uint64_t capacity;                                    // Number of requests allocated.
+  uint64_t next_request;                                // Index of the request to be read next.
+  uint64_t batch_end;                                   // Index after the last request read by the running reader.
+  uint64_t requested_size;                              // Total size of the requested objects.(Byte)
+  uint64_t cost;                                        // Estimated seconds to read all requests.
+  int is_list_made;                                     // Whether list files of the tape exist.
+  TAPE_STATE state;
+  int drive;                                            // Index of the drive in which the tape is. -1 if none.
+} restore_tape;
+
+typedef struct restore_drive {
+  char drive_name[DEVICE_NAME_SIZE + 1];
+  int tape;                                             // Index of the tape assigned to the drive. -1 if none.
+  pid_t pid;                                            // Child object_reader reading the tape. 0 if none.
+} restore_drive;
+
+typedef struct restore_progress {
+  uint64_t tapes_done;
+  uint64_t objects;
+  uint64_t objects_done;
+  uint64_t objects_failed;
+  uint64_t bytes;
+  uint64_t bytes_done;
+} restore_progress;
+
+static restore_tape* tapes        = NULL;
+static uint64_t tape_count        = 0;
+static restore_drive* drives      = NULL;
+static int drive_count            = 0;
+static restore_progress progress  = { 0 };
+static const char* reader_options[SCHEDULER_MAX_READER_OPTIONS * 2] = { NULL }; // Pairs of an option and its value.
+static int reader_option_count    = 0;
+
+
+/**
+ * Find a tape in the manifest by its barcode.
+ * @param [in]  (barcode_id) Barcode of a tape.
+ * @return      Index of the tape, or -1 if the tape is not in the manifest.
+ */
+static int64_t find_tape(const char* const barcode_id) {
+  for (uint64_t i = 0; i < tape_count; i++) {
+    if (strcmp(tapes[i].barcode_id, barcode_id) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Find a drive by its device name.
+ * @param [in]  (drive_name) Device name of a tape drive.
+ * @return      Index of the drive, or -1 if the drive is not scheduled.
+ */
+static int find_drive(const char* const drive_name) {
+  for (int i = 0; i < drive_count; i++) {
+    if (strcmp(drives[i].drive_name, drive_name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Add a request to a tape. The tape is added at the first request for it.
+ * @param [in]  (barcode_id) Barcode of the tape.
+ * @param [in]  (request)    Request read from the manifest.
+ */
+static void add_restore_request(const char* const barcode_id, const restore_request* const request) {
+  int64_t index = find_tape(barcode_id);
+  if (index < 0) {
+    tapes = (restore_tape*)realloc(tapes, sizeof(restore_tape) * (tape_count + 1));
+    if (tapes == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to allocate memory for tapes.\n");
+    }
+    index = tape_count++;
+    memset(&tapes[index], 0, sizeof(restore_tape));
+    snprintf(tapes[index].barcode_id, BARCODE_SIZE + 1, "%s", barcode_id);
+    tapes[index].drive = -1;
+    tapes[index].state = TAPE_PENDING;
+  }
+  restore_tape* const tape = &tapes[index];
+  if (tape->count == tape->capacity) {
+    tape->capacity = (tape->capacity == 0) ? OBJECT_VECTOR_INITIAL_CAPACITY : tape->capacity * 2;
+    tape->requests = (restore_request*)realloc(tape->requests, sizeof(restore_request) * tape->capacity);
+    if (tape->requests == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to allocate memory for requests.\n");
+    }
+  }
+  tape->requests[tape->count++] = *request;
+}
+
+/**
+ * Read a manifest.
+ * @param [in]  (manifest_path) Path of the manifest.
+ * @return      (OK/NG)         If success, return OK. Otherwise, return NG.
+ */
+static int read_manifest(const char* const manifest_path) {
+  int ret                              = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:read_manifest\n");
+  char readline[MAX_LINE_LENGTH + 1]   = { '\0' };
+  uint64_t line_number                 = 0;
+
+  FILE* const fp = fopen(manifest_path, "r");
+  if (fp == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO,
+                              "Failed to open the manifest(%s). error=%s\n", manifest_path, strerror(errno));
+  }
+  while (fgets(readline, sizeof(readline), fp) != NULL) {
+    line_number++;
+    readline[strcspn(readline, "\r\n")] = '\0';
+    if (readline[0] == '\0' || readline[0] == '#') {
+      continue;
+    }
+    char* fields[4]  = { NULL };
+    int field_count  = 0;
+    char* field      = readline;
+    while (field != NULL && field_count < 4) {
+      fields[field_count++] = field;
+      field = strchr(field, SCHEDULER_TAB_ASCII);
+      if (field != NULL) {
+        *field++ = '\0';
+      }
+    }
+    if (field_count < 3 || field != NULL || strlen(fields[0]) < 1 || BARCODE_SIZE < strlen(fields[0])
+        || strlen(fields[1]) < BUCKET_LIST_BUCKETNAME_MIN_SIZE || BUCKET_LIST_BUCKETNAME_MAX_SIZE < strlen(fields[1])
+        || strlen(fields[2]) < 1 || MAX_KEY_SIZE < strlen(fields[2])
+        || (field_count == 4 && UUID_SIZE < strlen(fields[3]))) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO,
+                                "Line %lu of the manifest is invalid. Specify <barcode>, <bucket>, <object key> and optionally <object id> separated by TAB.\n",
+                                line_number);
+      continue;
+    }
+    restore_request request = { 0 };
+    snprintf(request.bucket_name, sizeof(request.bucket_name), "%s", fields[1]);
+    snprintf(request.object_key, sizeof(request.object_key), "%s", fields[2]);
+    snprintf(request.object_id, sizeof(request.object_id), "%s", (field_count == 4) ? fields[3] : "latest");
+    request.block_address = UINT64_MAX;
+    add_restore_request(fields[0], &request);
+  }
+  fclose(fp);
+  if (tape_count == 0) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "No object is requested in the manifest(%s).\n", manifest_path);
+  }
+  return ret;
+}
+
+/**
+ * Compare requests by the position on tape. Requests at an unknown position come last.
+ */
+static int compare_restore_request_address(const void* const a, const void* const b) {
+  const restore_request* const left  = (const restore_request*)a;
+  const restore_request* const right = (const restore_request*)b;
+  if (left->block_address != right->block_address) {
+    return (left->block_address < right->block_address) ? -1 : 1;
+  }
+  return 0;
+}
+
+/**
+ * Compare requests by the bucket, and then by the position on tape.
+ */
+static int compare_restore_request_bucket(const void* const a, const void* const b) {
+  const restore_request* const left  = (const restore_request*)a;
+  const restore_request* const right = (const restore_request*)b;
+  const int bucket_order             = strcmp(left->bucket_name, right->bucket_name);
+  if (bucket_order != 0) {
+    return bucket_order;
+  }
+  return compare_restore_request_address(a, b);
+}
+
+/**
+ * Compare tapes by the estimated cost. The most expensive tape comes first.
+ */
+static int compare_restore_tape_cost(const void* const a, const void* const b) {
+  const restore_tape* const left  = (const restore_tape*)a;
+  const restore_tape* const right = (const restore_tape*)b;
+  if (left->cost != right->cost) {
+    return (left->cost > right->cost) ? -1 : 1;
+  }
+  return strcmp(left->barcode_id, right->barcode_id);
+}
+
+/**
+ * Look up the size and the position of a requested object in the list files made by "--list".
+ * @param [in]     (save_path) Directory in which the list files are saved.
+ * @param [in]     (barcode_id) Barcode of the tape.
+ * @param [in/out] (request)   Request to be filled.
+ * @return         (true/false) Whether the list files of the bucket exist.
+ */
+static Bool look_up_restore_request(const char* const save_path, const char* const barcode_id, restore_request* const request) {
+  char list_path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  object_vector objects                = { 0 };
+  Bool is_list_found                   = false;
+
+  initialize_object_vector(&objects);
+  for (int i = 1; i <= MAX_NUMBER_OF_LISTS; i++) {
+    snprintf(list_path, sizeof(list_path), "%s/%s/%s_%04d.lst", save_path, barcode_id, request->bucket_name, i);
+    if (check_file(list_path) != OK) {
+      break;
+    }
+    is_list_found = true;
+    get_object_info_in_list(request->object_key, request->object_id, list_path, &objects);
+  }
+  for (uint64_t i = 0; i < objects.count; i++) {
+    request->size         += objects.records[i].size;
+    request->block_address = MIN(request->block_address, objects.records[i].block_address);
+  }
+  free_object_vector(&objects);
+  return is_list_found;
+}
+
+/**
+ * Estimate the time to read the requests of each tape, and sort tapes so that the most expensive tape is loaded first.
+ * Reading the longest tapes first keeps all drives busy until the end of the restore.
+ * @param [in]  (save_path) Directory in which the list files are saved.
+ */
+static void prioritize_tapes(const char* const save_path) {
+  for (uint64_t i = 0; i < tape_count; i++) {
+    restore_tape* const tape = &tapes[i];
+    uint64_t seek_count      = 0;
+
+    tape->is_list_made = true;
+    for (uint64_t j = 0; j < tape->count; j++) {
+      if (look_up_restore_request(save_path, tape->barcode_id, &tape->requests[j]) == false) {
+        tape->is_list_made = false;
+      }
+      tape->requested_size += tape->requests[j].size;
+    }
+    // Objects are read in the order of their position on tape, so each packed object costs one locate at most.
+    qsort(tape->requests, tape->count, sizeof(restore_request), compare_restore_request_address);
+    for (uint64_t j = 0; j < tape->count; j++) {
+      if (j == 0 || tape->requests[j].block_address != tape->requests[j - 1].block_address
+                 || tape->requests[j].block_address == UINT64_MAX) {
+        seek_count++;
+      }
+    }
+    tape->cost = tape->requested_size / SCHEDULER_READ_RATE + seek_count * SCHEDULER_LOCATE_SECONDS
+               + ((tape->is_list_made == true) ? 0 : SCHEDULER_LIST_SECONDS);
+    // A reader reads the requests of a bucket at once, so the requests of each bucket are put together.
+    qsort(tape->requests, tape->count, sizeof(restore_request), compare_restore_request_bucket);
+    progress.objects += tape->count;
+    progress.bytes   += tape->requested_size;
+  }
+  qsort(tapes, tape_count, sizeof(restore_tape), compare_restore_tape_cost);
+  for (uint64_t i = 0; i < tape_count; i++) {
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Tape %s: %lu object(s), %lu bytes, about %lu seconds.\n",
+                       tapes[i].barcode_id, tapes[i].count, tapes[i].requested_size, tapes[i].cost);
+  }
+}
+
+/**
+ * Parse a comma separated list of drives.
+ * @param [in]  (drive_names) Device names of tape drives separated by comma.
+ * @return      (OK/NG)       If success, return OK. Otherwise, return NG.
+ */
+static int set_drives(const char* const drive_names) {
+  char* names = (char*)clf_allocate_memory(strlen(drive_names) + 1, "drive names");
+  strcpy(names, drive_names);
+  for (char* name = strtok(names, ","); name != NULL; name = strtok(NULL, ",")) {
+    if (strlen(name) < 1 || find_drive(name) >= 0) {
+      continue;
+    }
+    drives = (restore_drive*)realloc(drives, sizeof(restore_drive) * (drive_count + 1));
+    if (drives == NULL) {
+      output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to allocate memory for drives.\n");
+    }
+    memset(&drives[drive_count], 0, sizeof(restore_drive));
+    snprintf(drives[drive_count].drive_name, DEVICE_NAME_SIZE + 1, "%s", name);
+    drives[drive_count].tape = -1;
+    drive_count++;
+  }
+  free(names);
+  if (drive_count == 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "No tape drive is specified.\n");
+  }
+  return OK;
+}
+
+/**
+ * Write a request to the external loader.
+ * @param [in]  (action) "load" or "unload".
+ * @param [in]  (tape)   Tape to be moved.
+ * @param [in]  (drive)  Drive from/to which the tape is moved.
+ */
+static void request_tape_movement(const char* const action, const restore_tape* const tape, const restore_drive* const drive) {
+  flush_log_ring();
+  fflush(stdout);
+  printf("%s %s %s\n", action, tape->barcode_id, drive->drive_name);
+  fflush(stdout);
+}
+
+/**
+ * Request to load the most expensive pending tape into each free drive.
+ */
+static void request_tapes_for_free_drives(void) {
+  for (int i = 0; i < drive_count; i++) {
+    if (drives[i].tape >= 0) {
+      continue;
+    }
+    for (uint64_t j = 0; j < tape_count; j++) {
+      if (tapes[j].state == TAPE_PENDING) {
+        tapes[j].state = TAPE_REQUESTED;
+        tapes[j].drive = i;
+        drives[i].tape = j;
+        request_tape_movement("load", &tapes[j], &drives[i]);
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * Handle "loaded <barcode> <drive>" from the external loader.
+ * A tape may be loaded into another drive than requested, then the requested drive becomes free again.
+ * @param [in]  (event) A line of the event stream.
+ * @return      (OK/NG) If the event is handled, return OK. Otherwise, return NG.
+ */
+static int handle_loaded_event(char* const event) {
+  char* const action     = strtok(event, " \t\r\n");
+  char* const barcode_id = strtok(NULL, " \t\r\n");
+  char* const drive_name = strtok(NULL, " \t\r\n");
+
+  if (action == NULL) {
+    return OK;
+  }
+  if (strcmp(action, "loaded") != 0 || barcode_id == NULL || drive_name == NULL) {
+    return output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "Unknown event is ignored: %s\n", action);
+  }
+  const int64_t tape_index = find_tape(barcode_id);
+  const int drive_index    = find_drive(drive_name);
+  if (tape_index < 0 || drive_index < 0) {
+    return output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO,
+                              "Tape %s in drive %s is not scheduled, so it is ignored.\n", barcode_id, drive_name);
+  }
+  restore_tape* const tape   = &tapes[tape_index];
+  restore_drive* const drive = &drives[drive_index];
+  if (tape->state == TAPE_LOADED || tape->state == TAPE_DONE
+      || (drive->tape >= 0 && drive->tape != tape_index && tapes[drive->tape].state == TAPE_LOADED)) {
+    return output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO,
+                              "Tape %s in drive %s is not expected now, so it is ignored.\n", barcode_id, drive_name);
+  }
+  // Release the drive the tape was requested for and the tape the drive was waiting for.
+  if (tape->drive >= 0 && tape->drive != drive_index) {
+    drives[tape->drive].tape = -1;
+  }
+  if (drive->tape >= 0 && drive->tape != tape_index) {
+    tapes[drive->tape].state = TAPE_PENDING;
+    tapes[drive->tape].drive = -1;
+  }
+  tape->state = TAPE_LOADED;
+  tape->drive = drive_index;
+  drive->tape = tape_index;
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Tape %s is loaded in drive %s.\n", barcode_id, drive_name);
+  return OK;
+}
+
+/**
+ * Add an option passed through to every child object_reader, such as the emulated drive.
+ * @param [in]  (option) Option, e.g. "-E". It is referred until the scheduler ends.
+ * @param [in]  (value)  Value of the option. It is referred until the scheduler ends.
+ */
+void add_restore_reader_option(const char* const option, const char* const value) {
+  if (reader_option_count == SCHEDULER_MAX_READER_OPTIONS) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Too many options for object_reader.\n");
+    return;
+  }
+  reader_options[reader_option_count * 2]     = option;
+  reader_options[reader_option_count * 2 + 1] = value;
+  reader_option_count++;
+}
+
+/**
+ * Write the requests for the next bucket on a tape, which are read by a child object_reader with --requests.
+ * @param [in/out] (tape)           Tape whose next requests are written. batch_end is set after the last written request.
+ * @param [out]    (requests_path)  Path of the requests.
+ * @param [in]     (workspace_root) Directory in which the requests are written.
+ * @return         (OK/NG)          If success, return OK. Otherwise, return NG.
+ */
+static int write_requests(restore_tape* const tape, char requests_path[OUTPUT_PATH_SIZE + 1], const char* const workspace_root) {
+  const char* const bucket_name = tape->requests[tape->next_request].bucket_name;
+
+  if (snprintf(requests_path, OUTPUT_PATH_SIZE + 1, "%s/%s%s", workspace_root, tape->barcode_id, SCHEDULER_REQUESTS_EXTENSION)
+      > OUTPUT_PATH_SIZE) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Path of the requests is too long: %s/%s%s\n",
+                              workspace_root, tape->barcode_id, SCHEDULER_REQUESTS_EXTENSION);
+  }
+  FILE* const fp = fopen(requests_path, "w");
+  if (fp == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to open the requests(%s). error=%s\n",
+                              requests_path, strerror(errno));
+  }
+  for (tape->batch_end = tape->next_request; tape->batch_end < tape->count
+       && strcmp(tape->requests[tape->batch_end].bucket_name, bucket_name) == 0; tape->batch_end++) {
+    fprintf(fp, "%s%c%s\n", tape->requests[tape->batch_end].object_key, SCHEDULER_TAB_ASCII, tape->requests[tape->batch_end].object_id);
+  }
+  if (fclose(fp) != 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the requests(%s).\n", requests_path);
+  }
+  return OK;
+}
+
+/**
+ * Start a child object_reader to read the requests for the next bucket on the tape in a drive.
+ * @param [in]  (drive)          Drive in which the tape is loaded.
+ * @param [in]  (self_path)      Path of the object_reader executable.
+ * @param [in]  (save_path)      Directory in which objects are saved.
+ * @param [in]  (workspace_root) Directory in which workspaces are created.
+ * @param [in]  (verbose_level)  Verbose level passed to the child.
+ * @return      (OK/NG)          If the child is started, return OK. Otherwise, return NG.
+ */
+static int start_reader(restore_drive* const drive, const char* const self_path, const char* const save_path,
+                        const char* const workspace_root, const char* const verbose_level) {
+  restore_tape* const tape                 = &tapes[drive->tape];
+  const restore_request* const request     = &tape->requests[tape->next_request];
+  char requests_path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  char* args[SCHEDULER_MAX_ARGS]           = { NULL };
+  int n                                    = 0;
+
+  if (write_requests(tape, requests_path, workspace_root) != OK) {
+    return NG;
+  }
+  args[n++] = (char*)self_path;
+  args[n++] = "-d";
+  args[n++] = drive->drive_name;
+  args[n++] = "-b";
+  args[n++] = (char*)request->bucket_name;
+  args[n++] = "-Q";
+  args[n++] = requests_path;
+  args[n++] = "-s";
+  args[n++] = (char*)save_path;
+  args[n++] = "-w";
+  args[n++] = (char*)workspace_root;
+  if (strlen(verbose_level) > 0) {
+    args[n++] = "-v";
+    args[n++] = (char*)verbose_level;
+  }
+  if (get_force_flag() == true) {
+    args[n++] = "-F";
+  }
+  if (tape->is_list_made == false) {
+    args[n++] = "-l"; // The objects are read after the lists are made.
+  }
+  for (int i = 0; i < reader_option_count * 2; i++) {
+    args[n++] = (char*)reader_options[i];
+  }
+  args[n] = NULL;
+
+  flush_log_ring();
+  fflush(stdout);
+  fflush(stderr);
+  const pid_t pid = fork();
+  if (pid < 0) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to start object_reader. error=%s\n", strerror(errno));
+  } else if (pid == 0) {
+    // stdout is dedicated to the loader protocol, so messages of the child are written to stderr.
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    execv(self_path, args);
+    fprintf(stderr, "Failed to execute %s. error=%s\n", self_path, strerror(errno));
+    _exit(EXIT_FAILURE);
+  }
+  drive->pid = pid;
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Reading %lu object(s) in %s from tape %s in drive %s.\n",
+                     tape->batch_end - tape->next_request, request->bucket_name, tape->barcode_id, drive->drive_name);
+  return OK;
+}
+
+/**
+ * Output the progress of all tapes.
+ */
+static void output_restore_progress(void) {
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO,
+                     "Progress: %lu/%lu tape(s), %lu/%lu object(s), %lu/%lu bytes, %lu failed.\n",
+                     progress.tapes_done, tape_count, progress.objects_done, progress.objects,
+                     progress.bytes_done, progress.bytes, progress.objects_failed);
+}
+
+/**
+ * Account the requests read by a reader, and move to the next bucket on the tape.
+ * @param [in/out] (tape)         Tape read by the reader.
+ * @param [in]     (is_succeeded) Whether the reader succeeded.
+ */
+static void account_requests(restore_tape* const tape, const Bool is_succeeded) {
+  for (uint64_t i = tape->next_request; i < tape->batch_end; i++) {
+    if (is_succeeded == true) {
+      progress.objects_done++;
+      progress.bytes_done += tape->requests[i].size;
+    } else {
+      progress.objects_failed++;
+    }
+  }
+  tape->next_request = tape->batch_end;
+}
+
+/**
+ * Reap the finished child object_readers and account the results.
+ * @return      (OK/NG) If all finished readers succeeded, return OK. Otherwise, return NG.
+ */
+static int reap_readers(void) {
+  int ret    = OK;
+  int status = 0;
+  pid_t pid  = 0;
+
+  while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+    for (int i = 0; i < drive_count; i++) {
+      if (drives[i].pid != pid) {
+        continue;
+      }
+      restore_tape* const tape             = &tapes[drives[i].tape];
+      const restore_request* const request = &tape->requests[tape->next_request];
+      drives[i].pid = 0;
+      if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) {
+        tape->is_list_made = true;
+        account_requests(tape, true);
+      } else {
+        ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Some of %lu object(s) in %s are not read from tape %s in drive %s.\n",
+                                  tape->batch_end - tape->next_request, request->bucket_name, tape->barcode_id, drives[i].drive_name);
+        account_requests(tape, false);
+      }
+      output_restore_progress();
+    }
+  }
+  return ret;
+}
+
+/**
+ * Start the next reader for each loaded tape, and unload tapes whose requests are all read.
+ * @param [in]  (self_path)      Path of the object_reader executable.
+ * @param [in]  (save_path)      Directory in which objects are saved.
+ * @param [in]  (workspace_root) Directory in which workspaces are created.
+ * @param [in]  (verbose_level)  Verbose level passed to the children.
+ */
+static void dispatch_readers(const char* const self_path, const char* const save_path,
+                             const char* const workspace_root, const char* const verbose_level) {
+  for (int i = 0; i < drive_count; i++) {
+    if (drives[i].tape < 0 || drives[i].pid != 0 || tapes[drives[i].tape].state != TAPE_LOADED) {
+      continue;
+    }
+    restore_tape* const tape = &tapes[drives[i].tape];
+    if (tape->next_request < tape->count) {
+      if (start_reader(&drives[i], self_path, save_path, workspace_root, verbose_level) != OK) {
+        account_requests(tape, false); // Requests of the bucket are given up, and the next bucket is tried.
+        output_restore_progress();
+      }
+    } else {
+      tape->state = TAPE_DONE;
+      progress.tapes_done++;
+      request_tape_movement("unload", tape, &drives[i]);
+      drives[i].tape = -1;
+    }
+  }
+}
+
+/**
+ * Check if any tape is being read.
+ * @return      (true/false) Whether a tape is loaded in any drive.
+ */
+static Bool is_any_tape_loaded(void) {
+  for (int i = 0; i < drive_count; i++) {
+    if (drives[i].tape >= 0 && tapes[drives[i].tape].state == TAPE_LOADED) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Restore objects listed in a manifest with several tape drives.
+ * @param [in]  (manifest_path)  Path of the manifest.
+ * @param [in]  (drive_names)    Device names of tape drives separated by comma.
+ * @param [in]  (events_path)    Path of the event stream from the external loader. "-" for stdin.
+ * @param [in]  (save_path)      Directory in which objects are saved.
+ * @param [in]  (workspace_root) Directory in which workspaces are created.
+ * @param [in]  (verbose_level)  Verbose level passed to the children.
+ * @return      (OK/NG)          If all objects are restored, return OK. Otherwise, return NG.
+ */
+int run_restore_scheduler(const char* const manifest_path, const char* const drive_names, const char* const events_path,
+                          const char* const save_path, const char* const workspace_root, const char* const verbose_level) {
+  int ret                                 = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:run_restore_scheduler\n");
+  char self_path[OUTPUT_PATH_SIZE + 1]    = { '\0' };
+  char requests_dir[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  char event[MAX_LINE_LENGTH + 1]         = { '\0' };
+  size_t event_length                     = 0;
+  Bool is_events_open                     = true;
+
+  if (readlink(SCHEDULER_SELF_PATH, self_path, OUTPUT_PATH_SIZE) < 0) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_COMMON_INFO, "Failed to get the path of object_reader. error=%s\n", strerror(errno));
+  }
+  if (read_manifest(manifest_path) != OK || set_drives(drive_names) != OK) {
+    return NG;
+  }
+  const int events_fd = (strcmp(events_path, SCHEDULER_STDIN) == 0) ? STDIN_FILENO : open(events_path, O_RDONLY);
+  if (events_fd < 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to open the events(%s). error=%s\n", events_path, strerror(errno));
+  }
+  if (snprintf(requests_dir, sizeof(requests_dir), "%s/", workspace_root) >= (int)sizeof(requests_dir) || mk_deep_dir(requests_dir) != OK) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to make the workspace(%s).\n", workspace_root);
+  }
+  prioritize_tapes(save_path);
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu tape(s) will be read with %d drive(s).\n", tape_count, drive_count);
+
+  while (progress.tapes_done < tape_count) {
+    request_tapes_for_free_drives();
+    dispatch_readers(self_path, save_path, workspace_root, verbose_level);
+    if (progress.tapes_done == tape_count) {
+      break;
+    }
+    if (is_events_open == false && is_any_tape_loaded() == false) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO,
+                                "Events are closed before all tapes are loaded. %lu tape(s) are not read.\n", tape_count - progress.tapes_done);
+      break;
+    }
+
+    struct pollfd pfd = { .fd = events_fd, .events = POLLIN };
+    if (is_events_open == true && poll(&pfd, 1, SCHEDULER_POLL_INTERVAL) > 0) {
+      const ssize_t read_size = read(events_fd, event + event_length, MAX_LINE_LENGTH - event_length);
+      if (read_size <= 0) {
+        is_events_open = false;
+        if (event_length > 0) { // The last event without a newline.
+          event[event_length] = '\0';
+          handle_loaded_event(event);
+          event_length = 0;
+        }
+      } else {
+        event_length += read_size;
+        char* newline = NULL;
+        while ((newline = memchr(event, '\n', event_length)) != NULL) {
+          *newline = '\0';
+          handle_loaded_event(event);
+          event_length -= newline + 1 - event;
+          memmove(event, newline + 1, event_length);
+        }
+        if (event_length == MAX_LINE_LENGTH) {
+          ret |= output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_COMMON_INFO, "Too long event is ignored.\n");
+          event_length = 0;
+        }
+      }
+    } else if (is_events_open == false) {
+      sleep(1);
+    }
+    ret |= reap_readers();
+  }
+
+  // Wait for the readers which are still running after an error.
+  while (waitpid(-1, NULL, 0) > 0) {
+  }
+  if (events_fd != STDIN_FILENO) {
+    close(events_fd);
+  }
+  output_restore_progress();
+  if (progress.objects_failed > 0 || progress.objects_done < progress.objects) {
+    ret = NG;
+  }
+  for (uint64_t i = 0; i < tape_count; i++) {
+    free(tapes[i].requests);
+  }
+  free(tapes);
+  free(drives);
+  return ret;
+}
+#endif // OBJ_READER
@@ -0,0 +1,778 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file scsi_emulator.c
+ * @brief Functions to answer SCSI commands from a tape image as an emulated tape drive
+ *
+ * The blocks and filemarks of both partitions in an image made with --capture or --generate are indexed,
+ * and run_scsi_command answers READ, LOCATE, SPACE, REWIND, READ POSITION, READ ATTRIBUTE and a few others
+ * from the image instead of the drive. Unlike a SCSI trace, any sequence of commands is answered.
+ *
+ * Each command is charged the time a real drive would take: an overhead per command, LOCATE and SPACE
+ * as a function of the distance, the transfer at the streaming bandwidth, and a backhitch.
+ * The drive reads ahead into its buffer while the host is busy. When the buffer becomes full, the drive stops,
+ * and the READ which finds the buffer empty after that waits for the reposition.
+ * The charged time is either accounted only, or slept so that the run takes as long as with a real drive.
+ */
+
+#include <pthread.h>
+#include "ltos_format_checker.h"
+
+typedef struct {
+  uint64_t offset;                      // Offset of the data in the image.
+  uint32_t length;                      // Length of the block. SCSI_EMULATOR_FILEMARK for a filemark.
+} emulated_block;
+
+typedef struct {
+  emulated_block* blocks;               // Blocks and filemarks. The number of them is the block number of EOD.
+  uint64_t count;
+  uint64_t capacity;
+  uint64_t* filemarks;                  // Block numbers of the filemarks in ascending order.
+  uint64_t filemark_count;
+  uint64_t filemark_capacity;
+  uint64_t attribute_offset;            // Response of READ ATTRIBUTE in the image.
+  uint64_t attribute_length;
+} emulated_partition;
+
+#define SCSI_EMULATOR_FILEMARK                    (UINT32_MAX)
+
+static int emulator_fd                          = -1;
+static int is_emulator_enabled                  = FALSE;
+static emulated_partition emulator_partitions[SCSI_EMULATOR_PARTITIONS];
+static uint32_t emulator_partition              = 0;      // Current position.
+static uint64_t emulator_block                  = 0;
+static uint64_t emulator_read_ahead             = 0;      // Bytes in the buffer ahead of the host.
+static uint64_t emulator_behind                 = 0;      // Bytes in the buffer already transferred to the host.
+static int is_emulator_stopped                  = FALSE;  // The buffer became full, so the drive stopped streaming.
+static char emulator_personality[]             = "Ultrium-9"; // Volume personality, whose generation is the one of the barcode.
+static uint64_t emulator_last_time              = 0;      // When the last command was answered.
+static scsi_emulator_cost emulator_cost         = { 0 };
+static scsi_emulator_stats emulator_stats       = { 0 };
+static pthread_mutex_t emulator_mutex           = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Read data in the image.
+ * @param [out] (buf)    Buffer.
+ * @param [in]  (size)   Size to read.
+ * @param [in]  (offset) Offset in the image.
+ * @return      (OK/NG)  If all data is read, return OK. Otherwise, return NG.
+ */
+static int pread_emulated_image(uint8_t* buf, uint64_t size, uint64_t offset) {
+  while (size > 0) {
+    const ssize_t read_size = pread(emulator_fd, buf, size, offset);
+    if (read_size <= 0) {
+      return NG;
+    }
+    buf    += read_size;
+    size   -= read_size;
+    offset += read_size;
+  }
+  return OK;
+}
+
+/**
+ * Add a block, a filemark or an attribute record to a partition.
+ * @param [in/out] (part)   Partition.
+ * @param [in]     (type)   Type of the record.
+ * @param [in]     (offset) Offset of the data of the record in the image.
+ * @param [in]     (length) Length of the data of the record.
+ * @return         (OK/NG)  If success, return OK. Otherwise, return NG.
+ */
+static int add_emulated_record(emulated_partition* const part, const uint32_t type, const uint64_t offset, const uint64_t length) {
+  if (type == IMAGE_RECORD_ATTRIBUTE) {
+    part->attribute_offset = offset;
+    part->attribute_length = length;
+    return OK;
+  }
+  if (part->count == part->capacity) {
+    part->capacity = (part->capacity == 0) ? SCSI_EMULATOR_INITIAL_BLOCKS : part->capacity * 2;
+    emulated_block* const blocks = (emulated_block*)realloc(part->blocks, part->capacity * sizeof(emulated_block));
+    if (blocks == NULL) {
+      return NG;
+    }
+    part->blocks = blocks;
+  }
+  if (type == IMAGE_RECORD_FILEMARK) {
+    if (part->filemark_count == part->filemark_capacity) {
+      part->filemark_capacity = (part->filemark_capacity == 0) ? SCSI_EMULATOR_INITIAL_BLOCKS : part->filemark_capacity * 2;
+      uint64_t* const filemarks = (uint64_t*)realloc(part->filemarks, part->filemark_capacity * sizeof(uint64_t));
+      if (filemarks == NULL) {
+        return NG;
+      }
+      part->filemarks = filemarks;
+    }
+    part->filemarks[part->filemark_count++] = part->count;
+  }
+  part->blocks[part->count].offset = offset;
+  part->blocks[part->count].length = (type == IMAGE_RECORD_FILEMARK) ? SCSI_EMULATOR_FILEMARK : (uint32_t)length;
+  part->count++;
+  return OK;
+}
+
+/**
+ * Index the blocks and filemarks of both partitions in the image.
+ * @param [in]  (image_path) Path of the image.
+ * @return      (OK/NG)      If the image is indexed up to its end, return OK. Otherwise, return NG.
+ */
+static int index_emulated_image(const char* const image_path) {
+  uint8_t header[TAPE_IMAGE_HEADER_SIZE] = { 0 };
+  uint64_t offset                        = TAPE_IMAGE_HEADER_SIZE;
+  uint32_t version                       = 0;
+
+  if (pread_emulated_image(header, TAPE_IMAGE_HEADER_SIZE, 0) != OK || memcmp(header, TAPE_IMAGE_MAGIC, TAPE_IMAGE_MAGIC_SIZE) != 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "%s is not a tape image.\n", image_path);
+  }
+  r32(BIG, header + 8, &version, 1);
+  if (version != TAPE_IMAGE_VERSION) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Version %u of the tape image is not supported.\n", version);
+  }
+  // The reader makes the barcode from the volume identifier and the generation of the drive, e.g. "L8" of "Ultrium-8".
+  if (header[16 + BARCODE_SIZE - 2] == 'L' && isdigit(header[16 + BARCODE_SIZE - 1])) {
+    emulator_personality[strlen(emulator_personality) - 1] = header[16 + BARCODE_SIZE - 1];
+  }
+
+  while (true) {
+    uint8_t record[TAPE_IMAGE_RECORD_HEADER_SIZE] = { 0 };
+    uint32_t type                                 = 0;
+    uint32_t partition                            = 0;
+    uint64_t number                               = 0;
+    uint64_t length                               = 0;
+    if (pread_emulated_image(record, TAPE_IMAGE_RECORD_HEADER_SIZE, offset) != OK) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The tape image is truncated at %lu.\n", offset);
+    }
+    r32(BIG, record,      &type,      1);
+    r32(BIG, record + 4,  &partition, 1);
+    r64(BIG, record + 8,  &number,    1);
+    r64(BIG, record + 16, &length,    1);
+    if (type == IMAGE_RECORD_END) {
+      break;
+    }
+    if (SCSI_EMULATOR_PARTITIONS <= partition || UINT32_MAX <= length) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "The tape image has a broken record at %lu.\n", offset);
+    }
+    emulated_partition* const part = &emulator_partitions[partition];
+    if (type != IMAGE_RECORD_ATTRIBUTE && number != part->count) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO,
+                                "Block %lu of partition %u is expected at %lu, but block %lu is found.\n",
+                                part->count, partition, offset, number);
+    }
+    // EOD is the position after the last block, so it is not added.
+    if (type != IMAGE_RECORD_EOD && add_emulated_record(part, type, offset + TAPE_IMAGE_RECORD_HEADER_SIZE, length) != OK) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to allocate memory for the tape image.\n");
+    }
+    offset += TAPE_IMAGE_RECORD_HEADER_SIZE + length;
+  }
+  for (int i = 0; i < SCSI_EMULATOR_PARTITIONS; i++) {
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Partition %d of the emulated tape has %lu blocks and %lu filemarks.\n",
+                       i, emulator_partitions[i].count - emulator_partitions[i].filemark_count, emulator_partitions[i].filemark_count);
+  }
+  return OK;
+}
+
+/**
+ * Parse the costs of the emulated drive, which is a list of key=value separated by comma.
+ * @param [in]  (cost_spec) Costs. Keys which are not specified are set to the default.
+ * @param [out] (cost)      Costs.
+ * @return      (OK/NG)     If the costs are valid, return OK. Otherwise, return NG.
+ */
+static int parse_emulator_cost(const char* const cost_spec, scsi_emulator_cost* const cost) {
+  int ret         = OK;
+  char* const str = (char*)clf_allocate_memory(strlen(cost_spec) + 1, "emulator cost");
+  char* item      = str;
+
+  cost->command      = SCSI_EMULATOR_COMMAND;
+  cost->locate       = SCSI_EMULATOR_LOCATE;
+  cost->locate_block = SCSI_EMULATOR_LOCATE_BLOCK;
+  cost->partition    = SCSI_EMULATOR_PARTITION;
+  cost->bandwidth    = SCSI_EMULATOR_BANDWIDTH;
+  cost->backhitch    = SCSI_EMULATOR_BACKHITCH;
+  cost->buffer       = SCSI_EMULATOR_BUFFER;
+  cost->is_slept     = FALSE;
+
+  strcpy(str, cost_spec);
+  while (item != NULL && *item != '\0') {
+    char* const next  = strchr(item, ',');
+    if (next != NULL) {
+      *next = '\0';
+    }
+    char* const value = strchr(item, '=');
+    uint64_t number   = 0;
+    char extra        = '\0';
+    if (value == NULL) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "\"%s\" in the drive costs is not key=value.\n", item);
+      break;
+    }
+    *value = '\0';
+    const char* const key = item;
+    const char* const val = value + 1;
+    item = (next != NULL) ? next + 1 : NULL;
+
+    if (!isdigit(val[0]) || sscanf(val, "%lu%c", &number, &extra) != 1) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Value of %s is not a number: %s\n", key, val);
+    } else if (!strcmp(key, "command")) {
+      cost->command = number;
+    } else if (!strcmp(key, "locate")) {
+      cost->locate = number;
+    } else if (!strcmp(key, "locate_block")) {
+      cost->locate_block = number;
+    } else if (!strcmp(key, "partition")) {
+      cost->partition = number;
+    } else if (!strcmp(key, "bandwidth")) {
+      cost->bandwidth = number;
+    } else if (!strcmp(key, "backhitch")) {
+      cost->backhitch = number;
+    } else if (!strcmp(key, "buffer")) {
+      cost->buffer = number;
+    } else if (!strcmp(key, "sleep")) {
+      cost->is_slept = (number != 0) ? TRUE : FALSE;
+    } else {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Unknown key in the drive costs: %s\n", key);
+    }
+  }
+  free(str);
+
+  if (cost->bandwidth == 0) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "bandwidth of the drive must be 1 or more.\n");
+  }
+  return ret;
+}
+
+/**
+ * Start to answer SCSI commands from a tape image instead of the drive. The tape is positioned at BOP of partition 0.
+ *
+ * @param  image_path [i] Path of the image made with --capture or --generate
+ * @param  cost_spec  [i] Costs of the drive, which is key=value separated by comma. "" for the default.
+ * @return TRUE: success, FALSE: failed
+ */
+BOOL start_scsi_emulator(const char* const image_path, const char* const cost_spec) {
+  if (parse_emulator_cost(cost_spec, &emulator_cost) != OK) {
+    return FALSE;
+  }
+  emulator_fd = open(image_path, O_RDONLY);
+  if (emulator_fd < 0) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Can't open the tape image(%s). error=%s\n", image_path, strerror(errno));
+    return FALSE;
+  }
+  memset(emulator_partitions, 0, sizeof(emulator_partitions));
+  if (index_emulated_image(image_path) != OK) {
+    stop_scsi_emulator();
+    return FALSE;
+  }
+  memset(&emulator_stats, 0, sizeof(emulator_stats));
+  emulator_stats.is_slept = emulator_cost.is_slept;
+  emulator_partition      = 0;
+  emulator_block          = 0;
+  emulator_read_ahead     = 0;
+  emulator_behind         = 0;
+  is_emulator_stopped     = FALSE;
+  emulator_last_time      = start_metric_timer();
+  is_emulator_enabled     = TRUE;
+  atexit(stop_scsi_emulator);
+  return TRUE;
+}
+
+/**
+ * Stop answering SCSI commands from the image, and release the index.
+ */
+void stop_scsi_emulator(void) {
+  pthread_mutex_lock(&emulator_mutex);
+  if (emulator_fd >= 0) {
+    if (is_emulator_enabled) {
+      output_accdg_to_vl(OUTPUT_INFO, DISPLAY_ALL_INFO,
+                         "%lu SCSI command(s) were emulated in %.3f seconds of the drive (%lu locate(s), %lu backhitch(es)).\n",
+                         emulator_stats.commands,
+                         (double)(emulator_stats.command_time + emulator_stats.locate_time + emulator_stats.transfer_time
+                                  + emulator_stats.backhitch_time) / 1000000,
+                         emulator_stats.locates, emulator_stats.backhitches);
+    }
+    close(emulator_fd);
+    emulator_fd = -1;
+  }
+  for (int i = 0; i < SCSI_EMULATOR_PARTITIONS; i++) {
+    free(emulator_partitions[i].blocks);
+    free(emulator_partitions[i].filemarks);
+    memset(&emulator_partitions[i], 0, sizeof(emulated_partition));
+  }
+  is_emulator_enabled = FALSE;
+  pthread_mutex_unlock(&emulator_mutex);
+}
+
+/**
+ * Check if SCSI commands are answered from a tape image
+ *
+ * @return TRUE: emulated, FALSE: the drive is used
+ */
+BOOL is_scsi_emulator_enabled(void) {
+  return is_emulator_enabled;
+}
+
+/**
+ * Get the statistics of the emulated drive
+ *
+ * @param  stats [o] Statistics
+ */
+void get_scsi_emulator_stats(scsi_emulator_stats* const stats) {
+  pthread_mutex_lock(&emulator_mutex);
+  *stats = emulator_stats;
+  pthread_mutex_unlock(&emulator_mutex);
+}
+
+/**
+ * Set fixed format sense data and CHECK CONDITION.
+ * @param [out] (hdr)         SCSI Generic Input/Output Header, whose sbp is the raw sense data.
+ * @param [in]  (flags)       Filemark, EOM and ILI bits of byte 2.
+ * @param [in]  (sense_key)   Sense key.
+ * @param [in]  (asc)         Additional sense code.
+ * @param [in]  (ascq)        Additional sense code qualifier.
+ * @param [in]  (information) Information field, which is the residue of READ and SPACE.
+ */
+static void set_emulated_sense(sg_io_hdr_t* const hdr, const uint8_t flags, const uint8_t sense_key,
+                               const uint8_t asc, const uint8_t ascq, const uint32_t information) {
+  uint8_t* const sense = hdr->sbp;
+
+  memset(sense, 0, SCSI_EMULATOR_SENSE_SIZE);
+  sense[0]       = 0x70 | ((information != 0) ? 0x80 : 0x00); // Current error, and the information field is valid.
+  sense[2]       = flags | sense_key;
+  sense[3]       = information >> 24;
+  sense[4]       = information >> 16;
+  sense[5]       = information >> 8;
+  sense[6]       = information;
+  sense[7]       = SCSI_EMULATOR_SENSE_SIZE - 8;
+  sense[12]      = asc;
+  sense[13]      = ascq;
+  hdr->status    = 0x02;
+  hdr->sb_len_wr = SCSI_EMULATOR_SENSE_SIZE;
+}
+
+/**
+ * Find the number of filemarks before a block.
+ * @param [in]  (part)  Partition.
+ * @param [in]  (block) Block number.
+ * @return              Index of the first filemark at the block or after it.
+ */
+static uint64_t find_emulated_filemark(const emulated_partition* const part, const uint64_t block) {
+  uint64_t low  = 0;
+  uint64_t high = part->filemark_count;
+  while (low < high) {
+    const uint64_t middle = low + (high - low) / 2;
+    if (part->filemarks[middle] < block) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/**
+ * Move the tape, and charge the time of the move.
+ * @param [in]  (partition) Destination partition.
+ * @param [in]  (block)     Destination block number.
+ * @return                  Charged time in microseconds.
+ */
+static uint64_t move_emulated_tape(const uint32_t partition, const uint64_t block) {
+  const emulated_partition* const part = &emulator_partitions[partition];
+  uint64_t distance                    = 0;
+  uint64_t charged                     = 0;
+
+  if (partition != emulator_partition) {
+    distance = block;
+    charged  = emulator_cost.partition;
+  } else {
+    distance = (block < emulator_block) ? emulator_block - block : block - emulator_block;
+  }
+  // A move within the blocks in the buffer is not a locate, since the drive keeps streaming.
+  if (partition == emulator_partition && distance > 0) {
+    const uint64_t from  = MIN(block, emulator_block);
+    const uint64_t limit = (block < emulator_block) ? emulator_behind : emulator_read_ahead;
+    uint64_t bytes       = 0;
+    for (uint64_t i = from; i < from + distance && i < part->count && bytes <= limit; i++) {
+      bytes += (part->blocks[i].length == SCSI_EMULATOR_FILEMARK) ? 0 : part->blocks[i].length;
+    }
+    if (bytes <= limit && block < emulator_block) {
+      emulator_behind     -= bytes;
+      emulator_read_ahead += bytes;
+      distance             = 0;
+    } else if (emulator_block < block && (bytes <= limit || distance == 1)) {
+      // The next block is read as the drive streams, even if it is not in the buffer yet.
+      emulator_read_ahead -= MIN(bytes, emulator_read_ahead);
+      emulator_behind     += bytes;
+      distance             = 0;
+    }
+  }
+  if (partition != emulator_partition || distance > 0) {
+    charged += emulator_cost.locate + distance * emulator_cost.locate_block;
+    emulator_stats.locates++;
+    emulator_stats.locate_blocks += distance;
+    emulator_stats.locate_time   += charged;
+    emulator_read_ahead           = 0;
+    emulator_behind               = 0;
+    is_emulator_stopped           = FALSE;
+  }
+  emulator_partition = partition;
+  emulator_block     = block;
+  return charged;
+}
+
+/**
+ * Read a block at the current position, and charge the transfer and a backhitch.
+ * The drive reads ahead at the bandwidth while the host is busy, up to the size of the buffer.
+ * @param [in/out] (hdr)  SCSI Generic Input/Output Header.
+ * @param [in]     (gap)  Time since the last command in microseconds, during which the drive was reading ahead.
+ * @return                Charged time in microseconds.
+ */
+static uint64_t read_emulated_block(sg_io_hdr_t* const hdr, const uint64_t gap) {
+  const emulated_partition* const part = &emulator_partitions[emulator_partition];
+  const uint32_t requested             = hdr->cmdp[2] << 16 | hdr->cmdp[3] << 8 | hdr->cmdp[4];
+  const int is_sili                    = hdr->cmdp[1] & 0x02;
+  const uint64_t buffer                = emulator_cost.buffer * 1000000;
+  uint64_t charged                     = 0;
+
+  hdr->resid = hdr->dxfer_len;
+  if ((hdr->cmdp[1] & 0x01) != 0 || hdr->dxfer_len < requested) {
+    set_emulated_sense(hdr, 0, 0x05, 0x24, 0x00, 0); // Fixed block mode is not emulated.
+    return 0;
+  }
+  if (part->count <= emulator_block) {
+    set_emulated_sense(hdr, 0, 0x08, 0x00, 0x05, requested); // End-of-data detected.
+    return 0;
+  }
+  const emulated_block* const block = &part->blocks[emulator_block];
+  const uint64_t length             = (block->length == SCSI_EMULATOR_FILEMARK) ? 0 : block->length;
+  if (length > 0 && pread_emulated_image((uint8_t*)hdr->dxferp, MIN(length, requested), block->offset) != OK) {
+    set_emulated_sense(hdr, 0, 0x03, 0x11, 0x00, requested); // Unrecovered read error.
+    return 0;
+  }
+  emulator_block++;
+
+  if (is_emulator_stopped == FALSE) {
+    emulator_read_ahead += gap * emulator_cost.bandwidth;
+    if (buffer <= emulator_read_ahead) {
+      emulator_read_ahead = buffer;
+      is_emulator_stopped = TRUE;
+    }
+  }
+  if (length <= emulator_read_ahead) {
+    emulator_read_ahead -= length;
+  } else {
+    if (is_emulator_stopped) {
+      charged += emulator_cost.backhitch;
+      emulator_stats.backhitches++;
+      emulator_stats.backhitch_time += emulator_cost.backhitch;
+      is_emulator_stopped            = FALSE;
+    }
+    const uint64_t transfer = (length - emulator_read_ahead) / emulator_cost.bandwidth;
+    charged                       += transfer;
+    emulator_stats.transfer_time  += transfer;
+    emulator_read_ahead            = 0;
+  }
+  emulator_stats.read_bytes += length;
+  emulator_behind            = MIN(emulator_behind + length, buffer - MIN(emulator_read_ahead, buffer));
+
+  if (block->length == SCSI_EMULATOR_FILEMARK) {
+    set_emulated_sense(hdr, 0x80, 0x00, 0x00, 0x01, requested); // Filemark detected.
+  } else if (length < requested) {
+    hdr->resid = hdr->dxfer_len - length;
+    if (!is_sili) {
+      set_emulated_sense(hdr, 0x20, 0x00, 0x00, 0x00, requested - length);
+    }
+  } else {
+    hdr->resid = hdr->dxfer_len - requested;
+    if (requested < length) {
+      set_emulated_sense(hdr, 0x20, 0x00, 0x00, 0x00, (uint32_t)(requested - length)); // The rest of the block is lost.
+    }
+  }
+  return charged;
+}
+
+/**
+ * Space over blocks, filemarks or to EOD.
+ * @param [in/out] (hdr) SCSI Generic Input/Output Header.
+ * @return               Charged time in microseconds.
+ */
+static uint64_t space_emulated_tape(sg_io_hdr_t* const hdr) {
+  const emulated_partition* const part = &emulator_partitions[emulator_partition];
+  const uint8_t code                   = hdr->cmdp[1] & 0x07;
+  int32_t count                        = hdr->cmdp[2] << 16 | hdr->cmdp[3] << 8 | hdr->cmdp[4];
+  const uint64_t index                 = find_emulated_filemark(part, emulator_block);
+
+  if (count & 0x800000) {
+    count -= 0x1000000; // Sign extension of 24 bits.
+  }
+  switch (code) {
+  case 0x03: // End of data
+    return move_emulated_tape(emulator_partition, part->count);
+  case 0x01: // Filemarks
+    if (count > 0 && part->filemark_count < index + count) {
+      const uint64_t charged = move_emulated_tape(emulator_partition, part->count);
+      set_emulated_sense(hdr, 0x00, 0x08, 0x00, 0x05, index + count - part->filemark_count);
+      return charged;
+    }
+    if (count > 0) {
+      return move_emulated_tape(emulator_partition, part->filemarks[index + count - 1] + 1);
+    }
+    if (count < 0 && index < (uint64_t)-count) {
+      const uint64_t charged = move_emulated_tape(emulator_partition, 0);
+      set_emulated_sense(hdr, 0x40, 0x00, 0x00, 0x04, -count - index); // Beginning-of-partition detected.
+      return charged;
+    }
+    if (count < 0) {
+      // The tape stops on the BOP side of the last filemark.
+      return move_emulated_tape(emulator_partition, part->filemarks[index + count]);
+    }
+    return 0;
+  case 0x00: { // Blocks. A filemark stops the space.
+    const uint64_t start = emulator_block;
+    if (count > 0) {
+      const uint64_t target = MIN(start + count, part->count);
+      if (index < part->filemark_count && part->filemarks[index] < target) {
+        const uint64_t filemark = part->filemarks[index];
+        const uint64_t charged  = move_emulated_tape(emulator_partition, filemark + 1);
+        set_emulated_sense(hdr, 0x80, 0x00, 0x00, 0x01, start + count - (filemark + 1));
+        return charged;
+      }
+      const uint64_t charged = move_emulated_tape(emulator_partition, target);
+      if (target < start + count) {
+        set_emulated_sense(hdr, 0x00, 0x08, 0x00, 0x05, start + count - target);
+      }
+      return charged;
+    }
+    if (count < 0) {
+      const uint64_t target = ((uint64_t)-count <= start) ? start + count : 0;
+      if (0 < index && target <= part->filemarks[index - 1]) {
+        const uint64_t filemark = part->filemarks[index - 1];
+        const uint64_t charged  = move_emulated_tape(emulator_partition, filemark);
+        set_emulated_sense(hdr, 0x80, 0x00, 0x00, 0x01, -count - (start - filemark));
+        return charged;
+      }
+      const uint64_t charged = move_emulated_tape(emulator_partition, target);
+      if (start < (uint64_t)-count) {
+        set_emulated_sense(hdr, 0x40, 0x00, 0x00, 0x04, -count - start);
+      }
+      return charged;
+    }
+    return 0;
+  }
+  default:
+    set_emulated_sense(hdr, 0, 0x05, 0x24, 0x00, 0);
+    return 0;
+  }
+}
+
+/**
+ * Answer READ POSITION in the short or the long form.
+ * @param [in/out] (hdr) SCSI Generic Input/Output Header.
+ */
+static void read_emulated_position(sg_io_hdr_t* const hdr) {
+  const emulated_partition* const part = &emulator_partitions[emulator_partition];
+  const uint8_t service_action         = hdr->cmdp[1] & 0x1F;
+  uint8_t data[32]                     = { 0 };
+  uint32_t size                        = 0;
+
+  data[0] = (emulator_block == 0) ? 0x80 : 0x00; // BOP
+  if (service_action == 0x06) {
+    const uint64_t file = find_emulated_filemark(part, emulator_block);
+    size = 32;
+    for (int i = 0; i < 4; i++) {
+      data[4 + i] = emulator_partition >> (8 * (3 - i));
+    }
+    for (int i = 0; i < 8; i++) {
+      data[8 + i]  = emulator_block >> (8 * (7 - i));
+      data[16 + i] = file >> (8 * (7 - i));
+    }
+  } else if (service_action == 0x00 || service_action == 0x01) {
+    size    = 20;
+    data[1] = emulator_partition;
+    for (int i = 0; i < 4; i++) {
+      data[4 + i] = emulator_block >> (8 * (3 - i));
+      data[8 + i] = emulator_block >> (8 * (3 - i));
+    }
+  } else {
+    set_emulated_sense(hdr, 0, 0x05, 0x24, 0x00, 0);
+    return;
+  }
+  size = MIN(size, hdr->dxfer_len);
+  memcpy(hdr->dxferp, data, size);
+  hdr->resid = hdr->dxfer_len - size;
+}
+
+/**
+ * Answer READ ATTRIBUTE(ATTRIBUTE VALUES) from the attributes of a partition in the image.
+ * The response starts with the first attribute whose ID is the requested one or greater, like a drive.
+ * @param [in/out] (hdr) SCSI Generic Input/Output Header.
+ */
+static void read_emulated_attribute(sg_io_hdr_t* const hdr) {
+  const uint8_t partition = hdr->cmdp[7];
+  const uint16_t first_id = hdr->cmdp[8] << 8 | hdr->cmdp[9];
+  uint8_t* const data     = (uint8_t*)hdr->dxferp;
+
+  hdr->resid = hdr->dxfer_len;
+  if ((hdr->cmdp[1] & 0x1F) != 0x00 || SCSI_EMULATOR_PARTITIONS <= partition) {
+    set_emulated_sense(hdr, 0, 0x05, 0x24, 0x00, 0);
+    return;
+  }
+  const emulated_partition* const part = &emulator_partitions[partition];
+  uint8_t* const attributes            = (uint8_t*)malloc(part->attribute_length + 1);
+  if (attributes == NULL || part->attribute_length < 4
+      || pread_emulated_image(attributes, part->attribute_length, part->attribute_offset) != OK) {
+    free(attributes);
+    set_emulated_sense(hdr, 0, 0x03, 0x11, 0x12, 0); // Auxiliary memory read error.
+    return;
+  }
+
+  const uint64_t end = MIN(4 + btoui(attributes, 4), part->attribute_length);
+  uint64_t size      = 4;
+  for (uint64_t offset = 4; offset + 5 <= end;) {
+    const uint16_t id     = btoui(attributes + offset, 2);
+    const uint64_t length = 5 + btoui(attributes + offset + 3, 2);
+    if (first_id <= id && size < hdr->dxfer_len) {
+      memcpy(data + size, attributes + offset, MIN(length, hdr->dxfer_len - size));
+    }
+    if (first_id <= id) {
+      size += length;
+    }
+    offset += length;
+  }
+  free(attributes);
+  // The available length is the whole of the attributes, even if the buffer is too small.
+  for (int i = 0; i < 4 && i < (int)hdr->dxfer_len; i++) {
+    data[i] = (size - 4) >> (8 * (3 - i));
+  }
+  hdr->resid = hdr->dxfer_len - MIN(size, hdr->dxfer_len);
+}
+
+/**
+ * Answer INQUIRY with the standard data of a sequential-access device.
+ * @param [in/out] (hdr) SCSI Generic Input/Output Header.
+ */
+static void inquire_emulated_drive(sg_io_hdr_t* const hdr) {
+  uint8_t data[36] = { 0 };
+
+  if ((hdr->cmdp[1] & 0x01) != 0) {
+    set_emulated_sense(hdr, 0, 0x05, 0x24, 0x00, 0); // No vital product data page is emulated.
+    hdr->resid = hdr->dxfer_len;
+    return;
+  }
+  data[0] = 0x01;                       // Sequential-access device
+  data[1] = 0x80;                       // Removable
+  data[2] = 0x06;
+  data[3] = 0x02;
+  data[4] = sizeof(data) - 5;
+  memcpy(data + 8,  "OTFormat", 8);
+  memcpy(data + 16, "Emulated drive  ", 16);
+  memcpy(data + 32, "0001", 4);
+  const uint32_t size = MIN(sizeof(data), hdr->dxfer_len);
+  memcpy(hdr->dxferp, data, size);
+  hdr->resid = hdr->dxfer_len - size;
+}
+
+/**
+ * Answer LOG SENSE of the volume personality, which is the only parameter referred by the reader.
+ * @param [in/out] (hdr) SCSI Generic Input/Output Header.
+ */
+static void sense_emulated_log(sg_io_hdr_t* const hdr) {
+  uint8_t data[8 + sizeof(emulator_personality)] = { 0 };
+
+  hdr->resid = hdr->dxfer_len;
+  if ((hdr->cmdp[2] & 0x3F) != 0x17) {
+    set_emulated_sense(hdr, 0, 0x05, 0x24, 0x00, 0);
+    return;
+  }
+  data[0] = 0x17;
+  data[3] = sizeof(data) - 4;
+  data[5] = 0x45;
+  data[7] = sizeof(emulator_personality);
+  memcpy(data + 8, emulator_personality, sizeof(emulator_personality));
+  const uint32_t size = MIN(sizeof(data), hdr->dxfer_len);
+  memcpy(hdr->dxferp, data, size);
+  hdr->resid = hdr->dxfer_len - size;
+}
+
+/**
+ * Answer a SCSI command from the tape image instead of the drive, and charge its time.
+ *
+ * @param  hdr [i->o] SCSI Generic Input/Output Header, whose sbp is the raw sense data
+ * @return 0 like ioctl, or -1 if the emulator has already stopped
+ */
+int emulate_scsi_command(sg_io_hdr_t* const hdr) {
+  pthread_mutex_lock(&emulator_mutex);
+  if (is_emulator_enabled == FALSE) {
+    pthread_mutex_unlock(&emulator_mutex);
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "The emulated drive has already stopped.\n");
+    return -1;
+  }
+  const uint64_t now = start_metric_timer();
+  const uint64_t gap = (now > emulator_last_time) ? now - emulator_last_time : 0;
+  uint64_t charged   = emulator_cost.command;
+
+  hdr->status    = 0x00;
+  hdr->resid     = 0;
+  hdr->sb_len_wr = 0;
+  switch (hdr->cmdp[0]) {
+  case 0x00: // TEST UNIT READY
+    break;
+  case 0x01: // REWIND
+    charged += move_emulated_tape(0, 0);
+    break;
+  case 0x08: // READ(6)
+    charged += read_emulated_block(hdr, gap);
+    break;
+  case 0x11: // SPACE(6)
+    charged += space_emulated_tape(hdr);
+    break;
+  case 0x12: // INQUIRY
+    inquire_emulated_drive(hdr);
+    break;
+  case 0x2B: { // LOCATE(10)
+    const uint32_t partition = (hdr->cmdp[1] & 0x02) ? hdr->cmdp[8] : emulator_partition;
+    const uint64_t block     = btoui(hdr->cmdp + 3, 4);
+    if (SCSI_EMULATOR_PARTITIONS <= partition) {
+      set_emulated_sense(hdr, 0, 0x05, 0x24, 0x00, 0);
+    } else if (emulator_partitions[partition].count < block) {
+      charged += move_emulated_tape(partition, emulator_partitions[partition].count);
+      set_emulated_sense(hdr, 0, 0x08, 0x00, 0x05, 0);
+    } else {
+      charged += move_emulated_tape(partition, block);
+    }
+    break;
+  }
+  case 0x34: // READ POSITION
+    read_emulated_position(hdr);
+    break;
+  case 0x4D: // LOG SENSE
+    sense_emulated_log(hdr);
+    break;
+  case 0x8C: // READ ATTRIBUTE
+    read_emulated_attribute(hdr);
+    break;
+  default:
+    set_emulated_sense(hdr, 0, 0x05, 0x20, 0x00, 0); // Invalid command operation code.
+    hdr->resid = hdr->dxfer_len;
+    break;
+  }
+  emulator_stats.commands++;
+  emulator_stats.command_time += emulator_cost.command;
+  pthread_mutex_unlock(&emulator_mutex);
+
+  if (emulator_cost.is_slept && charged > 0) {
+    const struct timespec wait = { charged / 1000000, (charged % 1000000) * 1000 };
+    nanosleep(&wait, NULL);
+  }
+  // The drive reads ahead while the host is busy between commands, which starts from here.
+  pthread_mutex_lock(&emulator_mutex);
+  emulator_last_time = start_metric_timer();
+  pthread_mutex_unlock(&emulator_mutex);
+  return 0;
+}
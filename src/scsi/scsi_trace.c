@@ -0,0 +1,214 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file scsi_trace.c
+ * @brief Functions to record SCSI commands to a trace file and to replay them without a tape drive
+ *
+ * Every command issued by run_scsi_command is recorded with its CDB, status, sense data, residual count,
+ * latency and the data read from the drive or its MD5. In replay mode, run_scsi_command answers each command
+ * with the recorded response instead of the drive, optionally after the recorded latency,
+ * so a restore can be reproduced with no hardware as long as the same commands are issued in the same order.
+ */
+
+#include <pthread.h>
+#include <openssl/md5.h>
+#include "spti_lib.h"
+
+static FILE* scsi_trace_file                = NULL;
+static int scsi_trace_mode                  = SCSI_TRACE_OFF;
+static int is_scsi_trace_digest             = FALSE;
+static int is_scsi_trace_latency_replayed   = FALSE;
+static uint64_t scsi_trace_commands         = 0;  // Commands recorded or replayed.
+static pthread_mutex_t scsi_trace_mutex     = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Start to record SCSI commands. The trace is closed at exit.
+ *
+ * @param  path      [i] Path of the trace file
+ * @param  is_digest [i] TRUE: record MD5 of the data read from the drive, FALSE: record the data
+ * @return TRUE: success, FALSE: failed
+ */
+BOOL start_scsi_trace_record(const char* const path, const int is_digest) {
+  scsi_trace_header header = { SCSI_TRACE_MAGIC, SCSI_TRACE_VERSION, is_digest ? TRUE : FALSE };
+
+  scsi_trace_file = fopen(path, "wb");
+  if (scsi_trace_file == NULL) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Can't open the SCSI trace(%s). error=%s\n", path, strerror(errno));
+    return FALSE;
+  }
+  setvbuf(scsi_trace_file, NULL, _IOFBF, SCSI_TRACE_BUFFER_SIZE);
+  if (fwrite(&header, sizeof(header), 1, scsi_trace_file) != 1) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to write the SCSI trace(%s).\n", path);
+    fclose(scsi_trace_file);
+    scsi_trace_file = NULL;
+    return FALSE;
+  }
+  is_scsi_trace_digest = is_digest ? TRUE : FALSE;
+  scsi_trace_commands  = 0;
+  scsi_trace_mode      = SCSI_TRACE_RECORD;
+  atexit(stop_scsi_trace);
+  return TRUE;
+}
+
+/**
+ * Start to answer SCSI commands from a trace instead of the drive. The trace is closed at exit.
+ *
+ * @param  path                [i] Path of the trace file
+ * @param  is_latency_replayed [i] TRUE: wait for the recorded latency of each command, FALSE: answer immediately
+ * @return TRUE: success, FALSE: failed
+ */
+BOOL start_scsi_trace_replay(const char* const path, const int is_latency_replayed) {
+  scsi_trace_header header = { { '\0' }, 0, 0 };
+
+  scsi_trace_file = fopen(path, "rb");
+  if (scsi_trace_file == NULL) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Can't open the SCSI trace(%s). error=%s\n", path, strerror(errno));
+    return FALSE;
+  }
+  setvbuf(scsi_trace_file, NULL, _IOFBF, SCSI_TRACE_BUFFER_SIZE);
+  if (fread(&header, sizeof(header), 1, scsi_trace_file) != 1
+      || memcmp(header.magic, SCSI_TRACE_MAGIC, SCSI_TRACE_MAGIC_SIZE) != 0 || header.version != SCSI_TRACE_VERSION) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "%s is not a SCSI trace.\n", path);
+  } else if (header.is_digest) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO,
+                       "%s cannot be replayed because it was recorded with digests instead of data.\n", path);
+  } else {
+    is_scsi_trace_latency_replayed = is_latency_replayed ? TRUE : FALSE;
+    scsi_trace_commands            = 0;
+    scsi_trace_mode                = SCSI_TRACE_REPLAY;
+    atexit(stop_scsi_trace);
+    return TRUE;
+  }
+  fclose(scsi_trace_file);
+  scsi_trace_file = NULL;
+  return FALSE;
+}
+
+/**
+ * Stop recording or replaying. A recorded trace is flushed and closed.
+ */
+void stop_scsi_trace(void) {
+  pthread_mutex_lock(&scsi_trace_mutex);
+  if (scsi_trace_file != NULL) {
+    if (fclose(scsi_trace_file) != 0 && scsi_trace_mode == SCSI_TRACE_RECORD) {
+      output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_ALL_INFO, "Failed to close the SCSI trace. It may be incomplete.\n");
+    }
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_ALL_INFO, "%lu SCSI command(s) were %s.\n", scsi_trace_commands,
+                       (scsi_trace_mode == SCSI_TRACE_RECORD) ? "recorded" : "replayed");
+    scsi_trace_file = NULL;
+  }
+  scsi_trace_mode = SCSI_TRACE_OFF;
+  pthread_mutex_unlock(&scsi_trace_mutex);
+}
+
+/**
+ * Get the mode of the SCSI trace
+ *
+ * @return SCSI_TRACE_OFF, SCSI_TRACE_RECORD or SCSI_TRACE_REPLAY
+ */
+int get_scsi_trace_mode(void) {
+  return scsi_trace_mode;
+}
+
+/**
+ * Record a SCSI command and its response. Recording stops at the first write error.
+ *
+ * @param  hdr     [i] SCSI Generic Input/Output Header after the command, whose sbp is the raw sense data
+ * @param  result  [i] Return value of ioctl
+ * @param  latency [i] Latency of the command in microseconds
+ */
+void record_scsi_command(const sg_io_hdr_t* const hdr, const int result, const uint64_t latency) {
+  scsi_trace_record record                     = { 0 };
+  unsigned char digest[SCSI_TRACE_DIGEST_SIZE] = { 0 };
+  const unsigned char* payload                 = NULL;
+
+  record.latency   = latency;
+  record.dxfer_len = hdr->dxfer_len;
+  record.resid     = hdr->resid;
+  record.result    = result;
+  record.cdb_len   = (hdr->cmd_len < SCSI_TRACE_CDB_SIZE) ? hdr->cmd_len : SCSI_TRACE_CDB_SIZE;
+  record.status    = hdr->status;
+  memcpy(record.cdb, hdr->cmdp, record.cdb_len);
+  memcpy(record.sense, hdr->sbp, SCSI_TRACE_SENSE_SIZE);
+  if (result >= 0 && hdr->dxfer_direction == SG_DXFER_FROM_DEV && hdr->resid < (int)hdr->dxfer_len) {
+    if (is_scsi_trace_digest) {
+      MD5((const unsigned char*)hdr->dxferp, hdr->dxfer_len - hdr->resid, digest);
+      record.payload_kind = SCSI_TRACE_PAYLOAD_DIGEST;
+      record.payload_size = SCSI_TRACE_DIGEST_SIZE;
+      payload             = digest;
+    } else {
+      record.payload_kind = SCSI_TRACE_PAYLOAD_DATA;
+      record.payload_size = hdr->dxfer_len - hdr->resid;
+      payload             = (const unsigned char*)hdr->dxferp;
+    }
+  }
+
+  pthread_mutex_lock(&scsi_trace_mutex);
+  if (scsi_trace_mode == SCSI_TRACE_RECORD) {
+    if (fwrite(&record, sizeof(record), 1, scsi_trace_file) != 1
+        || (record.payload_size > 0 && fwrite(payload, record.payload_size, 1, scsi_trace_file) != 1)) {
+      output_accdg_to_vl(OUTPUT_WARNING, DISPLAY_ALL_INFO, "Failed to write the SCSI trace. No more commands are recorded.\n");
+      fclose(scsi_trace_file);
+      scsi_trace_file = NULL;
+      scsi_trace_mode = SCSI_TRACE_OFF;
+    } else {
+      scsi_trace_commands++;
+    }
+  }
+  pthread_mutex_unlock(&scsi_trace_mutex);
+}
+
+/**
+ * Answer a SCSI command with the next response in the trace instead of the drive.
+ * The command must be the same as the recorded one, otherwise the replay stops and every command fails after it.
+ *
+ * @param  hdr [i->o] SCSI Generic Input/Output Header, whose sbp is the raw sense data
+ * @return Return value of ioctl in the trace, or -1 if the command is not in the trace
+ */
+int replay_scsi_command(sg_io_hdr_t* const hdr) {
+  scsi_trace_record record = { 0 };
+  int result               = -1;
+
+  pthread_mutex_lock(&scsi_trace_mutex);
+  if (scsi_trace_mode != SCSI_TRACE_REPLAY || scsi_trace_file == NULL) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "The SCSI trace has already stopped.\n");
+  } else if (fread(&record, sizeof(record), 1, scsi_trace_file) != 1) {
+    output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "The SCSI trace ended at command #%lu (%02Xh).\n",
+                       scsi_trace_commands, hdr->cmdp[0]);
+    scsi_trace_mode = SCSI_TRACE_OFF;
+  } else if (record.cdb_len != hdr->cmd_len || memcmp(record.cdb, hdr->cmdp, record.cdb_len) != 0
+             || record.dxfer_len != hdr->dxfer_len || record.payload_size > hdr->dxfer_len) {
+    output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "SCSI command #%lu (%02Xh) is different from the trace (%02Xh).\n",
+                       scsi_trace_commands, hdr->cmdp[0], record.cdb[0]);
+    scsi_trace_mode = SCSI_TRACE_OFF;
+  } else if (record.payload_size > 0 && fread(hdr->dxferp, record.payload_size, 1, scsi_trace_file) != 1) {
+    output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "The SCSI trace is truncated at command #%lu.\n", scsi_trace_commands);
+    scsi_trace_mode = SCSI_TRACE_OFF;
+  } else {
+    memcpy(hdr->sbp, record.sense, SCSI_TRACE_SENSE_SIZE);
+    hdr->status    = record.status;
+    hdr->resid     = record.resid;
+    hdr->sb_len_wr = SCSI_TRACE_SENSE_SIZE;
+    result         = record.result;
+    scsi_trace_commands++;
+  }
+  pthread_mutex_unlock(&scsi_trace_mutex);
+
+  if (result >= 0 && is_scsi_trace_latency_replayed) {
+    const struct timespec latency = { record.latency / 1000000, (record.latency % 1000000) * 1000 };
+    nanosleep(&latency, NULL);
+  }
+  return result;
+}
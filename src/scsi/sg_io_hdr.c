@@ -21,6 +21,7 @@
 #include <string.h>
 #include "spti_lib.h"
 #include "output_level.h"
+#include "metrics.h"
 
 /*
 static void set_cmd(sg_io_hdr_t* const hdr, const unsigned char cmd_len,
@@ -119,7 +120,7 @@ static void show_sense_data(const ST_SPTI_REQUEST_SENSE_RESPONSE* const sbp, con
                                       "Blank Check", "",
                                       "", "Aborted Command",
                                       "", "Volume Overflow", "", "" };
-  char* log_level = OUTPUT_WARNING;
+  int log_level = OUTPUT_WARNING;
   if (sbp->sense_key == 0) {
     log_level = OUTPUT_INFO;
   }
@@ -151,7 +152,20 @@ BOOL run_scsi_command(void* const scparam, sg_io_hdr_t* const hdr, uint32_t* con
   hdr->sbp                                  = sense_data;
 
   output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start SCSI_COMMAND:(%x)\n", hdr->cmdp[0]);
-  const int ret = ioctl(psdp->fd_scsidevice, SG_IO, hdr);
+  const uint64_t start = start_metric_timer();
+  int ret              = 0;
+  if (is_scsi_emulator_enabled()) {
+    ret = emulate_scsi_command(hdr);
+  } else if (get_scsi_trace_mode() == SCSI_TRACE_REPLAY) {
+    ret = replay_scsi_command(hdr);
+  } else {
+    ret = ioctl(psdp->fd_scsidevice, SG_IO, hdr);
+  }
+  // Commands answered by the emulated drive are recorded as well, so that a trace can be made from a tape image.
+  if (get_scsi_trace_mode() == SCSI_TRACE_RECORD) {
+    record_scsi_command(hdr, ret, start_metric_timer() - start);
+  }
+  observe_scsi_command(hdr->cmdp[0], start, hdr->status, sense_data[2] & 0x0F, sense_data[12], sense_data[13]);
 
   sbp->scsi_status             = hdr->status;
   sbp->filemark                = sense_data[2] & 0x80 ? 1 : 0;
@@ -179,7 +193,7 @@ BOOL run_scsi_command(void* const scparam, sg_io_hdr_t* const hdr, uint32_t* con
                        "Sending SCSI Command failed.\n");
     return FALSE;
   }
-  char* log_level = OUTPUT_WARNING;
+  int log_level = OUTPUT_WARNING;
   if (sbp->sense_key == 0) {
     log_level = OUTPUT_INFO;
   }
@@ -21,11 +21,6 @@
 #include "ltos_format_checker.h"
 
 
-static SCSI_DEVICE_PARAM* scsi_param                = NULL;
-static ST_SPTI_REQUEST_SENSE_RESPONSE* sense_data   = NULL;
-static ST_SYSTEM_ERRORINFO* err_info                = NULL;
-
-
 /**
  * Set all pointers which are essential to control a tape drive.
  * @param [in] (scsiparam) Pointer to a structure of SCSI_DEVICE_PARAM
@@ -33,12 +28,13 @@ static ST_SYSTEM_ERRORINFO* err_info                = NULL;
  * @param [in] (errinfo)   Pointer to a structure of ST_SYSTEM_ERRORINFO
  */
 void  set_device_pram(SCSI_DEVICE_PARAM* scsiparam, ST_SPTI_REQUEST_SENSE_RESPONSE* sensedata, ST_SYSTEM_ERRORINFO* errinfo) {
+  reader_context* const ctx = get_reader_context();
   if (scsiparam == NULL || sensedata == NULL || errinfo == NULL) {
     output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Null pointer is detected at set_device_pram");
   }
-  scsi_param = scsiparam;
-  sense_data = sensedata;
-  err_info   = errinfo;
+  ctx->scsi_param = scsiparam;
+  ctx->sense_data = sensedata;
+  ctx->err_info   = errinfo;
 }
 
 
@@ -49,6 +45,7 @@ void  set_device_pram(SCSI_DEVICE_PARAM* scsiparam, ST_SPTI_REQUEST_SENSE_RESPON
  * @param [in] (residual_count) Actual data size
  */
 int read_data(uint32_t const data_trans_len, void* const data_pointer, uint32_t* const residual_count) {
+  reader_context* const ctx = get_reader_context();
 //  static int c = 0; // just for debug
   int ret = OK;
   if (data_pointer == NULL || residual_count == NULL) {
@@ -60,13 +57,19 @@ int read_data(uint32_t const data_trans_len, void* const data_pointer, uint32_t*
 //    output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "read_data: %d at p=%d, b=%lu, f=%lu\n",
 //                       c++, pos.partitionNumber, pos.blockNumber, pos.fileNumber);
 //  }
-  if (spti_read_data(scsi_param, data_trans_len, data_pointer, residual_count, sense_data, err_info) != TRUE) {
-    if (sense_data->sense_key == 0 && sense_data->asc == 0 && sense_data->ascq == 1) {
+  if (spti_read_data(ctx->scsi_param, data_trans_len, data_pointer, residual_count, ctx->sense_data, ctx->err_info) == TRUE) {
+    add_metric_counter(METRIC_TAPE_BLOCKS_READ, 1);
+    add_metric_counter(METRIC_TAPE_BYTES_READ, *residual_count);
+#ifdef OBJ_READER
+    add_progress_read_size(*residual_count);
+#endif
+  } else {
+    if (ctx->sense_data->sense_key == 0 && ctx->sense_data->asc == 0 && ctx->sense_data->ascq == 1) {
       output_accdg_to_vl(OUTPUT_INFO, DISPLAY_ALL_INFO, "Filemark detected during reading data.\n");
       ret = NG; // Though this is just a warning, return NG to kick check_fm_next_to_marker at caller if needed.
     } else {
       ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "Failed to Read data: %X/%02X/%02X.\n",
-                                sense_data->sense_key, sense_data->asc, sense_data->ascq);
+                                ctx->sense_data->sense_key, ctx->sense_data->asc, ctx->sense_data->ascq);
     }
   }
   return ret;
@@ -78,9 +81,10 @@ int read_data(uint32_t const data_trans_len, void* const data_pointer, uint32_t*
  * @param [in] (block_address) Destination block address
  */
 int move_on_tape(const uint8_t code, const uint32_t block_address) {
+  reader_context* const ctx = get_reader_context();
   int ret = OK;
 
-  if (spti_space(scsi_param, code, block_address, sense_data, err_info) != TRUE) {
+  if (spti_space(ctx->scsi_param, code, block_address, ctx->sense_data, ctx->err_info) != TRUE) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to move on tape.\n");
   }
   return ret;
@@ -91,11 +95,12 @@ int move_on_tape(const uint8_t code, const uint32_t block_address) {
  * @param [out] (pos) Position
  */
 int read_position_on_tape(ST_SPTI_CMD_POSITIONDATA* pos) {
+  reader_context* const ctx = get_reader_context();
   int ret = OK;
   if (pos == NULL) {
     output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Null pointer is detected at read_position_on_tape");
   }
-  if (spti_read_position(scsi_param, pos, sense_data, err_info) != TRUE) {
+  if (spti_read_position(ctx->scsi_param, pos, ctx->sense_data, ctx->err_info) != TRUE) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to read position on tape.\n");
   }
   return ret;
@@ -107,8 +112,9 @@ int read_position_on_tape(ST_SPTI_CMD_POSITIONDATA* pos) {
  * @return      (OK/NG)            If the format is correct or not.
  */
 int set_tape_head(const int which_partition) {
+  reader_context* const ctx = get_reader_context();
   int ret = OK;
-  if (spti_locate_partition(scsi_param, which_partition, 0, sense_data, err_info) != TRUE) {
+  if (spti_locate_partition(ctx->scsi_param, which_partition, 0, ctx->sense_data, ctx->err_info) != TRUE) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to locate partition %d.\n", which_partition);
   }
   return ret;
@@ -120,14 +126,68 @@ int set_tape_head(const int which_partition) {
  * @return      (OK/NG)            If the format is correct or not.
  */
 int locate_to_tape(const uint32_t block_addres) {
+  reader_context* const ctx = get_reader_context();
   int ret = OK;
-  if (spti_locate(scsi_param, block_addres, sense_data, err_info) != TRUE) {
+  const uint64_t start = start_metric_timer();
+  if (spti_locate(ctx->scsi_param, block_addres, ctx->sense_data, ctx->err_info) != TRUE) {
     ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to locate to Block address: %d.\n", block_addres);
   }
+  observe_metric_timer(METRIC_LOCATE, start);
   return ret;
 }
 
 
+/**
+ * Read a block as it is. Unlike read_data, a filemark and EOD are not errors but reported as a kind of the block.
+ * @param [in]  (data_trans_len) Requested data size
+ * @param [out] (data_pointer)   Pointer to read data
+ * @param [out] (transfer_size)  Actual data size
+ * @param [out] (kind)           TAPE_BLOCK, TAPE_FILEMARK or TAPE_EOD
+ * @return      (OK/NG)          If a block, a filemark or EOD is read, return OK. Otherwise, return NG.
+ */
+int read_raw_block(uint32_t const data_trans_len, void* const data_pointer, uint32_t* const transfer_size, TAPE_BLOCK_KIND* const kind) {
+  reader_context* const ctx = get_reader_context();
+  if (data_pointer == NULL || transfer_size == NULL || kind == NULL) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Null pointer is detected at read_raw_block");
+  }
+  *kind = TAPE_BLOCK;
+  if (spti_read_data(ctx->scsi_param, data_trans_len, data_pointer, transfer_size, ctx->sense_data, ctx->err_info) == TRUE) {
+    add_metric_counter(METRIC_TAPE_BLOCKS_READ, 1);
+    add_metric_counter(METRIC_TAPE_BYTES_READ, *transfer_size);
+    return OK;
+  }
+  if (ctx->sense_data->filemark) {
+    *kind          = TAPE_FILEMARK;
+    *transfer_size = 0;
+    return OK;
+  }
+  if (ctx->sense_data->sense_key == SENSE_KEY_BLANK_CHECK && ctx->sense_data->asc == 0 && ctx->sense_data->ascq == ASCQ_END_OF_DATA) {
+    *kind          = TAPE_EOD;
+    *transfer_size = 0;
+    return OK;
+  }
+  return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "Failed to Read data: %X/%02X/%02X.\n",
+                            ctx->sense_data->sense_key, ctx->sense_data->asc, ctx->sense_data->ascq);
+}
+
+/**
+ * Just a wrapper of "spti_read_attribute" to read all attribute values of a partition from the first attribute.
+ * @param [in]  (which_partition) Partition of which attributes are read.
+ * @param [in]  (data_trans_len)  Size of the buffer.
+ * @param [out] (data_pointer)    Pointer to read attributes.
+ * @param [out] (transfer_size)   Actual data size
+ * @return      (OK/NG)           If success, return OK. Otherwise, return NG.
+ */
+int read_attributes_on_tape(const int which_partition, uint32_t const data_trans_len, void* const data_pointer, uint32_t* const transfer_size) {
+  reader_context* const ctx = get_reader_context();
+  if (spti_read_attribute(ctx->scsi_param, which_partition, 0x00, 0x0000, data_trans_len, data_pointer, transfer_size,
+                          ctx->sense_data, ctx->err_info) != TRUE) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_ALL_INFO, "Failed to read attributes of partition %d: %X/%02X/%02X.\n",
+                              which_partition, ctx->sense_data->sense_key, ctx->sense_data->asc, ctx->sense_data->ascq);
+  }
+  return OK;
+}
+
 #ifdef OBSOLETE
 /**
  * Padding Hexspeaker such as "DEADBEEF" to the buffer.
@@ -0,0 +1,1141 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file tape_generator.c
+ *
+ * Generation of a synthetic tape image which complies with OTFormat, so that the reader and the checker can be
+ * measured without writing real tapes. The image has the same format as the one captured by capture_tape_image().
+ *
+ * Every value of an object is derived from the seed and the index of the object, so the same specification always
+ * makes the same image, and no part of the tape has to be kept in memory to make another part.
+ * The image is made in two passes. The first pass lays out the data partition and writes the reference partition,
+ * whose partial references(PR) hold the information of all OCMs and POs. The second pass writes the data partition
+ * from the PRs read back from the image, so only the object data is made again.
+ */
+
+#ifdef OBJ_READER
+#include <openssl/evp.h>
+#include <openssl/md5.h>
+#include "ltos_format_checker.h"
+
+#define GOLDEN_GAMMA                              (0x9E3779B97F4A7C15UL)
+
+typedef enum {
+  SIZE_FIXED             = 0,                           // All objects are size_min.
+  SIZE_UNIFORM           = 1,                           // From size_min to size_max evenly.
+  SIZE_SKEWED            = 2,                           // Most objects are close to size_min, and a few are up to size_max.
+} SIZE_DISTRIBUTION;
+
+typedef enum {
+  HASH_VOLUME            = 1,                           // System, volume, pool and pool group IDs.
+  HASH_BUCKET_ID         = 2,
+  HASH_PACK_ID           = 3,
+  HASH_OBJECT_ID         = 4,
+  HASH_VERSION_ID        = 5,
+  HASH_KEY               = 6,
+  HASH_SIZE              = 7,
+  HASH_TIME              = 8,
+  HASH_DATA              = 9,
+} HASH_DOMAIN;
+
+typedef struct generator_spec {
+  uint64_t objects;
+  uint64_t objects_per_po;
+  uint64_t pos_per_ocm;
+  uint64_t prs;
+  uint64_t buckets;
+  uint64_t versions;                                    // Number of versions of each key.
+  uint64_t size_min;
+  uint64_t size_max;
+  SIZE_DISTRIBUTION distribution;
+  uint64_t key_length;
+  uint64_t block_size;
+  uint64_t seed;
+  int is_md5;                                           // Add ContentMd5 to the metadata.
+  char barcode[BARCODE_SIZE + 1];
+} generator_spec;
+
+typedef struct tape_generator {
+  generator_spec spec;
+  int fd;
+  FILE* image;
+  char* image_buffer;
+  uint64_t image_size;                                  // Bytes written to the image.
+  uint32_t partition;                                   // Partition being written.
+  uint64_t block_number;                                // Number of the next block in the partition.
+  uint8_t* block;                                       // Block being filled.
+  uint64_t block_used;
+  uint8_t* chunk;                                       // Object data being made.
+  uint8_t* ocm_info;                                    // OCM information being made or written.
+  uint64_t ocm_info_size;
+  uint64_t ocm_info_capacity;
+  FILE* pr_body;                                        // OCM information of the PR being made.
+  uint64_t* po_dir;                                     // Length and first block of each PO in the OCM being made.
+  uint64_t* ocm_dir;                                    // Length and block of each OCM in the PR being made.
+  uint64_t* pr_blocks;                                  // Block of each PR in the data partition.
+  uint64_t* pr_offsets;                                 // Offset in the image of the first block of each PR in the reference partition.
+  uint64_t po_total;
+  uint64_t ocm_total;
+  uint64_t rcm_blocks[NUMBER_OF_PARTITIONS];            // Block of the last RCM in each partition.
+  uuid_t system_id;
+  uuid_t volume_id;
+  uuid_t pool_id;
+  uuid_t pool_group_id;
+  char vol1_label[VOL1_LABEL_SIZE + 1];
+  char* otf_label;
+  char* system_info;                                    // Pool group name and bucket list in RCMs.
+  uint8_t* rcm;                                         // Last RCM.
+  uint64_t rcm_size;
+  uint64_t data_size;                                   // Total size of the object data.
+} tape_generator;
+
+
+/**
+ * Mix a 64-bit value into a pseudo random number (SplitMix64).
+ * @param [in]  (x) Value.
+ * @return      Pseudo random number.
+ */
+static uint64_t splitmix64(uint64_t x) {
+  x += GOLDEN_GAMMA;
+  x  = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9UL;
+  x  = (x ^ (x >> 27)) * 0x94D049BB133111EBUL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * Get a pseudo random number of an item, which depends only on the seed, the kind of value and the index.
+ * @param [in]  (gen)    Generator.
+ * @param [in]  (domain) Kind of value.
+ * @param [in]  (index)  Index of the item.
+ * @return      Pseudo random number.
+ */
+static uint64_t get_hash(const tape_generator* const gen, const HASH_DOMAIN domain, const uint64_t index) {
+  return splitmix64(splitmix64(gen->spec.seed + domain * GOLDEN_GAMMA) ^ index);
+}
+
+/**
+ * Make a UUID of version 4 of an item.
+ * @param [in]  (gen)    Generator.
+ * @param [in]  (domain) Kind of value.
+ * @param [in]  (index)  Index of the item.
+ * @param [out] (uuid)   UUID.
+ */
+static void make_uuid(const tape_generator* const gen, const HASH_DOMAIN domain, const uint64_t index, uuid_t uuid) {
+  const uint64_t upper = get_hash(gen, domain, index * 2);
+  const uint64_t lower = get_hash(gen, domain, index * 2 + 1);
+  w64(BIG, &upper, uuid,     1);
+  w64(BIG, &lower, uuid + 8, 1);
+  uuid[6] = (uuid[6] & 0x0F) | 0x40;
+  uuid[8] = (uuid[8] & 0x3F) | 0x80;
+}
+
+/**
+ * Format a time in UTC as "YYYY-MM-DDThh:mm:ss.ffffffZ".
+ * @param [in]  (seconds)      Seconds since the epoch.
+ * @param [in]  (microseconds) Microseconds.
+ * @param [out] (buf)          Buffer of UTC_LENGTH + 1 bytes or more.
+ */
+static void format_utc_time(const time_t seconds, const uint64_t microseconds, char* const buf) {
+  struct tm tm_utc = { 0 };
+  gmtime_r(&seconds, &tm_utc);
+  sprintf(buf, "%04d-%02d-%02dT%02d:%02d:%02d.%06luZ", tm_utc.tm_year + 1900, tm_utc.tm_mon + 1, tm_utc.tm_mday,
+          tm_utc.tm_hour, tm_utc.tm_min, tm_utc.tm_sec, microseconds);
+}
+
+/**
+ * Write a record to the image.
+ * @param [in]  (gen)    Generator.
+ * @param [in]  (type)   Type of the record.
+ * @param [in]  (number) Block number of the record.
+ * @param [in]  (data)   Data of the record.
+ * @param [in]  (length) Length of the data.
+ */
+static void put_record(tape_generator* const gen, const uint32_t type, const uint64_t number,
+                       const uint8_t* const data, const uint64_t length) {
+  uint8_t header[TAPE_IMAGE_RECORD_HEADER_SIZE] = { 0 };
+  w32(BIG, &type,           header,      1);
+  w32(BIG, &gen->partition, header + 4,  1);
+  w64(BIG, &number,         header + 8,  1);
+  w64(BIG, &length,         header + 16, 1);
+  fwrite(header, 1, TAPE_IMAGE_RECORD_HEADER_SIZE, gen->image);
+  if (length > 0) {
+    fwrite(data, 1, length, gen->image);
+  }
+  const uint64_t size = TAPE_IMAGE_RECORD_HEADER_SIZE + length;
+  if (gen->image_size / TAPE_IMAGE_PROGRESS_SIZE != (gen->image_size + size) / TAPE_IMAGE_PROGRESS_SIZE) {
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu GiB generated. Partition %u: block %lu.\n",
+                       (gen->image_size + size) >> 30, gen->partition, gen->block_number);
+  }
+  gen->image_size += size;
+}
+
+/**
+ * Append bytes to the marker being written. Every full block is written to the image.
+ * @param [in]  (gen)  Generator.
+ * @param [in]  (data) Bytes to be appended.
+ * @param [in]  (size) Number of the bytes.
+ */
+static void append_marker(tape_generator* const gen, const uint8_t* data, uint64_t size) {
+  while (size > 0) {
+    const uint64_t chunk = MIN(size, gen->spec.block_size - gen->block_used);
+    memcpy(gen->block + gen->block_used, data, chunk);
+    gen->block_used += chunk;
+    data            += chunk;
+    size            -= chunk;
+    if (gen->block_used == gen->spec.block_size) {
+      put_record(gen, IMAGE_RECORD_BLOCK, gen->block_number++, gen->block, gen->block_used);
+      gen->block_used = 0;
+    }
+  }
+}
+
+/**
+ * Write the last block of the marker being written.
+ * @param [in]  (gen)        Generator.
+ * @param [in]  (is_padded)  The block is padded with zeros up to the block size like a PO. Otherwise, it is short.
+ */
+static void end_marker(tape_generator* const gen, const int is_padded) {
+  if (gen->block_used > 0) {
+    if (is_padded) {
+      memset(gen->block + gen->block_used, 0, gen->spec.block_size - gen->block_used);
+      gen->block_used = gen->spec.block_size;
+    }
+    put_record(gen, IMAGE_RECORD_BLOCK, gen->block_number++, gen->block, gen->block_used);
+    gen->block_used = 0;
+  }
+}
+
+/**
+ * Write the last block of a marker and a filemark.
+ * @param [in]  (gen) Generator.
+ */
+static void put_filemark(tape_generator* const gen) {
+  end_marker(gen, false);
+  put_record(gen, IMAGE_RECORD_FILEMARK, gen->block_number++, NULL, 0);
+}
+
+/**
+ * Get the number of blocks of a marker.
+ * @param [in]  (gen)  Generator.
+ * @param [in]  (size) Size of the marker.
+ * @return      Number of blocks.
+ */
+static uint64_t get_marker_blocks(const tape_generator* const gen, const uint64_t size) {
+  return (size + gen->spec.block_size - 1) / gen->spec.block_size;
+}
+
+/**
+ * Get the size of an object data.
+ * @param [in]  (gen)   Generator.
+ * @param [in]  (index) Index of the object.
+ * @return      Size of the object data.
+ */
+static uint64_t get_object_size(const tape_generator* const gen, const uint64_t index) {
+  const generator_spec* const spec = &gen->spec;
+  const uint64_t hash              = get_hash(gen, HASH_SIZE, index);
+  const uint64_t range             = spec->size_max - spec->size_min;
+
+  switch (spec->distribution) {
+  case SIZE_UNIFORM:
+    return spec->size_min + hash % (range + 1);
+  case SIZE_SKEWED: {
+    const double u = (double)(hash >> 11) / (double)(1UL << 53);
+    return spec->size_min + (uint64_t)(range * u * u * u * u);
+  }
+  default:
+    return spec->size_min;
+  }
+}
+
+/**
+ * Make the data of an object. The data consists of 8-byte pseudo random numbers.
+ * @param [in]  (gen)    Generator.
+ * @param [in]  (index)  Index of the object.
+ * @param [in]  (offset) Offset in the object data, which is a multiple of 8.
+ * @param [out] (buf)    Buffer.
+ * @param [in]  (size)   Size to be made.
+ */
+static void make_object_data(const tape_generator* const gen, const uint64_t index, const uint64_t offset,
+                             uint8_t* const buf, const uint64_t size) {
+  const uint64_t object_seed = get_hash(gen, HASH_DATA, index);
+  for (uint64_t i = 0; i < size; i += sizeof(uint64_t)) {
+    const uint64_t word = splitmix64(object_seed + (offset + i) / sizeof(uint64_t) * GOLDEN_GAMMA);
+    memcpy(buf + i, &word, MIN(sizeof(uint64_t), size - i));
+  }
+}
+
+/**
+ * Make the metadata of an object.
+ * @param [in]  (gen)   Generator.
+ * @param [in]  (index) Index of the object.
+ * @param [out] (meta)  Buffer of GENERATOR_META_SIZE bytes.
+ * @return      Length of the metadata.
+ */
+static uint64_t make_object_meta(tape_generator* const gen, const uint64_t index, char* const meta) {
+  const generator_spec* const spec          = &gen->spec;
+  const uint64_t key_index                  = index / spec->versions;
+  const uint64_t size                       = get_object_size(gen, index);
+  char key[MAX_KEY_SIZE + 1]                = { '\0' };
+  char last_modified[UTC_LENGTH + 1]    = { '\0' };
+  char version[STR_MAX]                     = { '\0' };
+  char content_md5[STR_MAX]                 = { '\0' };
+
+  // The key is the index in hexadecimal, followed by letters which differ for each key up to the length.
+  const int hex_length = (int)MIN(spec->key_length, 2 * sizeof(uint64_t));
+  snprintf(key, sizeof(key), "%0*lx", hex_length, key_index);
+  for (uint64_t i = hex_length; i < spec->key_length; i++) {
+    key[i] = (i == (uint64_t)hex_length) ? '/' : 'a' + get_hash(gen, HASH_KEY, key_index * spec->key_length + i) % 26;
+  }
+  key[spec->key_length] = '\0';
+
+  // Versions of a key are made one after another, so the last one is the latest.
+  format_utc_time(GENERATOR_BASE_TIME + 60 + index, get_hash(gen, HASH_TIME, index) % 1000000, last_modified);
+
+  if (spec->versions > 1) {
+    uuid_t version_id;
+    make_uuid(gen, HASH_VERSION_ID, index, version_id);
+    strcpy(version, ",\"Version\":\"");
+    uuid_unparse(version_id, version + strlen(version));
+    strcat(version, "\"");
+  }
+
+  if (spec->is_md5) {
+    MD5_CTX md5_ctx                       = { 0 };
+    unsigned char md[MD5_DIGEST_LENGTH]   = { 0 };
+    MD5_Init(&md5_ctx);
+    for (uint64_t offset = 0; offset < size; offset += GENERATOR_CHUNK_SIZE) {
+      const uint64_t chunk = MIN(size - offset, GENERATOR_CHUNK_SIZE);
+      make_object_data(gen, index, offset, gen->chunk, chunk);
+      MD5_Update(&md5_ctx, gen->chunk, chunk);
+    }
+    MD5_Final(md, &md5_ctx);
+    strcpy(content_md5, ",\"ContentMd5\":\"");
+    EVP_EncodeBlock((unsigned char*)content_md5 + strlen(content_md5), md, MD5_DIGEST_LENGTH);
+    strcat(content_md5, "\"");
+  }
+
+  return snprintf(meta, GENERATOR_META_SIZE,
+                  "{\"MetadataVersion\":1,\"Key\":\"%s\",\"Size\":%lu,\"LastModifiedTime\":\"%s\"%s%s}",
+                  key, size, last_modified, version, content_md5);
+}
+
+/**
+ * Make sure that the OCM information has room for more bytes.
+ * @param [in]  (gen)  Generator.
+ * @param [in]  (size) Number of bytes to be added.
+ */
+static void reserve_ocm_info(tape_generator* const gen, const uint64_t size) {
+  if (gen->ocm_info_size + size <= gen->ocm_info_capacity) {
+    return;
+  }
+  gen->ocm_info_capacity = MAX(gen->ocm_info_capacity * 2, gen->ocm_info_size + size);
+  gen->ocm_info          = (uint8_t*)realloc(gen->ocm_info, gen->ocm_info_capacity);
+  if (gen->ocm_info == NULL) {
+    output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to allocate memory for OCM information.\n");
+  }
+}
+
+/**
+ * Add the information of a PO, which is the PO header, the object directory and all metadata, to the OCM information.
+ * @param [in]  (gen)   Generator.
+ * @param [in]  (po)    Index of the PO.
+ * @return      Size of the PO on tape including its identifier.
+ */
+static uint64_t add_po_info(tape_generator* const gen, const uint64_t po) {
+  const generator_spec* const spec = &gen->spec;
+  const uint64_t first_object      = po * spec->objects_per_po;
+  const uint64_t num_of_obj        = MIN(spec->objects_per_po, spec->objects - first_object);
+  const uint64_t directory_offset  = PO_HEADER_SIZE;
+  const uint64_t data_offset       = PO_HEADER_SIZE + (num_of_obj + 1) * PO_DIR_SIZE;
+  const uint64_t base              = gen->ocm_info_size;
+  char meta[GENERATOR_META_SIZE]   = { '\0' };
+  uint64_t offset                  = data_offset;
+
+  reserve_ocm_info(gen, data_offset);
+  uint8_t* header = gen->ocm_info + base;
+  memset(header, 0, data_offset);
+  w64(BIG, &directory_offset, header,      1);
+  w64(BIG, &data_offset,      header + 8,  1);
+  w64(BIG, &num_of_obj,       header + 16, 1);
+  make_uuid(gen, HASH_PACK_ID, po, header + 24);
+  make_uuid(gen, HASH_BUCKET_ID, po % spec->buckets, header + 24 + PACK_ID_SIZE);
+  memcpy(header + 24 + PACK_ID_SIZE + BUCKET_ID_SIZE, gen->system_id, SYSTEM_ID_SIZE);
+  gen->ocm_info_size += data_offset;
+
+  // Each metadata is followed by its data on tape, but the data is not a part of the PO information.
+  for (uint64_t i = 0; i < num_of_obj; i++) {
+    const uint64_t meta_length = make_object_meta(gen, first_object + i, meta);
+    const uint64_t meta_offset = offset;
+    offset += meta_length;
+    const uint64_t object_data_offset = offset;
+    offset += get_object_size(gen, first_object + i);
+
+    reserve_ocm_info(gen, meta_length);
+    uint8_t* const entry = gen->ocm_info + base + directory_offset + i * PO_DIR_SIZE;
+    make_uuid(gen, HASH_OBJECT_ID, first_object + i, entry);
+    w64(BIG, &meta_offset,        entry + OBJECT_ID_SIZE,                         1);
+    w64(BIG, &object_data_offset, entry + OBJECT_ID_SIZE + META_DATA_OFFSET_SIZE, 1);
+    memcpy(gen->ocm_info + gen->ocm_info_size, meta, meta_length);
+    gen->ocm_info_size += meta_length;
+  }
+  // The last entry has no object ID, and both offsets are the end of the PO.
+  uint8_t* const last_entry = gen->ocm_info + base + directory_offset + num_of_obj * PO_DIR_SIZE;
+  w64(BIG, &offset, last_entry + OBJECT_ID_SIZE,                         1);
+  w64(BIG, &offset, last_entry + OBJECT_ID_SIZE + META_DATA_OFFSET_SIZE, 1);
+  return PO_IDENTIFIER_SIZE + offset;
+}
+
+/**
+ * Make the information of an OCM, which is written in the OCM and the PR.
+ * @param [in]  (gen)         Generator.
+ * @param [in]  (ocm)         Index of the OCM.
+ * @param [in]  (first_block) Block of the first PO of the OCM in the data partition.
+ * @param [out] (ocm_block)   Block of the OCM in the data partition.
+ */
+static void make_ocm_info(tape_generator* const gen, const uint64_t ocm, const uint64_t first_block, uint64_t* const ocm_block) {
+  const uint64_t first_po         = ocm * gen->spec.pos_per_ocm;
+  const uint64_t num_of_po        = MIN(gen->spec.pos_per_ocm, gen->po_total - first_po);
+  const uint64_t directory_offset = OCM_HEADER_SIZE;
+  const uint64_t data_offset      = OCM_HEADER_SIZE + num_of_po * OCM_DIR_SIZE;
+  uint64_t block                  = first_block;
+
+  gen->ocm_info_size = 0;
+  reserve_ocm_info(gen, data_offset);
+  gen->ocm_info_size = data_offset;
+  for (uint64_t i = 0; i < num_of_po; i++) {
+    const uint64_t po_info_start = gen->ocm_info_size;
+    const uint64_t po_size       = add_po_info(gen, first_po + i);
+    gen->po_dir[i * 2]     = gen->ocm_info_size - po_info_start;
+    gen->po_dir[i * 2 + 1] = block;
+    block += get_marker_blocks(gen, po_size);
+  }
+  // A filemark follows the POs.
+  *ocm_block = block + 1;
+
+  w64(BIG, &directory_offset, gen->ocm_info,      1);
+  w64(BIG, &data_offset,      gen->ocm_info + 8,  1);
+  w64(BIG, &num_of_po,        gen->ocm_info + 16, 1);
+  for (uint64_t i = 0; i < num_of_po; i++) {
+    const uint64_t block_offset = *ocm_block - gen->po_dir[i * 2 + 1];
+    w64(BIG, &gen->po_dir[i * 2], gen->ocm_info + directory_offset + i * OCM_DIR_SIZE,                    1);
+    w64(BIG, &block_offset,       gen->ocm_info + directory_offset + i * OCM_DIR_SIZE + LENGTH_DIRECTORY, 1);
+  }
+}
+
+/**
+ * Make an RCM with the offsets of the PRs from the RCM.
+ * @param [in]  (gen)        Generator.
+ * @param [in]  (num_of_pr)  Number of PRs.
+ * @param [in]  (rcm_block)  Block of the RCM in the data partition.
+ * @param [out] (size)       Size of the RCM.
+ * @return      RCM, which is freed by the caller.
+ */
+static uint8_t* make_rcm(const tape_generator* const gen, const uint64_t num_of_pr, const uint64_t rcm_block, uint64_t* const size) {
+  const uint64_t directory_offset = RCM_HEADER_SIZE;
+  const uint64_t data_offset      = RCM_HEADER_SIZE + num_of_pr * RCM_DIR_SIZE;
+  const uint64_t data_length      = strlen(gen->system_info);
+  *size = IDENTIFIER_SIZE + data_offset + data_length;
+  uint8_t* const rcm = (uint8_t*)clf_allocate_memory(*size, "RCM");
+  uint8_t* const header = rcm + IDENTIFIER_SIZE;
+
+  memcpy(rcm, RCM_IDENTIFIER, IDENTIFIER_SIZE);
+  w64(BIG, &directory_offset, header,      1);
+  w64(BIG, &data_offset,      header + 8,  1);
+  w64(BIG, &data_length,      header + 16, 1);
+  w64(BIG, &num_of_pr,        header + 24, 1);
+  memcpy(header + 32,                                 gen->system_id,     SYSTEM_ID_SIZE);
+  memcpy(header + 32 + SYSTEM_ID_SIZE,                gen->pool_id,       POOL_ID_SIZE);
+  memcpy(header + 32 + SYSTEM_ID_SIZE + POOL_ID_SIZE, gen->pool_group_id, POOL_GROUP_ID_SIZE);
+  for (uint64_t i = 0; i < num_of_pr; i++) {
+    const uint64_t block_offset = rcm_block - gen->pr_blocks[i];
+    w64(BIG, &block_offset, header + directory_offset + i * RCM_DIR_SIZE, 1);
+  }
+  memcpy(header + data_offset, gen->system_info, data_length);
+  return rcm;
+}
+
+/**
+ * Make the response of READ ATTRIBUTE(ATTRIBUTE VALUES) of a partition, with the attributes read by the reader and the checker.
+ * @param [in]  (gen)       Generator.
+ * @param [in]  (partition) Partition.
+ * @param [out] (buf)       Buffer of GENERATOR_ATTRIBUTE_SIZE bytes.
+ * @return      Size of the response.
+ */
+static uint64_t make_attributes(const tape_generator* const gen, const uint32_t partition, uint8_t* const buf) {
+  static const struct {
+    uint16_t id;
+    uint8_t format;                                     // 0x00: binary, 0x01: ASCII, 0x80: read only.
+    uint16_t length;
+  } attributes[] = {
+    { 0x0009,             0x80, 8 },                    // VOLUME CHANGE REFERENCE
+    { 0x0800,             0x01, MAM_HTA_VENDOR_SIZE },
+    { 0x0801,             0x01, MAM_HTA_NAME_SIZE },
+    { 0x0802,             0x01, MAM_HTA_VERSION_SIZE },
+    { 0x0806,             0x01, MAM_HTA_BARCODE_SIZE },
+    { MAM_PAGE_COHERENCY, 0x00, MAM_PAGE_COHERENCY_SIZE },
+    { 0x0820,             0x00, 2 * sizeof(uuid_t) },   // MEDIUM GLOBALLY UNIQUE IDENTIFIER: system and volume
+    { 0x0821,             0x00, 2 * sizeof(uuid_t) },   // MEDIA POOL GLOBALLY UNIQUE IDENTIFIER: pool and pool group
+  };
+  const uint64_t vcr = GENERATOR_VCR;
+  uint64_t offset    = MAM_HEADER_SIZE;
+
+  memset(buf, 0, GENERATOR_ATTRIBUTE_SIZE);
+  for (uint64_t i = 0; i < sizeof(attributes) / sizeof(attributes[0]); i++) {
+    w16(BIG, &attributes[i].id, buf + offset, 1);
+    buf[offset + 2] = attributes[i].format;
+    w16(BIG, &attributes[i].length, buf + offset + 3, 1);
+    uint8_t* const value = buf + offset + MAM_PAGE_HEADER_SIZE;
+    if (attributes[i].format & 0x01) {
+      memset(value, ' ', attributes[i].length);
+    }
+    switch (attributes[i].id) {
+    case 0x0009:
+      w64(BIG, &vcr, value, 1);
+      break;
+    case 0x0800:
+      memcpy(value, IMPLEMENTATION_IDENTIFIER, strlen(IMPLEMENTATION_IDENTIFIER));
+      break;
+    case 0x0801:
+      memcpy(value, GENERATOR_CREATOR, strlen(GENERATOR_CREATOR));
+      break;
+    case 0x0802:
+      memcpy(value, VERSION_IN_LABEL, strlen(VERSION_IN_LABEL));
+      break;
+    case 0x0806:
+      memcpy(value, gen->spec.barcode, strlen(gen->spec.barcode));
+      break;
+    case MAM_PAGE_COHERENCY: {
+      // VCR length and VCR, PR count, RCM block, and the application client specific information.
+      const uint64_t pr_count  = gen->spec.prs;
+      const uint16_t acsi_size = strlen(IMPLEMENTATION_IDENTIFIER) + MAM_VCI_ACSI_VERSION_SIZE + sizeof(uuid_t);
+      value[0] = sizeof(uint64_t);
+      w64(BIG, &vcr,                         value + 1,  1);
+      w64(BIG, &pr_count,                    value + 9,  1);
+      w64(BIG, &gen->rcm_blocks[partition],  value + 17, 1);
+      w16(BIG, &acsi_size,                   value + 25, 1);
+      memcpy(value + 27, IMPLEMENTATION_IDENTIFIER, strlen(IMPLEMENTATION_IDENTIFIER));
+      value[27 + strlen(IMPLEMENTATION_IDENTIFIER)] = 1;
+      memcpy(value + 27 + strlen(IMPLEMENTATION_IDENTIFIER) + MAM_VCI_ACSI_VERSION_SIZE, gen->volume_id, sizeof(uuid_t));
+      break;
+    }
+    case 0x0820:
+      memcpy(value,                  gen->system_id, sizeof(uuid_t));
+      memcpy(value + sizeof(uuid_t), gen->volume_id, sizeof(uuid_t));
+      break;
+    case 0x0821:
+      memcpy(value,                  gen->pool_id,       sizeof(uuid_t));
+      memcpy(value + sizeof(uuid_t), gen->pool_group_id, sizeof(uuid_t));
+      break;
+    }
+    offset += MAM_PAGE_HEADER_SIZE + attributes[i].length;
+  }
+  const uint32_t available_length = offset - MAM_HEADER_SIZE;
+  w32(BIG, &available_length, buf, 1);
+  return offset;
+}
+
+/**
+ * Write the labels and the first RCM, which are the same in both partitions.
+ * @param [in]  (gen) Generator.
+ */
+static void put_labels(tape_generator* const gen) {
+  uint64_t rcm_size = 0;
+  uint8_t* const rcm = make_rcm(gen, 0, 0, &rcm_size);
+
+  append_marker(gen, (uint8_t*)gen->vol1_label, VOL1_LABEL_SIZE);
+  put_filemark(gen);
+  append_marker(gen, (uint8_t*)gen->otf_label, strlen(gen->otf_label));
+  put_filemark(gen);
+  append_marker(gen, rcm, rcm_size);
+  put_filemark(gen);
+  free(rcm);
+}
+
+/**
+ * Lay out the data partition, and write the reference partition.
+ * Each PR holds the information of its OCMs, which is made in a temporary file first, because the PR begins with
+ * the directory of the OCMs.
+ * @param [in]  (gen) Generator.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int write_reference_partition(tape_generator* const gen) {
+  int ret            = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:write_reference_partition\n");
+  uint64_t dp_block  = 0;
+  uint64_t ocm       = 0;
+
+  gen->partition    = REFERENCE_PARTITION;
+  gen->block_number = 0;
+  put_labels(gen);
+  // The data partition begins with the same labels and RCM.
+  dp_block = gen->block_number;
+
+  for (uint64_t pr = 0; pr < gen->spec.prs; pr++) {
+    const uint64_t last_ocm = (pr + 1) * gen->ocm_total / gen->spec.prs;
+    const uint64_t num_of_ocm = last_ocm - ocm;
+    uint64_t body_size = 0;
+
+    rewind(gen->pr_body);
+    for (uint64_t i = 0; ocm < last_ocm; i++, ocm++) {
+      uint64_t ocm_block = 0;
+      make_ocm_info(gen, ocm, dp_block, &ocm_block);
+      if (fwrite(gen->ocm_info, 1, gen->ocm_info_size, gen->pr_body) != gen->ocm_info_size) {
+        return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write a temporary file. error=%s\n", strerror(errno));
+      }
+      body_size += gen->ocm_info_size;
+      gen->ocm_dir[i * 2]     = gen->ocm_info_size;
+      gen->ocm_dir[i * 2 + 1] = ocm_block;
+      dp_block = ocm_block + get_marker_blocks(gen, IDENTIFIER_SIZE + gen->ocm_info_size) + 1;
+    }
+    if (fflush(gen->pr_body) != 0) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write a temporary file. error=%s\n", strerror(errno));
+    }
+    gen->pr_blocks[pr]  = dp_block;
+    gen->pr_offsets[pr] = gen->image_size;
+
+    const uint64_t directory_offset = PR_HEADER_SIZE;
+    const uint64_t data_offset      = PR_HEADER_SIZE + num_of_ocm * PR_DIR_SIZE;
+    uint8_t header[PR_HEADER_SIZE]  = { 0 };
+    w64(BIG, &directory_offset, header,      1);
+    w64(BIG, &data_offset,      header + 8,  1);
+    w64(BIG, &num_of_ocm,       header + 16, 1);
+    append_marker(gen, (uint8_t*)PR_IDENTIFIER, IDENTIFIER_SIZE);
+    append_marker(gen, header, PR_HEADER_SIZE);
+    for (uint64_t i = 0; i < num_of_ocm; i++) {
+      uint8_t entry[PR_DIR_SIZE]  = { 0 };
+      const uint64_t block_offset = gen->pr_blocks[pr] - gen->ocm_dir[i * 2 + 1];
+      w64(BIG, &gen->ocm_dir[i * 2], entry,                    1);
+      w64(BIG, &block_offset,        entry + LENGTH_DIRECTORY, 1);
+      append_marker(gen, entry, PR_DIR_SIZE);
+    }
+    rewind(gen->pr_body);
+    for (uint64_t copied = 0; copied < body_size; copied += GENERATOR_CHUNK_SIZE) {
+      const uint64_t chunk = MIN(body_size - copied, GENERATOR_CHUNK_SIZE);
+      if (fread(gen->chunk, 1, chunk, gen->pr_body) != chunk) {
+        return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to read a temporary file. error=%s\n", strerror(errno));
+      }
+      append_marker(gen, gen->chunk, chunk);
+    }
+    put_filemark(gen);
+    dp_block += get_marker_blocks(gen, IDENTIFIER_SIZE + data_offset + body_size) + 1;
+    output_accdg_to_vl(OUTPUT_DEBUG, DISPLAY_COMMON_INFO, "PR %lu is laid out at block %lu with %lu OCM(s).\n",
+                       pr, gen->pr_blocks[pr], num_of_ocm);
+  }
+
+  gen->rcm_blocks[REFERENCE_PARTITION] = gen->block_number;
+  gen->rcm_blocks[DATA_PARTITION]      = dp_block;
+  gen->rcm = make_rcm(gen, gen->spec.prs, dp_block, &gen->rcm_size);
+  if (gen->rcm_size >= LTOS_BLOCK_SIZE) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO,
+                              "The RCM is %lu bytes, which has to be smaller than %d. Reduce the number of PRs or buckets.\n",
+                              gen->rcm_size, LTOS_BLOCK_SIZE);
+  }
+  append_marker(gen, gen->rcm, gen->rcm_size);
+  put_filemark(gen);
+  put_record(gen, IMAGE_RECORD_EOD, gen->block_number, NULL, 0);
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "The reference partition is generated. %lu block(s).\n", gen->block_number);
+  return ret;
+}
+
+/**
+ * Read bytes of a marker in the reference partition already written to the image.
+ * @param [in]  (gen)          Generator.
+ * @param [in]  (first_record) Offset in the image of the record of the first block of the marker.
+ * @param [in]  (offset)       Offset from the beginning of the marker.
+ * @param [in]  (size)         Size to be read.
+ * @param [out] (buf)          Buffer.
+ * @return      (OK/NG)        If all bytes are read, return OK. Otherwise, return NG.
+ */
+static int read_reference_marker(const tape_generator* const gen, const uint64_t first_record, uint64_t offset,
+                                 uint64_t size, uint8_t* buf) {
+  const uint64_t block_size = gen->spec.block_size;
+  while (size > 0) {
+    const uint64_t chunk     = MIN(size, block_size - offset % block_size);
+    const uint64_t position  = first_record + (offset / block_size) * (TAPE_IMAGE_RECORD_HEADER_SIZE + block_size)
+                               + TAPE_IMAGE_RECORD_HEADER_SIZE + offset % block_size;
+    const ssize_t read_size  = pread(gen->fd, buf, chunk, position);
+    if (read_size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read_size <= 0) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to read the image at %lu. error=%s\n",
+                                position, (read_size < 0) ? strerror(errno) : "truncated");
+    }
+    buf    += read_size;
+    offset += read_size;
+    size   -= read_size;
+  }
+  return OK;
+}
+
+/**
+ * Write the POs in the OCM information, with the metadata in it and the object data made again.
+ * @param [in]     (gen)    Generator.
+ * @param [in/out] (object) Index of the first object of the OCM, which is advanced to the next OCM.
+ */
+static void write_packed_objects(tape_generator* const gen, uint64_t* const object) {
+  uint64_t num_of_po = 0;
+  r64(BIG, gen->ocm_info + 16, &num_of_po, 1);
+  const uint8_t* po_info = gen->ocm_info + OCM_HEADER_SIZE + num_of_po * OCM_DIR_SIZE;
+
+  for (uint64_t i = 0; i < num_of_po; i++) {
+    uint64_t po_info_length = 0;
+    uint64_t data_offset    = 0;
+    uint64_t num_of_obj     = 0;
+    r64(BIG, gen->ocm_info + OCM_HEADER_SIZE + i * OCM_DIR_SIZE, &po_info_length, 1);
+    r64(BIG, po_info + 8,  &data_offset, 1);
+    r64(BIG, po_info + 16, &num_of_obj,  1);
+
+    append_marker(gen, (uint8_t*)PO_IDENTIFIER_ASCII_CODE, PO_IDENTIFIER_SIZE);
+    append_marker(gen, po_info, data_offset);
+    const uint8_t* meta = po_info + data_offset;
+    for (uint64_t j = 0; j < num_of_obj; j++, (*object)++) {
+      const uint8_t* const entry = po_info + PO_HEADER_SIZE + j * PO_DIR_SIZE;
+      uint64_t meta_offset        = 0;
+      uint64_t object_data_offset = 0;
+      uint64_t next_meta_offset   = 0;
+      r64(BIG, entry + OBJECT_ID_SIZE,                                        &meta_offset,        1);
+      r64(BIG, entry + OBJECT_ID_SIZE + META_DATA_OFFSET_SIZE,                &object_data_offset, 1);
+      r64(BIG, entry + PO_DIR_SIZE + OBJECT_ID_SIZE,                          &next_meta_offset,   1);
+      append_marker(gen, meta, object_data_offset - meta_offset);
+      meta += object_data_offset - meta_offset;
+
+      const uint64_t size = next_meta_offset - object_data_offset;
+      for (uint64_t offset = 0; offset < size; offset += GENERATOR_CHUNK_SIZE) {
+        const uint64_t chunk = MIN(size - offset, GENERATOR_CHUNK_SIZE);
+        make_object_data(gen, *object, offset, gen->chunk, chunk);
+        append_marker(gen, gen->chunk, chunk);
+      }
+      gen->data_size += size;
+    }
+    end_marker(gen, true);
+    po_info += po_info_length;
+  }
+}
+
+/**
+ * Write the data partition from the PRs in the reference partition.
+ * @param [in]  (gen) Generator.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int write_data_partition(tape_generator* const gen) {
+  int ret         = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:write_data_partition\n");
+  uint64_t object = 0;
+
+  if (fflush(gen->image) != 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the tape image. error=%s\n", strerror(errno));
+  }
+  gen->partition    = DATA_PARTITION;
+  gen->block_number = 0;
+  put_labels(gen);
+
+  for (uint64_t pr = 0; pr < gen->spec.prs; pr++) {
+    uint8_t header[PR_HEADER_SIZE] = { 0 };
+    uint64_t num_of_ocm            = 0;
+    if (read_reference_marker(gen, gen->pr_offsets[pr], IDENTIFIER_SIZE, PR_HEADER_SIZE, header) != OK) {
+      return NG;
+    }
+    r64(BIG, header + 16, &num_of_ocm, 1);
+    uint64_t position = IDENTIFIER_SIZE + PR_HEADER_SIZE + num_of_ocm * PR_DIR_SIZE;
+
+    for (uint64_t i = 0; i < num_of_ocm; i++) {
+      uint8_t entry[PR_DIR_SIZE] = { 0 };
+      uint64_t block_offset      = 0;
+      if (read_reference_marker(gen, gen->pr_offsets[pr], IDENTIFIER_SIZE + PR_HEADER_SIZE + i * PR_DIR_SIZE,
+                                PR_DIR_SIZE, entry) != OK) {
+        return NG;
+      }
+      r64(BIG, entry,                    &gen->ocm_info_size, 1);
+      r64(BIG, entry + LENGTH_DIRECTORY, &block_offset,       1);
+      const uint64_t length = gen->ocm_info_size;
+      gen->ocm_info_size = 0;
+      reserve_ocm_info(gen, length);
+      gen->ocm_info_size = length;
+      if (read_reference_marker(gen, gen->pr_offsets[pr], position, length, gen->ocm_info) != OK) {
+        return NG;
+      }
+      position += length;
+
+      write_packed_objects(gen, &object);
+      put_filemark(gen);
+      if (gen->block_number != gen->pr_blocks[pr] - block_offset) {
+        return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "OCM %lu of PR %lu is at block %lu instead of %lu.\n",
+                                  i, pr, gen->block_number, gen->pr_blocks[pr] - block_offset);
+      }
+      append_marker(gen, (uint8_t*)OCM_IDENTIFIER, IDENTIFIER_SIZE);
+      append_marker(gen, gen->ocm_info, length);
+      put_filemark(gen);
+    }
+
+    if (gen->block_number != gen->pr_blocks[pr]) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "PR %lu is at block %lu instead of %lu.\n",
+                                pr, gen->block_number, gen->pr_blocks[pr]);
+    }
+    // The PR is the same as the one in the reference partition.
+    for (uint64_t offset = 0; offset < position; offset += GENERATOR_CHUNK_SIZE) {
+      const uint64_t chunk = MIN(position - offset, GENERATOR_CHUNK_SIZE);
+      if (read_reference_marker(gen, gen->pr_offsets[pr], offset, chunk, gen->chunk) != OK) {
+        return NG;
+      }
+      append_marker(gen, gen->chunk, chunk);
+    }
+    put_filemark(gen);
+  }
+
+  append_marker(gen, gen->rcm, gen->rcm_size);
+  put_filemark(gen);
+  put_record(gen, IMAGE_RECORD_EOD, gen->block_number, NULL, 0);
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "The data partition is generated. %lu block(s).\n", gen->block_number);
+  return ret;
+}
+
+/**
+ * Get a number in a specification, which may end with K, M or G for binary units.
+ * @param [in]  (value)  String of the number.
+ * @param [out] (number) Number.
+ * @return      (OK/NG)  If the string is a number, return OK. Otherwise, return NG.
+ */
+static int get_spec_number(const char* const value, uint64_t* const number) {
+  char unit  = '\0';
+  char extra = '\0';
+  const int matched = sscanf(value, "%lu%c%c", number, &unit, &extra);
+
+  if (matched == 1 && isdigit(value[0])) {
+    return OK;
+  }
+  if (matched != 2 || !isdigit(value[0])) {
+    return NG;
+  }
+  switch (unit) {
+  case 'K':
+    *number <<= 10;
+    return OK;
+  case 'M':
+    *number <<= 20;
+    return OK;
+  case 'G':
+    *number <<= 30;
+    return OK;
+  default:
+    return NG;
+  }
+}
+
+/**
+ * Parse a specification of a tape, which is a list of key=value separated by comma.
+ * @param [in]  (spec_str) Specification. Keys which are not specified are set to the default.
+ * @param [out] (spec)     Specification of the tape.
+ * @return      (OK/NG)    If the specification is valid, return OK. Otherwise, return NG.
+ */
+static int parse_generator_spec(const char* const spec_str, generator_spec* const spec) {
+  int ret              = OK;
+  char* const str      = (char*)clf_allocate_memory(strlen(spec_str) + 1, "generator spec");
+  char* item           = str;
+
+  memset(spec, 0, sizeof(generator_spec));
+  spec->objects        = 1000;
+  spec->objects_per_po = 100;
+  spec->pos_per_ocm    = 10;
+  spec->prs            = 1;
+  spec->buckets        = 1;
+  spec->versions       = 1;
+  spec->size_min       = 1024;
+  spec->size_max       = 1024;
+  spec->distribution   = SIZE_FIXED;
+  spec->key_length     = 32;
+  spec->block_size     = LTOS_BLOCK_SIZE;
+  spec->seed           = 1;
+  spec->is_md5         = true;
+  strcpy(spec->barcode, GENERATOR_DEFAULT_BARCODE);
+
+  strcpy(str, spec_str);
+  while (item != NULL && *item != '\0') {
+    char* const next  = strchr(item, ',');
+    if (next != NULL) {
+      *next = '\0';
+    }
+    char* const value = strchr(item, '=');
+    uint64_t number   = 0;
+    if (value == NULL) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "\"%s\" in the specification is not key=value.\n", item);
+      break;
+    }
+    *value = '\0';
+    const char* const key = item;
+    const char* const val = value + 1;
+    item = (next != NULL) ? next + 1 : NULL;
+
+    if (!strcmp(key, "distribution")) {
+      if (!strcmp(val, "fixed")) {
+        spec->distribution = SIZE_FIXED;
+      } else if (!strcmp(val, "uniform")) {
+        spec->distribution = SIZE_UNIFORM;
+      } else if (!strcmp(val, "skewed")) {
+        spec->distribution = SIZE_SKEWED;
+      } else {
+        ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Distribution must be fixed, uniform or skewed.\n");
+      }
+      continue;
+    }
+    if (!strcmp(key, "barcode")) {
+      if (strlen(val) < VOLUME_IDENTIFIER_SIZE || BARCODE_SIZE < strlen(val)) {
+        ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Barcode must be from %d to %d characters.\n",
+                                  VOLUME_IDENTIFIER_SIZE, BARCODE_SIZE);
+      } else {
+        strcpy(spec->barcode, val);
+      }
+      continue;
+    }
+    if (get_spec_number(val, &number) != OK) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Value of %s is not a number: %s\n", key, val);
+      continue;
+    }
+    if (!strcmp(key, "objects")) {
+      spec->objects = number;
+    } else if (!strcmp(key, "objects_per_po")) {
+      spec->objects_per_po = number;
+    } else if (!strcmp(key, "pos_per_ocm")) {
+      spec->pos_per_ocm = number;
+    } else if (!strcmp(key, "prs")) {
+      spec->prs = number;
+    } else if (!strcmp(key, "buckets")) {
+      spec->buckets = number;
+    } else if (!strcmp(key, "versions")) {
+      spec->versions = number;
+    } else if (!strcmp(key, "size")) {
+      spec->size_min = number;
+      spec->size_max = number;
+    } else if (!strcmp(key, "size_min")) {
+      spec->size_min = number;
+    } else if (!strcmp(key, "size_max")) {
+      spec->size_max = number;
+    } else if (!strcmp(key, "key_length")) {
+      spec->key_length = number;
+    } else if (!strcmp(key, "block_size")) {
+      spec->block_size = number;
+    } else if (!strcmp(key, "seed")) {
+      spec->seed = number;
+    } else if (!strcmp(key, "md5")) {
+      spec->is_md5 = (number != 0);
+    } else {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Unknown key in the specification: %s\n", key);
+    }
+  }
+  free(str);
+
+  if (spec->objects == 0 || spec->objects_per_po == 0 || spec->pos_per_ocm == 0 || spec->versions == 0) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "objects, objects_per_po, pos_per_ocm and versions must be 1 or more.\n");
+  }
+  if (spec->prs == 0 || MAX_NUM_OF_PR < spec->prs) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "prs must be from 1 to %d.\n", MAX_NUM_OF_PR);
+  }
+  if (spec->buckets == 0 || GENERATOR_MAX_BUCKETS < spec->buckets) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "buckets must be from 1 to %d.\n", GENERATOR_MAX_BUCKETS);
+  }
+  if (spec->size_max < spec->size_min || GENERATOR_MAX_OBJECT_SIZE < spec->size_max) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "size_min must be size_max or less, and size_max must be %d or less.\n",
+                              GENERATOR_MAX_OBJECT_SIZE);
+  }
+  if (spec->key_length < GENERATOR_MIN_KEY_LENGTH || MAX_KEY_SIZE < spec->key_length) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "key_length must be from %d to %d.\n",
+                              GENERATOR_MIN_KEY_LENGTH, MAX_KEY_SIZE);
+  } else if (spec->key_length < 2 * sizeof(uint64_t) && (spec->objects - 1) / spec->versions >> (spec->key_length * 4) != 0) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "key_length %lu is too short for %lu keys.\n",
+                              spec->key_length, (spec->objects - 1) / spec->versions + 1);
+  }
+  // The reader and the image extractor read POs in blocks of LTOS_BLOCK_SIZE, so no other size can be validated.
+  if (spec->block_size != LTOS_BLOCK_SIZE) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "block_size must be %d.\n", LTOS_BLOCK_SIZE);
+  }
+  for (int i = 0; i < VOLUME_IDENTIFIER_SIZE; i++) {
+    if (!isupper(spec->barcode[i]) && !isdigit(spec->barcode[i])) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO,
+                                "The first %d characters of the barcode must be upper case letters or digits.\n", VOLUME_IDENTIFIER_SIZE);
+      break;
+    }
+  }
+  return ret;
+}
+
+/**
+ * Initialize a generator: the IDs of the tape, the labels and the bucket list.
+ * @param [out] (gen)  Generator.
+ * @return      (OK/NG) If success, return OK. Otherwise, return NG.
+ */
+static int initialize_generator(tape_generator* const gen) {
+  const generator_spec* const spec       = &gen->spec;
+  char format_time[UTC_LENGTH + 1]   = { '\0' };
+  char volume_uuid[UUID_SIZE + 1]        = { '\0' };
+  char volume_identifier[VOLUME_IDENTIFIER_SIZE + 1] = { '\0' };
+
+  gen->po_total  = (spec->objects + spec->objects_per_po - 1) / spec->objects_per_po;
+  gen->ocm_total = (gen->po_total + spec->pos_per_ocm - 1) / spec->pos_per_ocm;
+  if (gen->ocm_total < spec->prs) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "%lu PR(s) need %lu OCM(s) or more, but there are %lu.\n",
+                              spec->prs, spec->prs, gen->ocm_total);
+  }
+  make_uuid(gen, HASH_VOLUME, 0, gen->system_id);
+  make_uuid(gen, HASH_VOLUME, 1, gen->volume_id);
+  make_uuid(gen, HASH_VOLUME, 2, gen->pool_id);
+  make_uuid(gen, HASH_VOLUME, 3, gen->pool_group_id);
+
+  memcpy(volume_identifier, spec->barcode, VOLUME_IDENTIFIER_SIZE);
+  snprintf(gen->vol1_label, sizeof(gen->vol1_label), "%s%s%s%s%s%s%s%s%s%s", LABEL_IDENTIFIER, LABEL_NUMBER, volume_identifier,
+           VOLUME_ACCESSIBILITY, RESERVED_13_SPACES, IMPLEMENTATION_IDENTIFIER, IMPLEMENTATION_IDENTIFIER_SPCE,
+           OWNER_IDENTIFIER, RESERVED_28_SPACES, LABEL_STANDARD_VERSION);
+
+  format_utc_time(GENERATOR_BASE_TIME, 0, format_time);
+  uuid_unparse(gen->volume_id, volume_uuid);
+  gen->otf_label = (char*)clf_allocate_memory(STR_MAX * 2, "OTFormat label");
+  snprintf(gen->otf_label, STR_MAX * 2,
+           "{\"%sLabel\":{\"Version\":\"%s\",\"FormatTime\":\"%s\",\"VolumeUuid\":\"%s\",\"Creator\":\"%s\","
+           "\"Compression\":false,\"BlockSize\":%lu}}",
+           IMPLEMENTATION_IDENTIFIER, VERSION_IN_LABEL, format_time, volume_uuid, GENERATOR_CREATOR, spec->block_size);
+
+  gen->system_info = (char*)clf_allocate_memory(STR_MAX + spec->buckets * STR_MAX, "system info");
+  char* tail = gen->system_info + sprintf(gen->system_info, "{\"PoolGroupName\":\"GeneratedPoolGroup\",\"BucketList\":[");
+  for (uint64_t i = 0; i < spec->buckets; i++) {
+    uuid_t bucket_id;
+    char bucket_uuid[UUID_SIZE + 1] = { '\0' };
+    make_uuid(gen, HASH_BUCKET_ID, i, bucket_id);
+    uuid_unparse(bucket_id, bucket_uuid);
+    tail += sprintf(tail, "%s{\"BucketID\":\"%s\",\"BucketName\":\"bucket-%05lu\"}", (i == 0) ? "" : ",", bucket_uuid, i);
+  }
+  strcpy(tail, "]}");
+
+  gen->block      = (uint8_t*)clf_allocate_memory(spec->block_size, "block");
+  gen->chunk      = (uint8_t*)clf_allocate_memory(GENERATOR_CHUNK_SIZE, "object data");
+  gen->po_dir     = (uint64_t*)clf_allocate_memory(2 * spec->pos_per_ocm * sizeof(uint64_t), "PO directory");
+  gen->ocm_dir    = (uint64_t*)clf_allocate_memory(2 * (gen->ocm_total / spec->prs + 1) * sizeof(uint64_t), "OCM directory");
+  gen->pr_blocks  = (uint64_t*)clf_allocate_memory(spec->prs * sizeof(uint64_t), "PR blocks");
+  gen->pr_offsets = (uint64_t*)clf_allocate_memory(spec->prs * sizeof(uint64_t), "PR offsets");
+  gen->pr_body    = tmpfile();
+  if (gen->pr_body == NULL) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to create a temporary file. error=%s\n", strerror(errno));
+  }
+  return OK;
+}
+
+/**
+ * Release the resources of a generator.
+ * @param [in]  (gen) Generator.
+ */
+static void destroy_generator(tape_generator* const gen) {
+  if (gen->pr_body != NULL) {
+    fclose(gen->pr_body);
+  }
+  free(gen->otf_label);
+  free(gen->system_info);
+  free(gen->rcm);
+  free(gen->block);
+  free(gen->chunk);
+  free(gen->ocm_info);
+  free(gen->po_dir);
+  free(gen->ocm_dir);
+  free(gen->pr_blocks);
+  free(gen->pr_offsets);
+}
+
+/**
+ * Generate a synthetic tape image which complies with OTFormat, in the format of capture_tape_image().
+ * The image is written to "<image_path>.part" and renamed when it is complete.
+ * @param [in]  (image_path) Path of the image.
+ * @param [in]  (spec)       Specification of the tape such as "objects=1000000,size=4K,prs=10". See README.md for the keys.
+ * @return      (OK/NG)      If the image is generated, return OK. Otherwise, return NG.
+ */
+int generate_tape_image(const char* const image_path, const char* const spec) {
+  int ret                                   = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:generate_tape_image\n");
+  char part_path[OUTPUT_PATH_SIZE + 1]      = { '\0' };
+  uint8_t header[TAPE_IMAGE_HEADER_SIZE]    = { 0 };
+  uint8_t attributes[NUMBER_OF_PARTITIONS][GENERATOR_ATTRIBUTE_SIZE];
+  uint64_t attribute_sizes[NUMBER_OF_PARTITIONS] = { 0 };
+  tape_generator gen                        = { .fd = -1 };
+  const time_t start                        = time(NULL);
+
+  if (parse_generator_spec(spec, &gen.spec) != OK || initialize_generator(&gen) != OK) {
+    destroy_generator(&gen);
+    return NG;
+  }
+  snprintf(part_path, sizeof(part_path), "%s%s", image_path, TAPE_IMAGE_EXTENSION);
+  gen.fd = open(part_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (gen.fd < 0 || (gen.image = fdopen(gen.fd, "w+")) == NULL) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to open the tape image(%s). error=%s\n", part_path, strerror(errno));
+    if (gen.fd >= 0) {
+      close(gen.fd);
+    }
+    destroy_generator(&gen);
+    return ret;
+  }
+  gen.image_buffer = (char*)clf_allocate_memory(GENERATOR_BUFFER_SIZE, "image buffer");
+  setvbuf(gen.image, gen.image_buffer, _IOFBF, GENERATOR_BUFFER_SIZE);
+
+  const uint32_t version    = TAPE_IMAGE_VERSION;
+  const uint32_t partitions = NUMBER_OF_PARTITIONS;
+  memcpy(header, TAPE_IMAGE_MAGIC, TAPE_IMAGE_MAGIC_SIZE);
+  w32(BIG, &version,    header + 8,  1);
+  w32(BIG, &partitions, header + 12, 1);
+  strncpy((char*)header + 16, gen.spec.barcode, TAPE_IMAGE_HEADER_SIZE - 16);
+  fwrite(header, 1, TAPE_IMAGE_HEADER_SIZE, gen.image);
+  gen.image_size = TAPE_IMAGE_HEADER_SIZE;
+
+  // MAM attributes come first, but the blocks of the last RCMs are known after the reference partition is laid out.
+  // They are written with a placeholder now, and written again at the same offset later.
+  for (int i = 0; i < NUMBER_OF_PARTITIONS; i++) {
+    attribute_sizes[i] = make_attributes(&gen, i, attributes[i]);
+    gen.partition = i;
+    put_record(&gen, IMAGE_RECORD_ATTRIBUTE, 0, attributes[i], attribute_sizes[i]);
+  }
+  ret |= write_reference_partition(&gen);
+  if (ret == OK) {
+    ret |= write_data_partition(&gen);
+  }
+  if (ret == OK) {
+    gen.partition = 0;
+    put_record(&gen, IMAGE_RECORD_END, 0, NULL, 0);
+  }
+  if (fflush(gen.image) != 0 || ferror(gen.image)) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the tape image. error=%s\n", strerror(errno));
+  }
+  uint64_t offset = TAPE_IMAGE_HEADER_SIZE;
+  for (int i = 0; i < NUMBER_OF_PARTITIONS && ret == OK; i++) {
+    make_attributes(&gen, i, attributes[i]);
+    if (pwrite(gen.fd, attributes[i], attribute_sizes[i], offset + TAPE_IMAGE_RECORD_HEADER_SIZE) != (ssize_t)attribute_sizes[i]) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the MAM attributes. error=%s\n", strerror(errno));
+    }
+    offset += TAPE_IMAGE_RECORD_HEADER_SIZE + attribute_sizes[i];
+  }
+  if (fsync(gen.fd) != 0 && ret == OK) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to flush the tape image. error=%s\n", strerror(errno));
+  }
+  fclose(gen.image);
+  free(gen.image_buffer);
+
+  if (ret == OK) {
+    if (rename(part_path, image_path) != 0) {
+      ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to rename the tape image to %s. error=%s\n", image_path, strerror(errno));
+    } else {
+      const time_t elapsed = MAX(time(NULL) - start, 1);
+      output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO,
+                         "Tape %s is generated to %s. %lu object(s) in %lu PO(s), %lu OCM(s) and %lu PR(s), "
+                         "%lu bytes of data, %lu bytes of image in %ld seconds.\n",
+                         gen.spec.barcode, image_path, gen.spec.objects, gen.po_total, gen.ocm_total, gen.spec.prs,
+                         gen.data_size, gen.image_size, (long)elapsed);
+    }
+  } else {
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "The incomplete image is left at %s.\n", part_path);
+  }
+  destroy_generator(&gen);
+  return ret;
+}
+#endif // OBJ_READER
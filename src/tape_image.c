@@ -0,0 +1,284 @@
+/*
+ * Copyright 2021 FUJIFILM Corporation
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file tape_image.c
+ *
+ * Capture of a whole tape into an image file, so that objects can be extracted offline.
+ *
+ * An image starts with a header of TAPE_IMAGE_HEADER_SIZE bytes, followed by records in the order they were read.
+ *   Header: magic(8) version(4) number of partitions(4) barcode(16)
+ *   Record: type(4) partition(4) block number(8) length(8) and data of the length
+ * All integers are big endian. The block number counts both blocks and filemarks from the beginning of the partition,
+ * which is the same as the block address on tape. The MAM attributes of all partitions come first,
+ * then the reference partition and the data partition, each of which ends with EOD.
+ */
+
+#ifdef OBJ_READER
+#include <pthread.h>
+#include "ltos_format_checker.h"
+
+typedef struct image_slot {
+  uint8_t* buffer;                                      // Record header followed by the data.
+  uint64_t size;                                        // Size of the record including the header.
+} image_slot;
+
+typedef struct image_queue {
+  image_slot slots[TAPE_IMAGE_QUEUE_DEPTH];
+  uint64_t head;                                        // Number of slots filled by the reader.
+  uint64_t tail;                                        // Number of slots written by the writer.
+  int is_closed;                                        // The reader has no more slots.
+  int write_error;                                      // errno of the failed write, 0 if none.
+  int fd;
+  pthread_mutex_t mutex;
+  pthread_cond_t filled;
+  pthread_cond_t written;
+} image_queue;
+
+
+/**
+ * Write all bytes to a file descriptor.
+ * @param [in]  (fd)   File descriptor.
+ * @param [in]  (data) Data to be written.
+ * @param [in]  (size) Size of the data.
+ * @return      (0)    If success, return 0. Otherwise, return errno.
+ */
+static int write_fully(const int fd, const uint8_t* data, uint64_t size) {
+  while (size > 0) {
+    const ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    data += written;
+    size -= written;
+  }
+  return 0;
+}
+
+/**
+ * Write the slots filled by the reader to the image in order, while the reader keeps the drive streaming.
+ * @param [in]  (arg) Image queue.
+ * @return      NULL
+ */
+static void* write_image_slots(void* arg) {
+  image_queue* const queue = (image_queue*)arg;
+
+  pthread_mutex_lock(&queue->mutex);
+  while (true) {
+    while (queue->tail == queue->head && !queue->is_closed) {
+      pthread_cond_wait(&queue->filled, &queue->mutex);
+    }
+    if (queue->tail == queue->head) {
+      break;
+    }
+    image_slot* const slot = &queue->slots[queue->tail % TAPE_IMAGE_QUEUE_DEPTH];
+    pthread_mutex_unlock(&queue->mutex);
+    const int error = (queue->write_error == 0) ? write_fully(queue->fd, slot->buffer, slot->size) : 0;
+    pthread_mutex_lock(&queue->mutex);
+    if (error != 0) {
+      queue->write_error = error;
+    }
+    queue->tail++;
+    pthread_cond_signal(&queue->written);
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return NULL;
+}
+
+/**
+ * Get a free slot. Wait for the writer if all slots are in use.
+ * @param [in]  (queue) Image queue.
+ * @return      Free slot.
+ */
+static image_slot* get_free_slot(image_queue* const queue) {
+  pthread_mutex_lock(&queue->mutex);
+  while (queue->head - queue->tail == TAPE_IMAGE_QUEUE_DEPTH) {
+    pthread_cond_wait(&queue->written, &queue->mutex);
+  }
+  image_slot* const slot = &queue->slots[queue->head % TAPE_IMAGE_QUEUE_DEPTH];
+  pthread_mutex_unlock(&queue->mutex);
+  return slot;
+}
+
+/**
+ * Pass a filled slot to the writer.
+ * @param [in]  (queue)     Image queue.
+ * @param [in]  (type)      Type of the record.
+ * @param [in]  (partition) Partition of the record.
+ * @param [in]  (number)    Block number of the record.
+ * @param [in]  (length)    Length of the data already stored after the record header.
+ * @return      (OK/NG)     If the image has been written without errors so far, return OK. Otherwise, return NG.
+ */
+static int put_filled_slot(image_queue* const queue, const uint32_t type, const uint32_t partition,
+                           const uint64_t number, const uint64_t length) {
+  image_slot* const slot = &queue->slots[queue->head % TAPE_IMAGE_QUEUE_DEPTH];
+  w32(BIG, &type,      slot->buffer,      1);
+  w32(BIG, &partition, slot->buffer + 4,  1);
+  w64(BIG, &number,    slot->buffer + 8,  1);
+  w64(BIG, &length,    slot->buffer + 16, 1);
+  slot->size = TAPE_IMAGE_RECORD_HEADER_SIZE + length;
+
+  pthread_mutex_lock(&queue->mutex);
+  queue->head++;
+  const int error = queue->write_error;
+  pthread_cond_signal(&queue->filled);
+  pthread_mutex_unlock(&queue->mutex);
+  if (error != 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the tape image. error=%s\n", strerror(error));
+  }
+  return OK;
+}
+
+/**
+ * Read all blocks and filemarks of a partition up to EOD, and pass them to the writer without parsing.
+ * @param [in]  (queue)           Image queue.
+ * @param [in]  (which_partition) Partition to be read.
+ * @param [out] (captured_size)   Total size of the blocks captured so far.
+ * @return      (OK/NG)           If EOD is reached, return OK. Otherwise, return NG.
+ */
+static int capture_partition(image_queue* const queue, const int which_partition, uint64_t* const captured_size) {
+  int ret                 = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:capture_partition\n");
+  uint64_t block_number   = 0;
+  uint64_t filemark_count = 0;
+  TAPE_BLOCK_KIND kind    = TAPE_BLOCK;
+  const time_t start      = time(NULL);
+
+  if (set_tape_head(which_partition) != OK) {
+    return NG;
+  }
+  do {
+    image_slot* const slot = get_free_slot(queue);
+    uint32_t size          = 0;
+    if (read_raw_block(LTOS_BLOCK_SIZE, slot->buffer + TAPE_IMAGE_RECORD_HEADER_SIZE, &size, &kind) != OK) {
+      return NG;
+    }
+    const uint32_t type = (kind == TAPE_FILEMARK) ? IMAGE_RECORD_FILEMARK : (kind == TAPE_EOD) ? IMAGE_RECORD_EOD : IMAGE_RECORD_BLOCK;
+    if (put_filled_slot(queue, type, which_partition, block_number, size) != OK) {
+      return NG;
+    }
+    if (kind != TAPE_EOD) {
+      block_number++;
+    }
+    if (kind == TAPE_FILEMARK) {
+      filemark_count++;
+    }
+    if (*captured_size / TAPE_IMAGE_PROGRESS_SIZE != (*captured_size + size) / TAPE_IMAGE_PROGRESS_SIZE) {
+      const time_t elapsed = MAX(time(NULL) - start, 1);
+      output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "%lu GiB captured. Partition %d: block %lu, %lu MB/s.\n",
+                         (*captured_size + size) >> 30, which_partition, block_number, (*captured_size + size) / 1000000 / elapsed);
+    }
+    *captured_size += size;
+  } while (kind != TAPE_EOD);
+
+  output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Partition %d is captured. %lu block(s) including %lu filemark(s).\n",
+                     which_partition, block_number, filemark_count);
+  return ret;
+}
+
+/**
+ * Capture both partitions and the MAM attributes of a tape into an image file at the full speed of the drive.
+ * Blocks are not parsed, and the writer works in parallel with the reads, so the drive keeps streaming.
+ * The image is written to "<image_path>.part" and renamed when it is complete.
+ * @param [in]  (image_path) Path of the image.
+ * @param [in]  (barcode_id) Barcode of the tape.
+ * @return      (OK/NG)      If the whole tape is captured, return OK. Otherwise, return NG.
+ */
+int capture_tape_image(const char* const image_path, const char* const barcode_id) {
+  int ret                              = output_accdg_to_vl(OUTPUT_TRACE, DISPLAY_ALL_INFO, "start:capture_tape_image\n");
+  char part_path[OUTPUT_PATH_SIZE + 1] = { '\0' };
+  uint8_t header[TAPE_IMAGE_HEADER_SIZE] = { 0 };
+  uint64_t captured_size               = 0;
+  image_queue queue                    = { .fd = -1 };
+  pthread_t writer;
+
+  snprintf(part_path, sizeof(part_path), "%s%s", image_path, TAPE_IMAGE_EXTENSION);
+  queue.fd = open(part_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (queue.fd < 0) {
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to open the tape image(%s). error=%s\n", part_path, strerror(errno));
+  }
+  const uint32_t version    = TAPE_IMAGE_VERSION;
+  const uint32_t partitions = NUMBER_OF_PARTITIONS;
+  memcpy(header, TAPE_IMAGE_MAGIC, TAPE_IMAGE_MAGIC_SIZE);
+  w32(BIG, &version,    header + 8,  1);
+  w32(BIG, &partitions, header + 12, 1);
+  strncpy((char*)header + 16, barcode_id, TAPE_IMAGE_HEADER_SIZE - 16);
+  if (write_fully(queue.fd, header, TAPE_IMAGE_HEADER_SIZE) != 0) {
+    close(queue.fd);
+    return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the tape image. error=%s\n", strerror(errno));
+  }
+
+  for (int i = 0; i < TAPE_IMAGE_QUEUE_DEPTH; i++) {
+    queue.slots[i].buffer = (uint8_t*)clf_allocate_memory(TAPE_IMAGE_RECORD_HEADER_SIZE + LTOS_BLOCK_SIZE, "image slot");
+  }
+  pthread_mutex_init(&queue.mutex, NULL);
+  pthread_cond_init(&queue.filled, NULL);
+  pthread_cond_init(&queue.written, NULL);
+  if (pthread_create(&writer, NULL, write_image_slots, &queue) != 0) {
+    ret |= output_accdg_to_vl(OUTPUT_SYSTEM_ERROR, DISPLAY_ALL_INFO, "Failed to start the image writer.\n");
+  }
+
+  // MAM attributes come first, so that they can be checked without reading the whole image.
+  for (int i = 0; i < NUMBER_OF_PARTITIONS && ret == OK; i++) {
+    image_slot* const slot = get_free_slot(&queue);
+    uint32_t size          = 0;
+    if (read_attributes_on_tape(i, MAM_CAPTURE_SIZE, slot->buffer + TAPE_IMAGE_RECORD_HEADER_SIZE, &size) != OK) {
+      ret |= NG;
+      break;
+    }
+    ret |= put_filled_slot(&queue, IMAGE_RECORD_ATTRIBUTE, i, 0, size);
+  }
+  if (ret == OK) {
+    ret |= capture_partition(&queue, REFERENCE_PARTITION, &captured_size);
+  }
+  if (ret == OK) {
+    ret |= capture_partition(&queue, DATA_PARTITION, &captured_size);
+  }
+  if (ret == OK) {
+    get_free_slot(&queue);
+    ret |= put_filled_slot(&queue, IMAGE_RECORD_END, 0, 0, 0);
+  }
+
+  pthread_mutex_lock(&queue.mutex);
+  queue.is_closed = true;
+  pthread_cond_signal(&queue.filled);
+  pthread_mutex_unlock(&queue.mutex);
+  pthread_join(writer, NULL);
+  if (queue.write_error != 0) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to write the tape image. error=%s\n", strerror(queue.write_error));
+  }
+  if (fsync(queue.fd) != 0 && ret == OK) {
+    ret |= output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to flush the tape image. error=%s\n", strerror(errno));
+  }
+  close(queue.fd);
+  pthread_cond_destroy(&queue.written);
+  pthread_cond_destroy(&queue.filled);
+  pthread_mutex_destroy(&queue.mutex);
+  for (int i = 0; i < TAPE_IMAGE_QUEUE_DEPTH; i++) {
+    free(queue.slots[i].buffer);
+  }
+
+  if (ret == OK) {
+    if (rename(part_path, image_path) != 0) {
+      return output_accdg_to_vl(OUTPUT_ERROR, DISPLAY_COMMON_INFO, "Failed to rename the tape image to %s. error=%s\n", image_path, strerror(errno));
+    }
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "Tape %s is captured to %s. %lu bytes.\n", barcode_id, image_path, captured_size);
+  } else {
+    output_accdg_to_vl(OUTPUT_INFO, DISPLAY_COMMON_INFO, "The incomplete image is left at %s.\n", part_path);
+  }
+  return ret;
+}
+#endif // OBJ_READER